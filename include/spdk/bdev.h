@@ -836,6 +836,34 @@ void spdk_bdev_get_qos_rate_limits(struct spdk_bdev *bdev, uint64_t *limits);
 void spdk_bdev_set_qos_rate_limits(struct spdk_bdev *bdev, uint64_t *limits,
 				   void (*cb_fn)(void *cb_arg, int status), void *cb_arg);
 
+/**
+ * Get the quality of service latency target of a bdev.
+ *
+ * \param bdev Block device to query.
+ * \param latency_target_us Pointer to the p99 latency target in microseconds, 0 if not set.
+ * \param weight Pointer to the weight of the bdev.
+ */
+void spdk_bdev_get_qos_latency_target(struct spdk_bdev *bdev, uint64_t *latency_target_us,
+				      uint32_t *weight);
+
+/**
+ * Set the quality of service latency target of a bdev.
+ *
+ * The read/write IOPS limit of the bdev is then adjusted based on the observed p99
+ * completion latency of its I/O: it is decreased when the target is missed and
+ * increased again proportionally to the weight when the target is met. The limit
+ * never exceeds the read/write IOPS rate limit, if one is set.
+ *
+ * \param bdev Block device.
+ * \param latency_target_us p99 latency target in microseconds, 0 to disable it.
+ * \param weight Weight of the bdev relative to other bdevs sharing the same device, 1-100.
+ * \param cb_fn Callback function to be called when the QoS latency target has been updated.
+ * \param cb_arg Argument to pass to cb_fn.
+ */
+void spdk_bdev_set_qos_latency_target(struct spdk_bdev *bdev, uint64_t latency_target_us,
+				      uint32_t weight, void (*cb_fn)(void *cb_arg, int status),
+				      void *cb_arg);
+
 /**
  * Get minimum I/O buffer address alignment for a bdev.
  *
@@ -965,7 +965,10 @@ struct spdk_bdev_io_internal_fields {
 			/** Whether we are currently inside the submit request call */
 			uint8_t in_submit_request		: 1;
 
-			uint8_t reserved			: 2;
+			/** Whether the qos_submit_tsc member is valid */
+			uint8_t qos_released			: 1;
+
+			uint8_t reserved			: 1;
 		};
 		uint8_t raw;
 	} f;
@@ -976,7 +979,10 @@ struct spdk_bdev_io_internal_fields {
 	/** Retry state (resubmit, re-pull, re-push, etc.) */
 	uint8_t retry_state;
 
-	uint8_t	reserved[5];
+	uint8_t	reserved;
+
+	/** Low 32 bits of the tsc at which QoS released the IO to the bdev module. */
+	uint32_t qos_submit_tsc;
 
 	/** The bdev descriptor that was used when submitting this I/O. */
 	struct spdk_bdev_desc *desc;
@@ -50,6 +50,21 @@ uint32_t spdk_crc32c_update(const void *buf, size_t len, uint32_t crc);
  */
 uint32_t spdk_crc32c_iov_update(struct iovec *iov, int iovcnt, uint32_t crc32c);
 
+/**
+ * Calculate partial CRC-32C checksums of several independent data buffer vectors.
+ *
+ * The result is the same as calling spdk_crc32c_iov_update() for each of them, but the
+ * computations may be interleaved, which is faster on CPUs where the CRC instruction has a
+ * latency longer than its throughput.
+ *
+ * \param iovs Array of count data buffer vectors to checksum.
+ * \param iovcnts Array of count sizes of the data buffer vectors.
+ * \param crcs Array of count CRC-32C values. Previous values on input, updated ones on output.
+ * \param count Number of data buffer vectors.
+ */
+void spdk_crc32c_iov_update_multi(struct iovec **iovs, const int *iovcnts, uint32_t *crcs,
+				  int count);
+
 /**
  * Calculate a CRC-32C checksum, for NVMe Protection Information
  *
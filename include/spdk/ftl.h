@@ -74,6 +74,17 @@ struct ftl_stats {
 
 typedef void (*spdk_ftl_stats_fn)(struct ftl_stats *stats, void *cb_arg);
 
+/* Garbage collection victim selection policies */
+enum spdk_ftl_gc_policy {
+	/* Pick the band group with the most invalid data, the least worn one among similar ones */
+	SPDK_FTL_GC_POLICY_GREEDY = 0,
+
+	/* Weigh the space reclaimed against the cost of moving the valid data, favoring
+	 * band groups whose data has not been rewritten for a long time
+	 */
+	SPDK_FTL_GC_POLICY_COST_BENEFIT,
+};
+
 /*
  * FTL configuration.
  *
@@ -147,8 +158,14 @@ struct spdk_ftl_conf {
 	 * structure are valid. And the library will populate any remaining fields with default values.
 	 */
 	size_t					conf_size;
+
+	/* Garbage collection victim selection policy, see spdk_ftl_gc_policy enum */
+	uint32_t				gc_policy;
+
+	/* Number of L2P pages to page in ahead of sequential user IO, 0 disables prefetching */
+	uint32_t				l2p_prefetch_depth;
 } __attribute__((packed));
-SPDK_STATIC_ASSERT(sizeof(struct spdk_ftl_conf) == 136, "Incorrect size");
+SPDK_STATIC_ASSERT(sizeof(struct spdk_ftl_conf) == 144, "Incorrect size");
 
 enum spdk_ftl_mode {
 	/* Create new device */
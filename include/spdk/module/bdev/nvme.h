@@ -27,6 +27,7 @@ enum spdk_bdev_nvme_multipath_policy {
 enum spdk_bdev_nvme_multipath_selector {
 	BDEV_NVME_MP_SELECTOR_ROUND_ROBIN = 1,
 	BDEV_NVME_MP_SELECTOR_QUEUE_DEPTH,
+	BDEV_NVME_MP_SELECTOR_SERVICE_TIME,
 };
 
 struct spdk_bdev_nvme_ctrlr_opts {
@@ -102,6 +103,9 @@ struct spdk_bdev_nvme_opts {
 	uint32_t dhchap_digests;
 	uint32_t dhchap_dhgroups;
 	bool rdma_umr_per_io;
+	/* Hole at bytes 121-123. */
+	uint8_t reserved121[3];
+	uint32_t tcp_zcopy_threshold;
 };
 SPDK_STATIC_ASSERT(sizeof(struct spdk_bdev_nvme_opts) == 128, "Incorrect size");
 
@@ -134,7 +138,7 @@ int spdk_bdev_nvme_create(struct spdk_nvme_transport_id *trid,
  *
  * \param name NVMe bdev name.
  * \param policy Multipath policy (active-passive or active-active).
- * \param selector Multipath selector (round_robin, queue_depth).
+ * \param selector Multipath selector (round_robin, queue_depth, service_time).
  * \param rr_min_io Number of IO to route to a path before switching to another for round-robin.
  * \param cb_fn Function to be called back after completion.
  * \param cb_arg Argument passed to the callback function.
@@ -1753,6 +1753,9 @@ struct spdk_nvme_io_qpair_opts {
 	 *
 	 * This only applies to PCIe and RDMA transports.
 	 *
+	 * For PCIe, the number of commands held back is adapted to the number of outstanding
+	 * commands, so the doorbell is still rung for each command at low queue depth.
+	 *
 	 * The flag was originally named delay_pcie_doorbell. To allow backward compatibility
 	 * both names are kept in unnamed union.
 	 */
@@ -3047,6 +3050,21 @@ int spdk_nvme_poll_group_remove(struct spdk_nvme_poll_group *group, struct spdk_
 int spdk_nvme_poll_group_wait(struct spdk_nvme_poll_group *group,
 			      spdk_nvme_disconnected_qpair_cb disconnected_qpair_cb);
 
+/**
+ * Enable hybrid polling in spdk_nvme_poll_group_wait().
+ *
+ * With hybrid polling, spdk_nvme_poll_group_wait() busy-polls the qpairs of the poll group
+ * instead of waiting for interrupt events if a completion is expected within max_spin_us,
+ * based on the command latency measured on each qpair. It returns the number of completions
+ * in that case. Otherwise, or if nothing completes within max_spin_us, it waits for interrupt
+ * events. This is currently supported by the PCIe transport.
+ *
+ * \param group The poll group.
+ * \param max_spin_us Maximum time to busy-poll in microseconds. 0 disables hybrid polling.
+ */
+void spdk_nvme_poll_group_set_hybrid_polling(struct spdk_nvme_poll_group *group,
+		uint32_t max_spin_us);
+
 /**
  * Return the internal epoll file descriptor of this poll group.
  *
@@ -3107,6 +3125,24 @@ int spdk_nvme_poll_group_destroy(struct spdk_nvme_poll_group *group);
 int64_t spdk_nvme_poll_group_process_completions(struct spdk_nvme_poll_group *group,
 		uint32_t completions_per_qpair, spdk_nvme_disconnected_qpair_cb disconnected_qpair_cb);
 
+/**
+ * Limit the number of completions processed by each call to
+ * spdk_nvme_poll_group_process_completions().
+ *
+ * The budget is shared by the qpairs which have commands outstanding in round robin fashion.
+ * In each round every such qpair may process up to an equal share of the remaining budget, so
+ * a busy qpair cannot delay the completions of the other qpairs. Further rounds hand out the
+ * budget left unused, while there are still completions to process. No credit is kept for
+ * qpairs which used less than their share. When the budget runs out, the next call continues
+ * with the qpairs which were not polled yet.
+ * This is currently supported by the PCIe transport.
+ *
+ * \param group The poll group.
+ * \param budget Maximum number of completions per call and transport. 0 means no limit.
+ */
+void spdk_nvme_poll_group_set_completion_budget(struct spdk_nvme_poll_group *group,
+		uint32_t budget);
+
 /**
  * Check if all qpairs in the poll group are connected.
  *
@@ -4699,6 +4735,12 @@ struct spdk_nvme_transport_ops {
 
 	/* Optional callback for transports to process removal events of attached controllers. */
 	int (*ctrlr_scan_attached)(struct spdk_nvme_probe_ctx *probe_ctx);
+
+	/*
+	 * Optional callback returning the number of ticks until the next completion is expected
+	 * on any qpair of the poll group, or UINT64_MAX if it is not known.
+	 */
+	uint64_t (*poll_group_get_next_completion)(struct spdk_nvme_transport_poll_group *tgroup);
 };
 
 /**
@@ -4762,8 +4804,20 @@ struct spdk_nvme_transport_opts {
 	 * Configure UMR per IO request if supported by the system
 	 */
 	bool rdma_umr_per_io;
+
+	/* Hole at byte 23. */
+	uint8_t reserved23[1];
+
+	/**
+	 * It is used for TCP transport.
+	 *
+	 * Send the data of I/O qpairs with zero-copy once a batch of PDUs written together reaches
+	 * this many bytes. It is zero, which means leaving it to the sock implementation's options,
+	 * by default.
+	 */
+	uint32_t tcp_zcopy_threshold;
 };
-SPDK_STATIC_ASSERT(sizeof(struct spdk_nvme_transport_opts) == 24, "Incorrect size");
+SPDK_STATIC_ASSERT(sizeof(struct spdk_nvme_transport_opts) == 32, "Incorrect size");
 
 /**
  * Get the current NVMe transport options.
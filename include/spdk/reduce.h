@@ -19,6 +19,9 @@ extern "C" {
 
 #define REDUCE_MAX_IOVECS	33
 
+/* Maximum number of chunks a single readv or writev request may span */
+#define REDUCE_MAX_BATCH_CHUNKS	8
+
 /**
  * Describes the information of spdk_reduce_vol.
  */
@@ -161,7 +164,9 @@ const struct spdk_uuid *spdk_reduce_vol_get_uuid(struct spdk_reduce_vol *vol);
  * \param backing_dev Structure describing the backing device to use for the new volume.
  * \param pm_file_dir Directory to use for creation of the persistent memory file to
  *                    use for the new volume.  This function will append the UUID as
- *		      the filename to create in this directory.
+ *		      the filename to create in this directory.  If NULL, no persistent
+ *		      memory file is used and the metadata is kept on the backing device
+ *		      instead, cached in memory and journaled to a log on the device.
  * \param cb_fn Callback function to signal completion of the initialization process.
  * \param cb_arg Argument to pass to the callback function.
  */
@@ -212,8 +217,7 @@ void spdk_reduce_vol_destroy(struct spdk_reduce_backing_dev *backing_dev,
 /**
  * Read data from a libreduce compressed volume.
  *
- * This function will only read from logical blocks on the comparessed volume that
- * fall within the same chunk.
+ * The request may span up to REDUCE_MAX_BATCH_CHUNKS chunks of the compressed volume.
  *
  * \param vol Volume to read data.
  * \param iov iovec array describing the data to be read
@@ -230,8 +234,8 @@ void spdk_reduce_vol_readv(struct spdk_reduce_vol *vol,
 /**
  * Write data to a libreduce compressed volume.
  *
- * This function will only write to logical blocks on the comparessed volume that
- * fall within the same chunk.
+ * The request may span up to REDUCE_MAX_BATCH_CHUNKS chunks of the compressed volume.  The
+ * chunks are compressed in parallel and their backing writes are merged where possible.
  *
  * \param vol Volume to write data.
  * \param iov iovec array describing the data to be written
@@ -283,7 +287,8 @@ void spdk_reduce_vol_print_info(struct spdk_reduce_vol *vol);
  * Get the pm path for a libreduce compressed volume.
  *
  * \param vol Previously loaded or initialized compressed volume.
- * \return pm path for the compressed volume.
+ * \return pm path for the compressed volume, or an empty string if its metadata is kept
+ *         on the backing device.
  */
 const char *spdk_reduce_vol_get_pm_path(const struct spdk_reduce_vol *vol);
 
@@ -189,6 +189,14 @@ struct spdk_sock_impl_opts {
 	 * example: "TLS_AES_256_GCM_SHA384:TLS_AES_128_GCM_SHA256"
 	 */
 	const char *tls_cipher_suites;
+
+	/**
+	 * Maximum time in microseconds a small batch of queued writes may be held back by the
+	 * socket group poller, so that it's sent together with writes queued on later polls.
+	 * Writes are only held back while the peer keeps sending data. 0 disables it.
+	 * Used by posix socket module.
+	 */
+	uint32_t flush_batch_timeout;
 };
 
 /**
@@ -616,6 +624,74 @@ int spdk_sock_group_poll_count(struct spdk_sock_group *group, int max_events);
  */
 int spdk_sock_group_close(struct spdk_sock_group **group);
 
+/**
+ * Statistics of a sock group.
+ */
+struct spdk_sock_group_stats {
+	/** Number of sockets in the group. */
+	uint32_t num_socks;
+
+	uint8_t reserved[4];
+
+	/** Bytes received by the sockets of the group. */
+	uint64_t bytes_read;
+
+	/** Bytes queued for sending by the sockets of the group. */
+	uint64_t bytes_written;
+
+	/** Socket events reaped by the polls of the group. */
+	uint64_t events;
+
+	/**
+	 * Recent load of the group, as a moving average of the bytes transferred per second. Each
+	 * event counts as SPDK_SOCK_GROUP_EVENT_LOAD bytes, so groups handling many small
+	 * transfers aren't considered idle.
+	 */
+	uint64_t load;
+};
+
+/** Bytes accounted to the load of a sock group for each socket event. */
+#define SPDK_SOCK_GROUP_EVENT_LOAD 4096
+
+/**
+ * Get the statistics of a sock group.
+ *
+ * This can be called from any thread, in which case the values are approximate.
+ *
+ * \param group The sock group.
+ * \param stats Filled with the statistics of the group.
+ */
+void spdk_sock_group_get_stats(struct spdk_sock_group *group, struct spdk_sock_group_stats *stats);
+
+/**
+ * Get the recent load of a sock group, as reported in spdk_sock_group_stats.
+ *
+ * This can be called from any thread.
+ *
+ * \param group The sock group.
+ *
+ * \return the load of the group in bytes per second.
+ */
+uint64_t spdk_sock_group_get_load(struct spdk_sock_group *group);
+
+/**
+ * Callback function for spdk_sock_for_each_group().
+ *
+ * \param group The sock group.
+ * \param ctx Context passed to spdk_sock_for_each_group().
+ */
+typedef void (*spdk_sock_group_fn)(struct spdk_sock_group *group, void *ctx);
+
+/**
+ * Call a function for each existing sock group.
+ *
+ * No sock group can be created or closed while the function runs, so it must not block.
+ *
+ * \param fn Function to call.
+ * \param ctx Context passed to fn.
+ */
+void spdk_sock_for_each_group(spdk_sock_group_fn fn, void *ctx);
+
 /**
  * Get the optimal sock group for this sock.
  *
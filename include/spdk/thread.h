@@ -1088,6 +1088,27 @@ struct spdk_iobuf_opts {
 
 	/** Enable per-NUMA node buffer pools */
 	uint8_t	enable_numa;
+
+	/**
+	 * Policy used to take buffers from other NUMA nodes' pools once the local pool is empty,
+	 * see enum spdk_iobuf_numa_steal_policy.  Only used if enable_numa is set.
+	 */
+	uint8_t	numa_steal;
+
+	/**
+	 * Resize the per-channel caches based on how often they run dry and how many of their
+	 * buffers stay unused, instead of keeping the cache sizes requested by the modules.
+	 */
+	uint8_t	enable_adaptive_cache;
+};
+
+enum spdk_iobuf_numa_steal_policy {
+	/** Never use buffers from other NUMA nodes, wait for a local buffer instead */
+	SPDK_IOBUF_NUMA_STEAL_NONE = 0,
+	/** Use buffers from other NUMA nodes only if at least half of their pool is free */
+	SPDK_IOBUF_NUMA_STEAL_IDLE,
+	/** Use buffers from other NUMA nodes whenever they have any free buffers */
+	SPDK_IOBUF_NUMA_STEAL_ANY,
 };
 
 struct spdk_iobuf_pool_stats {
@@ -1097,6 +1118,10 @@ struct spdk_iobuf_pool_stats {
 	uint64_t	main;
 	/** Buffer missed and request to get buffer was queued */
 	uint64_t	retry;
+	/** Buffer got from another NUMA node's pool or cache */
+	uint64_t	steal;
+	/** Buffer moved from the main shared pool to the local per-thread cache */
+	uint64_t	refill;
 };
 
 struct spdk_iobuf_module_stats {
@@ -1138,6 +1163,16 @@ struct spdk_iobuf_pool_cache {
 	uint32_t			bufsize;
 	/** Pool usage statistics */
 	struct spdk_iobuf_pool_stats	stats;
+	/** Minimum size of the cache, if the cache is adaptive */
+	uint32_t			cache_size_min;
+	/** Maximum size of the cache, if the cache is adaptive, zero otherwise */
+	uint32_t			cache_size_max;
+	/** Number of gets and puts since the cache was last resized */
+	uint32_t			adapt_ops;
+	/** Number of gets since the cache was last resized that found it empty */
+	uint32_t			adapt_misses;
+	/** Lowest number of elements in the cache since it was last resized */
+	uint32_t			adapt_low;
 };
 
 struct spdk_iobuf_node_cache {
@@ -61,6 +61,12 @@ struct spdk_sock_group {
 	STAILQ_HEAD(, spdk_sock_group_impl)	group_impls;
 	STAILQ_HEAD(, spdk_sock_group_provided_buf) pool;
 	void					*ctx;
+	struct spdk_sock_group_stats		stats;
+	/* Bytes and events accounted to the load when it was last updated */
+	uint64_t				load_work;
+	uint64_t				load_tsc;
+	uint64_t				load_period;
+	TAILQ_ENTRY(spdk_sock_group)		link;
 };
 
 struct spdk_sock_group_impl {
@@ -267,6 +273,32 @@ spdk_sock_abort_requests(struct spdk_sock *sock)
 	return rc;
 }
 
+/*
+ * Fill out_iovs with the part of iovs which follows the first offset bytes. Used to receive the
+ * rest of a partially filled read directly into the caller's buffers.
+ */
+static inline int
+spdk_sock_iovs_skip(struct iovec *iovs, int iovcnt, size_t offset, struct iovec *out_iovs,
+		    int out_iovcnt)
+{
+	int i, cnt = 0;
+
+	for (i = 0; i < iovcnt && cnt < out_iovcnt; i++) {
+		/* Consume any offset first */
+		if (offset >= iovs[i].iov_len) {
+			offset -= iovs[i].iov_len;
+			continue;
+		}
+
+		out_iovs[cnt].iov_base = (uint8_t *)iovs[i].iov_base + offset;
+		out_iovs[cnt].iov_len = iovs[i].iov_len - offset;
+		offset = 0;
+		cnt++;
+	}
+
+	return cnt;
+}
+
 static inline int
 spdk_sock_prep_req(struct spdk_sock_request *req, struct iovec *iovs, int index,
 		   uint64_t *num_bytes)
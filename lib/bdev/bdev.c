@@ -49,6 +49,12 @@ int __itt_init_ittlib(const char *, __itt_group_id);
 #define SPDK_BDEV_QOS_MIN_BYTES_PER_SEC		(1024 * 1024)
 #define SPDK_BDEV_QOS_MAX_MBYTES_PER_SEC	(UINT64_MAX / (1024 * 1024))
 #define SPDK_BDEV_QOS_LIMIT_NOT_DEFINED		UINT64_MAX
+#define SPDK_BDEV_QOS_LATENCY_PERIOD_IN_USEC	10000
+#define SPDK_BDEV_QOS_LATENCY_MAX_PERIOD_IN_USEC	100000
+#define SPDK_BDEV_QOS_LATENCY_MIN_SAMPLES	100
+#define SPDK_BDEV_QOS_LATENCY_BUCKETS		256
+#define SPDK_BDEV_QOS_LATENCY_STEP_IOS_PER_SEC	1000
+#define SPDK_BDEV_QOS_LATENCY_MAX_WEIGHT	100
 #define SPDK_BDEV_IO_POLL_INTERVAL_IN_MSEC	1000
 
 /* The maximum number of children requests for a UNMAP or WRITE ZEROES command
@@ -205,6 +211,30 @@ struct spdk_bdev_qos {
 
 	/** Poller that processes queued I/O commands each time slice. */
 	struct spdk_poller *poller;
+
+	/** Set by channels left with queued I/O, cleared by the poller. */
+	bool io_queued;
+
+	/** Whether collection of the channels' latency histograms is in progress. */
+	bool latency_collecting;
+
+	/** Whether the channels keep latency histograms. */
+	bool latency_hist_active;
+
+	/** Weight of the rate increase of the latency controller. */
+	uint32_t latency_weight;
+
+	/** p99 latency target in microseconds, 0 if not set. */
+	uint64_t latency_target_us;
+
+	/** I/O per second allowed by the latency controller, 0 if not limited. */
+	uint64_t latency_rate;
+
+	/** Timestamp of the last latency controller update. */
+	uint64_t last_latency_update;
+
+	/** Latency histogram accumulated since the last latency controller update. */
+	uint64_t latency_hist[SPDK_BDEV_QOS_LATENCY_BUCKETS];
 };
 
 struct spdk_bdev_mgmt_channel {
@@ -328,6 +358,9 @@ struct spdk_bdev_channel {
 
 	/** List of I/Os queued by QoS. */
 	bdev_io_tailq_t		qos_queued_io;
+
+	/** Completion latency histogram used by the QoS latency target. */
+	uint64_t		*qos_latency_hist;
 };
 
 struct media_event_entry {
@@ -2094,26 +2127,50 @@ bdev_qos_config_json(struct spdk_bdev *bdev, struct spdk_json_write_ctx *w)
 	int i;
 	struct spdk_bdev_qos *qos = bdev->internal.qos;
 	uint64_t limits[SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES];
+	uint64_t latency_target_us;
+	uint32_t latency_weight;
 
 	if (!qos) {
 		return;
 	}
 
 	spdk_bdev_get_qos_rate_limits(bdev, limits);
+	spdk_bdev_get_qos_latency_target(bdev, &latency_target_us, &latency_weight);
 
-	spdk_json_write_object_begin(w);
-	spdk_json_write_named_string(w, "method", "bdev_set_qos_limit");
-
-	spdk_json_write_named_object_begin(w, "params");
-	spdk_json_write_named_string(w, "name", bdev->name);
 	for (i = 0; i < SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES; i++) {
 		if (limits[i] > 0) {
-			spdk_json_write_named_uint64(w, qos_rpc_type[i], limits[i]);
+			break;
 		}
 	}
-	spdk_json_write_object_end(w);
 
-	spdk_json_write_object_end(w);
+	if (i < SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES) {
+		spdk_json_write_object_begin(w);
+		spdk_json_write_named_string(w, "method", "bdev_set_qos_limit");
+
+		spdk_json_write_named_object_begin(w, "params");
+		spdk_json_write_named_string(w, "name", bdev->name);
+		for (i = 0; i < SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES; i++) {
+			if (limits[i] > 0) {
+				spdk_json_write_named_uint64(w, qos_rpc_type[i], limits[i]);
+			}
+		}
+		spdk_json_write_object_end(w);
+
+		spdk_json_write_object_end(w);
+	}
+
+	if (latency_target_us != 0) {
+		spdk_json_write_object_begin(w);
+		spdk_json_write_named_string(w, "method", "bdev_set_qos_latency_target");
+
+		spdk_json_write_named_object_begin(w, "params");
+		spdk_json_write_named_string(w, "name", bdev->name);
+		spdk_json_write_named_uint64(w, "latency_target_us", latency_target_us);
+		spdk_json_write_named_uint32(w, "weight", latency_weight);
+		spdk_json_write_object_end(w);
+
+		spdk_json_write_object_end(w);
+	}
 }
 
 void
@@ -2886,13 +2943,27 @@ bdev_qos_w_bps_rewind_quota(struct spdk_bdev_qos_limit *limit, struct spdk_bdev_
 	}
 }
 
+static uint64_t
+bdev_qos_get_limit(struct spdk_bdev_qos *qos, int i)
+{
+	uint64_t limit = qos->rate_limits[i].limit;
+
+	if (i == SPDK_BDEV_QOS_RW_IOPS_RATE_LIMIT && qos->latency_rate != 0) {
+		limit = spdk_min(limit, qos->latency_rate);
+	}
+
+	return limit;
+}
+
 static void
 bdev_qos_set_ops(struct spdk_bdev_qos *qos)
 {
 	int i;
 
 	for (i = 0; i < SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES; i++) {
-		if (qos->rate_limits[i].limit == SPDK_BDEV_QOS_LIMIT_NOT_DEFINED) {
+		/* The IOPS limit can be set by the latency controller at any time */
+		if (bdev_qos_get_limit(qos, i) == SPDK_BDEV_QOS_LIMIT_NOT_DEFINED &&
+		    (i != SPDK_BDEV_QOS_RW_IOPS_RATE_LIMIT || qos->latency_target_us == 0)) {
 			qos->rate_limits[i].queue_io = NULL;
 			continue;
 		}
@@ -3011,12 +3082,22 @@ bdev_qos_io_submit(struct spdk_bdev_channel *ch, struct spdk_bdev_qos *qos)
 	TAILQ_FOREACH_SAFE(bdev_io, &ch->qos_queued_io, internal.link, tmp) {
 		if (!bdev_qos_queue_io(qos, bdev_io)) {
 			TAILQ_REMOVE(&ch->qos_queued_io, bdev_io, internal.link);
+			if (ch->qos_latency_hist != NULL) {
+				/* Keep the time spent in the queue out of the latency samples */
+				bdev_io->internal.f.qos_released = true;
+				bdev_io->internal.qos_submit_tsc = (uint32_t)spdk_get_ticks();
+			}
 			bdev_io_do_submit(ch, bdev_io);
 
 			submitted_ios++;
 		}
 	}
 
+	if (!TAILQ_EMPTY(&ch->qos_queued_io)) {
+		/* Let the poller resubmit the queued I/O in the next timeslice */
+		__atomic_store_n(&qos->io_queued, true, __ATOMIC_RELAXED);
+	}
+
 	return submitted_ios;
 }
 
@@ -4096,24 +4177,32 @@ spdk_bdev_dump_info_json(struct spdk_bdev *bdev, struct spdk_json_write_ctx *w)
 	return 0;
 }
 
+static uint32_t
+bdev_qos_calc_max_per_timeslice(struct spdk_bdev_qos *qos, int i)
+{
+	uint64_t limit = bdev_qos_get_limit(qos, i);
+	uint32_t max_per_timeslice;
+
+	if (limit == SPDK_BDEV_QOS_LIMIT_NOT_DEFINED) {
+		return 0;
+	}
+
+	max_per_timeslice = limit * SPDK_BDEV_QOS_TIMESLICE_IN_USEC / SPDK_SEC_TO_USEC;
+
+	return spdk_max(max_per_timeslice, qos->rate_limits[i].min_per_timeslice);
+}
+
 static void
 bdev_qos_update_max_quota_per_timeslice(struct spdk_bdev_qos *qos)
 {
-	uint32_t max_per_timeslice = 0;
 	int i;
 
 	for (i = 0; i < SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES; i++) {
-		if (qos->rate_limits[i].limit == SPDK_BDEV_QOS_LIMIT_NOT_DEFINED) {
-			qos->rate_limits[i].max_per_timeslice = 0;
+		qos->rate_limits[i].max_per_timeslice = bdev_qos_calc_max_per_timeslice(qos, i);
+		if (qos->rate_limits[i].max_per_timeslice == 0) {
 			continue;
 		}
 
-		max_per_timeslice = qos->rate_limits[i].limit *
-				    SPDK_BDEV_QOS_TIMESLICE_IN_USEC / SPDK_SEC_TO_USEC;
-
-		qos->rate_limits[i].max_per_timeslice = spdk_max(max_per_timeslice,
-							qos->rate_limits[i].min_per_timeslice);
-
 		__atomic_store_n(&qos->rate_limits[i].remaining_this_timeslice,
 				 qos->rate_limits[i].max_per_timeslice, __ATOMIC_RELEASE);
 	}
@@ -4144,6 +4233,200 @@ bdev_channel_submit_qos_io_done(struct spdk_bdev *bdev, void *ctx, int status)
 
 }
 
+/* Buckets of the QoS latency histogram: four per power of two of tsc ticks */
+static inline uint32_t
+bdev_qos_latency_bucket(uint64_t ticks)
+{
+	uint32_t msb;
+
+	if (ticks < 4) {
+		return ticks;
+	}
+
+	msb = 63 - __builtin_clzll(ticks);
+
+	return (msb - 1) * 4 + ((ticks >> (msb - 2)) & 3);
+}
+
+static uint64_t
+bdev_qos_latency_bucket_end(uint32_t bucket)
+{
+	if (bucket < 4) {
+		return bucket + 1;
+	}
+
+	return (uint64_t)(5 + bucket % 4) << (bucket / 4 - 1);
+}
+
+static void
+bdev_qos_latency_tally(struct spdk_bdev_channel *bdev_ch, struct spdk_bdev_io *bdev_io,
+		       uint64_t tsc, uint64_t tsc_diff)
+{
+	if (!bdev_qos_io_to_limit(bdev_io)) {
+		return;
+	}
+
+	if (bdev_io->internal.f.qos_released) {
+		tsc_diff = (uint32_t)((uint32_t)tsc - bdev_io->internal.qos_submit_tsc);
+	}
+
+	bdev_ch->qos_latency_hist[bdev_qos_latency_bucket(tsc_diff)]++;
+}
+
+static void
+bdev_qos_set_latency_rate(struct spdk_bdev_qos *qos, uint64_t rate)
+{
+	struct spdk_bdev_qos_limit *limit = &qos->rate_limits[SPDK_BDEV_QOS_RW_IOPS_RATE_LIMIT];
+
+	if (rate == qos->latency_rate) {
+		return;
+	}
+
+	SPDK_DEBUGLOG(bdev, "QoS latency controller changed IOPS limit from %" PRIu64 " to %" PRIu64 "\n",
+		      qos->latency_rate, rate);
+
+	qos->latency_rate = rate;
+	limit->max_per_timeslice = bdev_qos_calc_max_per_timeslice(qos,
+				   SPDK_BDEV_QOS_RW_IOPS_RATE_LIMIT);
+}
+
+/*
+ * Adjust the IOPS limit to keep the p99 completion latency under the target. The limit
+ * is decreased multiplicatively when the target is missed and increased additively,
+ * proportionally to the weight, when it is met. Bdevs sharing a device then converge
+ * to rates proportional to their weights.
+ */
+static void
+bdev_qos_latency_update(struct spdk_bdev_qos *qos, const uint64_t *hist)
+{
+	uint64_t ticks_hz = spdk_get_ticks_hz();
+	uint64_t now = spdk_get_ticks();
+	uint64_t total = 0, sum = 0, p99, ios_per_sec, rate;
+	uint32_t i;
+
+	for (i = 0; i < SPDK_BDEV_QOS_LATENCY_BUCKETS; i++) {
+		qos->latency_hist[i] += hist[i];
+		total += qos->latency_hist[i];
+	}
+
+	if (qos->last_latency_update == 0 ||
+	    (total < SPDK_BDEV_QOS_LATENCY_MIN_SAMPLES &&
+	     now - qos->last_latency_update > SPDK_BDEV_QOS_LATENCY_MAX_PERIOD_IN_USEC * ticks_hz / SPDK_SEC_TO_USEC)) {
+		/* Start over, the rate of a mostly idle period is not representative */
+		goto reset;
+	}
+
+	if (total < SPDK_BDEV_QOS_LATENCY_MIN_SAMPLES || now == qos->last_latency_update) {
+		return;
+	}
+
+	for (i = 0; i < SPDK_BDEV_QOS_LATENCY_BUCKETS; i++) {
+		sum += qos->latency_hist[i];
+		if (sum * 100 >= total * 99) {
+			break;
+		}
+	}
+	p99 = bdev_qos_latency_bucket_end(i);
+	ios_per_sec = total * ticks_hz / (now - qos->last_latency_update);
+
+	if (p99 > qos->latency_target_us * ticks_hz / SPDK_SEC_TO_USEC) {
+		/* Decrease relative to the rate that was actually achieved */
+		rate = qos->latency_rate != 0 ? spdk_min(qos->latency_rate, ios_per_sec) : ios_per_sec;
+		rate = spdk_max(rate * 3 / 4, SPDK_BDEV_QOS_MIN_IOS_PER_SEC);
+	} else if (qos->latency_rate != 0) {
+		rate = qos->latency_rate + qos->latency_weight * SPDK_BDEV_QOS_LATENCY_STEP_IOS_PER_SEC;
+		if (rate > ios_per_sec * 2) {
+			/* The load is well below the limit, lift it */
+			rate = 0;
+		}
+	} else {
+		rate = 0;
+	}
+
+	bdev_qos_set_latency_rate(qos, rate);
+reset:
+	memset(qos->latency_hist, 0, sizeof(qos->latency_hist));
+	qos->last_latency_update = now;
+}
+
+struct bdev_qos_latency_ctx {
+	struct spdk_bdev_qos *qos;
+	bool enabled;
+	uint64_t hist[SPDK_BDEV_QOS_LATENCY_BUCKETS];
+};
+
+static void
+bdev_qos_latency_collect(struct spdk_bdev_channel_iter *i, struct spdk_bdev *bdev,
+			 struct spdk_io_channel *io_ch, void *_ctx)
+{
+	struct bdev_qos_latency_ctx *ctx = _ctx;
+	struct spdk_bdev_channel *bdev_ch = __io_ch_to_bdev_ch(io_ch);
+	uint32_t j;
+
+	if (!ctx->enabled) {
+		free(bdev_ch->qos_latency_hist);
+		bdev_ch->qos_latency_hist = NULL;
+	} else if (bdev_ch->qos_latency_hist == NULL) {
+		bdev_ch->qos_latency_hist = calloc(SPDK_BDEV_QOS_LATENCY_BUCKETS,
+						   sizeof(*bdev_ch->qos_latency_hist));
+	} else {
+		for (j = 0; j < SPDK_BDEV_QOS_LATENCY_BUCKETS; j++) {
+			ctx->hist[j] += bdev_ch->qos_latency_hist[j];
+		}
+		memset(bdev_ch->qos_latency_hist, 0,
+		       SPDK_BDEV_QOS_LATENCY_BUCKETS * sizeof(*bdev_ch->qos_latency_hist));
+	}
+
+	spdk_bdev_for_each_channel_continue(i, 0);
+}
+
+static void
+bdev_qos_latency_collect_done(struct spdk_bdev *bdev, void *_ctx, int status)
+{
+	struct bdev_qos_latency_ctx *ctx = _ctx;
+	struct spdk_bdev_qos *qos = bdev->internal.qos;
+
+	/* The QoS could have been disabled or destroyed in the meantime */
+	if (qos == ctx->qos) {
+		qos->latency_collecting = false;
+		qos->latency_hist_active = ctx->enabled;
+		if (ctx->enabled && qos->latency_target_us != 0) {
+			bdev_qos_latency_update(qos, ctx->hist);
+		}
+	}
+
+	free(ctx);
+}
+
+static void
+bdev_qos_latency_poll(struct spdk_bdev *bdev, struct spdk_bdev_qos *qos, uint64_t now)
+{
+	struct bdev_qos_latency_ctx *ctx;
+
+	if (qos->latency_collecting ||
+	    (qos->last_latency_update != 0 &&
+	     now < qos->last_latency_update + SPDK_BDEV_QOS_LATENCY_PERIOD_IN_USEC *
+	     spdk_get_ticks_hz() / SPDK_SEC_TO_USEC)) {
+		return;
+	}
+
+	ctx = calloc(1, sizeof(*ctx));
+	if (ctx == NULL) {
+		return;
+	}
+
+	ctx->qos = qos;
+	ctx->enabled = qos->latency_target_us != 0;
+	if (!ctx->enabled) {
+		qos->last_latency_update = 0;
+		memset(qos->latency_hist, 0, sizeof(qos->latency_hist));
+	}
+
+	qos->latency_collecting = true;
+	spdk_bdev_for_each_channel(bdev, bdev_qos_latency_collect, ctx,
+				   bdev_qos_latency_collect_done);
+}
+
 static int
 bdev_channel_poll_qos(void *arg)
 {
@@ -4194,8 +4477,15 @@ bdev_channel_poll_qos(void *arg)
 		}
 	}
 
-	spdk_bdev_for_each_channel(bdev, bdev_channel_submit_qos_io, qos,
-				   bdev_channel_submit_qos_io_done);
+	/* Only visit the channels if some of them have I/O queued */
+	if (__atomic_exchange_n(&qos->io_queued, false, __ATOMIC_RELAXED)) {
+		spdk_bdev_for_each_channel(bdev, bdev_channel_submit_qos_io, qos,
+					   bdev_channel_submit_qos_io_done);
+	}
+
+	if (qos->latency_target_us != 0 || qos->latency_hist_active) {
+		bdev_qos_latency_poll(bdev, qos, now);
+	}
 
 	return SPDK_POLLER_BUSY;
 }
@@ -4210,6 +4500,7 @@ bdev_channel_destroy_resource(struct spdk_bdev_channel *ch)
 #ifdef SPDK_CONFIG_VTUNE
 	bdev_free_io_stat(ch->prev_stat);
 #endif
+	free(ch->qos_latency_hist);
 
 	while (!TAILQ_EMPTY(&ch->locked_ranges)) {
 		range = TAILQ_FIRST(&ch->locked_ranges);
@@ -4702,6 +4993,12 @@ bdev_qos_destroy(struct spdk_bdev *bdev)
 	new_qos->ch = NULL;
 	new_qos->thread = NULL;
 	new_qos->poller = NULL;
+	new_qos->io_queued = false;
+	new_qos->latency_collecting = false;
+	new_qos->latency_hist_active = false;
+	new_qos->latency_rate = 0;
+	new_qos->last_latency_update = 0;
+	memset(new_qos->latency_hist, 0, sizeof(new_qos->latency_hist));
 	/*
 	 * The limit member of spdk_bdev_qos_limit structure is not zeroed.
 	 * It will be used later for the new QoS structure.
@@ -7739,6 +8036,10 @@ bdev_io_complete(void *ctx)
 		}
 	}
 
+	if (spdk_unlikely(bdev_ch->qos_latency_hist != NULL)) {
+		bdev_qos_latency_tally(bdev_ch, bdev_io, tsc, tsc_diff);
+	}
+
 	bdev_io_update_io_stat(bdev_io, tsc_diff);
 	_bdev_io_complete(bdev_io);
 }
@@ -9788,6 +10089,8 @@ bdev_disable_qos_msg(struct spdk_bdev_channel_iter *i, struct spdk_bdev *bdev,
 	struct spdk_bdev_io *bdev_io;
 
 	bdev_ch->flags &= ~BDEV_CH_QOS_ENABLED;
+	free(bdev_ch->qos_latency_hist);
+	bdev_ch->qos_latency_hist = NULL;
 
 	while (!TAILQ_EMPTY(&bdev_ch->qos_queued_io)) {
 		/* Re-submit the queued I/O. */
@@ -9833,7 +10136,8 @@ bdev_enable_qos_done(struct spdk_bdev *bdev, void *_ctx, int status)
 }
 
 static void
-bdev_set_qos_rate_limits(struct spdk_bdev *bdev, uint64_t *limits)
+bdev_set_qos_rate_limits(struct spdk_bdev *bdev, uint64_t *limits, uint64_t latency_target_us,
+			 uint32_t latency_weight)
 {
 	int i;
 
@@ -9849,47 +10153,31 @@ bdev_set_qos_rate_limits(struct spdk_bdev *bdev, uint64_t *limits)
 			}
 		}
 	}
+
+	if (latency_target_us != SPDK_BDEV_QOS_LIMIT_NOT_DEFINED) {
+		bdev->internal.qos->latency_target_us = latency_target_us;
+		bdev->internal.qos->latency_weight = latency_weight;
+		/* Let the latency controller start over */
+		bdev->internal.qos->latency_rate = 0;
+	}
 }
 
-void
-spdk_bdev_set_qos_rate_limits(struct spdk_bdev *bdev, uint64_t *limits,
-			      void (*cb_fn)(void *cb_arg, int status), void *cb_arg)
+static void
+bdev_set_qos(struct spdk_bdev *bdev, uint64_t *limits, uint64_t latency_target_us,
+	     uint32_t latency_weight, void (*cb_fn)(void *cb_arg, int status), void *cb_arg)
 {
 	struct set_qos_limit_ctx	*ctx;
-	uint32_t			limit_set_complement;
-	uint64_t			min_limit_per_sec;
 	int				i;
 	bool				disable_rate_limit = true;
 
 	for (i = 0; i < SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES; i++) {
-		if (limits[i] == SPDK_BDEV_QOS_LIMIT_NOT_DEFINED) {
-			continue;
-		}
-
-		if (limits[i] > 0) {
+		if (limits[i] != SPDK_BDEV_QOS_LIMIT_NOT_DEFINED && limits[i] > 0) {
 			disable_rate_limit = false;
 		}
+	}
 
-		if (bdev_qos_is_iops_rate_limit(i) == true) {
-			min_limit_per_sec = SPDK_BDEV_QOS_MIN_IOS_PER_SEC;
-		} else {
-			if (limits[i] > SPDK_BDEV_QOS_MAX_MBYTES_PER_SEC) {
-				SPDK_WARNLOG("Requested rate limit %" PRIu64 " will result in uint64_t overflow, "
-					     "reset to %" PRIu64 "\n", limits[i], SPDK_BDEV_QOS_MAX_MBYTES_PER_SEC);
-				limits[i] = SPDK_BDEV_QOS_MAX_MBYTES_PER_SEC;
-			}
-			/* Change from megabyte to byte rate limit */
-			limits[i] = limits[i] * 1024 * 1024;
-			min_limit_per_sec = SPDK_BDEV_QOS_MIN_BYTES_PER_SEC;
-		}
-
-		limit_set_complement = limits[i] % min_limit_per_sec;
-		if (limit_set_complement) {
-			SPDK_ERRLOG("Requested rate limit %" PRIu64 " is not a multiple of %" PRIu64 "\n",
-				    limits[i], min_limit_per_sec);
-			limits[i] += min_limit_per_sec - limit_set_complement;
-			SPDK_ERRLOG("Round up the rate limit to %" PRIu64 "\n", limits[i]);
-		}
+	if (latency_target_us != SPDK_BDEV_QOS_LIMIT_NOT_DEFINED && latency_target_us > 0) {
+		disable_rate_limit = false;
 	}
 
 	ctx = calloc(1, sizeof(*ctx));
@@ -9921,6 +10209,11 @@ spdk_bdev_set_qos_rate_limits(struct spdk_bdev *bdev, uint64_t *limits,
 				break;
 			}
 		}
+
+		if (latency_target_us == SPDK_BDEV_QOS_LIMIT_NOT_DEFINED &&
+		    bdev->internal.qos->latency_target_us != 0) {
+			disable_rate_limit = false;
+		}
 	}
 
 	if (disable_rate_limit == false) {
@@ -9936,20 +10229,20 @@ spdk_bdev_set_qos_rate_limits(struct spdk_bdev *bdev, uint64_t *limits,
 
 		if (bdev->internal.qos->thread == NULL) {
 			/* Enabling */
-			bdev_set_qos_rate_limits(bdev, limits);
+			bdev_set_qos_rate_limits(bdev, limits, latency_target_us, latency_weight);
 
 			spdk_bdev_for_each_channel(bdev, bdev_enable_qos_msg, ctx,
 						   bdev_enable_qos_done);
 		} else {
 			/* Updating */
-			bdev_set_qos_rate_limits(bdev, limits);
+			bdev_set_qos_rate_limits(bdev, limits, latency_target_us, latency_weight);
 
 			spdk_thread_send_msg(bdev->internal.qos->thread,
 					     bdev_update_qos_rate_limit_msg, ctx);
 		}
 	} else {
 		if (bdev->internal.qos != NULL) {
-			bdev_set_qos_rate_limits(bdev, limits);
+			bdev_set_qos_rate_limits(bdev, limits, latency_target_us, latency_weight);
 
 			/* Disabling */
 			spdk_bdev_for_each_channel(bdev, bdev_disable_qos_msg, ctx,
@@ -9964,6 +10257,81 @@ spdk_bdev_set_qos_rate_limits(struct spdk_bdev *bdev, uint64_t *limits,
 	spdk_spin_unlock(&bdev->internal.spinlock);
 }
 
+void
+spdk_bdev_set_qos_rate_limits(struct spdk_bdev *bdev, uint64_t *limits,
+			      void (*cb_fn)(void *cb_arg, int status), void *cb_arg)
+{
+	uint32_t			limit_set_complement;
+	uint64_t			min_limit_per_sec;
+	int				i;
+
+	for (i = 0; i < SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES; i++) {
+		if (limits[i] == SPDK_BDEV_QOS_LIMIT_NOT_DEFINED) {
+			continue;
+		}
+
+		if (bdev_qos_is_iops_rate_limit(i) == true) {
+			min_limit_per_sec = SPDK_BDEV_QOS_MIN_IOS_PER_SEC;
+		} else {
+			if (limits[i] > SPDK_BDEV_QOS_MAX_MBYTES_PER_SEC) {
+				SPDK_WARNLOG("Requested rate limit %" PRIu64 " will result in uint64_t overflow, "
+					     "reset to %" PRIu64 "\n", limits[i], SPDK_BDEV_QOS_MAX_MBYTES_PER_SEC);
+				limits[i] = SPDK_BDEV_QOS_MAX_MBYTES_PER_SEC;
+			}
+			/* Change from megabyte to byte rate limit */
+			limits[i] = limits[i] * 1024 * 1024;
+			min_limit_per_sec = SPDK_BDEV_QOS_MIN_BYTES_PER_SEC;
+		}
+
+		limit_set_complement = limits[i] % min_limit_per_sec;
+		if (limit_set_complement) {
+			SPDK_ERRLOG("Requested rate limit %" PRIu64 " is not a multiple of %" PRIu64 "\n",
+				    limits[i], min_limit_per_sec);
+			limits[i] += min_limit_per_sec - limit_set_complement;
+			SPDK_ERRLOG("Round up the rate limit to %" PRIu64 "\n", limits[i]);
+		}
+	}
+
+	bdev_set_qos(bdev, limits, SPDK_BDEV_QOS_LIMIT_NOT_DEFINED, 0, cb_fn, cb_arg);
+}
+
+void
+spdk_bdev_set_qos_latency_target(struct spdk_bdev *bdev, uint64_t latency_target_us,
+				 uint32_t weight, void (*cb_fn)(void *cb_arg, int status), void *cb_arg)
+{
+	uint64_t limits[SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES];
+	int i;
+
+	if (latency_target_us == SPDK_BDEV_QOS_LIMIT_NOT_DEFINED ||
+	    (latency_target_us != 0 && (weight == 0 || weight > SPDK_BDEV_QOS_LATENCY_MAX_WEIGHT))) {
+		SPDK_ERRLOG("Invalid QoS latency target %" PRIu64 " us with weight %" PRIu32 "\n",
+			    latency_target_us, weight);
+		cb_fn(cb_arg, -EINVAL);
+		return;
+	}
+
+	for (i = 0; i < SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES; i++) {
+		limits[i] = SPDK_BDEV_QOS_LIMIT_NOT_DEFINED;
+	}
+
+	bdev_set_qos(bdev, limits, latency_target_us, weight, cb_fn, cb_arg);
+}
+
+void
+spdk_bdev_get_qos_latency_target(struct spdk_bdev *bdev, uint64_t *latency_target_us,
+				 uint32_t *weight)
+{
+	*latency_target_us = 0;
+	*weight = 0;
+
+	spdk_spin_lock(&bdev->internal.spinlock);
+	if (bdev->internal.qos) {
+		*latency_target_us = bdev->internal.qos->latency_target_us;
+		*weight = bdev->internal.qos->latency_weight;
+	}
+	spdk_spin_unlock(&bdev->internal.spinlock);
+}
+
 struct spdk_bdev_histogram_ctx {
 	spdk_bdev_histogram_status_cb cb_fn;
 	void *cb_arg;
@@ -646,6 +646,8 @@ rpc_dump_bdev_info(void *ctx, struct spdk_bdev *bdev)
 	struct spdk_json_write_ctx *w = ctx;
 	struct spdk_bdev_alias *tmp;
 	uint64_t qos_limits[SPDK_BDEV_QOS_NUM_RATE_LIMIT_TYPES];
+	uint64_t qos_latency_target_us;
+	uint32_t qos_latency_weight;
 	struct spdk_memory_domain **domains;
 	enum spdk_bdev_io_type io_type;
 	const char *name = NULL;
@@ -697,6 +699,14 @@ rpc_dump_bdev_info(void *ctx, struct spdk_bdev *bdev)
 	}
 	spdk_json_write_object_end(w);
 
+	spdk_bdev_get_qos_latency_target(bdev, &qos_latency_target_us, &qos_latency_weight);
+	if (qos_latency_target_us != 0) {
+		spdk_json_write_named_object_begin(w, "assigned_latency_target");
+		spdk_json_write_named_uint64(w, "latency_target_us", qos_latency_target_us);
+		spdk_json_write_named_uint32(w, "weight", qos_latency_weight);
+		spdk_json_write_object_end(w);
+	}
+
 	spdk_json_write_named_bool(w, "claimed",
 				   (bdev->internal.claim_type != SPDK_BDEV_CLAIM_NONE));
 	if (bdev->internal.claim_type != SPDK_BDEV_CLAIM_NONE) {
@@ -985,6 +995,78 @@ cleanup:
 
 SPDK_RPC_REGISTER("bdev_set_qos_limit", rpc_bdev_set_qos_limit, SPDK_RPC_RUNTIME)
 
+struct rpc_bdev_set_qos_latency_target {
+	char		*name;
+	uint64_t	latency_target_us;
+	uint32_t	weight;
+};
+
+static void
+free_rpc_bdev_set_qos_latency_target(struct rpc_bdev_set_qos_latency_target *r)
+{
+	free(r->name);
+}
+
+static const struct spdk_json_object_decoder rpc_bdev_set_qos_latency_target_decoders[] = {
+	{"name", offsetof(struct rpc_bdev_set_qos_latency_target, name), spdk_json_decode_string},
+	{
+		"latency_target_us", offsetof(struct rpc_bdev_set_qos_latency_target, latency_target_us),
+		spdk_json_decode_uint64
+	},
+	{"weight", offsetof(struct rpc_bdev_set_qos_latency_target, weight), spdk_json_decode_uint32, true},
+};
+
+static void
+rpc_bdev_set_qos_latency_target_complete(void *cb_arg, int status)
+{
+	struct spdk_jsonrpc_request *request = cb_arg;
+
+	if (status != 0) {
+		spdk_jsonrpc_send_error_response_fmt(request, SPDK_JSONRPC_ERROR_INVALID_PARAMS,
+						     "Failed to configure latency target: %s",
+						     spdk_strerror(-status));
+		return;
+	}
+
+	spdk_jsonrpc_send_bool_response(request, true);
+}
+
+static void
+rpc_bdev_set_qos_latency_target(struct spdk_jsonrpc_request *request,
+				const struct spdk_json_val *params)
+{
+	struct rpc_bdev_set_qos_latency_target req = {.weight = 1};
+	struct spdk_bdev_desc *desc;
+	int rc;
+
+	if (spdk_json_decode_object(params, rpc_bdev_set_qos_latency_target_decoders,
+				    SPDK_COUNTOF(rpc_bdev_set_qos_latency_target_decoders),
+				    &req)) {
+		SPDK_ERRLOG("spdk_json_decode_object failed\n");
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+						 "spdk_json_decode_object failed");
+		goto cleanup;
+	}
+
+	rc = spdk_bdev_open_ext(req.name, false, dummy_bdev_event_cb, NULL, &desc);
+	if (rc != 0) {
+		SPDK_ERRLOG("Failed to open bdev '%s': %d\n", req.name, rc);
+		spdk_jsonrpc_send_error_response(request, rc, spdk_strerror(-rc));
+		goto cleanup;
+	}
+
+	spdk_bdev_set_qos_latency_target(spdk_bdev_desc_get_bdev(desc), req.latency_target_us,
+					 req.weight, rpc_bdev_set_qos_latency_target_complete, request);
+
+	spdk_bdev_close(desc);
+
+cleanup:
+	free_rpc_bdev_set_qos_latency_target(&req);
+}
+
+SPDK_RPC_REGISTER("bdev_set_qos_latency_target", rpc_bdev_set_qos_latency_target,
+		  SPDK_RPC_RUNTIME)
+
 /* SPDK_RPC_ENABLE_BDEV_HISTOGRAM */
 
 struct rpc_bdev_enable_histogram_request {
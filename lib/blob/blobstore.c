@@ -156,6 +156,110 @@ bs_release_cluster(struct spdk_blob_store *bs, uint32_t cluster_num)
 	bs->num_free_clusters++;
 }
 
+/*
+ * Thin provisioning allocations on a channel take clusters from a small reservation claimed
+ * ahead of time, so that used_lock is only taken once every few allocations instead of on each.
+ * Reserved clusters are accounted as free until they're taken.
+ */
+static void
+bs_channel_reserve_clusters(struct spdk_bs_channel *ch)
+{
+	struct spdk_blob_store *bs = ch->bs;
+	uint32_t i, count;
+
+	assert(spdk_spin_held(&bs->used_lock));
+	assert(ch->num_reserved_clusters == 0);
+
+	/* Don't strand the last free clusters in channels that may not allocate anymore. */
+	count = spdk_min(SPDK_BS_CHANNEL_RESERVED_CLUSTERS, bs->num_free_clusters / 64);
+	if (count < 2) {
+		return;
+	}
+
+	for (i = 0; i < count; i++) {
+		ch->reserved_clusters[count - i - 1] = bs_claim_cluster(bs);
+		assert(ch->reserved_clusters[count - i - 1] != UINT32_MAX);
+	}
+	ch->num_reserved_clusters = count;
+	__atomic_add_fetch(&bs->num_reserved_clusters, count, __ATOMIC_RELAXED);
+}
+
+static uint32_t
+bs_channel_take_reserved_cluster(struct spdk_bs_channel *ch)
+{
+	assert(ch->num_reserved_clusters > 0);
+
+	__atomic_sub_fetch(&ch->bs->num_reserved_clusters, 1, __ATOMIC_RELAXED);
+
+	return ch->reserved_clusters[--ch->num_reserved_clusters];
+}
+
+static void
+bs_channel_release_reserved_clusters(struct spdk_bs_channel *ch)
+{
+	struct spdk_blob_store *bs = ch->bs;
+
+	if (ch->num_reserved_clusters == 0) {
+		return;
+	}
+
+	spdk_spin_lock(&bs->used_lock);
+	while (ch->num_reserved_clusters > 0) {
+		bs_release_cluster(bs, bs_channel_take_reserved_cluster(ch));
+	}
+	spdk_spin_unlock(&bs->used_lock);
+}
+
+static inline bool
+bs_has_reserved_clusters(struct spdk_blob_store *bs)
+{
+	return __atomic_load_n(&bs->num_reserved_clusters, __ATOMIC_RELAXED) > 0;
+}
+
+struct spdk_bs_release_reserved_ctx {
+	spdk_bs_op_complete	cb_fn;
+	void			*cb_arg;
+};
+
+static void
+bs_release_reserved_clusters_iter(struct spdk_io_channel_iter *i)
+{
+	struct spdk_io_channel *_ch = spdk_io_channel_iter_get_channel(i);
+
+	bs_channel_release_reserved_clusters(spdk_io_channel_get_ctx(_ch));
+	spdk_for_each_channel_continue(i, 0);
+}
+
+static void
+bs_release_reserved_clusters_cpl(struct spdk_io_channel_iter *i, int status)
+{
+	struct spdk_bs_release_reserved_ctx *ctx = spdk_io_channel_iter_get_ctx(i);
+
+	ctx->cb_fn(ctx->cb_arg, status);
+	free(ctx);
+}
+
+/*
+ * Return the clusters reserved by all channels to the free pool. Thick provisioning needs this
+ * before it can fail for lack of space, as the reserved clusters are reported as free.
+ */
+static void
+bs_release_reserved_clusters(struct spdk_blob_store *bs, spdk_bs_op_complete cb_fn, void *cb_arg)
+{
+	struct spdk_bs_release_reserved_ctx *ctx;
+
+	ctx = calloc(1, sizeof(*ctx));
+	if (ctx == NULL) {
+		cb_fn(cb_arg, -ENOMEM);
+		return;
+	}
+
+	ctx->cb_fn = cb_fn;
+	ctx->cb_arg = cb_arg;
+	spdk_for_each_channel(bs, bs_release_reserved_clusters_iter, ctx,
+			      bs_release_reserved_clusters_cpl);
+}
+
 static int
 blob_insert_cluster(struct spdk_blob *blob, uint32_t cluster_num, uint64_t cluster)
 {
@@ -174,14 +278,18 @@ blob_insert_cluster(struct spdk_blob *blob, uint32_t cluster_num, uint64_t clust
 }
 
 static int
-bs_allocate_cluster(struct spdk_blob *blob, uint32_t cluster_num,
+bs_allocate_cluster(struct spdk_blob *blob, struct spdk_bs_channel *ch, uint32_t cluster_num,
 		    uint64_t *cluster, uint32_t *lowest_free_md_page, bool update_map)
 {
 	uint32_t *extent_page = 0;
 
 	assert(spdk_spin_held(&blob->bs->used_lock));
 
-	*cluster = bs_claim_cluster(blob->bs);
+	if (ch != NULL && ch->num_reserved_clusters > 0) {
+		*cluster = bs_channel_take_reserved_cluster(ch);
+	} else {
+		*cluster = bs_claim_cluster(blob->bs);
+	}
 	if (*cluster == UINT32_MAX) {
 		/* No more free clusters. Cannot satisfy the request */
 		return -ENOSPC;
@@ -327,6 +435,8 @@ blob_alloc(struct spdk_blob_store *bs, spdk_blob_id id)
 	TAILQ_INIT(&blob->xattrs_internal);
 	TAILQ_INIT(&blob->pending_persists);
 	TAILQ_INIT(&blob->persists_to_complete);
+	TAILQ_INIT(&blob->ep_writes_in_progress);
+	TAILQ_INIT(&blob->pending_ep_writes);
 
 	return blob;
 }
@@ -357,6 +467,8 @@ blob_free(struct spdk_blob *blob)
 	assert(blob != NULL);
 	assert(TAILQ_EMPTY(&blob->pending_persists));
 	assert(TAILQ_EMPTY(&blob->persists_to_complete));
+	assert(TAILQ_EMPTY(&blob->ep_writes_in_progress));
+	assert(TAILQ_EMPTY(&blob->pending_ep_writes));
 
 	free(blob->active.extent_pages);
 	free(blob->clean.extent_pages);
@@ -2318,7 +2430,7 @@ blob_resize(struct spdk_blob *blob, uint64_t sz)
 		cluster = 0;
 		lfmd = 0;
 		for (i = num_clusters; i < sz; i++) {
-			bs_allocate_cluster(blob, i, &cluster, &lfmd, true);
+			bs_allocate_cluster(blob, NULL, i, &cluster, &lfmd, true);
 			/* Do not increment lfmd here.  lfmd will get updated
 			 * to the md_page allocated (if any) when a new extent
 			 * page is needed.  Just pass that value again,
@@ -2878,10 +2990,20 @@ bs_allocate_and_copy_cluster(struct spdk_blob *blob,
 		}
 	}
 
-	spdk_spin_lock(&blob->bs->used_lock);
-	rc = bs_allocate_cluster(blob, cluster_number, &ctx->new_cluster, &ctx->new_extent_page,
-				 false);
-	spdk_spin_unlock(&blob->bs->used_lock);
+	if (ch->num_reserved_clusters > 0 &&
+	    (!blob->use_extent_table || *bs_cluster_to_extent_page(blob, cluster_number) != 0)) {
+		/* Only the allocation of a new extent page needs used_lock. */
+		ctx->new_cluster = bs_channel_take_reserved_cluster(ch);
+		rc = 0;
+	} else {
+		spdk_spin_lock(&blob->bs->used_lock);
+		if (ch->num_reserved_clusters == 0) {
+			bs_channel_reserve_clusters(ch);
+		}
+		rc = bs_allocate_cluster(blob, ch, cluster_number, &ctx->new_cluster,
+					 &ctx->new_extent_page, false);
+		spdk_spin_unlock(&blob->bs->used_lock);
+	}
 	if (rc != 0) {
 		spdk_free(ctx->buf);
 		free(ctx);
@@ -3627,6 +3749,7 @@ bs_channel_create(void *io_device, void *ctx_buf)
 	TAILQ_INIT(&channel->need_cluster_alloc);
 	TAILQ_INIT(&channel->queued_io);
 	RB_INIT(&channel->esnap_channels);
+	channel->num_reserved_clusters = 0;
 
 	return 0;
 }
@@ -3650,6 +3773,7 @@ bs_channel_destroy(void *io_device, void *ctx_buf)
 	}
 
 	blob_esnap_destroy_bs_channel(channel);
+	bs_channel_release_reserved_clusters(channel);
 
 	free(channel->req_mem);
 	spdk_free(channel->new_cluster_page);
@@ -5893,6 +6017,17 @@ bs_unload_read_super_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
 	bs_write_used_md(seq, cb_arg, bs_unload_write_used_pages_cpl);
 }
 
+static void
+bs_unload_release_reserved_clusters_cpl(struct spdk_io_channel_iter *i, int status)
+{
+	struct spdk_bs_load_ctx *ctx = spdk_io_channel_iter_get_ctx(i);
+
+	/* Read super block */
+	bs_sequence_read_dev(ctx->seq, ctx->super, bs_page_to_lba(ctx->bs, 0),
+			     bs_byte_to_lba(ctx->bs, sizeof(*ctx->super)),
+			     bs_unload_read_super_cpl, ctx);
+}
+
 void
 spdk_bs_unload(struct spdk_blob_store *bs, spdk_bs_op_complete cb_fn, void *cb_arg)
 {
@@ -5959,10 +6094,9 @@ spdk_bs_unload(struct spdk_blob_store *bs, spdk_bs_op_complete cb_fn, void *cb_a
 		return;
 	}
 
-	/* Read super block */
-	bs_sequence_read_dev(ctx->seq, ctx->super, bs_page_to_lba(bs, 0),
-			     bs_byte_to_lba(bs, sizeof(*ctx->super)),
-			     bs_unload_read_super_cpl, ctx);
+	/* Return the clusters reserved by channels, so that they aren't marked used on disk. */
+	spdk_for_each_channel(bs, bs_release_reserved_clusters_iter, ctx,
+			      bs_unload_release_reserved_clusters_cpl);
 }
 
 /* END spdk_bs_unload */
@@ -6096,7 +6230,7 @@ spdk_bs_get_io_unit_size(struct spdk_blob_store *bs)
 uint64_t
 spdk_bs_free_cluster_count(struct spdk_blob_store *bs)
 {
-	return bs->num_free_clusters;
+	return bs->num_free_clusters + __atomic_load_n(&bs->num_reserved_clusters, __ATOMIC_RELAXED);
 }
 
 uint64_t
@@ -6262,6 +6396,72 @@ blob_opts_copy(const struct spdk_blob_opts *src, struct spdk_blob_opts *dst)
 #undef SET_FIELD
 }
 
+static void
+bs_create_blob_fail(struct spdk_blob_store *bs, struct spdk_blob *blob, uint32_t page_idx,
+		    uint64_t num_clusters, int rc, spdk_blob_op_with_id_complete cb_fn, void *cb_arg)
+{
+	SPDK_ERRLOG("Failed to create blob: %s, size in clusters/size: %lu (clusters)\n",
+		    spdk_strerror(rc), num_clusters);
+	if (blob != NULL) {
+		blob_free(blob);
+	}
+	spdk_spin_lock(&bs->used_lock);
+	spdk_bit_array_clear(bs->used_blobids, page_idx);
+	bs_release_md_page(bs, page_idx);
+	spdk_spin_unlock(&bs->used_lock);
+	cb_fn(cb_arg, 0, rc);
+}
+
+static void
+bs_create_blob_persist(struct spdk_blob *blob, uint64_t num_clusters,
+		       spdk_blob_op_with_id_complete cb_fn, void *cb_arg)
+{
+	struct spdk_bs_cpl	cpl;
+	spdk_bs_sequence_t	*seq;
+
+	cpl.type = SPDK_BS_CPL_TYPE_BLOBID;
+	cpl.u.blobid.cb_fn = cb_fn;
+	cpl.u.blobid.cb_arg = cb_arg;
+	cpl.u.blobid.blobid = blob->id;
+
+	seq = bs_sequence_start_bs(blob->bs->md_channel, &cpl);
+	if (!seq) {
+		bs_create_blob_fail(blob->bs, blob, bs_blobid_to_page(blob->id), num_clusters,
+				    -ENOMEM, cb_fn, cb_arg);
+		return;
+	}
+
+	blob_persist(seq, blob, bs_create_blob_cpl, blob);
+}
+
+struct spdk_bs_create_blob_retry_ctx {
+	struct spdk_blob		*blob;
+	uint64_t			num_clusters;
+	spdk_blob_op_with_id_complete	cb_fn;
+	void				*cb_arg;
+};
+
+static void
+bs_create_blob_resize_retry(void *cb_arg, int bserrno)
+{
+	struct spdk_bs_create_blob_retry_ctx ctx = *(struct spdk_bs_create_blob_retry_ctx *)cb_arg;
+	struct spdk_blob *blob = ctx.blob;
+	int rc = bserrno;
+
+	free(cb_arg);
+
+	if (rc == 0) {
+		rc = blob_resize(blob, ctx.num_clusters);
+	}
+	if (rc < 0) {
+		bs_create_blob_fail(blob->bs, blob, bs_blobid_to_page(blob->id), ctx.num_clusters,
+				    rc, ctx.cb_fn, ctx.cb_arg);
+		return;
+	}
+
+	bs_create_blob_persist(blob, ctx.num_clusters, ctx.cb_fn, ctx.cb_arg);
+}
+
 static void
 bs_create_blob(struct spdk_blob_store *bs,
 	       const struct spdk_blob_opts *opts,
@@ -6270,10 +6470,9 @@ bs_create_blob(struct spdk_blob_store *bs,
 {
 	struct spdk_blob	*blob;
 	uint32_t		page_idx;
-	struct spdk_bs_cpl	cpl;
 	struct spdk_blob_opts	opts_local;
 	struct spdk_blob_xattr_opts internal_xattrs_default;
-	spdk_bs_sequence_t	*seq;
+	struct spdk_bs_create_blob_retry_ctx *retry_ctx;
 	spdk_blob_id		id;
 	int rc;
 
@@ -6349,34 +6548,30 @@ bs_create_blob(struct spdk_blob_store *bs,
 	}
 
 	rc = blob_resize(blob, opts_local.num_clusters);
-	if (rc < 0) {
-		goto error;
-	}
-	cpl.type = SPDK_BS_CPL_TYPE_BLOBID;
-	cpl.u.blobid.cb_fn = cb_fn;
-	cpl.u.blobid.cb_arg = cb_arg;
-	cpl.u.blobid.blobid = blob->id;
+	if (rc == -ENOSPC && !spdk_blob_is_thin_provisioned(blob) && bs_has_reserved_clusters(bs)) {
+		/* Some of the free clusters are reserved by channels. Take them back and retry. */
+		retry_ctx = calloc(1, sizeof(*retry_ctx));
+		if (retry_ctx == NULL) {
+			rc = -ENOMEM;
+			goto error;
+		}
 
-	seq = bs_sequence_start_bs(bs->md_channel, &cpl);
-	if (!seq) {
-		rc = -ENOMEM;
+		retry_ctx->blob = blob;
+		retry_ctx->num_clusters = opts_local.num_clusters;
+		retry_ctx->cb_fn = cb_fn;
+		retry_ctx->cb_arg = cb_arg;
+		bs_release_reserved_clusters(bs, bs_create_blob_resize_retry, retry_ctx);
+		return;
+	}
+	if (rc < 0) {
 		goto error;
 	}
 
-	blob_persist(seq, blob, bs_create_blob_cpl, blob);
+	bs_create_blob_persist(blob, opts_local.num_clusters, cb_fn, cb_arg);
 	return;
 
 error:
-	SPDK_ERRLOG("Failed to create blob: %s, size in clusters/size: %lu (clusters)\n",
-		    spdk_strerror(rc), opts_local.num_clusters);
-	if (blob != NULL) {
-		blob_free(blob);
-	}
-	spdk_spin_lock(&bs->used_lock);
-	spdk_bit_array_clear(bs->used_blobids, page_idx);
-	bs_release_md_page(bs, page_idx);
-	spdk_spin_unlock(&bs->used_lock);
-	cb_fn(cb_arg, 0, rc);
+	bs_create_blob_fail(bs, blob, page_idx, opts_local.num_clusters, rc, cb_fn, cb_arg);
 }
 
 void
@@ -7874,6 +8069,7 @@ struct spdk_bs_resize_ctx {
 	struct spdk_blob *blob;
 	uint64_t sz;
 	int rc;
+	bool reserved_released;
 };
 
 static void
@@ -7896,6 +8092,30 @@ bs_resize_unfreeze_cpl(void *cb_arg, int rc)
 	free(ctx);
 }
 
+static void
+bs_resize_blob(void *cb_arg, int bserrno)
+{
+	struct spdk_bs_resize_ctx *ctx = (struct spdk_bs_resize_ctx *)cb_arg;
+	struct spdk_blob *blob = ctx->blob;
+
+	if (bserrno != 0) {
+		ctx->rc = bserrno;
+		blob_unfreeze_io(blob, bs_resize_unfreeze_cpl, ctx);
+		return;
+	}
+
+	ctx->rc = blob_resize(blob, ctx->sz);
+	if (ctx->rc == -ENOSPC && !ctx->reserved_released &&
+	    !spdk_blob_is_thin_provisioned(blob) && bs_has_reserved_clusters(blob->bs)) {
+		/* Some of the free clusters are reserved by channels. Take them back and retry. */
+		ctx->reserved_released = true;
+		bs_release_reserved_clusters(blob->bs, bs_resize_blob, ctx);
+		return;
+	}
+
+	blob_unfreeze_io(blob, bs_resize_unfreeze_cpl, ctx);
+}
+
 static void
 bs_resize_freeze_cpl(void *cb_arg, int rc)
 {
@@ -7908,9 +8128,7 @@ bs_resize_freeze_cpl(void *cb_arg, int rc)
 		return;
 	}
 
-	ctx->rc = blob_resize(ctx->blob, ctx->sz);
-
-	blob_unfreeze_io(ctx->blob, bs_resize_unfreeze_cpl, ctx);
+	bs_resize_blob(ctx, 0);
 }
 
 void
@@ -8768,6 +8986,11 @@ struct spdk_blob_cluster_op_ctx {
 	int			rc;
 	spdk_blob_op_complete	cb_fn;
 	void			*cb_arg;
+
+	/* Updates of the same extent page completed by this ctx's write */
+	TAILQ_HEAD(, spdk_blob_cluster_op_ctx) batch;
+	TAILQ_ENTRY(spdk_blob_cluster_op_ctx) link;
+	bool			ep_write_submitted;
 };
 
 static void
@@ -8912,6 +9135,93 @@ blob_write_extent_page(struct spdk_blob *blob, uint32_t extent, uint64_t cluster
 	bs_mark_dirty(seq, blob->bs, blob_write_extent_page_ready, ctx);
 }
 
+static void blob_submit_extent_page_write(struct spdk_blob_cluster_op_ctx *ctx);
+
+static void
+blob_update_extent_page_cpl(void *arg, int bserrno)
+{
+	struct spdk_blob_cluster_op_ctx *ctx = arg, *pending, *tmp;
+	struct spdk_blob *blob = ctx->blob;
+	struct spdk_blob_cluster_op_ctx *next = NULL;
+
+	TAILQ_REMOVE(&blob->ep_writes_in_progress, ctx, link);
+
+	/* All updates of this page that came in during the write are covered by the next one. */
+	TAILQ_FOREACH_SAFE(pending, &blob->pending_ep_writes, link, tmp) {
+		if (pending->extent_page != ctx->extent_page) {
+			continue;
+		}
+		TAILQ_REMOVE(&blob->pending_ep_writes, pending, link);
+		if (next == NULL) {
+			next = pending;
+		} else {
+			TAILQ_INSERT_TAIL(&next->batch, pending, link);
+		}
+	}
+
+	while (!TAILQ_EMPTY(&ctx->batch)) {
+		pending = TAILQ_FIRST(&ctx->batch);
+		TAILQ_REMOVE(&ctx->batch, pending, link);
+		blob_op_cluster_msg_cb(pending, bserrno);
+	}
+	blob_op_cluster_msg_cb(ctx, bserrno);
+
+	if (next != NULL) {
+		/* These already waited for a whole write, so don't delay them any further. */
+		TAILQ_INSERT_TAIL(&blob->ep_writes_in_progress, next, link);
+		blob_submit_extent_page_write(next);
+	}
+}
+
+static void
+blob_submit_extent_page_write(struct spdk_blob_cluster_op_ctx *ctx)
+{
+	ctx->ep_write_submitted = true;
+	blob_write_extent_page(ctx->blob, ctx->extent_page, ctx->cluster_num, ctx->page,
+			       blob_update_extent_page_cpl, ctx);
+}
+
+static void
+blob_submit_extent_page_write_msg(void *arg)
+{
+	blob_submit_extent_page_write(arg);
+}
+
+/*
+ * Write the extent page holding a newly inserted cluster.  Clusters of the same extent page
+ * are often inserted at the same time from different channels, so updates of a page are
+ * coalesced into as few writes as possible:
+ *  - The write of an idle page is deferred by a message to the md thread, so that inserts
+ *    already queued to the md thread join it.
+ *  - While a write of the page is in flight, other updates of it wait and are then all
+ *    covered by a single write.
+ */
+static void
+blob_update_extent_page(struct spdk_blob_cluster_op_ctx *ctx)
+{
+	struct spdk_blob *blob = ctx->blob;
+	struct spdk_blob_cluster_op_ctx *in_progress;
+
+	TAILQ_FOREACH(in_progress, &blob->ep_writes_in_progress, link) {
+		if (in_progress->extent_page != ctx->extent_page) {
+			continue;
+		}
+		if (in_progress->ep_write_submitted) {
+			TAILQ_INSERT_TAIL(&blob->pending_ep_writes, ctx, link);
+		} else {
+			/* The page isn't serialized until the write is submitted. */
+			TAILQ_INSERT_TAIL(&in_progress->batch, ctx, link);
+		}
+		return;
+	}
+
+	TAILQ_INSERT_TAIL(&blob->ep_writes_in_progress, ctx, link);
+	ctx->ep_write_submitted = false;
+	if (spdk_thread_send_msg(spdk_get_thread(), blob_submit_extent_page_write_msg, ctx) != 0) {
+		blob_submit_extent_page_write(ctx);
+	}
+}
+
 static void
 blob_insert_cluster_msg(void *arg)
 {
@@ -8952,8 +9262,8 @@ blob_insert_cluster_msg(void *arg)
 		}
 		/* Extent page already allocated.
 		 * Every cluster allocation, requires just an update of single extent page. */
-		blob_write_extent_page(ctx->blob, *extent_page, ctx->cluster_num, ctx->page,
-				       blob_op_cluster_msg_cb, ctx);
+		ctx->extent_page = *extent_page;
+		blob_update_extent_page(ctx);
 	}
 }
 
@@ -8978,6 +9288,7 @@ blob_insert_cluster_on_md_thread(struct spdk_blob *blob, uint32_t cluster_num,
 	ctx->page = page;
 	ctx->cb_fn = cb_fn;
 	ctx->cb_arg = cb_arg;
+	TAILQ_INIT(&ctx->batch);
 
 	spdk_thread_send_msg(blob->bs->md_thread, blob_insert_cluster_msg, ctx);
 }
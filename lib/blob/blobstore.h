@@ -26,6 +26,8 @@
 #define SPDK_BLOB_OPTS_MAX_MD_OPS 32
 #define SPDK_BLOB_OPTS_DEFAULT_CHANNEL_OPS 512
 #define SPDK_BLOB_BLOBID_HIGH_BIT (1ULL << 32)
+/* Maximum number of free clusters a channel claims ahead of thin provisioning allocations */
+#define SPDK_BS_CHANNEL_RESERVED_CLUSTERS 16
 
 struct spdk_xattr {
 	uint32_t	index;
@@ -148,6 +150,10 @@ struct spdk_blob {
 	TAILQ_HEAD(, spdk_blob_persist_ctx) pending_persists;
 	TAILQ_HEAD(, spdk_blob_persist_ctx) persists_to_complete;
 
+	/* Extent page writes of inserted clusters in flight, and the updates waiting for them. */
+	TAILQ_HEAD(, spdk_blob_cluster_op_ctx) ep_writes_in_progress;
+	TAILQ_HEAD(, spdk_blob_cluster_op_ctx) pending_ep_writes;
+
 	/* Number of data clusters retrieved from extent table,
 	 * that many have to be read from extent pages. */
 	uint64_t	remaining_clusters_in_et;
@@ -176,6 +182,8 @@ struct spdk_blob_store {
 	uint64_t			total_clusters;
 	uint64_t			total_data_clusters;
 	uint64_t			num_free_clusters;	/* Protected by used_lock */
+	/* Claimed clusters held by channels for thin provisioning, updated atomically */
+	uint64_t			num_reserved_clusters;
 	uint64_t			pages_per_cluster;
 	uint64_t			io_units_per_cluster;
 	uint8_t				pages_per_cluster_shift;
@@ -220,6 +228,11 @@ struct spdk_bs_channel {
 	TAILQ_HEAD(, spdk_bs_request_set) need_cluster_alloc;
 	TAILQ_HEAD(, spdk_bs_request_set) queued_io;
 
+	/* Free clusters claimed by this channel ahead of thin provisioning allocations.
+	 * They are taken from the end of the array, in ascending order. */
+	uint32_t			reserved_clusters[SPDK_BS_CHANNEL_RESERVED_CLUSTERS];
+	uint32_t			num_reserved_clusters;
+
 	RB_HEAD(blob_esnap_channel_tree, blob_esnap_channel) esnap_channels;
 };
 
@@ -31,6 +31,33 @@ ftl_band_filled(struct ftl_band *band, size_t offset)
 	return offset == ftl_band_tail_md_offset(band);
 }
 
+static bool
+is_band_relocateable(struct ftl_band *band)
+{
+	/* Can only move data from closed bands */
+	if (FTL_BAND_STATE_CLOSED != band->md->state) {
+		return false;
+	}
+
+	/* Band is already under relocation, skip it */
+	if (band->reloc) {
+		return false;
+	}
+
+	return true;
+}
+
+static inline struct ftl_band_gc_group *
+band_gc_group(struct ftl_band *band)
+{
+	assert(band->phys_id < band->dev->gc_index.num_groups);
+	return &band->dev->gc_index.groups[band->phys_id];
+}
+
+static void band_gc_group_requeue(struct spdk_ftl_dev *dev, struct ftl_band_gc_group *group);
+static void band_gc_index_add(struct ftl_band *band);
+static void band_gc_index_remove(struct ftl_band *band);
+
 static void
 ftl_band_free_p2l_map(struct ftl_band *band)
 {
@@ -67,6 +94,8 @@ _ftl_band_set_free(struct ftl_band *band)
 {
 	struct spdk_ftl_dev *dev = band->dev;
 
+	band_gc_index_remove(band);
+
 	/* Add the band to the free band list */
 	TAILQ_INSERT_TAIL(&dev->free_bands, band, queue_entry);
 	band->md->close_seq_id = 0;
@@ -114,6 +143,7 @@ _ftl_band_set_closed_cb(struct ftl_band *band, bool valid)
 	assert(band->p2l_map.ref_cnt == 0);
 
 	TAILQ_INSERT_TAIL(&dev->shut_bands, band, queue_entry);
+	band_gc_index_add(band);
 }
 
 static void
@@ -222,6 +252,11 @@ ftl_band_set_addr(struct ftl_band *band, uint64_t lba, ftl_addr addr)
 {
 	band->p2l_map.num_valid++;
 	ftl_bitmap_set(band->dev->valid_map, addr);
+
+	if (spdk_unlikely(band->gc_indexed)) {
+		band_gc_group(band)->num_valid++;
+		band_gc_group_requeue(band->dev, band_gc_group(band));
+	}
 }
 
 size_t
@@ -472,75 +507,270 @@ dump_bands_under_relocation(struct spdk_ftl_dev *dev)
 }
 
 static bool
-is_band_relocateable(struct ftl_band *band)
+band_cmp(double a_invalidity, double a_wr_cnt,
+	 double b_invalidity, double b_wr_cnt,
+	 uint64_t a_id, uint64_t b_id)
 {
-	/* Can only move data from closed bands */
-	if (FTL_BAND_STATE_CLOSED != band->md->state) {
-		return false;
+	assert(a_id != FTL_BAND_PHYS_ID_INVALID);
+	assert(b_id != FTL_BAND_PHYS_ID_INVALID);
+	double diff = a_invalidity - b_invalidity;
+	if (diff < 0.0L) {
+		diff *= -1.0L;
 	}
 
-	/* Band is already under relocation, skip it */
-	if (band->reloc) {
-		return false;
+	/* Use the following metrics for picking bands for GC (in order):
+	 * - relative invalidity
+	 * - if invalidity is similar (within 10% points), then their write counts (how many times band was written to)
+	 * - if write count is equal, then pick based on their placement on base device (lower LBAs win)
+	 */
+	if (diff > 0.1L) {
+		return a_invalidity > b_invalidity;
 	}
 
-	return true;
+	if (a_wr_cnt != b_wr_cnt) {
+		return a_wr_cnt < b_wr_cnt;
+	}
+
+	return a_id < b_id;
 }
 
-static void
-get_band_phys_info(struct spdk_ftl_dev *dev, uint64_t phys_id,
-		   double *invalidity, double *wr_cnt)
+static double
+gc_group_invalidity(struct spdk_ftl_dev *dev, const struct ftl_band_gc_group *group)
 {
-	struct ftl_band *band;
-	uint64_t band_id = phys_id * dev->num_logical_bands_in_physical;
+	double user_blocks = ftl_get_num_blocks_in_band(dev) - ftl_tail_md_num_blocks(dev);
+	double invalid = group->num_bands * user_blocks - group->num_valid;
 
-	*wr_cnt = *invalidity = 0.0L;
-	for (; band_id < ftl_get_num_bands(dev); band_id++) {
-		band = &dev->bands[band_id];
+	/* Bands of the group which can't be relocated count as fully valid */
+	return invalid / (dev->num_logical_bands_in_physical * user_blocks);
+}
 
-		if (phys_id != band->phys_id) {
-			break;
-		}
+static double
+gc_group_wr_cnt(struct spdk_ftl_dev *dev, const struct ftl_band_gc_group *group)
+{
+	uint64_t band_id = group->phys_id * dev->num_logical_bands_in_physical;
+	uint64_t end = band_id + dev->num_logical_bands_in_physical;
+	double wr_cnt = 0.0L;
 
-		*wr_cnt += band->md->wr_cnt;
+	for (; band_id < end; band_id++) {
+		wr_cnt += dev->bands[band_id].md->wr_cnt;
+	}
 
-		if (!is_band_relocateable(band)) {
-			continue;
+	return wr_cnt / dev->num_logical_bands_in_physical;
+}
+
+static void
+band_gc_group_requeue(struct spdk_ftl_dev *dev, struct ftl_band_gc_group *group)
+{
+	uint32_t bucket = FTL_GC_NUM_BUCKETS;
+	double invalidity;
+
+	if (group->num_bands) {
+		invalidity = gc_group_invalidity(dev, group);
+		if (invalidity > 0.0L) {
+			bucket = spdk_min((uint32_t)(invalidity * FTL_GC_NUM_BUCKETS), FTL_GC_NUM_BUCKETS - 1);
 		}
+	}
 
-		*invalidity += ftl_band_invalidity(band);
+	if (bucket == group->bucket) {
+		return;
 	}
 
-	*invalidity /= dev->num_logical_bands_in_physical;
-	*wr_cnt /= dev->num_logical_bands_in_physical;
+	if (group->bucket != FTL_GC_NUM_BUCKETS) {
+		TAILQ_REMOVE(&dev->gc_index.buckets[group->bucket], group, entry);
+	}
+	if (bucket != FTL_GC_NUM_BUCKETS) {
+		TAILQ_INSERT_TAIL(&dev->gc_index.buckets[bucket], group, entry);
+	}
+	group->bucket = bucket;
 }
 
-static bool
-band_cmp(double a_invalidity, double a_wr_cnt,
-	 double b_invalidity, double b_wr_cnt,
-	 uint64_t a_id, uint64_t b_id)
+static void
+band_gc_index_add(struct ftl_band *band)
 {
-	assert(a_id != FTL_BAND_PHYS_ID_INVALID);
-	assert(b_id != FTL_BAND_PHYS_ID_INVALID);
-	double diff = a_invalidity - b_invalidity;
-	if (diff < 0.0L) {
-		diff *= -1.0L;
+	struct spdk_ftl_dev *dev = band->dev;
+	struct ftl_band_gc_group *group;
+
+	if (!dev->gc_index.groups || band->gc_indexed || !is_band_relocateable(band)) {
+		return;
 	}
 
-	/* Use the following metrics for picking bands for GC (in order):
-	 * - relative invalidity
-	 * - if invalidity is similar (within 10% points), then their write counts (how many times band was written to)
-	 * - if write count is equal, then pick based on their placement on base device (lower LBAs win)
+	group = band_gc_group(band);
+	group->num_bands++;
+	group->num_valid += band->p2l_map.num_valid;
+	group->close_seq_id_sum += band->md->close_seq_id;
+	band->gc_indexed = true;
+
+	band_gc_group_requeue(dev, group);
+}
+
+static void
+band_gc_index_remove(struct ftl_band *band)
+{
+	struct ftl_band_gc_group *group;
+
+	if (!band->gc_indexed) {
+		return;
+	}
+
+	group = band_gc_group(band);
+	assert(group->num_bands > 0);
+	assert(group->num_valid >= band->p2l_map.num_valid);
+	group->num_bands--;
+	group->num_valid -= band->p2l_map.num_valid;
+	group->close_seq_id_sum -= band->md->close_seq_id;
+	band->gc_indexed = false;
+
+	band_gc_group_requeue(band->dev, group);
+}
+
+void
+ftl_band_gc_index_dec_valid(struct ftl_band *band)
+{
+	struct ftl_band_gc_group *group;
+
+	if (!band->gc_indexed) {
+		return;
+	}
+
+	group = band_gc_group(band);
+	assert(group->num_valid > 0);
+	group->num_valid--;
+
+	band_gc_group_requeue(band->dev, group);
+}
+
+static void
+gc_index_reset(struct spdk_ftl_dev *dev)
+{
+	struct ftl_band_gc_group *group;
+	uint64_t i;
+
+	for (i = 0; i < FTL_GC_NUM_BUCKETS; i++) {
+		TAILQ_INIT(&dev->gc_index.buckets[i]);
+	}
+
+	for (i = 0; i < dev->gc_index.num_groups; i++) {
+		group = &dev->gc_index.groups[i];
+		memset(group, 0, sizeof(*group));
+		group->phys_id = i;
+		group->bucket = FTL_GC_NUM_BUCKETS;
+	}
+}
+
+static void
+gc_index_rebuild(struct spdk_ftl_dev *dev)
+{
+	uint64_t i;
+
+	gc_index_reset(dev);
+
+	for (i = 0; i < ftl_get_num_bands(dev); i++) {
+		dev->bands[i].gc_indexed = false;
+		band_gc_index_add(&dev->bands[i]);
+	}
+
+	dev->gc_index.valid = true;
+}
+
+int
+ftl_band_gc_index_init(struct spdk_ftl_dev *dev, uint64_t num_groups)
+{
+	dev->gc_index.groups = calloc(num_groups, sizeof(*dev->gc_index.groups));
+	if (!dev->gc_index.groups) {
+		return -ENOMEM;
+	}
+
+	dev->gc_index.num_groups = num_groups;
+	dev->gc_index.valid = false;
+	/* Bands closing before the first rebuild are already added to the index */
+	gc_index_reset(dev);
+
+	return 0;
+}
+
+void
+ftl_band_gc_index_deinit(struct spdk_ftl_dev *dev)
+{
+	free(dev->gc_index.groups);
+	dev->gc_index.groups = NULL;
+	dev->gc_index.num_groups = 0;
+}
+
+static uint64_t
+gc_select_greedy(struct spdk_ftl_dev *dev)
+{
+	struct ftl_band_gc_group *group;
+	double invalidity, max_invalidity = 0.0L;
+	double wr_cnt, max_wr_cnt = 0.0L;
+	uint64_t phys_id = FTL_BAND_PHYS_ID_INVALID;
+	int i;
+
+	/* Only the most invalid non-empty bucket is compared. Groups within it are less
+	 * than 10% points apart, which is where band_cmp() falls back to the write count.
 	 */
-	if (diff > 0.1L) {
-		return a_invalidity > b_invalidity;
+	for (i = FTL_GC_NUM_BUCKETS - 1; i >= 0; i--) {
+		TAILQ_FOREACH(group, &dev->gc_index.buckets[i], entry) {
+			invalidity = gc_group_invalidity(dev, group);
+			wr_cnt = gc_group_wr_cnt(dev, group);
+
+			if (phys_id == FTL_BAND_PHYS_ID_INVALID ||
+			    band_cmp(invalidity, wr_cnt, max_invalidity, max_wr_cnt,
+				     group->phys_id, phys_id)) {
+				max_invalidity = invalidity;
+				max_wr_cnt = wr_cnt;
+				phys_id = group->phys_id;
+			}
+		}
+
+		if (phys_id != FTL_BAND_PHYS_ID_INVALID) {
+			break;
+		}
 	}
 
-	if (a_wr_cnt != b_wr_cnt) {
-		return a_wr_cnt < b_wr_cnt;
+	return phys_id;
+}
+
+static double
+gc_cost_benefit(double invalidity, double age)
+{
+	/* Space reclaimed times the age of the data, over the cost of reading the valid
+	 * data and writing it back (u = 1 - invalidity): age * (1 - u) / (1 + u).
+	 */
+	return age * invalidity / (2.0L - invalidity);
+}
+
+static uint64_t
+gc_select_cost_benefit(struct spdk_ftl_dev *dev)
+{
+	struct ftl_band_gc_group *group;
+	uint64_t seq_id = dev->sb->seq_id;
+	uint64_t phys_id = FTL_BAND_PHYS_ID_INVALID;
+	double score, max_score = 0.0L, age;
+	int i;
+
+	for (i = FTL_GC_NUM_BUCKETS - 1; i >= 0; i--) {
+		/* No group in this or lower buckets can beat the current pick, even if its data
+		 * was written at the very beginning.
+		 */
+		if (phys_id != FTL_BAND_PHYS_ID_INVALID &&
+		    gc_cost_benefit((double)(i + 1) / FTL_GC_NUM_BUCKETS, seq_id) <= max_score) {
+			break;
+		}
+
+		TAILQ_FOREACH(group, &dev->gc_index.buckets[i], entry) {
+			assert(group->num_bands > 0);
+			age = seq_id - spdk_min(seq_id, group->close_seq_id_sum / group->num_bands);
+			score = gc_cost_benefit(gc_group_invalidity(dev, group), age);
+
+			if (phys_id == FTL_BAND_PHYS_ID_INVALID || score > max_score ||
+			    (score == max_score && group->phys_id < phys_id)) {
+				max_score = score;
+				phys_id = group->phys_id;
+			}
+		}
 	}
 
-	return a_id < b_id;
+	return phys_id;
 }
 
 static void
@@ -549,6 +779,7 @@ band_start_gc(struct spdk_ftl_dev *dev, struct ftl_band *band)
 	ftl_bug(false == is_band_relocateable(band));
 
 	TAILQ_REMOVE(&dev->shut_bands, band, queue_entry);
+	band_gc_index_remove(band);
 	band->reloc = true;
 
 	FTL_DEBUGLOG(dev, "Band to GC, id %u\n", band->id);
@@ -588,11 +819,9 @@ ftl_band_reset_gc_iter(struct spdk_ftl_dev *dev)
 struct ftl_band *
 ftl_band_search_next_to_reloc(struct spdk_ftl_dev *dev)
 {
-	double invalidity, max_invalidity = 0.0L;
-	double wr_cnt, max_wr_cnt = 0.0L;
-	uint64_t phys_id = FTL_BAND_PHYS_ID_INVALID;
+	uint64_t phys_id;
 	struct ftl_band *band;
-	uint64_t i, band_count;
+	uint64_t band_count;
 	uint64_t phys_count;
 
 	band = gc_high_priority_band(dev);
@@ -618,24 +847,14 @@ ftl_band_search_next_to_reloc(struct spdk_ftl_dev *dev)
 		return band;
 	}
 
-	for (i = 0; i < band_count; i += phys_count) {
-		band = &dev->bands[i];
-
-		/* Calculate entire band physical group invalidity */
-		get_band_phys_info(dev, band->phys_id, &invalidity, &wr_cnt);
-
-		if (invalidity != 0.0L) {
-			if (phys_id == FTL_BAND_PHYS_ID_INVALID ||
-			    band_cmp(invalidity, wr_cnt, max_invalidity, max_wr_cnt,
-				     band->phys_id, phys_id)) {
-				max_wr_cnt = wr_cnt;
-				phys_id = band->phys_id;
+	if (!dev->gc_index.valid) {
+		gc_index_rebuild(dev);
+	}
 
-				if (invalidity > max_invalidity) {
-					max_invalidity = invalidity;
-				}
-			}
-		}
+	if (dev->conf.gc_policy == SPDK_FTL_GC_POLICY_COST_BENEFIT) {
+		phys_id = gc_select_cost_benefit(dev);
+	} else {
+		phys_id = gc_select_greedy(dev);
 	}
 
 	if (FTL_BAND_PHYS_ID_INVALID != phys_id) {
@@ -656,6 +875,8 @@ ftl_band_search_next_to_reloc(struct spdk_ftl_dev *dev)
 void
 ftl_band_init_gc_iter(struct spdk_ftl_dev *dev)
 {
+	dev->gc_index.valid = false;
+
 	if (dev->conf.mode & SPDK_FTL_MODE_CREATE) {
 		ftl_band_reset_gc_iter(dev);
 		return;
@@ -684,6 +905,8 @@ ftl_valid_map_load_state(struct spdk_ftl_dev *dev)
 		band = &dev->bands[i];
 		band->p2l_map.num_valid = ftl_bitmap_count_set(band->p2l_map.valid);
 	}
+
+	dev->gc_index.valid = false;
 }
 
 void
@@ -95,6 +95,28 @@ SPDK_STATIC_ASSERT(sizeof(struct ftl_band_md) == FTL_BLOCK_SIZE, "Incorrect band
 SPDK_STATIC_ASSERT(offsetof(struct ftl_band_md, version) == 0,
 		   "Incorrect band metadata version offset");
 
+/* Physical band group as tracked by the GC victim index. Sums cover only the group's bands
+ * which can be relocated (closed and not already under relocation).
+ */
+struct ftl_band_gc_group {
+	/* Physical band id */
+	uint64_t					phys_id;
+
+	/* Number of relocatable bands */
+	uint64_t					num_bands;
+
+	/* Valid blocks in the relocatable bands */
+	uint64_t					num_valid;
+
+	/* Sum of the relocatable bands' close sequence ids, used for the age of the data */
+	uint64_t					close_seq_id_sum;
+
+	/* Bucket the group is queued on, FTL_GC_NUM_BUCKETS if it has nothing to reclaim */
+	uint32_t					bucket;
+
+	TAILQ_ENTRY(ftl_band_gc_group)			entry;
+};
+
 struct ftl_band {
 	/* Device this band belongs to */
 	struct spdk_ftl_dev		*dev;
@@ -128,6 +150,9 @@ struct ftl_band {
 	/* Band relocation is in progress */
 	bool				reloc;
 
+	/* Band is accounted in its physical group of the GC victim index */
+	bool				gc_indexed;
+
 	/* Band's index */
 	uint32_t			id;
 
@@ -183,6 +208,9 @@ int ftl_band_write_prep(struct ftl_band *band);
 size_t ftl_p2l_map_pool_elem_size(struct spdk_ftl_dev *dev);
 struct ftl_band *ftl_band_search_next_to_reloc(struct spdk_ftl_dev *dev);
 void ftl_band_init_gc_iter(struct spdk_ftl_dev *dev);
+int ftl_band_gc_index_init(struct spdk_ftl_dev *dev, uint64_t num_groups);
+void ftl_band_gc_index_deinit(struct spdk_ftl_dev *dev);
+void ftl_band_gc_index_dec_valid(struct ftl_band *band);
 ftl_addr ftl_band_p2l_map_addr(struct ftl_band *band);
 void ftl_valid_map_load_state(struct spdk_ftl_dev *dev);
 int ftl_bands_load_state(struct spdk_ftl_dev *dev);
@@ -155,6 +155,7 @@ ftl_invalidate_addr(struct spdk_ftl_dev *dev, ftl_addr addr)
 		assert(p2l_map->num_valid > 0);
 		ftl_bitmap_clear(dev->valid_map, addr);
 		p2l_map->num_valid--;
+		ftl_band_gc_index_dec_valid(band);
 	}
 
 	/* Invalidate open/full band p2l_map entry to keep p2l and l2p
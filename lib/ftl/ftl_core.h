@@ -38,10 +38,14 @@
  * Some devices have bugs when sending a NULL pointer as part of metadata when namespace
  * is formatted with VSS. This buffer is passed to such calls to avoid the bug. */
 #define FTL_ZERO_BUFFER_SIZE 0x100000
+
+/* Number of invalidity buckets physical band groups are sorted into for GC victim selection */
+#define FTL_GC_NUM_BUCKETS 10
 extern void *g_ftl_write_buf;
 extern void *g_ftl_read_buf;
 
 struct ftl_layout_tracker_bdev;
+struct ftl_band_gc_group;
 
 struct spdk_ftl_dev {
 	/* Configuration */
@@ -183,6 +187,16 @@ struct spdk_ftl_dev {
 
 	uint32_t			num_logical_bands_in_physical;
 
+	/* GC victim index - physical band groups bucketed by invalidity */
+	struct {
+		struct ftl_band_gc_group	*groups;
+		uint64_t			num_groups;
+		TAILQ_HEAD(, ftl_band_gc_group)	buckets[FTL_GC_NUM_BUCKETS];
+
+		/* Rebuilt from the band state before the next victim search if false */
+		bool				valid;
+	} gc_index;
+
 	/* Retry init sequence */
 	bool				init_retry;
 
@@ -213,6 +213,9 @@ struct ftl_rq {
 
 		/* This is compaction IO */
 		bool compaction;
+
+		/* Relocated data which was already relocated before */
+		bool cold;
 	} owner;
 
 	/* Iterator fields for processing state of the request */
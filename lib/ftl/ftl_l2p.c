@@ -39,6 +39,7 @@ ftl_l2p_pin_ctx_init(struct ftl_l2p_pin_ctx *pin_ctx, uint64_t lba, uint64_t cou
 	pin_ctx->count = count;
 	pin_ctx->cb = cb;
 	pin_ctx->cb_ctx = cb_ctx;
+	pin_ctx->internal = false;
 }
 
 void
@@ -49,6 +50,15 @@ ftl_l2p_pin(struct spdk_ftl_dev *dev, uint64_t lba, uint64_t count, ftl_l2p_pin_
 	FTL_L2P_OP(pin)(dev, pin_ctx);
 }
 
+void
+ftl_l2p_pin_internal(struct spdk_ftl_dev *dev, uint64_t lba, uint64_t count, ftl_l2p_pin_cb cb,
+		     void *cb_ctx, struct ftl_l2p_pin_ctx *pin_ctx)
+{
+	ftl_l2p_pin_ctx_init(pin_ctx, lba, count, cb, cb_ctx);
+	pin_ctx->internal = true;
+	FTL_L2P_OP(pin)(dev, pin_ctx);
+}
+
 void
 ftl_l2p_unpin(struct spdk_ftl_dev *dev, uint64_t lba, uint64_t count)
 {
@@ -10,6 +10,9 @@
 
 #include "ftl_internal.h"
 
+/* Maximum number of L2P pages paged in ahead of sequential user IO */
+#define FTL_L2P_PREFETCH_DEPTH_MAX	512
+
 struct spdk_ftl_dev;
 struct ftl_nv_cache_chunk;
 struct ftl_rq;
@@ -28,11 +31,15 @@ struct ftl_l2p_pin_ctx {
 	uint64_t count;
 	ftl_l2p_pin_cb cb;
 	void *cb_ctx;
+	/* Pinned on behalf of relocation, compaction or trim rather than user IO */
+	bool internal;
 	TAILQ_ENTRY(ftl_l2p_pin_ctx) link;
 };
 
 void ftl_l2p_pin(struct spdk_ftl_dev *dev, uint64_t lba, uint64_t count, ftl_l2p_pin_cb cb,
 		 void *cb_ctx, struct ftl_l2p_pin_ctx *pin_ctx);
+void ftl_l2p_pin_internal(struct spdk_ftl_dev *dev, uint64_t lba, uint64_t count, ftl_l2p_pin_cb cb,
+			  void *cb_ctx, struct ftl_l2p_pin_ctx *pin_ctx);
 void ftl_l2p_unpin(struct spdk_ftl_dev *dev, uint64_t lba, uint64_t count);
 void ftl_l2p_pin_skip(struct spdk_ftl_dev *dev, ftl_l2p_pin_cb cb, void *cb_ctx,
 		      struct ftl_l2p_pin_ctx *pin_ctx);
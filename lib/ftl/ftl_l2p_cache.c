@@ -20,6 +20,8 @@
 #include "mngt/ftl_mngt_steps.h"
 #include "utils/ftl_defs.h"
 #include "utils/ftl_addr_utils.h"
+#include "utils/ftl_bitmap.h"
+#include "utils/ftl_property.h"
 
 struct ftl_l2p_cache_page_io_ctx {
 	struct ftl_l2p_cache *cache;
@@ -37,6 +39,35 @@ enum ftl_l2p_page_state {
 	L2P_CACHE_PAGE_CORRUPTED	/* Page corrupted */
 };
 
+/*
+ * Resident pages are ranked on two lists (2Q). Pages start on the probation list and only move
+ * to the protected list if they're paged in by user IO again shortly after being evicted from
+ * probation (while their page number is still in the ghost ring). A single sequential scan or
+ * relocation sweep therefore cycles through the probation list without pushing out the hot
+ * working set kept on the protected list.
+ */
+enum ftl_l2p_page_class {
+	L2P_CACHE_PAGE_PROBATION,
+	L2P_CACHE_PAGE_PROTECTED,
+};
+
+/* Maximum share of resident pages (in %) which can be kept on the protected list */
+#define FTL_L2P_CACHE_PROTECTED_RATIO	75UL
+/* Number of evicted pages remembered in the ghost ring (in % of resident pages) */
+#define FTL_L2P_CACHE_GHOST_RATIO	50UL
+
+/*
+ * Sequential user access is detected per stream, a stream being a run of pins each starting on
+ * (or right after) the last page pinned by the previous one. Once a stream advanced over
+ * FTL_L2P_CACHE_PREFETCH_TRIGGER pages, the next l2p_prefetch_depth pages are paged in ahead of
+ * time, so a sequential reader doesn't stall on an L2P page miss every lbas_in_page blocks.
+ */
+#define FTL_L2P_CACHE_PREFETCH_STREAMS	4
+#define FTL_L2P_CACHE_PREFETCH_TRIGGER	2
+
+/* Above this number of in flight IOs deferred pins wait and no pages are prefetched */
+#define FTL_L2P_CACHE_MAX_IOS_IN_FLIGHT	512
+
 struct ftl_l2p_page {
 	uint64_t updates; /* Number of times an L2P entry was updated in the page since it was last persisted */
 	TAILQ_HEAD(, ftl_l2p_page_wait_ctx) ppe_list; /* for deferred pins */
@@ -46,6 +77,9 @@ struct ftl_l2p_page {
 	uint64_t pin_ref_cnt;
 	struct ftl_l2p_cache_page_io_ctx ctx;
 	bool on_lru_list;
+	uint8_t lru_class;	/* enum ftl_l2p_page_class */
+	bool user_ref;		/* Pinned by user IO since the page was last ranked */
+	bool user_accessed;	/* Pinned by user IO since the page was paged in */
 	void *page_buffer;
 	uint64_t ckpt_seq_id;
 	ftl_df_obj_id obj_id;
@@ -107,7 +141,42 @@ struct ftl_l2p_cache {
 	struct ftl_mempool *l2_ctx_pool;
 	struct ftl_md *l1_md;
 
+	/* Probation rank list, new pages start here */
 	TAILQ_HEAD(l2p_lru_list, ftl_l2p_page) lru_list;
+	/* Protected rank list, holds pages re-referenced by user IO after eviction */
+	struct l2p_lru_list protected_list;
+	uint32_t protected_pages;
+	uint32_t protected_max;
+
+	/* Page numbers recently evicted from the probation list */
+	struct {
+		uint64_t *ring;
+		uint64_t size;
+		uint64_t head;
+		uint64_t count;
+		struct ftl_bitmap *map;
+		void *map_buf;
+	} ghost;
+
+	struct {
+		uint64_t hits;
+		uint64_t misses;
+		uint64_t ghost_hits;
+		uint64_t evictions;
+		uint64_t prefetches;
+	} stats;
+
+	/* Sequential access streams used for L2P page prefetching */
+	struct {
+		/* Last page pinned by the stream */
+		uint64_t last_page;
+		/* First page which wasn't prefetched for the stream yet */
+		uint64_t next_page;
+		/* Number of consecutive pages the stream advanced over */
+		uint32_t seq_pages;
+	} prefetch[FTL_L2P_CACHE_PREFETCH_STREAMS];
+	/* Stream slot to be reused by the next non-sequential pin */
+	uint32_t prefetch_victim;
 	/* TODO: A lot of / and % operations are done on this value, consider adding a shift based field and calculactions instead */
 	uint64_t lbas_in_page;
 	uint64_t num_pages;		/* num pages to hold the entire L2P */
@@ -154,6 +223,9 @@ static bool page_set_is_done(struct ftl_l2p_page_set *page_set);
 static void page_set_end(struct spdk_ftl_dev *dev, struct ftl_l2p_cache *cache,
 			 struct ftl_l2p_page_set *page_set);
 static void page_out_io_retry(void *arg);
+static struct ftl_l2p_page *page_allocate(struct ftl_l2p_cache *cache, uint64_t page_no);
+static void page_in_io(struct spdk_ftl_dev *dev, struct ftl_l2p_cache *cache,
+		       struct ftl_l2p_page *page);
 static void page_in_io_retry(void *arg);
 
 static inline void
@@ -181,13 +253,23 @@ ftl_l2p_cache_get_page_all_size(void)
 	return sizeof(struct ftl_l2p_page) + ftl_l2p_cache_get_l1_page_size();
 }
 
+static inline struct l2p_lru_list *
+ftl_l2p_cache_lru_get_list(struct ftl_l2p_cache *cache, struct ftl_l2p_page *page)
+{
+	if (page->lru_class == L2P_CACHE_PAGE_PROTECTED) {
+		return &cache->protected_list;
+	}
+
+	return &cache->lru_list;
+}
+
 static void
 ftl_l2p_cache_lru_remove_page(struct ftl_l2p_cache *cache, struct ftl_l2p_page *page)
 {
 	assert(page);
 	assert(page->on_lru_list);
 
-	TAILQ_REMOVE(&cache->lru_list, page, list_entry);
+	TAILQ_REMOVE(ftl_l2p_cache_lru_get_list(cache, page), page, list_entry);
 	page->on_lru_list = false;
 }
 
@@ -197,22 +279,80 @@ ftl_l2p_cache_lru_add_page(struct ftl_l2p_cache *cache, struct ftl_l2p_page *pag
 	assert(page);
 	assert(!page->on_lru_list);
 
-	TAILQ_INSERT_HEAD(&cache->lru_list, page, list_entry);
+	if (page->lru_class == L2P_CACHE_PAGE_PROTECTED || page->user_ref) {
+		TAILQ_INSERT_HEAD(ftl_l2p_cache_lru_get_list(cache, page), page, list_entry);
+	} else {
+		/* Only used by relocation, compaction or trim since last ranked, evict it first */
+		TAILQ_INSERT_TAIL(&cache->lru_list, page, list_entry);
+	}
 
+	page->user_ref = false;
 	page->on_lru_list = true;
 }
 
 static void
-ftl_l2p_cache_lru_promote_page(struct ftl_l2p_cache *cache, struct ftl_l2p_page *page)
+ftl_l2p_cache_ghost_add(struct ftl_l2p_cache *cache, uint64_t page_no)
+{
+	uint64_t tail;
+
+	if (ftl_bitmap_get(cache->ghost.map, page_no)) {
+		return;
+	}
+
+	if (cache->ghost.count == cache->ghost.size) {
+		/* Forget the oldest evicted page */
+		ftl_bitmap_clear(cache->ghost.map, cache->ghost.ring[cache->ghost.head]);
+		cache->ghost.head = (cache->ghost.head + 1) % cache->ghost.size;
+		cache->ghost.count--;
+	}
+
+	tail = (cache->ghost.head + cache->ghost.count) % cache->ghost.size;
+	cache->ghost.ring[tail] = page_no;
+	cache->ghost.count++;
+	ftl_bitmap_set(cache->ghost.map, page_no);
+}
+
+static void
+ftl_l2p_cache_demote_page(struct ftl_l2p_cache *cache)
 {
-	if (!page->on_lru_list) {
+	struct ftl_l2p_page *page = TAILQ_LAST(&cache->protected_list, l2p_lru_list);
+
+	if (!page) {
+		/* All protected pages are pinned, they'll be demoted later */
 		return;
 	}
 
 	ftl_l2p_cache_lru_remove_page(cache, page);
+	page->lru_class = L2P_CACHE_PAGE_PROBATION;
+	page->user_ref = true;
+	cache->protected_pages--;
 	ftl_l2p_cache_lru_add_page(cache, page);
 }
 
+static void
+ftl_l2p_cache_page_classify(struct ftl_l2p_cache *cache, struct ftl_l2p_page *page,
+			    struct ftl_l2p_pin_ctx *pin_ctx)
+{
+	/*
+	 * Ghost entries are left in the ring when hit, the bit is cleared instead. Such a stale
+	 * entry may make the page be forgotten early if it's evicted again, which only affects
+	 * its ranking.
+	 */
+	if (pin_ctx->internal || !ftl_bitmap_get(cache->ghost.map, page->page_no)) {
+		page->lru_class = L2P_CACHE_PAGE_PROBATION;
+		return;
+	}
+
+	ftl_bitmap_clear(cache->ghost.map, page->page_no);
+	cache->stats.ghost_hits++;
+
+	page->lru_class = L2P_CACHE_PAGE_PROTECTED;
+	cache->protected_pages++;
+	if (cache->protected_pages > cache->protected_max) {
+		ftl_l2p_cache_demote_page(cache);
+	}
+}
+
 static inline void
 ftl_l2p_cache_page_insert(struct ftl_l2p_cache *cache, struct ftl_l2p_page *page)
 {
@@ -232,6 +372,10 @@ ftl_l2p_cache_page_remove(struct ftl_l2p_cache *cache, struct ftl_l2p_page *page
 	assert(TAILQ_EMPTY(&page->ppe_list));
 
 	me[page->page_no].page_obj_id = FTL_DF_OBJ_ID_INVALID;
+	if (page->lru_class == L2P_CACHE_PAGE_PROTECTED) {
+		assert(cache->protected_pages > 0);
+		cache->protected_pages--;
+	}
 	cache->l2_pgs_avail++;
 	ftl_mempool_put(cache->l2_ctx_pool, page);
 }
@@ -239,7 +383,12 @@ ftl_l2p_cache_page_remove(struct ftl_l2p_cache *cache, struct ftl_l2p_page *page
 static inline struct ftl_l2p_page *
 ftl_l2p_cache_get_coldest_page(struct ftl_l2p_cache *cache)
 {
-	return TAILQ_LAST(&cache->lru_list, l2p_lru_list);
+	/* Pages on probation go first, the protected list is limited by demotions */
+	if (!TAILQ_EMPTY(&cache->lru_list)) {
+		return TAILQ_LAST(&cache->lru_list, l2p_lru_list);
+	}
+
+	return TAILQ_LAST(&cache->protected_list, l2p_lru_list);
 }
 
 static inline struct ftl_l2p_page *
@@ -334,9 +483,15 @@ ftl_l2p_page_set_invalid(struct spdk_ftl_dev *dev, struct ftl_l2p_page *page)
 }
 
 static inline void
-ftl_l2p_cache_page_pin(struct ftl_l2p_cache *cache, struct ftl_l2p_page *page)
+ftl_l2p_cache_page_pin(struct ftl_l2p_cache *cache, struct ftl_l2p_page *page,
+		       struct ftl_l2p_pin_ctx *pin_ctx)
 {
 	page->pin_ref_cnt++;
+	if (!pin_ctx->internal) {
+		page->user_ref = true;
+		page->user_accessed = true;
+	}
+
 	/* Pinned pages can't be evicted (since L2P sets/gets will be executed on it), so remove them from LRU */
 	if (page->on_lru_list) {
 		ftl_l2p_cache_lru_remove_page(cache, page);
@@ -422,6 +577,24 @@ get_l2p_page_by_df_id(struct ftl_l2p_cache *cache, size_t page_no)
 	return NULL;
 }
 
+static void
+ftl_property_dump_l2p_cache(struct spdk_ftl_dev *dev, const struct ftl_property *property,
+			    struct spdk_json_write_ctx *w)
+{
+	struct ftl_l2p_cache *cache = (struct ftl_l2p_cache *)dev->l2p;
+
+	spdk_json_write_named_uint64(w, "resident_pages",
+				     cache->l2_pgs_resident_max - cache->l2_pgs_avail);
+	spdk_json_write_named_uint64(w, "max_resident_pages", cache->l2_pgs_resident_max);
+	spdk_json_write_named_uint64(w, "protected_pages", cache->protected_pages);
+	spdk_json_write_named_uint64(w, "hits", cache->stats.hits);
+	spdk_json_write_named_uint64(w, "misses", cache->stats.misses);
+	spdk_json_write_named_uint64(w, "ghost_hits", cache->stats.ghost_hits);
+	spdk_json_write_named_uint64(w, "evictions", cache->stats.evictions);
+	spdk_json_write_named_uint64(w, "prefetches", cache->stats.prefetches);
+	spdk_json_write_named_uint32(w, "prefetch_depth", dev->conf.l2p_prefetch_depth);
+}
+
 int
 ftl_l2p_cache_init(struct spdk_ftl_dev *dev)
 {
@@ -460,6 +633,7 @@ ftl_l2p_cache_init(struct spdk_ftl_dev *dev)
 
 	TAILQ_INIT(&cache->deferred_page_set_list);
 	TAILQ_INIT(&cache->lru_list);
+	TAILQ_INIT(&cache->protected_list);
 
 	cache->l2_ctx_md = ftl_md_create(dev,
 					 spdk_divide_round_up(max_resident_pgs * SPDK_ALIGN_CEIL(sizeof(struct ftl_l2p_page), 64),
@@ -472,6 +646,20 @@ ftl_l2p_cache_init(struct spdk_ftl_dev *dev)
 	cache->l2_pgs_resident_max = max_resident_pgs;
 	cache->l2_pgs_avail = max_resident_pgs;
 	cache->l2_pgs_evicting = 0;
+	cache->protected_max = max_resident_pgs * FTL_L2P_CACHE_PROTECTED_RATIO / 100;
+
+	cache->ghost.size = spdk_max(1UL, max_resident_pgs * FTL_L2P_CACHE_GHOST_RATIO / 100);
+	cache->ghost.ring = calloc(cache->ghost.size, sizeof(*cache->ghost.ring));
+	cache->ghost.map_buf = calloc(1, ftl_bitmap_bits_to_size(cache->num_pages));
+	if (!cache->ghost.ring || !cache->ghost.map_buf) {
+		return -1;
+	}
+
+	cache->ghost.map = ftl_bitmap_create(cache->ghost.map_buf,
+					     ftl_bitmap_bits_to_size(cache->num_pages));
+	if (!cache->ghost.map) {
+		return -1;
+	}
 	cache->l2_ctx_pool = ftl_mempool_create_ext(ftl_md_get_buffer(cache->l2_ctx_md),
 			     max_resident_pgs, sizeof(struct ftl_l2p_page), 64);
 
@@ -504,6 +692,10 @@ ftl_l2p_cache_init(struct spdk_ftl_dev *dev)
 	cache->cache_layout_bdev_desc = reg->bdev_desc;
 	cache->cache_layout_ioch = reg->ioch;
 
+	ftl_property_register(dev, "l2p_cache", NULL, 0, NULL,
+			      "L2P cache residency and hit counters", ftl_property_dump_l2p_cache,
+			      NULL, NULL, false);
+
 	return 0;
 }
 
@@ -521,6 +713,15 @@ ftl_l2p_cache_deinit_l2(struct spdk_ftl_dev *dev, struct ftl_l2p_cache *cache)
 
 	ftl_mempool_destroy(cache->page_sets_pool);
 	cache->page_sets_pool = NULL;
+
+	if (cache->ghost.map) {
+		ftl_bitmap_destroy(cache->ghost.map);
+		cache->ghost.map = NULL;
+	}
+	free(cache->ghost.map_buf);
+	cache->ghost.map_buf = NULL;
+	free(cache->ghost.ring);
+	cache->ghost.ring = NULL;
 }
 
 static void
@@ -819,6 +1020,9 @@ l2p_shm_restore_clean(struct spdk_ftl_dev *dev)
 
 		page->pin_ref_cnt = 0;
 		page->on_lru_list = 0;
+		page->lru_class = L2P_CACHE_PAGE_PROBATION;
+		page->user_ref = false;
+		page->user_accessed = false;
 		memset(&page->ctx, 0, sizeof(page->ctx));
 
 		ftl_l2p_cache_lru_add_page(cache, page);
@@ -867,6 +1071,9 @@ l2p_shm_restore_dirty(struct spdk_ftl_dev *dev)
 
 		page->pin_ref_cnt = 0;
 		page->on_lru_list = 0;
+		page->lru_class = L2P_CACHE_PAGE_PROBATION;
+		page->user_ref = false;
+		page->user_accessed = false;
 		memset(&page->ctx, 0, sizeof(page->ctx));
 
 		ftl_l2p_cache_lru_add_page(cache, page);
@@ -996,6 +1203,84 @@ ftl_l2p_cache_page_is_pinnable(struct ftl_l2p_page *page)
 	return page->state != L2P_CACHE_PAGE_INIT;
 }
 
+static bool
+ftl_l2p_cache_prefetch_page(struct spdk_ftl_dev *dev, struct ftl_l2p_cache *cache,
+			    uint64_t page_no)
+{
+	struct ftl_l2p_page *page;
+
+	if (get_l2p_page_by_df_id(cache, page_no)) {
+		/* Already resident or being paged in */
+		return true;
+	}
+
+	/* Keep half of the eviction reserve for demand page ins */
+	if (cache->l2_pgs_avail <= cache->evict_keep / 2 ||
+	    cache->ios_in_flight > FTL_L2P_CACHE_MAX_IOS_IN_FLIGHT) {
+		return false;
+	}
+
+	page = page_allocate(cache, page_no);
+	/*
+	 * Nobody pins the page on page in, it's put on the rank list by page_in_io_complete().
+	 * Rank it as a user referenced one, so it isn't evicted before the reader gets to it.
+	 */
+	page->lru_class = L2P_CACHE_PAGE_PROBATION;
+	page->user_ref = true;
+	cache->stats.prefetches++;
+	page_in_io(dev, cache, page);
+
+	return true;
+}
+
+static void
+ftl_l2p_cache_prefetch(struct spdk_ftl_dev *dev, struct ftl_l2p_cache *cache,
+		       uint64_t start, uint64_t end)
+{
+	uint64_t depth = dev->conf.l2p_prefetch_depth;
+	uint64_t page_no, last;
+	uint32_t i;
+
+	if (!depth) {
+		return;
+	}
+
+	for (i = 0; i < FTL_L2P_CACHE_PREFETCH_STREAMS; i++) {
+		if (start == cache->prefetch[i].last_page ||
+		    start == cache->prefetch[i].last_page + 1) {
+			break;
+		}
+	}
+
+	if (i == FTL_L2P_CACHE_PREFETCH_STREAMS) {
+		/* Not a continuation of any known stream, start tracking a new one */
+		i = cache->prefetch_victim;
+		cache->prefetch_victim = (i + 1) % FTL_L2P_CACHE_PREFETCH_STREAMS;
+		cache->prefetch[i].last_page = end;
+		cache->prefetch[i].next_page = end + 1;
+		cache->prefetch[i].seq_pages = 0;
+		return;
+	}
+
+	if (end > cache->prefetch[i].last_page) {
+		cache->prefetch[i].seq_pages += end - cache->prefetch[i].last_page;
+		cache->prefetch[i].last_page = end;
+	}
+
+	if (cache->prefetch[i].seq_pages < FTL_L2P_CACHE_PREFETCH_TRIGGER) {
+		return;
+	}
+
+	last = spdk_min(end + depth, cache->num_pages - 1);
+	page_no = spdk_max(cache->prefetch[i].next_page, end + 1);
+	for (; page_no <= last; page_no++) {
+		if (!ftl_l2p_cache_prefetch_page(dev, cache, page_no)) {
+			break;
+		}
+	}
+	cache->prefetch[i].next_page = page_no;
+}
+
 void
 ftl_l2p_cache_pin(struct spdk_ftl_dev *dev, struct ftl_l2p_pin_ctx *pin_ctx)
 {
@@ -1024,6 +1309,10 @@ ftl_l2p_cache_pin(struct spdk_ftl_dev *dev, struct ftl_l2p_pin_ctx *pin_ctx)
 	}
 	ftl_l2p_cache_init_page_set(page_set, pin_ctx);
 
+	if (!pin_ctx->internal) {
+		ftl_l2p_cache_prefetch(dev, cache, start, end);
+	}
+
 	struct ftl_l2p_page_wait_ctx *entry = page_set->entry;
 	for (i = start; i <= end; i++, entry++) {
 		struct ftl_l2p_page *page;
@@ -1037,12 +1326,13 @@ ftl_l2p_cache_pin(struct spdk_ftl_dev *dev, struct ftl_l2p_pin_ctx *pin_ctx)
 		/* Try get page and pin */
 		page = get_l2p_page_by_df_id(cache, i);
 		if (page) {
+			cache->stats.hits++;
 			if (ftl_l2p_cache_page_is_pinnable(page)) {
 				/* Page available and we can pin it */
 				page_set->pinned_cnt++;
 				entry->pg_pin_issued = true;
 				entry->pg_pin_completed = true;
-				ftl_l2p_cache_page_pin(cache, page);
+				ftl_l2p_cache_page_pin(cache, page, pin_ctx);
 			} else {
 				/* The page is being loaded */
 				/* Queue the page pin entry to be executed on page in */
@@ -1051,6 +1341,7 @@ ftl_l2p_cache_pin(struct spdk_ftl_dev *dev, struct ftl_l2p_pin_ctx *pin_ctx)
 			}
 		} else {
 			/* The page is not in the cache, queue the page_set to page in */
+			cache->stats.misses++;
 			defer_pin = true;
 		}
 	}
@@ -1102,7 +1393,6 @@ ftl_l2p_cache_get(struct spdk_ftl_dev *dev, uint64_t lba)
 		ftl_bitmap_clear(dev->trim_map, page->page_no);
 	}
 
-	ftl_l2p_cache_lru_promote_page(cache, page);
 	addr = ftl_l2p_cache_get_addr(dev, cache, page, lba);
 
 	return addr;
@@ -1125,7 +1415,6 @@ ftl_l2p_cache_set(struct spdk_ftl_dev *dev, uint64_t lba, ftl_addr addr)
 	}
 
 	page->updates++;
-	ftl_l2p_cache_lru_promote_page(cache, page);
 	ftl_l2p_cache_set_addr(dev, cache, page, lba, addr);
 }
 
@@ -1213,7 +1502,7 @@ page_in_io_complete(struct spdk_ftl_dev *dev, struct ftl_l2p_cache *cache,
 		assert(false == pentry->pg_pin_completed);
 
 		if (success) {
-			ftl_l2p_cache_page_pin(cache, page);
+			ftl_l2p_cache_page_pin(cache, page, page_set->pin_ctx);
 			page_set->pinned_cnt++;
 			pentry->pg_pin_completed = true;
 		} else {
@@ -1229,6 +1518,9 @@ page_in_io_complete(struct spdk_ftl_dev *dev, struct ftl_l2p_cache *cache,
 	if (spdk_unlikely(!success)) {
 		ftl_bug(page->on_lru_list);
 		ftl_l2p_cache_page_remove(cache, page);
+	} else if (!page->pin_ref_cnt && !page->on_lru_list) {
+		/* Prefetched page nobody waited for, or all pins were already released */
+		ftl_l2p_cache_lru_add_page(cache, page);
 	}
 }
 
@@ -1300,11 +1592,12 @@ page_in(struct spdk_ftl_dev *dev, struct ftl_l2p_cache *cache,
 	if (!page) {
 		/* Page not allocated yet, do it */
 		page = page_allocate(cache, pentry->pg_no);
+		ftl_l2p_cache_page_classify(cache, page, page_set->pin_ctx);
 		page_in = true;
 	}
 
 	if (ftl_l2p_cache_page_is_pinnable(page)) {
-		ftl_l2p_cache_page_pin(cache, page);
+		ftl_l2p_cache_page_pin(cache, page, page_set->pin_ctx);
 		page_set->pinned_cnt++;
 		pentry->pg_pin_issued = true;
 		pentry->pg_pin_completed = true;
@@ -1335,7 +1628,7 @@ ftl_l2p_cache_process_page_sets(struct spdk_ftl_dev *dev, struct ftl_l2p_cache *
 		/* No enough page to pin, wait */
 		return -EBUSY;
 	}
-	if (cache->ios_in_flight > 512) {
+	if (cache->ios_in_flight > FTL_L2P_CACHE_MAX_IOS_IN_FLIGHT) {
 		/* Too big QD */
 		return -EBUSY;
 	}
@@ -1364,6 +1657,18 @@ ftl_l2p_cache_process_page_sets(struct spdk_ftl_dev *dev, struct ftl_l2p_cache *
 	return 0;
 }
 
+static void
+eviction_page_remove(struct ftl_l2p_cache *cache, struct ftl_l2p_page *page)
+{
+	/* Remember pages which were used by user IO, so they're protected when paged in again */
+	if (page->lru_class == L2P_CACHE_PAGE_PROBATION && page->user_accessed) {
+		ftl_l2p_cache_ghost_add(cache, page->page_no);
+	}
+
+	cache->stats.evictions++;
+	ftl_l2p_cache_page_remove(cache, page);
+}
+
 static struct ftl_l2p_page *
 eviction_get_page(struct spdk_ftl_dev *dev, struct ftl_l2p_cache *cache)
 {
@@ -1406,7 +1711,7 @@ page_out_io_complete(struct spdk_ftl_dev *dev, struct ftl_l2p_cache *cache,
 	}
 
 	if (success && ftl_l2p_cache_page_can_remove(page)) {
-		ftl_l2p_cache_page_remove(cache, page);
+		eviction_page_remove(cache, page);
 	} else {
 		if (!page->pin_ref_cnt) {
 			ftl_l2p_cache_lru_add_page(cache, page);
@@ -1500,7 +1805,7 @@ ftl_l2p_cache_process_eviction(struct spdk_ftl_dev *dev, struct ftl_l2p_cache *c
 		page_out_io(dev, cache, page);
 	} else {
 		/* Page clean and we can remove it */
-		ftl_l2p_cache_page_remove(cache, page);
+		eviction_page_remove(cache, page);
 	}
 }
 
@@ -1562,6 +1867,7 @@ ftl_l2p_lazy_trim_process(struct spdk_ftl_dev *dev)
 	pin_ctx->count = 1;
 	pin_ctx->cb = ftl_l2p_lazy_trim_process_cb;
 	pin_ctx->cb_ctx = pin_ctx;
+	pin_ctx->internal = true;
 
 	ftl_l2p_cache_pin(dev, pin_ctx);
 }
@@ -763,7 +763,8 @@ compaction_process_pin_lba(struct ftl_nv_cache_compactor *comp)
 		if (entry->lba == FTL_LBA_INVALID) {
 			ftl_l2p_pin_skip(dev, compaction_process_pin_lba_cb, comp, pin_ctx);
 		} else {
-			ftl_l2p_pin(dev, entry->lba, 1, compaction_process_pin_lba_cb, comp, pin_ctx);
+			ftl_l2p_pin_internal(dev, entry->lba, 1, compaction_process_pin_lba_cb, comp,
+					     pin_ctx);
 		}
 	}
 }
@@ -881,6 +882,62 @@ read_chunk_p2l_map(void *arg)
 	}
 }
 
+static uint64_t
+chunk_valid_blocks(struct ftl_nv_cache_chunk *chunk)
+{
+	struct spdk_ftl_dev *dev = SPDK_CONTAINEROF(chunk->nv_cache, struct spdk_ftl_dev, nv_cache);
+	uint64_t blocks = chunk_user_blocks_written(chunk);
+	ftl_addr start;
+
+	if (!blocks) {
+		return 0;
+	}
+
+	start = ftl_addr_from_nvc_offset(dev, chunk->offset);
+	return ftl_bitmap_count_set_range(dev->valid_map, start, start + blocks - 1);
+}
+
+static struct ftl_nv_cache_chunk *
+select_chunk_for_compaction(struct ftl_nv_cache *nv_cache)
+{
+	struct ftl_nv_cache_chunk *head, *chunk, *best = NULL;
+	uint64_t valid, blocks, best_valid = 0, best_blocks = 0;
+	uint64_t i = 0;
+
+	head = TAILQ_FIRST(&nv_cache->chunk_full_list);
+	if (nv_cache->compaction_head_skips >= FTL_NV_CACHE_COMPACTION_CANDIDATES) {
+		nv_cache->compaction_head_skips = 0;
+		return head;
+	}
+
+	/* Pick the chunk with the lowest valid data ratio, the oldest one wins ties */
+	TAILQ_FOREACH(chunk, &nv_cache->chunk_full_list, entry) {
+		if (i++ == FTL_NV_CACHE_COMPACTION_CANDIDATES) {
+			break;
+		}
+
+		blocks = chunk_user_blocks_written(chunk);
+		valid = chunk_valid_blocks(chunk);
+		if (!best || valid * best_blocks < best_valid * blocks) {
+			best = chunk;
+			best_valid = valid;
+			best_blocks = blocks;
+		}
+
+		if (!best_valid) {
+			break;
+		}
+	}
+
+	if (best == head) {
+		nv_cache->compaction_head_skips = 0;
+	} else {
+		nv_cache->compaction_head_skips++;
+	}
+
+	return best;
+}
+
 static void
 prepare_chunk_for_compaction(struct ftl_nv_cache *nv_cache)
 {
@@ -890,7 +947,7 @@ prepare_chunk_for_compaction(struct ftl_nv_cache *nv_cache)
 		return;
 	}
 
-	chunk = TAILQ_FIRST(&nv_cache->chunk_full_list);
+	chunk = select_chunk_for_compaction(nv_cache);
 	TAILQ_REMOVE(&nv_cache->chunk_full_list, chunk, entry);
 	assert(chunk->md->write_pointer);
 
@@ -1078,6 +1135,35 @@ compaction_process_start(struct ftl_nv_cache_compactor *compactor)
 	}
 }
 
+static uint64_t
+compaction_max_active(struct ftl_nv_cache *nv_cache)
+{
+	uint64_t usable = nv_cache->chunk_count - nv_cache->chunk_inactive_count;
+	uint64_t lo = nv_cache->chunk_compaction_threshold;
+	uint64_t hi, fill = nv_cache->chunk_full_count;
+
+	if (spdk_unlikely(nv_cache->halt)) {
+		return FTL_NV_CACHE_NUM_COMPACTORS;
+	}
+
+	if (nv_cache->chunk_free_count <= nv_cache->chunk_free_target ||
+	    usable <= nv_cache->chunk_free_target) {
+		return FTL_NV_CACHE_NUM_COMPACTORS;
+	}
+
+	hi = usable - nv_cache->chunk_free_target;
+	if (fill >= hi || hi <= lo) {
+		return FTL_NV_CACHE_NUM_COMPACTORS;
+	}
+
+	if (fill <= lo) {
+		return FTL_NV_CACHE_MIN_COMPACTORS;
+	}
+
+	return FTL_NV_CACHE_MIN_COMPACTORS +
+	       (FTL_NV_CACHE_NUM_COMPACTORS - FTL_NV_CACHE_MIN_COMPACTORS) * (fill - lo) / (hi - lo);
+}
+
 static void
 compaction_process(struct ftl_nv_cache *nv_cache)
 {
@@ -1096,6 +1182,10 @@ compaction_process(struct ftl_nv_cache *nv_cache)
 		return;
 	}
 
+	if (nv_cache->compaction_active_count >= compaction_max_active(nv_cache)) {
+		return;
+	}
+
 	compactor = TAILQ_FIRST(&nv_cache->compactor_list);
 	if (!compactor) {
 		return;
@@ -2563,10 +2653,29 @@ static void
 ftl_property_dump_cache_dev(struct spdk_ftl_dev *dev, const struct ftl_property *property,
 			    struct spdk_json_write_ctx *w)
 {
+	struct ftl_nv_cache *nv_cache = &dev->nv_cache;
 	uint64_t i;
 	struct ftl_nv_cache_chunk *chunk;
 
-	spdk_json_write_named_string(w, "type", dev->nv_cache.nvc_type->name);
+	spdk_json_write_named_string(w, "type", nv_cache->nvc_type->name);
+
+	spdk_json_write_named_object_begin(w, "compaction");
+	spdk_json_write_named_uint64(w, "active_compactors", nv_cache->compaction_active_count);
+	spdk_json_write_named_uint64(w, "max_active_compactors", compaction_max_active(nv_cache));
+	spdk_json_write_named_uint64(w, "full_chunks", nv_cache->chunk_full_count);
+	spdk_json_write_named_uint64(w, "free_chunks", nv_cache->chunk_free_count);
+	spdk_json_write_named_array_begin(w, "chunks");
+	TAILQ_FOREACH(chunk, &nv_cache->chunk_comp_list, entry) {
+		spdk_json_write_object_begin(w);
+		spdk_json_write_named_uint64(w, "id", get_chunk_idx(chunk));
+		spdk_json_write_named_uint64(w, "blocks_compacted", chunk->md->blocks_compacted);
+		spdk_json_write_named_uint64(w, "blocks_to_compact", chunk_user_blocks_written(chunk));
+		spdk_json_write_named_uint64(w, "valid_blocks", chunk_valid_blocks(chunk));
+		spdk_json_write_object_end(w);
+	}
+	spdk_json_write_array_end(w);
+	spdk_json_write_object_end(w);
+
 	spdk_json_write_named_array_begin(w, "chunks");
 	for (i = 0, chunk = dev->nv_cache.chunks; i < dev->nv_cache.chunk_count; i++, chunk++) {
 		spdk_json_write_object_begin(w);
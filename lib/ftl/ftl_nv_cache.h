@@ -32,6 +32,19 @@
 
 #define FTL_NV_CACHE_NUM_COMPACTORS 8
 
+/*
+ * Number of compactors allowed to run when compaction has just been triggered. The limit grows
+ * linearly up to FTL_NV_CACHE_NUM_COMPACTORS as the cache fills up to its free chunk target.
+ */
+#define FTL_NV_CACHE_MIN_COMPACTORS 2
+
+/*
+ * Number of the oldest full chunks considered when picking the next chunk to compact. The one with
+ * the least valid data is picked. The oldest chunk is taken unconditionally after being passed
+ * over this many times, so it can't be starved.
+ */
+#define FTL_NV_CACHE_COMPACTION_CANDIDATES 8
+
 /*
  * Parameters controlling nv cache write throttling.
  *
@@ -212,6 +225,9 @@ struct ftl_nv_cache {
 	uint64_t compaction_active_count;
 	uint64_t chunk_compaction_threshold;
 
+	/* Number of times the oldest full chunk was passed over for compaction */
+	uint64_t compaction_head_skips;
+
 	struct ftl_nv_cache_chunk *chunks;
 
 	uint64_t last_seq_id;
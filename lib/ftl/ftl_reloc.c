@@ -490,7 +490,8 @@ move_pin(struct ftl_reloc_move *mv)
 
 	for (i = 0; i < rq->num_blocks; i++) {
 		if (entry->lba != FTL_LBA_INVALID) {
-			ftl_l2p_pin(rq->dev, entry->lba, 1, move_pin_cb, mv, &entry->l2p_pin_ctx);
+			ftl_l2p_pin_internal(rq->dev, entry->lba, 1, move_pin_cb, mv,
+					     &entry->l2p_pin_ctx);
 		} else {
 			ftl_l2p_pin_skip(rq->dev, move_pin_cb, mv, &entry->l2p_pin_ctx);
 		}
@@ -541,6 +542,34 @@ move_write_cb(struct ftl_rq *rq)
 	}
 }
 
+static bool
+move_rq_is_cold(struct ftl_rq *rq)
+{
+	struct ftl_rq_entry *iter = rq->entries;
+	struct ftl_band *band;
+	uint64_t i, num_valid = 0, num_cold = 0;
+
+	/*
+	 * Data read from a band written by the GC writer has already survived at least one
+	 * relocation, so it's likely to stay valid for a long time. Keep it apart from data
+	 * relocated for the first time (read from bands written by compaction).
+	 */
+	for (i = 0; i < rq->num_blocks; ++i, ++iter) {
+		band = iter->owner.priv;
+
+		if (!band || iter->lba == FTL_LBA_INVALID) {
+			continue;
+		}
+
+		num_valid++;
+		if (band->md->type == FTL_BAND_TYPE_GC) {
+			num_cold++;
+		}
+	}
+
+	return num_cold * 2 > num_valid;
+}
+
 static void
 move_write(struct ftl_reloc *reloc, struct ftl_reloc_move *mv)
 {
@@ -549,6 +578,8 @@ move_write(struct ftl_reloc *reloc, struct ftl_reloc_move *mv)
 
 	assert(rq->iter.idx == rq->num_blocks);
 
+	rq->owner.cold = move_rq_is_cold(rq);
+
 	/* Request contains data to be placed on a new location, submit it */
 	ftl_writer_queue_rq(&dev->writer_gc, rq);
 	rq->iter.qd++;
@@ -15,6 +15,7 @@ ftl_writer_init(struct spdk_ftl_dev *dev, struct ftl_writer *writer,
 	memset(writer, 0, sizeof(*writer));
 	writer->dev = dev;
 	TAILQ_INIT(&writer->rq_queue);
+	TAILQ_INIT(&writer->cold_rq_queue);
 	TAILQ_INIT(&writer->full_bands);
 	writer->limit = limit;
 	writer->halt = true;
@@ -22,13 +23,13 @@ ftl_writer_init(struct spdk_ftl_dev *dev, struct ftl_writer *writer,
 }
 
 static bool
-can_write(struct ftl_writer *writer)
+can_write(struct ftl_writer *writer, struct ftl_band *band)
 {
 	if (spdk_unlikely(writer->halt)) {
 		return false;
 	}
 
-	return writer->band->md->state == FTL_BAND_STATE_OPEN;
+	return band->md->state == FTL_BAND_STATE_OPEN;
 }
 
 void
@@ -38,9 +39,13 @@ ftl_writer_band_state_change(struct ftl_band *band)
 
 	switch (band->md->state) {
 	case FTL_BAND_STATE_FULL:
-		assert(writer->band == band);
 		TAILQ_INSERT_TAIL(&writer->full_bands, band, queue_entry);
-		writer->band = NULL;
+		if (writer->band == band) {
+			writer->band = NULL;
+		} else {
+			assert(writer->cold_band == band);
+			writer->cold_band = NULL;
+		}
 		break;
 
 	case FTL_BAND_STATE_CLOSED:
@@ -81,19 +86,19 @@ is_active(struct ftl_writer *writer)
 }
 
 static struct ftl_band *
-get_band(struct ftl_writer *writer)
+get_band(struct ftl_writer *writer, struct ftl_band **slot)
 {
-	if (spdk_unlikely(!writer->band)) {
+	if (spdk_unlikely(!*slot)) {
 		if (!is_active(writer)) {
 			return NULL;
 		}
 
 		if (spdk_unlikely(NULL != writer->next_band)) {
 			if (FTL_BAND_STATE_OPEN == writer->next_band->md->state) {
-				writer->band = writer->next_band;
+				*slot = writer->next_band;
 				writer->next_band = NULL;
 
-				return writer->band;
+				return *slot;
 			} else {
 				assert(FTL_BAND_STATE_OPEN == writer->next_band->md->state);
 				ftl_abort();
@@ -107,13 +112,12 @@ get_band(struct ftl_writer *writer)
 			return NULL;
 		}
 
-		writer->band = ftl_band_get_next_free(writer->dev);
-		if (writer->band) {
+		*slot = ftl_band_get_next_free(writer->dev);
+		if (*slot) {
 			writer->num_bands++;
-			ftl_band_set_owner(writer->band,
-					   ftl_writer_band_state_change, writer);
+			ftl_band_set_owner(*slot, ftl_writer_band_state_change, writer);
 
-			if (ftl_band_write_prep(writer->band)) {
+			if (ftl_band_write_prep(*slot)) {
 				/*
 				 * This error might happen due to allocation failure. However number
 				 * of open bands is controlled and it should have enough resources
@@ -127,39 +131,57 @@ get_band(struct ftl_writer *writer)
 		}
 	}
 
-	if (spdk_likely(writer->band->md->state == FTL_BAND_STATE_OPEN)) {
-		return writer->band;
+	if (spdk_likely((*slot)->md->state == FTL_BAND_STATE_OPEN)) {
+		return *slot;
 	} else {
-		if (spdk_unlikely(writer->band->md->state == FTL_BAND_STATE_PREP)) {
-			ftl_band_open(writer->band, writer->writer_type);
+		if (spdk_unlikely((*slot)->md->state == FTL_BAND_STATE_PREP)) {
+			ftl_band_open(*slot, writer->writer_type);
 		}
 		return NULL;
 	}
 }
 
-void
-ftl_writer_run(struct ftl_writer *writer)
+static void
+writer_run_queue(struct ftl_writer *writer, struct ftl_rq_queue *queue, struct ftl_band **slot,
+		 struct ftl_band *fallback)
 {
 	struct ftl_band *band;
 	struct ftl_rq *rq;
 
-	close_full_bands(writer);
+	if (TAILQ_EMPTY(queue)) {
+		return;
+	}
 
-	if (!TAILQ_EMPTY(&writer->rq_queue)) {
-		band = get_band(writer);
-		if (spdk_unlikely(!band)) {
+	band = get_band(writer, slot);
+	if (spdk_unlikely(!band)) {
+		if (*slot || !fallback) {
+			/* The band is still being opened */
 			return;
 		}
 
-		if (!can_write(writer)) {
-			return;
-		}
+		/* No band can be opened for this class at the moment (e.g. the other one is
+		 * still closing). Don't stall the writer, share the band of the other class.
+		 */
+		band = fallback;
+	}
 
-		/* Finally we can write to band */
-		rq = TAILQ_FIRST(&writer->rq_queue);
-		TAILQ_REMOVE(&writer->rq_queue, rq, qentry);
-		ftl_band_rq_write(writer->band, rq);
+	if (!can_write(writer, band)) {
+		return;
 	}
+
+	/* Finally we can write to band */
+	rq = TAILQ_FIRST(queue);
+	TAILQ_REMOVE(queue, rq, qentry);
+	ftl_band_rq_write(band, rq);
+}
+
+void
+ftl_writer_run(struct ftl_writer *writer)
+{
+	close_full_bands(writer);
+
+	writer_run_queue(writer, &writer->rq_queue, &writer->band, writer->cold_band);
+	writer_run_queue(writer, &writer->cold_rq_queue, &writer->cold_band, writer->band);
 }
 
 static void
@@ -173,10 +195,11 @@ static void
 ftl_writer_pad_band(struct ftl_writer *writer)
 {
 	struct spdk_ftl_dev *dev = writer->dev;
+	struct ftl_band *band = writer->band ? writer->band : writer->cold_band;
 
 	assert(dev->conf.prep_upgrade_on_shutdown);
-	assert(writer->band);
-	assert(0 == writer->band->queue_depth);
+	assert(band);
+	assert(0 == band->queue_depth);
 
 	/* First allocate the padding FTL request */
 	if (!writer->pad) {
@@ -193,12 +216,28 @@ ftl_writer_pad_band(struct ftl_writer *writer)
 		return;
 	}
 
-	if (writer->band->md->state == FTL_BAND_STATE_OPEN) {
-		ftl_band_rq_write(writer->band, writer->pad);
+	if (band->md->state == FTL_BAND_STATE_OPEN) {
+		ftl_band_rq_write(band, writer->pad);
 		writer->pad->iter.qd++;
 	}
 }
 
+static bool
+writer_band_is_idle(struct ftl_band *band)
+{
+	if (band) {
+		if (band->md->state != FTL_BAND_STATE_OPEN) {
+			return false;
+		}
+
+		if (band->queue_depth) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
 bool
 ftl_writer_is_halted(struct ftl_writer *writer)
 {
@@ -206,18 +245,12 @@ ftl_writer_is_halted(struct ftl_writer *writer)
 		return false;
 	}
 
-	if (writer->band) {
-		if (writer->band->md->state != FTL_BAND_STATE_OPEN) {
-			return false;
-		}
-
-		if (writer->band->queue_depth) {
-			return false;
-		}
+	if (!writer_band_is_idle(writer->band) || !writer_band_is_idle(writer->cold_band)) {
+		return false;
 	}
 
 	if (writer->dev->conf.prep_upgrade_on_shutdown) {
-		if (writer->band) {
+		if (writer->band || writer->cold_band) {
 			ftl_writer_pad_band(writer);
 		} else if (writer->num_bands) {
 			return false;
@@ -246,5 +279,10 @@ ftl_writer_get_free_blocks(struct ftl_writer *writer)
 				writer->next_band->md->iter.offset);
 	}
 
+	if (writer->cold_band) {
+		free_blocks += ftl_band_user_blocks_left(writer->cold_band,
+				writer->cold_band->md->iter.offset);
+	}
+
 	return free_blocks;
 }
@@ -14,7 +14,7 @@
 struct ftl_writer {
 	struct spdk_ftl_dev *dev;
 
-	TAILQ_HEAD(, ftl_rq) rq_queue;
+	TAILQ_HEAD(ftl_rq_queue, ftl_rq) rq_queue;
 
 	/* Band currently being written to */
 	struct ftl_band	*band;
@@ -25,6 +25,14 @@ struct ftl_writer {
 	/* Band next being written to */
 	struct ftl_band *next_band;
 
+	/* Band receiving cold requests, so that data which keeps surviving relocation
+	 * doesn't share bands with data which is likely to be invalidated soon
+	 */
+	struct ftl_band *cold_band;
+
+	/* Queue of cold requests */
+	struct ftl_rq_queue cold_rq_queue;
+
 	/* List of full bands */
 	TAILQ_HEAD(, ftl_band) full_bands;
 
@@ -71,7 +79,11 @@ void ftl_writer_run(struct ftl_writer *writer);
 static inline void
 ftl_writer_queue_rq(struct ftl_writer *writer, struct ftl_rq *rq)
 {
-	TAILQ_INSERT_TAIL(&writer->rq_queue, rq, qentry);
+	if (rq->owner.cold) {
+		TAILQ_INSERT_TAIL(&writer->cold_rq_queue, rq, qentry);
+	} else {
+		TAILQ_INSERT_TAIL(&writer->rq_queue, rq, qentry);
+	}
 }
 
 /**
@@ -103,6 +103,7 @@ ftl_dev_init_bands_md(struct spdk_ftl_dev *dev)
 static void
 ftl_dev_deinit_bands(struct spdk_ftl_dev *dev)
 {
+	ftl_band_gc_index_deinit(dev);
 	free(dev->bands);
 }
 
@@ -162,7 +163,7 @@ ftl_mngt_deinit_bands_md(struct spdk_ftl_dev *dev, struct ftl_mngt_process *mngt
  */
 #define BASE_BDEV_RECLAIM_UNIT_SIZE (72 * GiB)
 
-static void
+static int
 decorate_bands(struct spdk_ftl_dev *dev)
 {
 	struct ftl_band *band;
@@ -205,13 +206,18 @@ decorate_bands(struct spdk_ftl_dev *dev)
 	}
 
 	dev->num_logical_bands_in_physical = num_logical_in_phys;
+
+	return ftl_band_gc_index_init(dev, phys_id);
 }
 
 void
 ftl_mngt_decorate_bands(struct spdk_ftl_dev *dev, struct ftl_mngt_process *mngt)
 {
-	decorate_bands(dev);
-	ftl_mngt_next_step(mngt);
+	if (decorate_bands(dev)) {
+		ftl_mngt_fail_step(mngt);
+	} else {
+		ftl_mngt_next_step(mngt);
+	}
 }
 
 void
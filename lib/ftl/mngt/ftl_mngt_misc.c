@@ -175,6 +175,33 @@ ftl_mngt_scrub_nv_cache(struct spdk_ftl_dev *dev, struct ftl_mngt_process *mngt)
 	}
 }
 
+static void
+ftl_property_dump_gc_policy(struct spdk_ftl_dev *dev, const struct ftl_property *property,
+			    struct spdk_json_write_ctx *w)
+{
+	spdk_json_write_named_string(w, "value",
+				     dev->conf.gc_policy == SPDK_FTL_GC_POLICY_COST_BENEFIT ?
+				     "cost_benefit" : "greedy");
+}
+
+static void
+ftl_property_dump_write_amplification(struct spdk_ftl_dev *dev,
+				      const struct ftl_property *property,
+				      struct spdk_json_write_ctx *w)
+{
+	uint64_t write_user, write_gc, write_md;
+
+	write_user = dev->stats.entries[FTL_STATS_TYPE_CMP].write.blocks;
+	write_gc = dev->stats.entries[FTL_STATS_TYPE_GC].write.blocks;
+	write_md = dev->stats.entries[FTL_STATS_TYPE_MD_BASE].write.blocks;
+
+	spdk_json_write_named_uint64(w, "user_blocks", write_user);
+	spdk_json_write_named_uint64(w, "gc_blocks", write_gc);
+	spdk_json_write_named_uint64(w, "md_blocks", write_md);
+	spdk_json_write_named_double(w, "value", write_user ?
+				     (double)(write_user + write_gc + write_md) / write_user : 0.0);
+}
+
 void
 ftl_mngt_finalize_startup(struct spdk_ftl_dev *dev, struct ftl_mngt_process *mngt)
 {
@@ -186,6 +213,14 @@ ftl_mngt_finalize_startup(struct spdk_ftl_dev *dev, struct ftl_mngt_process *mng
 			      sizeof(dev->sb->header.version), NULL, NULL,
 			      ftl_property_dump_uint64, NULL, NULL, false);
 
+	ftl_property_register(dev, "gc_policy", NULL, 0, NULL, "Policy used to select bands for garbage collection",
+			      ftl_property_dump_gc_policy, NULL, NULL, false);
+
+	ftl_property_register(dev, "write_amplification", NULL, 0, NULL,
+			      "Blocks written to the base device by compaction (user data), GC and "
+			      "metadata, and the resulting write amplification factor",
+			      ftl_property_dump_write_amplification, NULL, NULL, false);
+
 	/* Clear the limit applications as they're incremented incorrectly by
 	 * the initialization code.
 	 */
@@ -148,8 +148,8 @@ ftl_mngt_test_valid_map(struct spdk_ftl_dev *dev, struct ftl_mngt_process *mngt)
 	pin_ctx->count = spdk_min(left, 4096);
 
 	if (pin_ctx->count) {
-		ftl_l2p_pin(dev, pin_ctx->lba, pin_ctx->count,
-			    test_valid_map_pin_cb, mngt, pin_ctx);
+		ftl_l2p_pin_internal(dev, pin_ctx->lba, pin_ctx->count,
+				     test_valid_map_pin_cb, mngt, pin_ctx);
 	} else {
 		if (!ctx->status) {
 			uint64_t valid = ctx->valid_map.base_valid_count +
@@ -184,3 +184,28 @@ ftl_bitmap_count_set(struct ftl_bitmap *bitmap)
 
 	return count;
 }
+
+uint64_t
+ftl_bitmap_count_set_range(struct ftl_bitmap *bitmap, uint64_t start_bit, uint64_t end_bit)
+{
+	bitmap_word word;
+	size_t i, end;
+	uint64_t count = 0;
+
+	assert(start_bit <= end_bit);
+
+	i = start_bit >> FTL_BITMAP_WORD_SHIFT;
+	end = end_bit >> FTL_BITMAP_WORD_SHIFT;
+	assert(end < bitmap->size);
+
+	word = bitmap->buf[i] & (~0UL << (start_bit & FTL_BITMAP_WORD_MASK));
+	while (i < end) {
+		count += __builtin_popcountl(word);
+		word = bitmap->buf[++i];
+	}
+
+	word &= ~0UL >> (FTL_BITMAP_WORD_MASK - (end_bit & FTL_BITMAP_WORD_MASK));
+	count += __builtin_popcountl(word);
+
+	return count;
+}
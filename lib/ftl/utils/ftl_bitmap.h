@@ -108,4 +108,16 @@ uint64_t ftl_bitmap_find_first_clear(struct ftl_bitmap *bitmap, uint64_t start_b
  */
 uint64_t ftl_bitmap_count_set(struct ftl_bitmap *bitmap);
 
+/**
+ * @brief Counts set bits in a range
+ *
+ * @param bitmap The bitmap
+ * @param start_bit Index of the first bit to count
+ * @param end_bit Index of the last bit to count
+ *
+ * @return Count of set bits in the range
+ */
+uint64_t ftl_bitmap_count_set_range(struct ftl_bitmap *bitmap, uint64_t start_bit,
+				    uint64_t end_bit);
+
 #endif /* FTL_BITMAP_H_ */
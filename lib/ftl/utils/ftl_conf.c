@@ -22,6 +22,8 @@ static const struct spdk_ftl_conf g_default_conf = {
 	.overprovisioning = 20,
 	/* 2GiB of DRAM for l2p cache */
 	.l2p_dram_limit = 2048,
+	/* Page in up to 8 L2P pages ahead of sequential user IO */
+	.l2p_prefetch_depth = 8,
 	/* IO pool size per user thread (this should be adjusted to thread IO qdepth) */
 	.user_io_pool_size = 2048,
 	.nv_cache = {
@@ -176,5 +178,13 @@ ftl_conf_is_valid(const struct spdk_ftl_conf *conf)
 		return false;
 	}
 
+	if (conf->gc_policy > SPDK_FTL_GC_POLICY_COST_BENEFIT) {
+		return false;
+	}
+
+	if (conf->l2p_prefetch_depth > FTL_L2P_PREFETCH_DEPTH_MAX) {
+		return false;
+	}
+
 	return true;
 }
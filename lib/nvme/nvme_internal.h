@@ -541,6 +541,8 @@ struct spdk_nvme_poll_group {
 	bool						enable_interrupts_is_valid;
 	int						disconnect_qpair_fd;
 	struct spdk_fd_group				*fgrp;
+	uint64_t					hybrid_spin_ticks;
+	uint32_t					completion_budget;
 	struct {
 		spdk_nvme_poll_group_interrupt_cb	cb_fn;
 		void					*cb_ctx;
@@ -1742,6 +1744,8 @@ int nvme_transport_poll_group_get_stats(struct spdk_nvme_transport_poll_group *t
 					struct spdk_nvme_transport_poll_group_stat **stats);
 void nvme_transport_poll_group_free_stats(struct spdk_nvme_transport_poll_group *tgroup,
 		struct spdk_nvme_transport_poll_group_stat *stats);
+uint64_t nvme_transport_poll_group_get_next_completion(
+	struct spdk_nvme_transport_poll_group *tgroup);
 enum spdk_nvme_transport_type nvme_transport_get_trtype(const struct spdk_nvme_transport
 		*transport);
 /*
@@ -1156,6 +1156,7 @@ const struct spdk_nvme_transport_ops pcie_ops = {
 	.poll_group_process_completions = nvme_pcie_poll_group_process_completions,
 	.poll_group_check_disconnected_qpairs = nvme_pcie_poll_group_check_disconnected_qpairs,
 	.poll_group_destroy = nvme_pcie_poll_group_destroy,
+	.poll_group_get_next_completion = nvme_pcie_poll_group_get_next_completion,
 	.poll_group_get_stats = nvme_pcie_poll_group_get_stats,
 	.poll_group_free_stats = nvme_pcie_poll_group_free_stats
 };
@@ -698,6 +698,9 @@ nvme_pcie_qpair_submit_tracker(struct spdk_nvme_qpair *qpair, struct nvme_tracke
 
 	if (!pqpair->flags.delay_cmd_submit) {
 		nvme_pcie_qpair_ring_sq_doorbell(qpair);
+	} else if (nvme_pcie_qpair_sq_batch_full(pqpair)) {
+		nvme_pcie_qpair_ring_sq_doorbell(qpair);
+		pqpair->last_sq_tail = pqpair->sq_tail;
 	}
 }
 
@@ -872,6 +875,7 @@ nvme_pcie_qpair_process_completions(struct spdk_nvme_qpair *qpair, uint32_t max_
 	uint16_t		 next_cq_head;
 	uint8_t			 next_phase;
 	bool			 next_is_valid = false;
+	uint64_t		 now = 0;
 	int			 rc;
 
 	if (spdk_unlikely(pqpair->pcie_state == NVME_PCIE_QPAIR_FAILED)) {
@@ -918,6 +922,10 @@ nvme_pcie_qpair_process_completions(struct spdk_nvme_qpair *qpair, uint32_t max_
 
 	pqpair->stat->polls++;
 
+	if (spdk_unlikely(pqpair->flags.track_latency)) {
+		now = spdk_get_ticks();
+	}
+
 	while (1) {
 		cpl = &pqpair->cpl[pqpair->cq_head];
 
@@ -962,6 +970,9 @@ nvme_pcie_qpair_process_completions(struct spdk_nvme_qpair *qpair, uint32_t max_
 			 * as part of putting the req back on the qpair's free list.
 			 */
 			__builtin_prefetch(&tr->req->stailq);
+			if (spdk_unlikely(pqpair->flags.track_latency)) {
+				nvme_pcie_qpair_update_latency(pqpair, tr->req, now);
+			}
 			nvme_pcie_qpair_complete_tracker(qpair, tr, cpl, true);
 		} else {
 			SPDK_ERRLOG("cpl does not map to outstanding cmd\n");
@@ -1087,6 +1098,7 @@ nvme_pcie_ctrlr_create_io_qpair(struct spdk_nvme_ctrlr *ctrlr, uint16_t qid,
 
 	pqpair->num_entries = opts->io_queue_size;
 	pqpair->flags.delay_cmd_submit = opts->delay_cmd_submit;
+	pqpair->flags.track_latency = ctrlr->opts.enable_interrupts;
 
 	qpair = &pqpair->qpair;
 
@@ -1692,7 +1704,13 @@ nvme_pcie_qpair_submit_request(struct spdk_nvme_qpair *qpair, struct nvme_reques
 	TAILQ_REMOVE(&pqpair->free_tr, tr, tq_list); /* remove tr from free_tr */
 	TAILQ_INSERT_TAIL(&pqpair->outstanding_tr, tr, tq_list);
 	pqpair->qpair.queue_depth++;
+	if (spdk_unlikely(!pqpair->flags.active && qpair->poll_group != NULL)) {
+		nvme_pcie_poll_group_activate_qpair(pqpair);
+	}
 	tr->req = req;
+	if (spdk_unlikely(pqpair->flags.track_latency) && req->submit_tick == 0) {
+		req->submit_tick = spdk_get_ticks();
+	}
 	tr->cb_fn = req->cb_fn;
 	tr->cb_arg = req->cb_arg;
 	req->cmd.cid = tr->cid;
@@ -1760,18 +1778,83 @@ nvme_pcie_poll_group_create(void)
 		return NULL;
 	}
 
+	TAILQ_INIT(&group->active_qpairs);
+
 	return &group->group;
 }
 
+static inline struct nvme_pcie_poll_group *
+nvme_pcie_poll_group(struct spdk_nvme_transport_poll_group *tgroup)
+{
+	return SPDK_CONTAINEROF(tgroup, struct nvme_pcie_poll_group, group);
+}
+
+static bool
+nvme_pcie_qpair_is_idle(struct nvme_pcie_qpair *pqpair)
+{
+	struct spdk_nvme_qpair *qpair = &pqpair->qpair;
+
+	return TAILQ_EMPTY(&pqpair->outstanding_tr) &&
+	       STAILQ_EMPTY(&qpair->queued_req) &&
+	       STAILQ_EMPTY(&qpair->err_req_head) &&
+	       STAILQ_EMPTY(&qpair->aborting_queued_req) &&
+	       nvme_qpair_get_state(qpair) == NVME_QPAIR_ENABLED &&
+	       pqpair->pcie_state == NVME_PCIE_QPAIR_READY &&
+	       !qpair->ctrlr->is_failed;
+}
+
+void
+nvme_pcie_poll_group_activate_qpair(struct nvme_pcie_qpair *pqpair)
+{
+	struct spdk_nvme_transport_poll_group *tgroup = pqpair->qpair.poll_group;
+	struct nvme_pcie_poll_group *pgroup = nvme_pcie_poll_group(tgroup);
+
+	/* Only connected qpairs are polled by the poll group. */
+	if (pqpair->flags.active ||
+	    pqpair->qpair.poll_group_tailq_head != &tgroup->connected_qpairs) {
+		return;
+	}
+
+	pqpair->flags.active = 1;
+	TAILQ_INSERT_TAIL(&pgroup->active_qpairs, pqpair, active_link);
+	pgroup->num_active_qpairs++;
+}
+
+static void
+nvme_pcie_poll_group_deactivate_qpair(struct nvme_pcie_poll_group *pgroup,
+				      struct nvme_pcie_qpair *pqpair)
+{
+	if (!pqpair->flags.active) {
+		return;
+	}
+
+	if (pgroup->next_qpair == pqpair) {
+		pgroup->next_qpair = TAILQ_NEXT(pqpair, active_link);
+	}
+
+	pqpair->flags.active = 0;
+	TAILQ_REMOVE(&pgroup->active_qpairs, pqpair, active_link);
+	assert(pgroup->num_active_qpairs > 0);
+	pgroup->num_active_qpairs--;
+}
+
 int
 nvme_pcie_poll_group_connect_qpair(struct spdk_nvme_qpair *qpair)
 {
+	/* Called before the qpair is moved to connected_qpairs. It is activated by the next
+	 * scan of the poll group, or by the next submission.
+	 */
+	nvme_pcie_poll_group(qpair->poll_group)->polls_since_scan = NVME_PCIE_POLL_GROUP_SCAN_POLLS;
+
 	return 0;
 }
 
 int
 nvme_pcie_poll_group_disconnect_qpair(struct spdk_nvme_qpair *qpair)
 {
+	nvme_pcie_poll_group_deactivate_qpair(nvme_pcie_poll_group(qpair->poll_group),
+					      nvme_pcie_qpair(qpair));
+
 	return 0;
 }
 
@@ -1788,31 +1871,148 @@ nvme_pcie_poll_group_remove(struct spdk_nvme_transport_poll_group *tgroup,
 {
 	struct nvme_pcie_qpair *pqpair = nvme_pcie_qpair(qpair);
 
+	nvme_pcie_poll_group_deactivate_qpair(nvme_pcie_poll_group(tgroup), pqpair);
+
 	pqpair->stat = &g_dummy_stat;
 	return 0;
 }
 
+static void
+nvme_pcie_poll_group_scan(struct nvme_pcie_poll_group *pgroup)
+{
+	struct spdk_nvme_qpair *qpair;
+	struct nvme_pcie_qpair *pqpair;
+
+	pgroup->polls_since_scan = 0;
+
+	STAILQ_FOREACH(qpair, &pgroup->group.connected_qpairs, poll_group_stailq) {
+		pqpair = nvme_pcie_qpair(qpair);
+		if (!pqpair->flags.active && !nvme_pcie_qpair_is_idle(pqpair)) {
+			nvme_pcie_poll_group_activate_qpair(pqpair);
+		}
+	}
+}
+
+/*
+ * Poll the active qpairs once, starting where the previous round stopped. Each qpair may reap up
+ * to quantum completions, but no more than what is left of the budget.
+ */
+static int64_t
+nvme_pcie_poll_group_round(struct nvme_pcie_poll_group *pgroup, uint32_t quantum,
+			   uint32_t *budget, bool *has_more,
+			   spdk_nvme_disconnected_qpair_cb disconnected_qpair_cb)
+{
+	struct spdk_nvme_qpair *qpair;
+	struct nvme_pcie_qpair *pqpair;
+	uint32_t max_completions, num_qpairs;
+	int32_t local_completions;
+	int64_t total_completions = 0;
+
+	if (pgroup->next_qpair == NULL) {
+		pgroup->next_qpair = TAILQ_FIRST(&pgroup->active_qpairs);
+	}
+
+	num_qpairs = pgroup->num_active_qpairs;
+	while (num_qpairs-- > 0 && pgroup->next_qpair != NULL) {
+		pqpair = pgroup->next_qpair;
+		pgroup->next_qpair = TAILQ_NEXT(pqpair, active_link);
+		if (pgroup->next_qpair == NULL) {
+			pgroup->next_qpair = TAILQ_FIRST(&pgroup->active_qpairs);
+		}
+
+		if (nvme_pcie_qpair_is_idle(pqpair)) {
+			nvme_pcie_poll_group_deactivate_qpair(pgroup, pqpair);
+			continue;
+		}
+
+		max_completions = quantum;
+		if (*budget != 0) {
+			max_completions = spdk_min(max_completions, *budget);
+		}
+
+		/* The qpair may be disconnected, or even freed, while its completions are
+		 * processed. Don't touch it after this call.
+		 */
+		qpair = &pqpair->qpair;
+		local_completions = spdk_nvme_qpair_process_completions(qpair, max_completions);
+		if (spdk_unlikely(local_completions < 0)) {
+			disconnected_qpair_cb(qpair, pgroup->group.group->ctx);
+			total_completions = -ENXIO;
+			continue;
+		}
+
+		if (spdk_likely(total_completions >= 0)) {
+			total_completions += local_completions;
+		}
+
+		if (*budget != 0) {
+			if ((uint32_t)local_completions >= max_completions) {
+				*has_more = true;
+			}
+			*budget -= spdk_min((uint32_t)local_completions, *budget);
+			if (*budget == 0) {
+				break;
+			}
+		}
+	}
+
+	return total_completions;
+}
+
+/*
+ * Only the active qpairs are polled. A qpair becomes active when a command is submitted to it,
+ * and inactive when it is found idle. All connected qpairs are scanned periodically so that
+ * failures and state changes of idle qpairs are still noticed.
+ *
+ * If the poll group has a completion budget, it is shared by round robin with a fixed quantum:
+ * each round, every active qpair may process up to an equal share of the remaining budget.
+ * The share left unused by qpairs with fewer completions isn't carried over for them, it is
+ * handed out in further rounds instead. When the budget runs out, the next poll continues the
+ * round where this one stopped.
+ */
 int64_t
 nvme_pcie_poll_group_process_completions(struct spdk_nvme_transport_poll_group *tgroup,
 		uint32_t completions_per_qpair, spdk_nvme_disconnected_qpair_cb disconnected_qpair_cb)
 {
+	struct nvme_pcie_poll_group *pgroup = nvme_pcie_poll_group(tgroup);
 	struct spdk_nvme_qpair *qpair, *tmp_qpair;
-	int32_t local_completions = 0;
-	int64_t total_completions = 0;
+	uint32_t budget, quantum;
+	int64_t rc, total_completions = 0;
+	bool has_more;
 
 	STAILQ_FOREACH_SAFE(qpair, &tgroup->disconnected_qpairs, poll_group_stailq, tmp_qpair) {
 		disconnected_qpair_cb(qpair, tgroup->group->ctx);
 	}
 
-	STAILQ_FOREACH_SAFE(qpair, &tgroup->connected_qpairs, poll_group_stailq, tmp_qpair) {
-		local_completions = spdk_nvme_qpair_process_completions(qpair, completions_per_qpair);
-		if (spdk_unlikely(local_completions < 0)) {
-			disconnected_qpair_cb(qpair, tgroup->group->ctx);
-			total_completions = -ENXIO;
+	if (spdk_unlikely(++pgroup->polls_since_scan >= NVME_PCIE_POLL_GROUP_SCAN_POLLS)) {
+		nvme_pcie_poll_group_scan(pgroup);
+	}
+
+	budget = tgroup->group->completion_budget;
+	if (budget == 0) {
+		return nvme_pcie_poll_group_round(pgroup, completions_per_qpair, &budget, &has_more,
+						  disconnected_qpair_cb);
+	}
+
+	do {
+		if (pgroup->num_active_qpairs == 0) {
+			break;
+		}
+
+		quantum = spdk_max(budget / pgroup->num_active_qpairs, 1);
+		if (completions_per_qpair != 0) {
+			quantum = spdk_min(quantum, completions_per_qpair);
+		}
+
+		has_more = false;
+		rc = nvme_pcie_poll_group_round(pgroup, quantum, &budget, &has_more,
+						disconnected_qpair_cb);
+		if (spdk_unlikely(rc < 0)) {
+			total_completions = rc;
 		} else if (spdk_likely(total_completions >= 0)) {
-			total_completions += local_completions;
+			total_completions += rc;
 		}
-	}
+	} while (budget != 0 && has_more);
 
 	return total_completions;
 }
@@ -1828,6 +2028,38 @@ nvme_pcie_poll_group_check_disconnected_qpairs(struct spdk_nvme_transport_poll_g
 	}
 }
 
+uint64_t
+nvme_pcie_poll_group_get_next_completion(struct spdk_nvme_transport_poll_group *tgroup)
+{
+	struct spdk_nvme_qpair *qpair;
+	struct nvme_pcie_qpair *pqpair;
+	struct nvme_tracker *tr;
+	uint64_t now, due, next = UINT64_MAX;
+
+	now = spdk_get_ticks();
+
+	STAILQ_FOREACH(qpair, &tgroup->connected_qpairs, poll_group_stailq) {
+		pqpair = nvme_pcie_qpair(qpair);
+		if (!pqpair->flags.track_latency || pqpair->lat_ticks == 0) {
+			continue;
+		}
+
+		/* Trackers are in submission order, so the first one is due first. */
+		tr = TAILQ_FIRST(&pqpair->outstanding_tr);
+		if (tr == NULL) {
+			continue;
+		}
+
+		due = tr->req->submit_tick + pqpair->lat_ticks;
+		if (due <= now) {
+			return 0;
+		}
+		next = spdk_min(next, due - now);
+	}
+
+	return next;
+}
+
 int
 nvme_pcie_poll_group_destroy(struct spdk_nvme_transport_poll_group *tgroup)
 {
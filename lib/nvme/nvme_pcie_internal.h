@@ -112,6 +112,16 @@ SPDK_STATIC_ASSERT((offsetof(struct nvme_tracker, meta_sgl) & 7) == 0, "SGL must
 struct nvme_pcie_poll_group {
 	struct spdk_nvme_transport_poll_group group;
 	struct spdk_nvme_pcie_stat stats;
+
+	/* Connected qpairs which may have work to do. Idle qpairs are not polled. */
+	TAILQ_HEAD(, nvme_pcie_qpair) active_qpairs;
+	uint32_t num_active_qpairs;
+
+	/* Active qpair to poll next, to continue the round when the budget ran out */
+	struct nvme_pcie_qpair *next_qpair;
+
+	/* Number of polls since all connected qpairs were checked for work */
+	uint32_t polls_since_scan;
 };
 
 enum nvme_pcie_qpair_state {
@@ -165,6 +175,12 @@ struct nvme_pcie_qpair {
 
 		/* Disable merging of physically contiguous SGL entries */
 		uint8_t disable_pcie_sgl_merge	: 1;
+
+		/* Measure command latency to estimate when the next completion is due */
+		uint8_t track_latency		: 1;
+
+		/* The qpair is in active_qpairs of its poll group */
+		uint8_t active			: 1;
 	} flags;
 
 	/*
@@ -188,6 +204,11 @@ struct nvme_pcie_qpair {
 		volatile uint32_t *cq_eventidx;
 	} shadow_doorbell;
 
+	/* Moving average of the command latency, if flags.track_latency is set */
+	uint64_t lat_ticks;
+
+	TAILQ_ENTRY(nvme_pcie_qpair) active_link;
+
 	/*
 	 * Fields below this point should not be touched on the normal I/O path.
 	 */
@@ -274,6 +295,55 @@ nvme_pcie_qpair_ring_sq_doorbell(struct spdk_nvme_qpair *qpair)
 	}
 }
 
+#define NVME_PCIE_LAT_EWMA_SHIFT	3
+
+/* Number of polls after which all connected qpairs of a poll group are checked for work */
+#define NVME_PCIE_POLL_GROUP_SCAN_POLLS	64
+
+static inline void
+nvme_pcie_qpair_update_latency(struct nvme_pcie_qpair *pqpair, struct nvme_request *req,
+			       uint64_t now)
+{
+	uint64_t lat;
+
+	if (spdk_unlikely(req->submit_tick == 0 || req->submit_tick > now)) {
+		return;
+	}
+
+	lat = now - req->submit_tick;
+	if (pqpair->lat_ticks == 0) {
+		pqpair->lat_ticks = lat;
+	} else {
+		pqpair->lat_ticks -= pqpair->lat_ticks >> NVME_PCIE_LAT_EWMA_SHIFT;
+		pqpair->lat_ticks += lat >> NVME_PCIE_LAT_EWMA_SHIFT;
+	}
+}
+
+/*
+ * With delay_cmd_submit, the SQ doorbell is rung once per call to process_completions.
+ * The number of commands held back is limited to a fraction of the commands already
+ * outstanding, so that the doorbell is still rung for each command while the queue is
+ * shallow and the controller would otherwise wait idle for the next poll.
+ */
+#define NVME_PCIE_SQ_BATCH_QD_SHIFT	2
+
+static inline bool
+nvme_pcie_qpair_sq_batch_full(struct nvme_pcie_qpair *pqpair)
+{
+	uint32_t pending, outstanding;
+
+	if (pqpair->sq_tail >= pqpair->last_sq_tail) {
+		pending = pqpair->sq_tail - pqpair->last_sq_tail;
+	} else {
+		pending = pqpair->sq_tail + pqpair->num_entries - pqpair->last_sq_tail;
+	}
+
+	outstanding = pqpair->qpair.num_outstanding_reqs;
+	outstanding = outstanding > pending ? outstanding - pending : 0;
+
+	return pending > (outstanding >> NVME_PCIE_SQ_BATCH_QD_SHIFT);
+}
+
 static inline void
 nvme_pcie_qpair_ring_cq_doorbell(struct spdk_nvme_qpair *qpair)
 {
@@ -352,5 +422,7 @@ void nvme_pcie_poll_group_check_disconnected_qpairs(
 	struct spdk_nvme_transport_poll_group *tgroup,
 	spdk_nvme_disconnected_qpair_cb disconnected_qpair_cb);
 int nvme_pcie_poll_group_destroy(struct spdk_nvme_transport_poll_group *tgroup);
+uint64_t nvme_pcie_poll_group_get_next_completion(struct spdk_nvme_transport_poll_group *tgroup);
+void nvme_pcie_poll_group_activate_qpair(struct nvme_pcie_qpair *pqpair);
 
 #endif
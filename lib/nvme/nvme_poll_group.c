@@ -338,6 +338,38 @@ nvme_poll_group_disconnect_qpair(struct spdk_nvme_qpair *qpair)
 	return nvme_transport_poll_group_disconnect_qpair(qpair);
 }
 
+/*
+ * Busy-poll instead of waiting for an interrupt if a completion is expected within
+ * hybrid_spin_ticks, so short commands don't pay the interrupt wakeup latency.
+ */
+static int
+nvme_poll_group_hybrid_spin(struct spdk_nvme_poll_group *group,
+			    spdk_nvme_disconnected_qpair_cb disconnected_qpair_cb)
+{
+	struct spdk_nvme_transport_poll_group *tgroup;
+	uint64_t next = UINT64_MAX, deadline;
+	int64_t num_completions;
+
+	STAILQ_FOREACH(tgroup, &group->tgroups, link) {
+		next = spdk_min(next, nvme_transport_poll_group_get_next_completion(tgroup));
+	}
+
+	if (next > group->hybrid_spin_ticks) {
+		return 0;
+	}
+
+	deadline = spdk_get_ticks() + group->hybrid_spin_ticks;
+	do {
+		num_completions = spdk_nvme_poll_group_process_completions(group, 0,
+				  disconnected_qpair_cb);
+		if (num_completions != 0) {
+			return spdk_min(num_completions, INT_MAX);
+		}
+	} while (spdk_get_ticks() < deadline);
+
+	return 0;
+}
+
 int
 spdk_nvme_poll_group_wait(struct spdk_nvme_poll_group *group,
 			  spdk_nvme_disconnected_qpair_cb disconnected_qpair_cb)
@@ -353,11 +385,30 @@ spdk_nvme_poll_group_wait(struct spdk_nvme_poll_group *group,
 		nvme_transport_poll_group_check_disconnected_qpairs(tgroup, disconnected_qpair_cb);
 	}
 
+	if (group->hybrid_spin_ticks != 0) {
+		num_events = nvme_poll_group_hybrid_spin(group, disconnected_qpair_cb);
+		if (num_events != 0) {
+			return num_events;
+		}
+	}
+
 	num_events = spdk_fd_group_wait(group->fgrp, timeout);
 
 	return num_events;
 }
 
+void
+spdk_nvme_poll_group_set_completion_budget(struct spdk_nvme_poll_group *group, uint32_t budget)
+{
+	group->completion_budget = budget;
+}
+
+void
+spdk_nvme_poll_group_set_hybrid_polling(struct spdk_nvme_poll_group *group, uint32_t max_spin_us)
+{
+	group->hybrid_spin_ticks = max_spin_us * spdk_get_ticks_hz() / SPDK_SEC_TO_USEC;
+}
+
 int64_t
 spdk_nvme_poll_group_process_completions(struct spdk_nvme_poll_group *group,
 		uint32_t completions_per_qpair, spdk_nvme_disconnected_qpair_cb disconnected_qpair_cb)
@@ -68,6 +68,11 @@ struct nvme_tcp_poll_group {
 	int64_t num_completions;
 
 	TAILQ_HEAD(, nvme_tcp_qpair) needs_poll;
+
+	/* Data digests that aren't offloaded to accel are queued here and calculated in batches
+	 * when the group is polled */
+	TAILQ_HEAD(, nvme_tcp_pdu) send_digest_pdus;
+	TAILQ_HEAD(, nvme_tcp_pdu) recv_digest_pdus;
 	struct spdk_nvme_tcp_stat stats;
 };
 
@@ -337,6 +342,29 @@ nvme_tcp_qpair_set_recv_state(struct nvme_tcp_qpair *tqpair,
 
 static void nvme_tcp_qpair_abort_reqs(struct spdk_nvme_qpair *qpair, uint32_t dnr);
 
+/* Drop the PDUs of a disconnected qpair waiting for their data digests, so that their requests
+ * can be aborted */
+static void
+nvme_tcp_poll_group_drop_digests(struct nvme_tcp_poll_group *group, struct nvme_tcp_qpair *tqpair)
+{
+	struct nvme_tcp_pdu *pdu, *tmp;
+	struct nvme_tcp_req *treq;
+
+	TAILQ_FOREACH_SAFE(pdu, &group->send_digest_pdus, tailq, tmp) {
+		if (pdu->qpair == tqpair) {
+			TAILQ_REMOVE(&group->send_digest_pdus, pdu, tailq);
+		}
+	}
+
+	TAILQ_FOREACH_SAFE(pdu, &group->recv_digest_pdus, tailq, tmp) {
+		if (pdu->qpair == tqpair) {
+			TAILQ_REMOVE(&group->recv_digest_pdus, pdu, tailq);
+			treq = pdu->req;
+			treq->ordering.bits.in_progress_accel = 0;
+		}
+	}
+}
+
 static void
 nvme_tcp_ctrlr_disconnect_qpair(struct spdk_nvme_ctrlr *ctrlr, struct spdk_nvme_qpair *qpair)
 {
@@ -351,6 +379,11 @@ nvme_tcp_ctrlr_disconnect_qpair(struct spdk_nvme_ctrlr *ctrlr, struct spdk_nvme_
 		tqpair->needs_poll = false;
 	}
 
+	if (qpair->poll_group != NULL) {
+		group = nvme_tcp_poll_group(qpair->poll_group);
+		nvme_tcp_poll_group_drop_digests(group, tqpair);
+	}
+
 	rc = spdk_sock_close(&tqpair->sock);
 
 	if (tqpair->sock != NULL) {
@@ -559,6 +592,15 @@ tcp_write_pdu(struct nvme_tcp_pdu *pdu)
 	_tcp_write_pdu(pdu);
 }
 
+/* Interrupt driven groups are only polled when an event arrives, so queued digests could stall */
+static inline bool
+nvme_tcp_pdu_batch_digest(struct nvme_tcp_qpair *tqpair, struct nvme_tcp_pdu *pdu)
+{
+	return tqpair->qpair.poll_group != NULL && !tqpair->qpair.ctrlr->opts.enable_interrupts &&
+	       nvme_qpair_get_state(&tqpair->qpair) >= NVME_QPAIR_CONNECTED &&
+	       pdu->dif_ctx == NULL && pdu->data_len % SPDK_NVME_TCP_DIGEST_ALIGNMENT == 0;
+}
+
 static void
 pdu_accel_seq_compute_crc32_done(void *cb_arg)
 {
@@ -655,6 +697,12 @@ pdu_compute_crc32(struct nvme_tcp_pdu *pdu)
 			return;
 		}
 
+		if (nvme_tcp_pdu_batch_digest(tqpair, pdu)) {
+			tgroup = nvme_tcp_poll_group(tqpair->qpair.poll_group);
+			TAILQ_INSERT_TAIL(&tgroup->send_digest_pdus, pdu, tailq);
+			return;
+		}
+
 		crc32c = nvme_tcp_pdu_calc_data_digest(pdu);
 		crc32c = crc32c ^ SPDK_CRC32C_XOR;
 		MAKE_DIGEST_WORD(pdu->data_digest, crc32c);
@@ -1408,6 +1456,34 @@ nvme_tcp_accel_recv_compute_crc32(struct nvme_tcp_req *treq, struct nvme_tcp_pdu
 	return true;
 }
 
+static bool
+nvme_tcp_recv_batch_crc32(struct nvme_tcp_req *treq, struct nvme_tcp_pdu *pdu)
+{
+	struct nvme_tcp_qpair *tqpair = treq->tqpair;
+	struct nvme_tcp_poll_group *tgroup;
+	struct nvme_request *req = treq->req;
+	uint32_t dummy = 0;
+
+	/* The PDU is copied to treq->pdu, so the request can have only one c2h pdu and its command
+	 * capsule has to be released by the socket already */
+	if (!nvme_tcp_pdu_batch_digest(tqpair, pdu) || pdu->data_len != req->payload_size ||
+	    req->accel_sequence != NULL || !treq->ordering.bits.send_ack) {
+		return false;
+	}
+
+	nvme_tcp_req_copy_pdu(treq, pdu);
+	treq->pdu->qpair = tqpair;
+	/* Hold the completion until the digest is checked */
+	treq->ordering.bits.in_progress_accel = 1;
+	tgroup = nvme_tcp_poll_group(tqpair->qpair.poll_group);
+	TAILQ_INSERT_TAIL(&tgroup->recv_digest_pdus, treq->pdu, tailq);
+
+	nvme_tcp_qpair_set_recv_state(tqpair, NVME_TCP_PDU_RECV_STATE_AWAIT_PDU_READY);
+	nvme_tcp_c2h_data_payload_handle(tqpair, treq->pdu, &dummy);
+
+	return true;
+}
+
 static void
 nvme_tcp_pdu_payload_handle(struct nvme_tcp_qpair *tqpair,
 			    uint32_t *reaped)
@@ -1429,7 +1505,8 @@ nvme_tcp_pdu_payload_handle(struct nvme_tcp_qpair *tqpair,
 	if (pdu->ddgst_enable) {
 		/* But if the data digest is enabled, tcp_req cannot be NULL */
 		assert(tcp_req != NULL);
-		if (nvme_tcp_accel_recv_compute_crc32(tcp_req, pdu)) {
+		if (nvme_tcp_accel_recv_compute_crc32(tcp_req, pdu) ||
+		    nvme_tcp_recv_batch_crc32(tcp_req, pdu)) {
 			return;
 		}
 
@@ -2214,7 +2291,7 @@ nvme_tcp_qpair_connect_sock(struct spdk_nvme_ctrlr *ctrlr, struct spdk_nvme_qpai
 	struct nvme_tcp_qpair *tqpair;
 	int family;
 	long int port, src_port = 0;
-	char *sock_impl_name;
+	const char *sock_impl_name;
 	struct spdk_sock_impl_opts impl_opts = {};
 	size_t impl_opts_size = sizeof(impl_opts);
 	struct spdk_sock_opts opts;
@@ -2269,6 +2346,21 @@ nvme_tcp_qpair_connect_sock(struct spdk_nvme_ctrlr *ctrlr, struct spdk_nvme_qpai
 		impl_opts.psk_key = tcp_ctrlr->psk;
 		impl_opts.psk_key_size = tcp_ctrlr->psk_size;
 		impl_opts.tls_cipher_suites = tcp_ctrlr->tls_cipher_suite;
+	} else if (g_spdk_nvme_transport_opts.tcp_zcopy_threshold != 0 &&
+		   !nvme_qpair_is_admin_queue(qpair)) {
+		/* Zero-copy is enabled only for this socket, leaving other clients of the default
+		 * sock implementation alone.  The sock layer doesn't complete a zero-copy request
+		 * before the kernel reports its data as sent, and the write of a PDU completes
+		 * its request only afterwards, so the payload can't be released early. */
+		sock_impl_name = spdk_sock_get_default_impl();
+		if (sock_impl_name &&
+		    spdk_sock_impl_get_opts(sock_impl_name, &impl_opts, &impl_opts_size) == 0) {
+			impl_opts.enable_zerocopy_send_client = true;
+			impl_opts.zerocopy_threshold =
+				g_spdk_nvme_transport_opts.tcp_zcopy_threshold;
+		} else {
+			sock_impl_name = NULL;
+		}
 	}
 	opts.opts_size = sizeof(opts);
 	spdk_sock_get_default_opts(&opts);
@@ -2716,6 +2808,8 @@ nvme_tcp_poll_group_create(void)
 	}
 
 	TAILQ_INIT(&group->needs_poll);
+	TAILQ_INIT(&group->send_digest_pdus);
+	TAILQ_INIT(&group->recv_digest_pdus);
 
 	group->sock_group = spdk_sock_group_create(group);
 	if (group->sock_group == NULL) {
@@ -2813,6 +2907,96 @@ nvme_tcp_poll_group_remove(struct spdk_nvme_transport_poll_group *tgroup,
 	return 0;
 }
 
+static void
+nvme_tcp_send_digest_done(struct nvme_tcp_pdu *pdu, uint32_t crc32c)
+{
+	crc32c ^= SPDK_CRC32C_XOR;
+	MAKE_DIGEST_WORD(pdu->data_digest, crc32c);
+
+	tcp_write_pdu(pdu);
+}
+
+static void
+nvme_tcp_recv_digest_done(struct nvme_tcp_poll_group *group, struct nvme_tcp_pdu *pdu,
+			  uint32_t crc32c)
+{
+	struct nvme_tcp_req *treq = pdu->req;
+	struct nvme_tcp_qpair *tqpair = treq->tqpair;
+
+	assert(treq->ordering.bits.in_progress_accel);
+	treq->ordering.bits.in_progress_accel = 0;
+
+	nvme_tcp_cond_schedule_qpair_polling(tqpair);
+
+	crc32c ^= SPDK_CRC32C_XOR;
+	if (spdk_unlikely(!MATCH_DIGEST_WORD(pdu->data_digest, crc32c))) {
+		SPDK_ERRLOG("data digest error on tqpair=(%p) with pdu=%p\n", tqpair, pdu);
+		treq->rsp.status.sc = SPDK_NVME_SC_COMMAND_TRANSIENT_TRANSPORT_ERROR;
+	}
+
+	if (nvme_tcp_req_complete_safe(treq) && group->num_completions >= 0) {
+		group->num_completions++;
+		group->stats.nvme_completions++;
+	}
+}
+
+#define NVME_TCP_DIGEST_BATCH_SIZE 32
+
+static void
+nvme_tcp_calc_digests(struct nvme_tcp_poll_group *group, bool send)
+{
+	struct nvme_tcp_pdu *pdu, *pdus[NVME_TCP_DIGEST_BATCH_SIZE];
+	struct iovec *iovs[NVME_TCP_DIGEST_BATCH_SIZE];
+	int iovcnts[NVME_TCP_DIGEST_BATCH_SIZE];
+	uint32_t crcs[NVME_TCP_DIGEST_BATCH_SIZE];
+	int i, count = 0;
+
+	pdu = send ? TAILQ_FIRST(&group->send_digest_pdus) :
+	      TAILQ_FIRST(&group->recv_digest_pdus);
+	while (pdu != NULL && count < NVME_TCP_DIGEST_BATCH_SIZE) {
+		pdus[count] = pdu;
+		iovs[count] = pdu->data_iov;
+		iovcnts[count] = pdu->data_iovcnt;
+		crcs[count] = SPDK_CRC32C_XOR;
+		count++;
+		pdu = TAILQ_NEXT(pdu, tailq);
+	}
+
+	if (count == 0) {
+		return;
+	}
+
+	spdk_crc32c_iov_update_multi(iovs, iovcnts, crcs, count);
+
+	/* A callback can disconnect a qpair, which drops its PDUs from the queue, so only
+	 * the PDUs still at the head are completed. New PDUs are queued at the tail and are
+	 * handled by the next batch. */
+	for (i = 0; i < count; i++) {
+		if (send) {
+			if (TAILQ_FIRST(&group->send_digest_pdus) != pdus[i]) {
+				continue;
+			}
+			TAILQ_REMOVE(&group->send_digest_pdus, pdus[i], tailq);
+			nvme_tcp_send_digest_done(pdus[i], crcs[i]);
+		} else {
+			if (TAILQ_FIRST(&group->recv_digest_pdus) != pdus[i]) {
+				continue;
+			}
+			TAILQ_REMOVE(&group->recv_digest_pdus, pdus[i], tailq);
+			nvme_tcp_recv_digest_done(group, pdus[i], crcs[i]);
+		}
+	}
+}
+
+static void
+nvme_tcp_poll_group_calc_digests(struct nvme_tcp_poll_group *group)
+{
+	while (!TAILQ_EMPTY(&group->recv_digest_pdus) || !TAILQ_EMPTY(&group->send_digest_pdus)) {
+		nvme_tcp_calc_digests(group, false);
+		nvme_tcp_calc_digests(group, true);
+	}
+}
+
 static int64_t
 nvme_tcp_poll_group_process_completions(struct spdk_nvme_transport_poll_group *tgroup,
 					uint32_t completions_per_qpair, spdk_nvme_disconnected_qpair_cb disconnected_qpair_cb)
@@ -2826,7 +3010,10 @@ nvme_tcp_poll_group_process_completions(struct spdk_nvme_transport_poll_group *t
 	group->num_completions = 0;
 	group->stats.polls++;
 
+	/* Send the PDUs queued since the last poll */
+	nvme_tcp_poll_group_calc_digests(group);
 	num_events = spdk_sock_group_poll(group->sock_group);
+	nvme_tcp_poll_group_calc_digests(group);
 
 	STAILQ_FOREACH_SAFE(qpair, &tgroup->disconnected_qpairs, poll_group_stailq, tmp_qpair) {
 		tqpair = nvme_tcp_qpair(qpair);
@@ -30,6 +30,7 @@ struct spdk_nvme_transport_opts g_spdk_nvme_transport_opts = {
 	.rdma_max_cq_size = 0,
 	.rdma_cm_event_timeout_ms = 1000,
 	.rdma_umr_per_io = false,
+	.tcp_zcopy_threshold = 0,
 };
 
 const struct spdk_nvme_transport *
@@ -871,6 +872,15 @@ nvme_transport_poll_group_free_stats(struct spdk_nvme_transport_poll_group *tgro
 	}
 }
 
+uint64_t
+nvme_transport_poll_group_get_next_completion(struct spdk_nvme_transport_poll_group *tgroup)
+{
+	if (tgroup->transport->ops.poll_group_get_next_completion) {
+		return tgroup->transport->ops.poll_group_get_next_completion(tgroup);
+	}
+	return UINT64_MAX;
+}
+
 spdk_nvme_transport_type_t
 nvme_transport_get_trtype(const struct spdk_nvme_transport *transport)
 {
@@ -901,10 +911,11 @@ spdk_nvme_transport_get_opts(struct spdk_nvme_transport_opts *opts, size_t opts_
 	SET_FIELD(rdma_max_cq_size);
 	SET_FIELD(rdma_cm_event_timeout_ms);
 	SET_FIELD(rdma_umr_per_io);
+	SET_FIELD(tcp_zcopy_threshold);
 
 	/* Do not remove this statement, you should always update this statement when you adding a new field,
 	 * and do not forget to add the SET_FIELD statement for your added field. */
-	SPDK_STATIC_ASSERT(sizeof(struct spdk_nvme_transport_opts) == 24, "Incorrect size");
+	SPDK_STATIC_ASSERT(sizeof(struct spdk_nvme_transport_opts) == 32, "Incorrect size");
 
 #undef SET_FIELD
 }
@@ -931,6 +942,7 @@ spdk_nvme_transport_set_opts(const struct spdk_nvme_transport_opts *opts, size_t
 	SET_FIELD(rdma_max_cq_size);
 	SET_FIELD(rdma_cm_event_timeout_ms);
 	SET_FIELD(rdma_umr_per_io);
+	SET_FIELD(tcp_zcopy_threshold);
 
 	g_spdk_nvme_transport_opts.opts_size = opts->opts_size;
 
@@ -349,6 +349,22 @@ struct spdk_nvmf_tcp_poll_group {
 	struct spdk_io_channel			*accel_channel;
 	struct spdk_nvmf_tcp_control_msg_list	*control_msg_list;
 
+	/*
+	 * When CRC-32C isn't offloaded to a hardware accel module, data digests of the PDUs sent
+	 * and received during a poll are calculated together at its end instead of by one accel
+	 * task per PDU.
+	 */
+	bool					batch_digests;
+	TAILQ_HEAD(, nvme_tcp_pdu)		send_digest_pdus;
+	TAILQ_HEAD(, nvme_tcp_pdu)		recv_digest_pdus;
+
+	/*
+	 * Load of the sock group and the time it was last published.  Written by the poll group's
+	 * thread only, read by the thread placing new connections.
+	 */
+	uint64_t				load;
+	uint64_t				load_tsc;
+
 	TAILQ_ENTRY(spdk_nvmf_tcp_poll_group)	link;
 };
 
@@ -1275,6 +1291,10 @@ pdu_data_crc32_compute(struct nvme_tcp_pdu *pdu)
 		/* Only support this limitated case for the first step */
 		if (spdk_likely(!pdu->dif_ctx && (pdu->data_len % SPDK_NVME_TCP_DIGEST_ALIGNMENT == 0)
 				&& tqpair->group)) {
+			if (tqpair->group->batch_digests) {
+				TAILQ_INSERT_TAIL(&tqpair->group->send_digest_pdus, pdu, tailq);
+				return;
+			}
 			rc = spdk_accel_submit_crc32cv(tqpair->group->accel_channel, &pdu->data_digest_crc32, pdu->data_iov,
 						       pdu->data_iovcnt, 0, data_crc32_accel_done, pdu);
 			if (spdk_likely(rc == 0)) {
@@ -1648,6 +1668,18 @@ nvmf_tcp_poll_group_intr(void *ctx)
 	return ret != 0 ? SPDK_POLLER_BUSY : SPDK_POLLER_IDLE;
 }
 
+static bool
+nvmf_tcp_crc32c_is_sw(void)
+{
+	const char *module_name;
+
+	if (spdk_accel_get_opc_module_name(SPDK_ACCEL_OPC_CRC32C, &module_name) != 0) {
+		return false;
+	}
+
+	return strcmp(module_name, "software") == 0;
+}
+
 static struct spdk_nvmf_transport_poll_group *
 nvmf_tcp_poll_group_create(struct spdk_nvmf_transport *transport,
 			   struct spdk_nvmf_poll_group *group)
@@ -1666,6 +1698,10 @@ nvmf_tcp_poll_group_create(struct spdk_nvmf_transport *transport,
 		goto cleanup;
 	}
 
+	TAILQ_INIT(&tgroup->send_digest_pdus);
+	TAILQ_INIT(&tgroup->recv_digest_pdus);
+	tgroup->batch_digests = !spdk_interrupt_mode_is_enabled() && nvmf_tcp_crc32c_is_sw();
+
 	TAILQ_INIT(&tgroup->qpairs);
 
 	ttransport = SPDK_CONTAINEROF(transport, struct spdk_nvmf_tcp_transport, transport);
@@ -1707,6 +1743,50 @@ cleanup:
 	return NULL;
 }
 
+/* Load (in bytes per second) a poll group may exceed the least loaded one by, before new
+ * connections are steered away from it */
+#define NVMF_TCP_POLL_GROUP_LOAD_SLACK (1024 * 1024)
+/* A poll group which didn't publish its load for this long, e.g. an idle one in interrupt mode,
+ * is considered to have none */
+#define NVMF_TCP_POLL_GROUP_LOAD_TIMEOUT_MS 1000
+
+/*
+ * Poll groups are picked round-robin, unless the next one is clearly busier than the least
+ * loaded one.  This still spreads a burst of new connections, e.g. after a reconnect storm, as
+ * the measured load doesn't change between them, but keeps hot groups from getting even more.
+ */
+static struct spdk_nvmf_tcp_poll_group *
+nvmf_tcp_get_hint_poll_group(struct spdk_nvmf_tcp_transport *ttransport)
+{
+	struct spdk_nvmf_tcp_poll_group *tgroup, *min_tgroup = NULL;
+	uint64_t group_load, load = UINT64_MAX, min_load = UINT64_MAX;
+	uint64_t now = spdk_get_ticks();
+	uint64_t timeout = spdk_get_ticks_hz() * NVMF_TCP_POLL_GROUP_LOAD_TIMEOUT_MS / 1000;
+
+	TAILQ_FOREACH(tgroup, &ttransport->poll_groups, link) {
+		/* Only the values published by the poll group are used, its sock group belongs to
+		 * another thread */
+		group_load = __atomic_load_n(&tgroup->load, __ATOMIC_RELAXED);
+		if (now - __atomic_load_n(&tgroup->load_tsc, __ATOMIC_RELAXED) > timeout) {
+			group_load = 0;
+		}
+
+		if (tgroup == ttransport->next_pg) {
+			load = group_load;
+		}
+		if (group_load < min_load) {
+			min_load = group_load;
+			min_tgroup = tgroup;
+		}
+	}
+
+	if (min_tgroup == NULL || load <= min_load + min_load / 4 + NVMF_TCP_POLL_GROUP_LOAD_SLACK) {
+		return ttransport->next_pg;
+	}
+
+	return min_tgroup;
+}
+
 static struct spdk_nvmf_transport_poll_group *
 nvmf_tcp_get_optimal_poll_group(struct spdk_nvmf_qpair *qpair)
 {
@@ -1724,7 +1804,7 @@ nvmf_tcp_get_optimal_poll_group(struct spdk_nvmf_qpair *qpair)
 
 	pg = &ttransport->next_pg;
 	assert(*pg != NULL);
-	hint = (*pg)->sock_group;
+	hint = nvmf_tcp_get_hint_poll_group(ttransport)->sock_group;
 
 	tqpair = SPDK_CONTAINEROF(qpair, struct spdk_nvmf_tcp_qpair, qpair);
 	rc = spdk_sock_get_optimal_sock_group(tqpair->sock, &group, hint);
@@ -1751,6 +1831,23 @@ nvmf_tcp_poll_group_destroy(struct spdk_nvmf_transport_poll_group *group)
 	struct spdk_nvmf_tcp_transport *ttransport;
 
 	tgroup = SPDK_CONTAINEROF(group, struct spdk_nvmf_tcp_poll_group, group);
+
+	/* Transport can be NULL when nvmf_tcp_poll_group_create()
+	 * calls this function directly in a failure path. */
+	if (tgroup->group.transport != NULL) {
+		ttransport = SPDK_CONTAINEROF(tgroup->group.transport,
+					      struct spdk_nvmf_tcp_transport, transport);
+
+		next_tgroup = TAILQ_NEXT(tgroup, link);
+		TAILQ_REMOVE(&ttransport->poll_groups, tgroup, link);
+		if (next_tgroup == NULL) {
+			next_tgroup = TAILQ_FIRST(&ttransport->poll_groups);
+		}
+		if (ttransport->next_pg == tgroup) {
+			ttransport->next_pg = next_tgroup;
+		}
+	}
+
 	spdk_sock_group_unregister_interrupt(tgroup->sock_group);
 	spdk_sock_group_close(&tgroup->sock_group);
 	if (tgroup->control_msg_list) {
@@ -1761,24 +1858,6 @@ nvmf_tcp_poll_group_destroy(struct spdk_nvmf_transport_poll_group *group)
 		spdk_put_io_channel(tgroup->accel_channel);
 	}
 
-	if (tgroup->group.transport == NULL) {
-		/* Transport can be NULL when nvmf_tcp_poll_group_create()
-		 * calls this function directly in a failure path. */
-		free(tgroup);
-		return;
-	}
-
-	ttransport = SPDK_CONTAINEROF(tgroup->group.transport, struct spdk_nvmf_tcp_transport, transport);
-
-	next_tgroup = TAILQ_NEXT(tgroup, link);
-	TAILQ_REMOVE(&ttransport->poll_groups, tgroup, link);
-	if (next_tgroup == NULL) {
-		next_tgroup = TAILQ_FIRST(&ttransport->poll_groups);
-	}
-	if (ttransport->next_pg == tgroup) {
-		ttransport->next_pg = next_tgroup;
-	}
-
 	free(tgroup);
 }
 
@@ -2258,6 +2337,10 @@ nvmf_tcp_pdu_payload_handle(struct spdk_nvmf_tcp_qpair *tqpair, struct nvme_tcp_
 	if (pdu->ddgst_enable) {
 		if (tqpair->qpair.qid != 0 && !pdu->dif_ctx && tqpair->group &&
 		    (pdu->data_len % SPDK_NVME_TCP_DIGEST_ALIGNMENT == 0)) {
+			if (tqpair->group->batch_digests) {
+				TAILQ_INSERT_TAIL(&tqpair->group->recv_digest_pdus, pdu, tailq);
+				return;
+			}
 			rc = spdk_accel_submit_crc32cv(tqpair->group->accel_channel, &pdu->data_digest_crc32, pdu->data_iov,
 						       pdu->data_iovcnt, 0, data_crc32_calc_done, pdu);
 			if (spdk_likely(rc == 0)) {
@@ -3465,6 +3548,68 @@ nvmf_tcp_poll_group_add(struct spdk_nvmf_transport_poll_group *group,
 	return 0;
 }
 
+#define NVMF_TCP_DIGEST_BATCH_SIZE 32
+
+static int
+nvmf_tcp_calc_digests(struct spdk_nvmf_tcp_poll_group *tgroup, bool send)
+{
+	struct nvme_tcp_pdu *pdu, *pdus[NVMF_TCP_DIGEST_BATCH_SIZE];
+	struct iovec *iovs[NVMF_TCP_DIGEST_BATCH_SIZE];
+	int iovcnts[NVMF_TCP_DIGEST_BATCH_SIZE];
+	uint32_t crcs[NVMF_TCP_DIGEST_BATCH_SIZE];
+	int i, count, total = 0;
+
+	do {
+		count = 0;
+		while (count < NVMF_TCP_DIGEST_BATCH_SIZE) {
+			pdu = send ? TAILQ_FIRST(&tgroup->send_digest_pdus) :
+			      TAILQ_FIRST(&tgroup->recv_digest_pdus);
+			if (!pdu) {
+				break;
+			}
+
+			if (send) {
+				TAILQ_REMOVE(&tgroup->send_digest_pdus, pdu, tailq);
+			} else {
+				TAILQ_REMOVE(&tgroup->recv_digest_pdus, pdu, tailq);
+			}
+			pdus[count] = pdu;
+			iovs[count] = pdu->data_iov;
+			iovcnts[count] = pdu->data_iovcnt;
+			crcs[count] = SPDK_CRC32C_XOR;
+			count++;
+		}
+
+		spdk_crc32c_iov_update_multi(iovs, iovcnts, crcs, count);
+
+		/* The callbacks can queue more PDUs, which are handled by the next iteration */
+		for (i = 0; i < count; i++) {
+			pdus[i]->data_digest_crc32 = crcs[i];
+			if (send) {
+				data_crc32_accel_done(pdus[i], 0);
+			} else {
+				data_crc32_calc_done(pdus[i], 0);
+			}
+		}
+		total += count;
+	} while (count > 0);
+
+	return total;
+}
+
+static int
+nvmf_tcp_poll_group_calc_digests(struct spdk_nvmf_tcp_poll_group *tgroup)
+{
+	int count = 0;
+
+	while (!TAILQ_EMPTY(&tgroup->recv_digest_pdus) || !TAILQ_EMPTY(&tgroup->send_digest_pdus)) {
+		count += nvmf_tcp_calc_digests(tgroup, false);
+		count += nvmf_tcp_calc_digests(tgroup, true);
+	}
+
+	return count;
+}
+
 static int
 nvmf_tcp_poll_group_remove(struct spdk_nvmf_transport_poll_group *group,
 			   struct spdk_nvmf_qpair *qpair)
@@ -3486,6 +3631,9 @@ nvmf_tcp_poll_group_remove(struct spdk_nvmf_transport_poll_group *group,
 	}
 	TAILQ_REMOVE(&tgroup->qpairs, tqpair, link);
 
+	/* Complete the PDUs waiting for their digests, so that none of them refers to the qpair */
+	nvmf_tcp_poll_group_calc_digests(tgroup);
+
 	/* Try to force out any pending writes */
 	spdk_sock_flush(tqpair->sock);
 
@@ -3548,6 +3696,14 @@ nvmf_tcp_close_qpair(struct spdk_nvmf_qpair *qpair,
 	nvmf_tcp_qpair_destroy(tqpair);
 }
 
+static void
+nvmf_tcp_poll_group_publish_load(struct spdk_nvmf_tcp_poll_group *tgroup)
+{
+	__atomic_store_n(&tgroup->load, spdk_sock_group_get_load(tgroup->sock_group),
+			 __ATOMIC_RELAXED);
+	__atomic_store_n(&tgroup->load_tsc, spdk_get_ticks(), __ATOMIC_RELAXED);
+}
+
 static int
 nvmf_tcp_poll_group_poll(struct spdk_nvmf_transport_poll_group *group)
 {
@@ -3557,14 +3713,24 @@ nvmf_tcp_poll_group_poll(struct spdk_nvmf_transport_poll_group *group)
 	tgroup = SPDK_CONTAINEROF(group, struct spdk_nvmf_tcp_poll_group, group);
 
 	if (spdk_unlikely(TAILQ_EMPTY(&tgroup->qpairs))) {
+		if (tgroup->load != 0) {
+			__atomic_store_n(&tgroup->load, 0, __ATOMIC_RELAXED);
+		}
 		return 0;
 	}
 
+	/* Send the PDUs completed since the last poll, before the sock group flushes */
+	nvmf_tcp_poll_group_calc_digests(tgroup);
+
 	num_events = spdk_sock_group_poll(tgroup->sock_group);
 	if (spdk_unlikely(num_events < 0)) {
 		SPDK_ERRLOG("Failed to poll sock_group=%p\n", tgroup->sock_group);
+	} else {
+		num_events += nvmf_tcp_poll_group_calc_digests(tgroup);
 	}
 
+	nvmf_tcp_poll_group_publish_load(tgroup);
+
 	return num_events;
 }
 
@@ -3721,6 +3887,25 @@ nvmf_tcp_qpair_abort_request(struct spdk_nvmf_qpair *qpair,
 	_nvmf_tcp_qpair_abort_request(req);
 }
 
+static void
+nvmf_tcp_poll_group_dump_stat(struct spdk_nvmf_transport_poll_group *group,
+			      struct spdk_json_write_ctx *w)
+{
+	struct spdk_nvmf_tcp_poll_group *tgroup;
+	struct spdk_sock_group_stats stats;
+
+	tgroup = SPDK_CONTAINEROF(group, struct spdk_nvmf_tcp_poll_group, group);
+	spdk_sock_group_get_stats(tgroup->sock_group, &stats);
+
+	spdk_json_write_named_object_begin(w, "sock_group");
+	spdk_json_write_named_uint32(w, "num_socks", stats.num_socks);
+	spdk_json_write_named_uint64(w, "bytes_read", stats.bytes_read);
+	spdk_json_write_named_uint64(w, "bytes_written", stats.bytes_written);
+	spdk_json_write_named_uint64(w, "events", stats.events);
+	spdk_json_write_named_uint64(w, "load", stats.load);
+	spdk_json_write_object_end(w);
+}
+
 struct tcp_subsystem_add_host_opts {
 	char *psk;
 };
@@ -3948,6 +4133,7 @@ const struct spdk_nvmf_transport_ops spdk_nvmf_transport_tcp = {
 	.poll_group_add = nvmf_tcp_poll_group_add,
 	.poll_group_remove = nvmf_tcp_poll_group_remove,
 	.poll_group_poll = nvmf_tcp_poll_group_poll,
+	.poll_group_dump_stat = nvmf_tcp_poll_group_dump_stat,
 
 	.req_free = nvmf_tcp_req_free,
 	.req_complete = nvmf_tcp_req_complete,
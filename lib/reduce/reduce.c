@@ -16,6 +16,7 @@
 #include "spdk/log.h"
 #include "spdk/memory.h"
 #include "spdk/tree.h"
+#include "spdk/crc32.h"
 
 #include "libpmem.h"
 
@@ -29,11 +30,20 @@
 
 #define REDUCE_NUM_VOL_REQUESTS	256
 
+/* Backing io units of a chunk are only merged into larger backing IOs for chunks of at most
+ * this many io units. */
+#define REDUCE_MAX_MERGED_IO_UNITS	4
+
+/* Where the logical map and chunk maps of a volume are kept. */
+#define REDUCE_MD_TYPE_PM_FILE		0
+#define REDUCE_MD_TYPE_BACKING_DEV	1
+
 /* Structure written to offset 0 of both the pm file and the backing device. */
 struct spdk_reduce_vol_superblock {
 	uint8_t				signature[8];
 	struct spdk_reduce_vol_params	params;
-	uint8_t				reserved[4040];
+	uint32_t			md_type;
+	uint8_t				reserved[4036];
 };
 SPDK_STATIC_ASSERT(sizeof(struct spdk_reduce_vol_superblock) == 4096, "size incorrect");
 
@@ -46,6 +56,55 @@ SPDK_STATIC_ASSERT(sizeof(SPDK_REDUCE_SIGNATURE) - 1 ==
 
 #define REDUCE_ZERO_BUF_SIZE 0x100000
 
+/*
+ * When a volume is created without a pm file, the maps are kept on the backing device, just
+ *  after the superblock and the (empty) path:
+ *
+ *   | superblock | path | md header | log pages ... | map pages ... | data io units ...
+ *
+ *  The map pages hold the same image that would otherwise be in the pm file.  The whole image
+ *  is cached in memory and every _reduce_persist() call appends the persisted range to the log.
+ *  Dirty map pages are written back by periodic checkpoints, after which the log pages covered
+ *  by the checkpoint can be reused.  After a crash, the log is replayed on top of the map pages.
+ */
+#define REDUCE_MD_HEADER_OFFSET		(REDUCE_BACKING_DEV_PATH_OFFSET + REDUCE_PATH_MAX)
+#define REDUCE_MD_PAGE_SIZE		4096
+/* Minimum number of log pages on the backing device */
+#define REDUCE_MD_LOG_MIN_PAGES		256
+/* Start a checkpoint once this many map pages are dirty */
+#define REDUCE_MD_MAX_DIRTY_PAGES	1024
+/* Maximum size of a single IO used to format or load the metadata */
+#define REDUCE_MD_IO_SIZE		0x100000
+
+#define SPDK_REDUCE_MD_SIGNATURE "SPDKRDMD"
+#define SPDK_REDUCE_LOG_SIGNATURE "SPDKRLOG"
+
+struct reduce_md_header {
+	uint8_t		signature[8];
+	/* All log pages with a lower sequence number are already reflected in the map pages. */
+	uint64_t	ckpt_seq;
+	uint32_t	crc;
+	uint8_t		reserved[4076];
+};
+SPDK_STATIC_ASSERT(sizeof(struct reduce_md_header) == REDUCE_MD_PAGE_SIZE, "size incorrect");
+
+struct reduce_md_log_page {
+	uint8_t		signature[8];
+	uint64_t	seq;
+	uint32_t	num_entries;
+	uint32_t	crc;
+	uint8_t		entries[4072];
+};
+SPDK_STATIC_ASSERT(sizeof(struct reduce_md_log_page) == REDUCE_MD_PAGE_SIZE, "size incorrect");
+
+struct reduce_md_log_entry {
+	/* Offset of the persisted range within the metadata image */
+	uint64_t	offset;
+	uint32_t	len;
+	uint32_t	reserved;
+	uint8_t		data[0];
+};
+
 /**
  * Describes a persistent memory file used to hold metadata associated with a
  *  compressed volume.
@@ -116,6 +175,109 @@ struct spdk_reduce_vol_request {
 	TAILQ_ENTRY(spdk_reduce_vol_request)	tailq;
 	RB_ENTRY(spdk_reduce_vol_request)	rbnode;
 	struct spdk_reduce_vol_cb_args		backing_cb_args;
+
+	/**
+	 * Requests spanning multiple chunks are split into one child request per chunk.  The
+	 *  parent request doesn't touch any chunk itself, it only tracks its children and
+	 *  completes the user's request once all of them are done.
+	 */
+	struct spdk_reduce_vol_request		*parent;
+	TAILQ_HEAD(, spdk_reduce_vol_request)	children;
+	TAILQ_ENTRY(spdk_reduce_vol_request)	child_tailq;
+	/* Number of children that haven't completed yet */
+	uint32_t				num_children;
+	/* Number of write children that haven't finished compressing their chunk yet */
+	uint32_t				num_children_compressing;
+	/**
+	 * For a child, the part of the parent's iovecs that falls into its chunk.  For a parent
+	 *  writing its children's chunks, the iovecs of the merged backing writes.
+	 */
+	struct iovec				split_iov[REDUCE_MAX_IOVECS];
+
+	/**
+	 * Used when the maps are kept on the backing device.  The request completes once the log
+	 *  page with this sequence number is durable, and only then releases the chunk map it
+	 *  replaced.
+	 */
+	uint64_t				md_seq;
+	uint64_t				old_chunk_map_index;
+};
+
+/* Merged backing writes of a multi-chunk write need at most one iovec per backing io unit. */
+SPDK_STATIC_ASSERT(REDUCE_MAX_BATCH_CHUNKS * REDUCE_MAX_MERGED_IO_UNITS <= REDUCE_MAX_IOVECS,
+		   "split_iov too small");
+
+/* State of the metadata log, used when the maps are kept on the backing device. */
+struct reduce_md_log {
+	/* Layout of the metadata on the backing device, offsets are in bytes */
+	uint64_t				log_offset;
+	uint32_t				log_pages;
+	uint64_t				map_offset;
+	uint64_t				map_pages;
+
+	struct reduce_md_header			*header;
+
+	/**
+	 * Ring of log pages that are not durable yet.  The page with sequence number seq is kept
+	 *  in buf[seq % buf_pages] and is written to log page seq % log_pages.
+	 */
+	struct reduce_md_log_page		*buf;
+	uint32_t				buf_pages;
+	/* Sequence number of the page that new entries are appended to */
+	uint64_t				open_seq;
+	/* Number of bytes used in the entries of the open page */
+	uint32_t				open_offset;
+	/* All pages below this sequence number have been written to the backing device */
+	uint64_t				durable_seq;
+	/* Sequence number stored in the md header by the last checkpoint */
+	uint64_t				ckpt_seq;
+	/* Number of pages being written by the outstanding log write, if any */
+	uint32_t				flush_pages;
+	/* A failed log write makes all later metadata updates fail too */
+	int					md_errno;
+	/* Requests waiting for their log entries to become durable */
+	TAILQ_HEAD(, spdk_reduce_vol_request)	waiters;
+
+	struct spdk_bit_array			*dirty_pages;
+	uint64_t				num_dirty_pages;
+
+	/* Checkpoint state */
+	bool					ckpt_in_progress;
+	/* The checkpoint's map pages may only be written once this page is durable */
+	uint64_t				ckpt_seq_target;
+	uint8_t					*ckpt_buf;
+	uint64_t				*ckpt_page_index;
+	uint64_t				ckpt_num_pages;
+	uint8_t					*ckpt_io_mem;
+	struct iovec				*ckpt_iov;
+	struct spdk_reduce_vol_cb_args		ckpt_cb_args;
+	uint32_t				ckpt_outstanding;
+	int					ckpt_errno;
+	/* Called when a checkpoint started after it was set completes */
+	spdk_reduce_vol_op_complete		ckpt_cb_fn;
+	void					*ckpt_cb_arg;
+	bool					ckpt_cb_armed;
+
+	/* Outstanding log write */
+	struct spdk_reduce_backing_io		*flush_io;
+	struct iovec				flush_iov;
+	struct spdk_reduce_vol_cb_args		flush_cb_args;
+
+	/* Header writes and sequential IO used to format and load the metadata */
+	struct spdk_reduce_backing_io		*md_io;
+	struct iovec				md_iov;
+	struct spdk_reduce_vol_cb_args		md_cb_args;
+	enum spdk_reduce_backing_io_type	md_io_type;
+	uint8_t					*md_io_buf;
+	uint64_t				md_io_offset;
+	uint64_t				md_io_remaining;
+	spdk_reduce_vol_op_complete		md_io_cb_fn;
+	void					*md_io_cb_arg;
+	/* Temporary copy of the log pages, only used while loading */
+	struct reduce_md_log_page		*load_buf;
+	/* Completion of the format, load or unload in progress */
+	spdk_reduce_vol_op_complete		op_cb_fn;
+	void					*op_cb_arg;
 };
 
 struct spdk_reduce_vol {
@@ -152,10 +314,16 @@ struct spdk_reduce_vol {
 	struct iovec				*buf_iov_mem;
 	/* Single contiguous buffer used for backing io buffers for this volume. */
 	uint8_t					*buf_backing_io_mem;
+
+	/* Only set when the maps are kept on the backing device instead of a pm file. */
+	struct reduce_md_log			*md_log;
 };
 
 static void _start_readv_request(struct spdk_reduce_vol_request *req);
 static void _start_writev_request(struct spdk_reduce_vol_request *req);
+static void _reduce_vol_complete_req(struct spdk_reduce_vol_request *req, int reduce_errno);
+static void _reduce_vol_reset_chunk(struct spdk_reduce_vol *vol, uint64_t chunk_map_index);
+static void _reduce_md_log_append(struct spdk_reduce_vol *vol, const void *addr, size_t len);
 static uint8_t *g_zero_buf;
 static int g_vol_count = 0;
 
@@ -170,7 +338,9 @@ static int g_vol_count = 0;
 static void
 _reduce_persist(struct spdk_reduce_vol *vol, const void *addr, size_t len)
 {
-	if (vol->pm_file.pm_is_pmem) {
+	if (vol->md_log != NULL) {
+		_reduce_md_log_append(vol, addr, len);
+	} else if (vol->pm_file.pm_is_pmem) {
 		pmem_persist(addr, len);
 	} else {
 		pmem_msync(addr, len);
@@ -198,118 +368,1043 @@ _get_total_chunks(uint64_t vol_size, uint64_t chunk_size)
 	num_chunks = vol_size / chunk_size;
 	num_chunks += REDUCE_NUM_EXTRA_CHUNKS;
 
-	return num_chunks;
+	return num_chunks;
+}
+
+static inline uint32_t
+_reduce_vol_get_chunk_struct_size(uint64_t backing_io_units_per_chunk)
+{
+	return sizeof(struct spdk_reduce_chunk_map) + sizeof(uint64_t) * backing_io_units_per_chunk;
+}
+
+static uint64_t
+_get_pm_total_chunks_size(uint64_t vol_size, uint64_t chunk_size, uint64_t backing_io_unit_size)
+{
+	uint64_t io_units_per_chunk, num_chunks, total_chunks_size;
+
+	num_chunks = _get_total_chunks(vol_size, chunk_size);
+	io_units_per_chunk = chunk_size / backing_io_unit_size;
+
+	total_chunks_size = num_chunks * _reduce_vol_get_chunk_struct_size(io_units_per_chunk);
+
+	return spdk_divide_round_up(total_chunks_size, REDUCE_PM_SIZE_ALIGNMENT) *
+	       REDUCE_PM_SIZE_ALIGNMENT;
+}
+
+static struct spdk_reduce_chunk_map *
+_reduce_vol_get_chunk_map(struct spdk_reduce_vol *vol, uint64_t chunk_map_index)
+{
+	uintptr_t chunk_map_addr;
+
+	assert(chunk_map_index < _get_total_chunks(vol->params.vol_size, vol->params.chunk_size));
+
+	chunk_map_addr = (uintptr_t)vol->pm_chunk_maps;
+	chunk_map_addr += chunk_map_index *
+			  _reduce_vol_get_chunk_struct_size(vol->backing_io_units_per_chunk);
+
+	return (struct spdk_reduce_chunk_map *)chunk_map_addr;
+}
+
+static int
+_validate_vol_params(struct spdk_reduce_vol_params *params)
+{
+	if (params->vol_size > 0) {
+		/**
+		 * User does not pass in the vol size - it gets calculated by libreduce from
+		 *  values in this structure plus the size of the backing device.
+		 */
+		return -EINVAL;
+	}
+
+	if (params->chunk_size == 0 || params->backing_io_unit_size == 0 ||
+	    params->logical_block_size == 0) {
+		return -EINVAL;
+	}
+
+	/* Chunk size must be an even multiple of the backing io unit size. */
+	if ((params->chunk_size % params->backing_io_unit_size) != 0) {
+		return -EINVAL;
+	}
+
+	/* Chunk size must be an even multiple of the logical block size. */
+	if ((params->chunk_size % params->logical_block_size) != 0) {
+		return -1;
+	}
+
+	return 0;
+}
+
+static uint64_t
+_get_vol_size(uint64_t chunk_size, uint64_t backing_dev_size)
+{
+	uint64_t num_chunks;
+
+	num_chunks = backing_dev_size / chunk_size;
+	if (num_chunks <= REDUCE_NUM_EXTRA_CHUNKS) {
+		return 0;
+	}
+
+	num_chunks -= REDUCE_NUM_EXTRA_CHUNKS;
+	return num_chunks * chunk_size;
+}
+
+static uint64_t
+_get_pm_file_size(struct spdk_reduce_vol_params *params)
+{
+	uint64_t total_pm_size;
+
+	total_pm_size = sizeof(struct spdk_reduce_vol_superblock);
+	total_pm_size += _get_pm_logical_map_size(params->vol_size, params->chunk_size);
+	total_pm_size += _get_pm_total_chunks_size(params->vol_size, params->chunk_size,
+			 params->backing_io_unit_size);
+	return total_pm_size;
+}
+
+const struct spdk_uuid *
+spdk_reduce_vol_get_uuid(struct spdk_reduce_vol *vol)
+{
+	return &vol->params.uuid;
+}
+
+static void
+_initialize_vol_pm_pointers(struct spdk_reduce_vol *vol)
+{
+	uint64_t logical_map_size;
+
+	/* Superblock is at the beginning of the pm file. */
+	vol->pm_super = (struct spdk_reduce_vol_superblock *)vol->pm_file.pm_buf;
+
+	/* Logical map immediately follows the super block. */
+	vol->pm_logical_map = (uint64_t *)(vol->pm_super + 1);
+
+	/* Chunks maps follow the logical map. */
+	logical_map_size = _get_pm_logical_map_size(vol->params.vol_size, vol->params.chunk_size);
+	vol->pm_chunk_maps = (uint64_t *)((uint8_t *)vol->pm_logical_map + logical_map_size);
+}
+
+static inline uint32_t
+_md_log_entry_size(uint32_t len)
+{
+	return sizeof(struct reduce_md_log_entry) + SPDK_ALIGN_CEIL(len, sizeof(uint64_t));
+}
+
+/* Number of log pages that are buffered in memory until they are written to the log. */
+static uint32_t
+_get_md_log_buf_pages(struct spdk_reduce_vol_params *params)
+{
+	uint32_t chunk_entry_size, request_size, payload;
+
+	chunk_entry_size = _md_log_entry_size(_reduce_vol_get_chunk_struct_size(
+			params->chunk_size / params->backing_io_unit_size));
+	payload = SPDK_SIZEOF_MEMBER(struct reduce_md_log_page, entries);
+	if (chunk_entry_size >= payload) {
+		return 0;
+	}
+
+	/* A write persists its new chunk map and then its logical map entry. */
+	request_size = chunk_entry_size + _md_log_entry_size(sizeof(uint64_t));
+
+	/*
+	 * Requests keep their entries until they are durable, so the buffer never has to hold more
+	 *  than the entries of all requests.  Every full page wastes less than one entry, and at
+	 *  most a few pages (the open one, the last one of the outstanding log write and the ones
+	 *  sealed early to start a log write or a checkpoint) are only partially filled.
+	 */
+	return spdk_divide_round_up(REDUCE_NUM_VOL_REQUESTS * request_size,
+				    payload - chunk_entry_size) + 5;
+}
+
+static uint32_t
+_get_md_log_pages(struct spdk_reduce_vol_params *params)
+{
+	return spdk_max(REDUCE_MD_LOG_MIN_PAGES, 2 * _get_md_log_buf_pages(params) + 2);
+}
+
+/* Size of all metadata kept on the backing device, rounded up to whole backing io units. */
+static uint64_t
+_get_md_size(struct spdk_reduce_vol_params *params)
+{
+	uint64_t md_size;
+
+	md_size = REDUCE_MD_HEADER_OFFSET + REDUCE_MD_PAGE_SIZE;
+	md_size += (uint64_t)_get_md_log_pages(params) * REDUCE_MD_PAGE_SIZE;
+	md_size += SPDK_ALIGN_CEIL(_get_pm_file_size(params), REDUCE_MD_PAGE_SIZE);
+
+	return SPDK_ALIGN_CEIL(md_size, params->backing_io_unit_size);
+}
+
+static uint32_t
+_reduce_md_crc(void *page, uint32_t *crc)
+{
+	uint32_t saved_crc, result;
+
+	saved_crc = *crc;
+	*crc = 0;
+	result = spdk_crc32c_update(page, REDUCE_MD_PAGE_SIZE, ~0u) ^ ~0u;
+	*crc = saved_crc;
+
+	return result;
+}
+
+static inline struct reduce_md_log_page *
+_reduce_md_log_page(struct reduce_md_log *md, uint64_t seq)
+{
+	return &md->buf[seq % md->buf_pages];
+}
+
+static void
+_reduce_md_log_open(struct reduce_md_log *md)
+{
+	struct reduce_md_log_page *page = _reduce_md_log_page(md, md->open_seq);
+
+	memset(page, 0, sizeof(*page));
+	memcpy(page->signature, SPDK_REDUCE_LOG_SIGNATURE, sizeof(page->signature));
+	page->seq = md->open_seq;
+	md->open_offset = 0;
+}
+
+static void
+_reduce_md_log_seal(struct reduce_md_log *md)
+{
+	struct reduce_md_log_page *page = _reduce_md_log_page(md, md->open_seq);
+
+	page->crc = _reduce_md_crc(page, &page->crc);
+	md->open_seq++;
+	assert(md->open_seq - md->durable_seq < md->buf_pages);
+	_reduce_md_log_open(md);
+}
+
+static void
+_reduce_md_mark_dirty(struct reduce_md_log *md, uint64_t offset, uint64_t len)
+{
+	uint64_t page;
+
+	for (page = offset / REDUCE_MD_PAGE_SIZE; page <= (offset + len - 1) / REDUCE_MD_PAGE_SIZE;
+	     page++) {
+		if (!spdk_bit_array_get(md->dirty_pages, page)) {
+			spdk_bit_array_set(md->dirty_pages, page);
+			md->num_dirty_pages++;
+		}
+	}
+}
+
+static void
+_reduce_md_log_append(struct spdk_reduce_vol *vol, const void *addr, size_t len)
+{
+	struct reduce_md_log *md = vol->md_log;
+	struct reduce_md_log_page *page;
+	struct reduce_md_log_entry *entry;
+	uint64_t offset;
+	uint32_t entry_size;
+
+	offset = (uintptr_t)addr - (uintptr_t)vol->pm_file.pm_buf;
+	entry_size = _md_log_entry_size(len);
+	assert(offset + len <= vol->pm_file.size);
+	assert(entry_size <= sizeof(page->entries));
+
+	if (md->open_offset + entry_size > sizeof(page->entries)) {
+		_reduce_md_log_seal(md);
+	}
+
+	page = _reduce_md_log_page(md, md->open_seq);
+	entry = (struct reduce_md_log_entry *)&page->entries[md->open_offset];
+	entry->offset = offset;
+	entry->len = len;
+	memcpy(entry->data, addr, len);
+	page->num_entries++;
+	md->open_offset += entry_size;
+
+	_reduce_md_mark_dirty(md, offset, len);
+}
+
+static void _reduce_md_io_next(struct spdk_reduce_vol *vol);
+
+static void
+_reduce_md_io_cpl(void *cb_arg, int reduce_errno)
+{
+	struct spdk_reduce_vol *vol = cb_arg;
+	struct reduce_md_log *md = vol->md_log;
+
+	if (reduce_errno == 0) {
+		md->md_io_buf += md->md_iov.iov_len;
+		md->md_io_offset += md->md_iov.iov_len;
+		md->md_io_remaining -= md->md_iov.iov_len;
+		if (md->md_io_remaining > 0) {
+			_reduce_md_io_next(vol);
+			return;
+		}
+	}
+
+	md->md_io_cb_fn(md->md_io_cb_arg, reduce_errno);
+}
+
+static void
+_reduce_md_io_next(struct spdk_reduce_vol *vol)
+{
+	struct reduce_md_log *md = vol->md_log;
+	struct spdk_reduce_backing_io *backing_io = md->md_io;
+
+	md->md_iov.iov_base = md->md_io_buf;
+	md->md_iov.iov_len = spdk_min(md->md_io_remaining, REDUCE_MD_IO_SIZE);
+	md->md_cb_args.cb_fn = _reduce_md_io_cpl;
+	md->md_cb_args.cb_arg = vol;
+
+	backing_io->dev = vol->backing_dev;
+	backing_io->iov = &md->md_iov;
+	backing_io->iovcnt = 1;
+	backing_io->lba = md->md_io_offset / vol->backing_dev->blocklen;
+	backing_io->lba_count = md->md_iov.iov_len / vol->backing_dev->blocklen;
+	backing_io->backing_cb_args = &md->md_cb_args;
+	backing_io->backing_io_type = md->md_io_type;
+
+	vol->backing_dev->submit_backing_io(backing_io);
+}
+
+/* Read or write a metadata region, splitting it into IOs of at most REDUCE_MD_IO_SIZE. */
+static void
+_reduce_md_io(struct spdk_reduce_vol *vol, enum spdk_reduce_backing_io_type type, void *buf,
+	      uint64_t offset, uint64_t len, spdk_reduce_vol_op_complete cb_fn, void *cb_arg)
+{
+	struct reduce_md_log *md = vol->md_log;
+
+	assert(len > 0);
+	md->md_io_type = type;
+	md->md_io_buf = buf;
+	md->md_io_offset = offset;
+	md->md_io_remaining = len;
+	md->md_io_cb_fn = cb_fn;
+	md->md_io_cb_arg = cb_arg;
+
+	_reduce_md_io_next(vol);
+}
+
+/*
+ * Log pages below the returned sequence number may be written to the log.  A checkpoint has to
+ *  flush all pages up to its target before it can release any log page, so outside of a
+ *  checkpoint enough of the log is kept free for the pages that may be buffered when the next
+ *  one starts.
+ */
+static uint64_t
+_reduce_md_log_limit(struct reduce_md_log *md)
+{
+	uint64_t reserved_pages = md->buf_pages + 1;
+
+	if (md->ckpt_in_progress) {
+		return spdk_min(md->ckpt_seq + md->log_pages,
+				md->ckpt_seq_target + md->log_pages - reserved_pages);
+	}
+
+	return md->ckpt_seq + md->log_pages - reserved_pages;
+}
+
+static bool
+_reduce_md_ckpt_needed(struct reduce_md_log *md)
+{
+	return md->num_dirty_pages >= REDUCE_MD_MAX_DIRTY_PAGES ||
+	       md->durable_seq - md->ckpt_seq >= (md->log_pages - md->buf_pages - 1) / 2;
+}
+
+static void _reduce_md_ckpt_start(struct spdk_reduce_vol *vol);
+static void _reduce_md_ckpt_write_pages(struct spdk_reduce_vol *vol);
+static void _reduce_md_ckpt_done(struct spdk_reduce_vol *vol, int reduce_errno);
+static void _reduce_md_log_flush(struct spdk_reduce_vol *vol);
+
+static void
+_reduce_md_log_flush_cpl(void *cb_arg, int reduce_errno)
+{
+	struct spdk_reduce_vol *vol = cb_arg;
+	struct reduce_md_log *md = vol->md_log;
+	struct spdk_reduce_vol_request *req;
+
+	if (reduce_errno != 0) {
+		SPDK_ERRLOG("failed to write metadata log: %s\n", spdk_strerror(-reduce_errno));
+		md->flush_pages = 0;
+		md->md_errno = reduce_errno;
+		/* The chunk maps replaced by the failed requests are left allocated, so that the data
+		 *  they point to stays intact while the old mappings may still be the durable ones.
+		 */
+		while ((req = TAILQ_FIRST(&md->waiters)) != NULL) {
+			TAILQ_REMOVE(&md->waiters, req, tailq);
+			_reduce_vol_complete_req(req, reduce_errno);
+		}
+		if (md->ckpt_in_progress && md->ckpt_outstanding == 0) {
+			_reduce_md_ckpt_done(vol, reduce_errno);
+		}
+		return;
+	}
+
+	md->durable_seq += md->flush_pages;
+	md->flush_pages = 0;
+
+	/* Completions may submit new requests, so check the head of the list every time. */
+	while ((req = TAILQ_FIRST(&md->waiters)) != NULL && req->md_seq < md->durable_seq) {
+		TAILQ_REMOVE(&md->waiters, req, tailq);
+		if (req->old_chunk_map_index != REDUCE_EMPTY_MAP_ENTRY) {
+			_reduce_vol_reset_chunk(vol, req->old_chunk_map_index);
+		}
+		_reduce_vol_complete_req(req, 0);
+	}
+
+	if (md->ckpt_in_progress) {
+		if (md->ckpt_outstanding == 0 && md->durable_seq >= md->ckpt_seq_target) {
+			_reduce_md_ckpt_write_pages(vol);
+		}
+	} else if (_reduce_md_ckpt_needed(md)) {
+		_reduce_md_ckpt_start(vol);
+	}
+
+	_reduce_md_log_flush(vol);
+}
+
+/* Write all pending log pages.  Only a single log write is outstanding at a time, pages
+ *  filled in the meantime are written together once it completes.
+ */
+static void
+_reduce_md_log_flush(struct spdk_reduce_vol *vol)
+{
+	struct reduce_md_log *md = vol->md_log;
+	struct spdk_reduce_backing_io *backing_io = md->flush_io;
+	uint64_t limit, num_pages, log_index, buf_index;
+
+	if (md->flush_pages != 0 || md->md_errno != 0) {
+		return;
+	}
+
+	if (md->open_seq == md->durable_seq) {
+		if (md->open_offset == 0) {
+			return;
+		}
+		_reduce_md_log_seal(md);
+	}
+
+	limit = _reduce_md_log_limit(md);
+	if (md->durable_seq >= limit) {
+		/* The log is full, the pages are written once a checkpoint released some of it. */
+		_reduce_md_ckpt_start(vol);
+		return;
+	}
+
+	log_index = md->durable_seq % md->log_pages;
+	buf_index = md->durable_seq % md->buf_pages;
+	num_pages = spdk_min(md->open_seq, limit) - md->durable_seq;
+	num_pages = spdk_min(num_pages, md->log_pages - log_index);
+	num_pages = spdk_min(num_pages, md->buf_pages - buf_index);
+	md->flush_pages = num_pages;
+
+	md->flush_iov.iov_base = &md->buf[buf_index];
+	md->flush_iov.iov_len = num_pages * REDUCE_MD_PAGE_SIZE;
+	md->flush_cb_args.cb_fn = _reduce_md_log_flush_cpl;
+	md->flush_cb_args.cb_arg = vol;
+
+	backing_io->dev = vol->backing_dev;
+	backing_io->iov = &md->flush_iov;
+	backing_io->iovcnt = 1;
+	backing_io->lba = (md->log_offset + log_index * REDUCE_MD_PAGE_SIZE) / vol->backing_dev->blocklen;
+	backing_io->lba_count = md->flush_iov.iov_len / vol->backing_dev->blocklen;
+	backing_io->backing_cb_args = &md->flush_cb_args;
+	backing_io->backing_io_type = SPDK_REDUCE_BACKING_IO_WRITE;
+
+	vol->backing_dev->submit_backing_io(backing_io);
+}
+
+/*
+ * Complete a request whose map updates have been passed to _reduce_persist().  With the maps on
+ *  the backing device, the request waits until its log entries are durable, and the chunk map it
+ *  replaced is only released then.  Otherwise its io units could be overwritten while the old
+ *  mapping is still the one that would be found after a crash.
+ */
+static void
+_reduce_vol_complete_persisted(struct spdk_reduce_vol_request *req, uint64_t old_chunk_map_index)
+{
+	struct spdk_reduce_vol *vol = req->vol;
+	struct reduce_md_log *md = vol->md_log;
+
+	if (md == NULL) {
+		if (old_chunk_map_index != REDUCE_EMPTY_MAP_ENTRY) {
+			_reduce_vol_reset_chunk(vol, old_chunk_map_index);
+		}
+		_reduce_vol_complete_req(req, 0);
+		return;
+	}
+
+	if (md->md_errno != 0) {
+		_reduce_vol_complete_req(req, md->md_errno);
+		return;
+	}
+
+	req->md_seq = md->open_seq;
+	req->old_chunk_map_index = old_chunk_map_index;
+	TAILQ_INSERT_TAIL(&md->waiters, req, tailq);
+	_reduce_md_log_flush(vol);
+}
+
+static void
+_reduce_md_ckpt_header_cpl(void *cb_arg, int reduce_errno)
+{
+	struct spdk_reduce_vol *vol = cb_arg;
+	struct reduce_md_log *md = vol->md_log;
+
+	md->ckpt_outstanding = 0;
+	if (reduce_errno == 0) {
+		md->ckpt_seq = md->ckpt_seq_target;
+	}
+
+	_reduce_md_ckpt_done(vol, reduce_errno);
+}
+
+static void
+_reduce_md_ckpt_write_header(struct spdk_reduce_vol *vol)
+{
+	struct reduce_md_log *md = vol->md_log;
+
+	memset(md->header, 0, sizeof(*md->header));
+	memcpy(md->header->signature, SPDK_REDUCE_MD_SIGNATURE, sizeof(md->header->signature));
+	md->header->ckpt_seq = md->ckpt_seq_target;
+	md->header->crc = _reduce_md_crc(md->header, &md->header->crc);
+
+	md->ckpt_outstanding = 1;
+	_reduce_md_io(vol, SPDK_REDUCE_BACKING_IO_WRITE, md->header, REDUCE_MD_HEADER_OFFSET,
+		      REDUCE_MD_PAGE_SIZE, _reduce_md_ckpt_header_cpl, vol);
+}
+
+static void
+_reduce_md_ckpt_page_cpl(void *cb_arg, int reduce_errno)
+{
+	struct spdk_reduce_vol *vol = cb_arg;
+	struct reduce_md_log *md = vol->md_log;
+
+	if (reduce_errno != 0) {
+		md->ckpt_errno = reduce_errno;
+	}
+
+	assert(md->ckpt_outstanding > 0);
+	if (--md->ckpt_outstanding > 0) {
+		return;
+	}
+
+	free(md->ckpt_io_mem);
+	free(md->ckpt_iov);
+	md->ckpt_io_mem = NULL;
+	md->ckpt_iov = NULL;
+
+	if (md->ckpt_errno != 0) {
+		_reduce_md_ckpt_done(vol, md->ckpt_errno);
+		return;
+	}
+
+	/* Only release the log once all map pages of the checkpoint are written. */
+	_reduce_md_ckpt_write_header(vol);
+}
+
+static void
+_reduce_md_ckpt_write_pages(struct spdk_reduce_vol *vol)
+{
+	struct reduce_md_log *md = vol->md_log;
+	struct spdk_reduce_backing_dev *backing_dev = vol->backing_dev;
+	struct spdk_reduce_backing_io *backing_io;
+	uint64_t i, start, num_runs = 0, run = 0;
+	uint32_t io_size;
+
+	for (i = 0; i < md->ckpt_num_pages; i++) {
+		if (i == 0 || md->ckpt_page_index[i] != md->ckpt_page_index[i - 1] + 1) {
+			num_runs++;
+		}
+	}
+
+	if (num_runs == 0) {
+		_reduce_md_ckpt_write_header(vol);
+		return;
+	}
+
+	io_size = sizeof(*backing_io) + backing_dev->user_ctx_size;
+	md->ckpt_io_mem = calloc(num_runs, io_size);
+	md->ckpt_iov = calloc(num_runs, sizeof(*md->ckpt_iov));
+	if (md->ckpt_io_mem == NULL || md->ckpt_iov == NULL) {
+		free(md->ckpt_io_mem);
+		free(md->ckpt_iov);
+		md->ckpt_io_mem = NULL;
+		md->ckpt_iov = NULL;
+		_reduce_md_ckpt_done(vol, -ENOMEM);
+		return;
+	}
+
+	md->ckpt_errno = 0;
+	md->ckpt_cb_args.cb_fn = _reduce_md_ckpt_page_cpl;
+	md->ckpt_cb_args.cb_arg = vol;
+	/* Hold an extra reference so that synchronous completions don't finish the checkpoint
+	 *  before all pages are submitted.
+	 */
+	md->ckpt_outstanding = 1;
+
+	/* Dirty pages that are next to each other in the image are written with a single IO. */
+	for (start = 0; start < md->ckpt_num_pages; start = i) {
+		for (i = start + 1; i < md->ckpt_num_pages; i++) {
+			if (md->ckpt_page_index[i] != md->ckpt_page_index[i - 1] + 1) {
+				break;
+			}
+		}
+
+		backing_io = (struct spdk_reduce_backing_io *)(md->ckpt_io_mem + run * io_size);
+		md->ckpt_iov[run].iov_base = md->ckpt_buf + start * REDUCE_MD_PAGE_SIZE;
+		md->ckpt_iov[run].iov_len = (i - start) * REDUCE_MD_PAGE_SIZE;
+
+		backing_io->dev = backing_dev;
+		backing_io->iov = &md->ckpt_iov[run];
+		backing_io->iovcnt = 1;
+		backing_io->lba = (md->map_offset + md->ckpt_page_index[start] * REDUCE_MD_PAGE_SIZE) /
+				  backing_dev->blocklen;
+		backing_io->lba_count = md->ckpt_iov[run].iov_len / backing_dev->blocklen;
+		backing_io->backing_cb_args = &md->ckpt_cb_args;
+		backing_io->backing_io_type = SPDK_REDUCE_BACKING_IO_WRITE;
+
+		md->ckpt_outstanding++;
+		run++;
+		backing_dev->submit_backing_io(backing_io);
+	}
+
+	_reduce_md_ckpt_page_cpl(vol, 0);
+}
+
+static void
+_reduce_md_ckpt_done(struct spdk_reduce_vol *vol, int reduce_errno)
+{
+	struct reduce_md_log *md = vol->md_log;
+	spdk_reduce_vol_op_complete cb_fn;
+	void *cb_arg;
+	uint64_t i;
+
+	if (reduce_errno != 0) {
+		SPDK_ERRLOG("metadata checkpoint failed: %s\n", spdk_strerror(-reduce_errno));
+		/* Write the pages again with the next checkpoint. */
+		for (i = 0; i < md->ckpt_num_pages; i++) {
+			_reduce_md_mark_dirty(md, md->ckpt_page_index[i] * REDUCE_MD_PAGE_SIZE,
+					      REDUCE_MD_PAGE_SIZE);
+		}
+	}
+
+	spdk_free(md->ckpt_buf);
+	free(md->ckpt_page_index);
+	md->ckpt_buf = NULL;
+	md->ckpt_page_index = NULL;
+	md->ckpt_num_pages = 0;
+	md->ckpt_in_progress = false;
+
+	if (md->ckpt_cb_armed) {
+		cb_fn = md->ckpt_cb_fn;
+		cb_arg = md->ckpt_cb_arg;
+		md->ckpt_cb_fn = NULL;
+		md->ckpt_cb_armed = false;
+		/* The callback may release the volume, so resume the log before calling it. */
+		_reduce_md_log_flush(vol);
+		cb_fn(cb_arg, reduce_errno);
+		return;
+	}
+
+	if (md->ckpt_cb_fn != NULL) {
+		_reduce_md_ckpt_start(vol);
+	} else if (reduce_errno == 0 && _reduce_md_ckpt_needed(md)) {
+		_reduce_md_ckpt_start(vol);
+	}
+
+	if (reduce_errno != 0) {
+		/* Don't retry right away, the next log write or checkpoint will. */
+		return;
+	}
+
+	/* Log writes may have been waiting for the checkpoint to release log pages. */
+	_reduce_md_log_flush(vol);
+}
+
+/*
+ * Start writing back the dirty map pages.  The pages are copied first, so that updates made
+ *  while the checkpoint is in progress don't end up on the backing device before their log
+ *  entries.  All entries that are part of the copy are flushed to the log before the first map
+ *  page is written, and the log pages up to them are released by updating the md header last.
+ */
+static void
+_reduce_md_ckpt_start(struct spdk_reduce_vol *vol)
+{
+	struct reduce_md_log *md = vol->md_log;
+	uint64_t num_pages = 0;
+	uint32_t page;
+
+	if (md->ckpt_in_progress || md->md_errno != 0) {
+		return;
+	}
+
+	md->ckpt_in_progress = true;
+	md->ckpt_cb_armed = md->ckpt_cb_fn != NULL;
+
+	if (md->open_offset != 0) {
+		_reduce_md_log_seal(md);
+	}
+	md->ckpt_seq_target = md->open_seq;
+
+	if (md->num_dirty_pages > 0) {
+		md->ckpt_buf = spdk_zmalloc(md->num_dirty_pages * REDUCE_MD_PAGE_SIZE, REDUCE_MD_PAGE_SIZE,
+					    NULL, SPDK_ENV_LCORE_ID_ANY, SPDK_MALLOC_DMA);
+		md->ckpt_page_index = calloc(md->num_dirty_pages, sizeof(*md->ckpt_page_index));
+		if (md->ckpt_buf == NULL || md->ckpt_page_index == NULL) {
+			_reduce_md_ckpt_done(vol, -ENOMEM);
+			return;
+		}
+
+		page = spdk_bit_array_find_first_set(md->dirty_pages, 0);
+		while (page != UINT32_MAX) {
+			memcpy(md->ckpt_buf + num_pages * REDUCE_MD_PAGE_SIZE,
+			       (uint8_t *)vol->pm_file.pm_buf + (uint64_t)page * REDUCE_MD_PAGE_SIZE,
+			       REDUCE_MD_PAGE_SIZE);
+			md->ckpt_page_index[num_pages++] = page;
+			spdk_bit_array_clear(md->dirty_pages, page);
+			page = spdk_bit_array_find_first_set(md->dirty_pages, page + 1);
+		}
+		assert(num_pages == md->num_dirty_pages);
+		md->ckpt_num_pages = num_pages;
+		md->num_dirty_pages = 0;
+	}
+
+	if (md->durable_seq >= md->ckpt_seq_target) {
+		_reduce_md_ckpt_write_pages(vol);
+	} else {
+		_reduce_md_log_flush(vol);
+	}
+}
+
+/* Write back all dirty map pages and call cb_fn once they are on the backing device. */
+static void
+_reduce_md_checkpoint(struct spdk_reduce_vol *vol, spdk_reduce_vol_op_complete cb_fn, void *cb_arg)
+{
+	struct reduce_md_log *md = vol->md_log;
+
+	if (md->md_errno != 0) {
+		cb_fn(cb_arg, md->md_errno);
+		return;
+	}
+
+	assert(md->ckpt_cb_fn == NULL);
+	md->ckpt_cb_fn = cb_fn;
+	md->ckpt_cb_arg = cb_arg;
+
+	/* If a checkpoint is already in progress, another one is started once it completes. */
+	_reduce_md_ckpt_start(vol);
+}
+
+static void
+_reduce_md_log_free(struct spdk_reduce_vol *vol)
+{
+	struct reduce_md_log *md = vol->md_log;
+
+	spdk_free(md->header);
+	spdk_free(md->buf);
+	spdk_free(md->load_buf);
+	spdk_free(md->ckpt_buf);
+	spdk_free(vol->pm_file.pm_buf);
+	free(md->ckpt_page_index);
+	free(md->ckpt_io_mem);
+	free(md->ckpt_iov);
+	free(md->flush_io);
+	free(md->md_io);
+	spdk_bit_array_free(&md->dirty_pages);
+	free(md);
+
+	vol->pm_file.pm_buf = NULL;
+	vol->md_log = NULL;
+}
+
+/* Set up the in-memory map image and the log for a volume whose params are already known. */
+static int
+_reduce_md_log_alloc(struct spdk_reduce_vol *vol)
+{
+	struct spdk_reduce_backing_dev *backing_dev = vol->backing_dev;
+	struct reduce_md_log *md;
+
+	if (REDUCE_MD_PAGE_SIZE % backing_dev->blocklen != 0 ||
+	    _get_md_log_buf_pages(&vol->params) == 0) {
+		SPDK_ERRLOG("metadata can't be kept on a backing device with these params\n");
+		return -EINVAL;
+	}
+
+	md = calloc(1, sizeof(*md));
+	if (md == NULL) {
+		return -ENOMEM;
+	}
+	vol->md_log = md;
+
+	TAILQ_INIT(&md->waiters);
+	md->buf_pages = _get_md_log_buf_pages(&vol->params);
+	md->log_pages = _get_md_log_pages(&vol->params);
+	md->log_offset = REDUCE_MD_HEADER_OFFSET + REDUCE_MD_PAGE_SIZE;
+	md->map_offset = md->log_offset + (uint64_t)md->log_pages * REDUCE_MD_PAGE_SIZE;
+	vol->pm_file.size = _get_pm_file_size(&vol->params);
+	md->map_pages = spdk_divide_round_up(vol->pm_file.size, REDUCE_MD_PAGE_SIZE);
+
+	md->header = spdk_zmalloc(sizeof(*md->header), REDUCE_MD_PAGE_SIZE, NULL,
+				  SPDK_ENV_LCORE_ID_ANY, SPDK_MALLOC_DMA);
+	md->buf = spdk_zmalloc(md->buf_pages * REDUCE_MD_PAGE_SIZE, REDUCE_MD_PAGE_SIZE, NULL,
+			       SPDK_ENV_LCORE_ID_ANY, SPDK_MALLOC_DMA);
+	vol->pm_file.pm_buf = spdk_zmalloc(md->map_pages * REDUCE_MD_PAGE_SIZE, REDUCE_MD_PAGE_SIZE,
+					   NULL, SPDK_ENV_LCORE_ID_ANY, SPDK_MALLOC_DMA);
+	md->dirty_pages = spdk_bit_array_create(md->map_pages);
+	md->flush_io = calloc(1, sizeof(*md->flush_io) + backing_dev->user_ctx_size);
+	md->md_io = calloc(1, sizeof(*md->md_io) + backing_dev->user_ctx_size);
+	if (md->header == NULL || md->buf == NULL || vol->pm_file.pm_buf == NULL ||
+	    md->dirty_pages == NULL || md->flush_io == NULL || md->md_io == NULL) {
+		_reduce_md_log_free(vol);
+		return -ENOMEM;
+	}
+
+	_reduce_md_log_open(md);
+
+	return 0;
+}
+
+static void
+_reduce_md_format_header_cpl(void *cb_arg, int reduce_errno)
+{
+	struct spdk_reduce_vol *vol = cb_arg;
+	struct reduce_md_log *md = vol->md_log;
+
+	md->op_cb_fn(md->op_cb_arg, reduce_errno);
+}
+
+static void
+_reduce_md_format_map_cpl(void *cb_arg, int reduce_errno)
+{
+	struct spdk_reduce_vol *vol = cb_arg;
+	struct reduce_md_log *md = vol->md_log;
+
+	if (reduce_errno != 0) {
+		md->op_cb_fn(md->op_cb_arg, reduce_errno);
+		return;
+	}
+
+	memcpy(md->header->signature, SPDK_REDUCE_MD_SIGNATURE, sizeof(md->header->signature));
+	md->header->ckpt_seq = md->ckpt_seq;
+	md->header->crc = _reduce_md_crc(md->header, &md->header->crc);
+	_reduce_md_io(vol, SPDK_REDUCE_BACKING_IO_WRITE, md->header, REDUCE_MD_HEADER_OFFSET,
+		      REDUCE_MD_PAGE_SIZE, _reduce_md_format_header_cpl, vol);
+}
+
+static void
+_reduce_md_format_log_cpl(void *cb_arg, int reduce_errno)
+{
+	struct spdk_reduce_vol *vol = cb_arg;
+	struct reduce_md_log *md = vol->md_log;
+
+	spdk_free(md->load_buf);
+	md->load_buf = NULL;
+
+	if (reduce_errno != 0) {
+		md->op_cb_fn(md->op_cb_arg, reduce_errno);
+		return;
+	}
+
+	_reduce_md_io(vol, SPDK_REDUCE_BACKING_IO_WRITE, vol->pm_file.pm_buf, md->map_offset,
+		      md->map_pages * REDUCE_MD_PAGE_SIZE, _reduce_md_format_map_cpl, vol);
 }
 
-static inline uint32_t
-_reduce_vol_get_chunk_struct_size(uint64_t backing_io_units_per_chunk)
+/*
+ * Write the initial metadata of a new volume: an empty log, the map image and finally the md
+ *  header.  The log is zeroed so that pages left over from a previous volume on the same backing
+ *  device are never replayed.
+ */
+static void
+_reduce_md_format(struct spdk_reduce_vol *vol, spdk_reduce_vol_op_complete cb_fn, void *cb_arg)
 {
-	return sizeof(struct spdk_reduce_chunk_map) + sizeof(uint64_t) * backing_io_units_per_chunk;
-}
+	struct reduce_md_log *md = vol->md_log;
 
-static uint64_t
-_get_pm_total_chunks_size(uint64_t vol_size, uint64_t chunk_size, uint64_t backing_io_unit_size)
-{
-	uint64_t io_units_per_chunk, num_chunks, total_chunks_size;
+	md->op_cb_fn = cb_fn;
+	md->op_cb_arg = cb_arg;
 
-	num_chunks = _get_total_chunks(vol_size, chunk_size);
-	io_units_per_chunk = chunk_size / backing_io_unit_size;
+	md->load_buf = spdk_zmalloc(md->log_pages * REDUCE_MD_PAGE_SIZE, REDUCE_MD_PAGE_SIZE, NULL,
+				    SPDK_ENV_LCORE_ID_ANY, SPDK_MALLOC_DMA);
+	if (md->load_buf == NULL) {
+		cb_fn(cb_arg, -ENOMEM);
+		return;
+	}
 
-	total_chunks_size = num_chunks * _reduce_vol_get_chunk_struct_size(io_units_per_chunk);
+	_reduce_md_io(vol, SPDK_REDUCE_BACKING_IO_WRITE, md->load_buf, md->log_offset,
+		      md->log_pages * REDUCE_MD_PAGE_SIZE, _reduce_md_format_log_cpl, vol);
+}
 
-	return spdk_divide_round_up(total_chunks_size, REDUCE_PM_SIZE_ALIGNMENT) *
-	       REDUCE_PM_SIZE_ALIGNMENT;
+static bool
+_reduce_md_log_page_is_valid(struct reduce_md_log_page *page)
+{
+	return memcmp(page->signature, SPDK_REDUCE_LOG_SIGNATURE, sizeof(page->signature)) == 0 &&
+	       page->crc == _reduce_md_crc(page, &page->crc);
 }
 
-static struct spdk_reduce_chunk_map *
-_reduce_vol_get_chunk_map(struct spdk_reduce_vol *vol, uint64_t chunk_map_index)
+static int
+_reduce_md_replay_page(struct spdk_reduce_vol *vol, struct reduce_md_log_page *page)
 {
-	uintptr_t chunk_map_addr;
+	struct reduce_md_log_entry *entry;
+	uint32_t i, offset = 0, entry_size;
 
-	assert(chunk_map_index < _get_total_chunks(vol->params.vol_size, vol->params.chunk_size));
+	for (i = 0; i < page->num_entries; i++) {
+		if (offset + sizeof(*entry) > sizeof(page->entries)) {
+			return -EILSEQ;
+		}
 
-	chunk_map_addr = (uintptr_t)vol->pm_chunk_maps;
-	chunk_map_addr += chunk_map_index *
-			  _reduce_vol_get_chunk_struct_size(vol->backing_io_units_per_chunk);
+		entry = (struct reduce_md_log_entry *)&page->entries[offset];
+		entry_size = _md_log_entry_size(entry->len);
+		if (entry->len == 0 || offset + entry_size > sizeof(page->entries) ||
+		    entry->offset < sizeof(struct spdk_reduce_vol_superblock) ||
+		    entry->offset + entry->len > vol->pm_file.size) {
+			return -EILSEQ;
+		}
 
-	return (struct spdk_reduce_chunk_map *)chunk_map_addr;
+		memcpy((uint8_t *)vol->pm_file.pm_buf + entry->offset, entry->data, entry->len);
+		_reduce_md_mark_dirty(vol->md_log, entry->offset, entry->len);
+		offset += entry_size;
+	}
+
+	return 0;
 }
 
+/*
+ * Apply the log pages written since the last checkpoint to the map image.  Log writes are
+ *  serialized and a request only completes once all log pages up to its own are durable, so
+ *  replay stops at the first page that is missing.
+ */
 static int
-_validate_vol_params(struct spdk_reduce_vol_params *params)
+_reduce_md_replay(struct spdk_reduce_vol *vol)
 {
-	if (params->vol_size > 0) {
-		/**
-		 * User does not pass in the vol size - it gets calculated by libreduce from
-		 *  values in this structure plus the size of the backing device.
-		 */
-		return -EINVAL;
-	}
+	struct reduce_md_log *md = vol->md_log;
+	struct reduce_md_log_page *page;
+	uint64_t seq, max_seq = 0;
+	uint32_t i;
+	bool found = false;
+	int rc;
 
-	if (params->chunk_size == 0 || params->backing_io_unit_size == 0 ||
-	    params->logical_block_size == 0) {
-		return -EINVAL;
+	for (i = 0; i < md->log_pages; i++) {
+		page = &md->load_buf[i];
+		if (_reduce_md_log_page_is_valid(page)) {
+			max_seq = found ? spdk_max(max_seq, page->seq) : page->seq;
+			found = true;
+		}
 	}
 
-	/* Chunk size must be an even multiple of the backing io unit size. */
-	if ((params->chunk_size % params->backing_io_unit_size) != 0) {
-		return -EINVAL;
+	seq = md->ckpt_seq;
+	for (i = 0; i < md->log_pages; i++, seq++) {
+		page = &md->load_buf[seq % md->log_pages];
+		if (!_reduce_md_log_page_is_valid(page) || page->seq != seq) {
+			break;
+		}
+
+		rc = _reduce_md_replay_page(vol, page);
+		if (rc != 0) {
+			return rc;
+		}
 	}
 
-	/* Chunk size must be an even multiple of the logical block size. */
-	if ((params->chunk_size % params->logical_block_size) != 0) {
-		return -1;
+	/* Pages past the first missing one were never acknowledged.  Don't reuse their sequence
+	 *  numbers, so that they can't be mistaken for new pages by a later replay.
+	 */
+	if (found && max_seq >= seq) {
+		seq = max_seq + 1;
 	}
 
+	md->open_seq = seq;
+	md->durable_seq = seq;
+	_reduce_md_log_open(md);
+
 	return 0;
 }
 
-static uint64_t
-_get_vol_size(uint64_t chunk_size, uint64_t backing_dev_size)
+static void
+_reduce_md_load_ckpt_cpl(void *cb_arg, int reduce_errno)
 {
-	uint64_t num_chunks;
+	struct spdk_reduce_vol *vol = cb_arg;
+	struct reduce_md_log *md = vol->md_log;
 
-	num_chunks = backing_dev_size / chunk_size;
-	if (num_chunks <= REDUCE_NUM_EXTRA_CHUNKS) {
-		return 0;
+	md->op_cb_fn(md->op_cb_arg, reduce_errno);
+}
+
+static void
+_reduce_md_load_log_cpl(void *cb_arg, int reduce_errno)
+{
+	struct spdk_reduce_vol *vol = cb_arg;
+	struct reduce_md_log *md = vol->md_log;
+	int rc = reduce_errno;
+
+	if (rc == 0) {
+		rc = _reduce_md_replay(vol);
 	}
 
-	num_chunks -= REDUCE_NUM_EXTRA_CHUNKS;
-	return num_chunks * chunk_size;
+	spdk_free(md->load_buf);
+	md->load_buf = NULL;
+
+	if (rc != 0) {
+		md->op_cb_fn(md->op_cb_arg, rc);
+		return;
+	}
+
+	if (md->num_dirty_pages == 0 && md->open_seq == md->ckpt_seq) {
+		md->op_cb_fn(md->op_cb_arg, 0);
+		return;
+	}
+
+	/* Persist the replayed state and move the log past all pages found on the backing device. */
+	_reduce_md_checkpoint(vol, _reduce_md_load_ckpt_cpl, vol);
 }
 
-static uint64_t
-_get_pm_file_size(struct spdk_reduce_vol_params *params)
+static void
+_reduce_md_load_map_cpl(void *cb_arg, int reduce_errno)
 {
-	uint64_t total_pm_size;
+	struct spdk_reduce_vol *vol = cb_arg;
+	struct reduce_md_log *md = vol->md_log;
 
-	total_pm_size = sizeof(struct spdk_reduce_vol_superblock);
-	total_pm_size += _get_pm_logical_map_size(params->vol_size, params->chunk_size);
-	total_pm_size += _get_pm_total_chunks_size(params->vol_size, params->chunk_size,
-			 params->backing_io_unit_size);
-	return total_pm_size;
+	if (reduce_errno != 0) {
+		md->op_cb_fn(md->op_cb_arg, reduce_errno);
+		return;
+	}
+
+	md->load_buf = spdk_zmalloc(md->log_pages * REDUCE_MD_PAGE_SIZE, REDUCE_MD_PAGE_SIZE, NULL,
+				    SPDK_ENV_LCORE_ID_ANY, SPDK_MALLOC_DMA);
+	if (md->load_buf == NULL) {
+		md->op_cb_fn(md->op_cb_arg, -ENOMEM);
+		return;
+	}
+
+	_reduce_md_io(vol, SPDK_REDUCE_BACKING_IO_READ, md->load_buf, md->log_offset,
+		      md->log_pages * REDUCE_MD_PAGE_SIZE, _reduce_md_load_log_cpl, vol);
 }
 
-const struct spdk_uuid *
-spdk_reduce_vol_get_uuid(struct spdk_reduce_vol *vol)
+static void
+_reduce_md_load_header_cpl(void *cb_arg, int reduce_errno)
 {
-	return &vol->params.uuid;
+	struct spdk_reduce_vol *vol = cb_arg;
+	struct reduce_md_log *md = vol->md_log;
+
+	if (reduce_errno != 0) {
+		md->op_cb_fn(md->op_cb_arg, reduce_errno);
+		return;
+	}
+
+	if (memcmp(md->header->signature, SPDK_REDUCE_MD_SIGNATURE,
+		   sizeof(md->header->signature)) != 0 ||
+	    md->header->crc != _reduce_md_crc(md->header, &md->header->crc)) {
+		SPDK_ERRLOG("invalid metadata header on backing device\n");
+		md->op_cb_fn(md->op_cb_arg, -EILSEQ);
+		return;
+	}
+
+	md->ckpt_seq = md->header->ckpt_seq;
+	_reduce_md_io(vol, SPDK_REDUCE_BACKING_IO_READ, vol->pm_file.pm_buf, md->map_offset,
+		      md->map_pages * REDUCE_MD_PAGE_SIZE, _reduce_md_load_map_cpl, vol);
 }
 
+/* Read the map image from the backing device and replay the log on top of it. */
 static void
-_initialize_vol_pm_pointers(struct spdk_reduce_vol *vol)
+_reduce_md_load(struct spdk_reduce_vol *vol, spdk_reduce_vol_op_complete cb_fn, void *cb_arg)
 {
-	uint64_t logical_map_size;
-
-	/* Superblock is at the beginning of the pm file. */
-	vol->pm_super = (struct spdk_reduce_vol_superblock *)vol->pm_file.pm_buf;
+	struct reduce_md_log *md = vol->md_log;
 
-	/* Logical map immediately follows the super block. */
-	vol->pm_logical_map = (uint64_t *)(vol->pm_super + 1);
+	md->op_cb_fn = cb_fn;
+	md->op_cb_arg = cb_arg;
 
-	/* Chunks maps follow the logical map. */
-	logical_map_size = _get_pm_logical_map_size(vol->params.vol_size, vol->params.chunk_size);
-	vol->pm_chunk_maps = (uint64_t *)((uint8_t *)vol->pm_logical_map + logical_map_size);
+	_reduce_md_io(vol, SPDK_REDUCE_BACKING_IO_READ, md->header, REDUCE_MD_HEADER_OFFSET,
+		      REDUCE_MD_PAGE_SIZE, _reduce_md_load_header_cpl, vol);
 }
 
 /* We need 2 iovs during load - one for the superblock, another for the path */
@@ -480,7 +1575,9 @@ _init_load_cleanup(struct spdk_reduce_vol *vol, struct reduce_init_load_ctx *ctx
 	}
 
 	if (vol != NULL) {
-		if (vol->pm_file.pm_buf != NULL) {
+		if (vol->md_log != NULL) {
+			_reduce_md_log_free(vol);
+		} else if (vol->pm_file.pm_buf != NULL) {
 			pmem_unmap(vol->pm_file.pm_buf, vol->pm_file.size);
 		}
 
@@ -516,6 +1613,8 @@ _alloc_zero_buff(void)
 	return rc;
 }
 
+static void _init_write_path_cpl(void *cb_arg, int reduce_errno);
+
 static void
 _init_write_super_cpl(void *cb_arg, int reduce_errno)
 {
@@ -545,7 +1644,7 @@ _init_write_super_cpl(void *cb_arg, int reduce_errno)
 
 	return;
 err:
-	if (unlink(init_ctx->path)) {
+	if (((char *)init_ctx->path)[0] != '\0' && unlink(init_ctx->path)) {
 		SPDK_ERRLOG("%s could not be unlinked: %s\n",
 			    (char *)init_ctx->path, spdk_strerror(errno));
 	}
@@ -554,6 +1653,47 @@ err:
 	_init_load_cleanup(init_ctx->vol, init_ctx);
 }
 
+static void
+_init_write_path(struct reduce_init_load_ctx *init_ctx)
+{
+	struct spdk_reduce_vol *vol = init_ctx->vol;
+	struct spdk_reduce_backing_io *backing_io = init_ctx->backing_io;
+
+	memcpy(init_ctx->path, vol->pm_file.path, REDUCE_PATH_MAX);
+	init_ctx->iov[0].iov_base = init_ctx->path;
+	init_ctx->iov[0].iov_len = REDUCE_PATH_MAX;
+	init_ctx->backing_cb_args.cb_fn = _init_write_path_cpl;
+	init_ctx->backing_cb_args.cb_arg = init_ctx;
+	/* Write path to offset 4K on backing device - just after where the super
+	 *  block will be written.  We wait until this is committed before writing the
+	 *  super block to guarantee we don't get the super block written without the
+	 *  the path if the system crashed in the middle of a write operation.
+	 */
+	backing_io->dev = vol->backing_dev;
+	backing_io->iov = init_ctx->iov;
+	backing_io->iovcnt = 1;
+	backing_io->lba = REDUCE_BACKING_DEV_PATH_OFFSET / vol->backing_dev->blocklen;
+	backing_io->lba_count = REDUCE_PATH_MAX / vol->backing_dev->blocklen;
+	backing_io->backing_cb_args = &init_ctx->backing_cb_args;
+	backing_io->backing_io_type = SPDK_REDUCE_BACKING_IO_WRITE;
+
+	vol->backing_dev->submit_backing_io(backing_io);
+}
+
+static void
+_init_md_format_cpl(void *cb_arg, int reduce_errno)
+{
+	struct reduce_init_load_ctx *init_ctx = cb_arg;
+
+	if (reduce_errno != 0) {
+		_init_write_super_cpl(init_ctx, reduce_errno);
+		return;
+	}
+
+	/* The metadata is in place, the path and superblock make the volume valid. */
+	_init_write_path(init_ctx);
+}
+
 static void
 _init_write_path_cpl(void *cb_arg, int reduce_errno)
 {
@@ -592,6 +1732,14 @@ _allocate_bit_arrays(struct spdk_reduce_vol *vol)
 	vol->allocated_chunk_maps = spdk_bit_array_create(total_chunks);
 	vol->find_chunk_offset = 0;
 	total_backing_io_units = total_chunks * (vol->params.chunk_size / vol->params.backing_io_unit_size);
+	if (vol->md_log != NULL) {
+		/* The vol size already left room for the maps and the log on the backing device. */
+		num_metadata_io_units = _get_md_size(&vol->params) / vol->params.backing_io_unit_size;
+		total_backing_io_units += num_metadata_io_units;
+	} else {
+		num_metadata_io_units = (sizeof(*vol->backing_super) + REDUCE_PATH_MAX) /
+					vol->params.backing_io_unit_size;
+	}
 	vol->allocated_backing_io_units = spdk_bit_array_create(total_backing_io_units);
 	vol->find_block_offset = 0;
 
@@ -600,8 +1748,6 @@ _allocate_bit_arrays(struct spdk_reduce_vol *vol)
 	}
 
 	/* Set backing io unit bits associated with metadata. */
-	num_metadata_io_units = (sizeof(*vol->backing_super) + REDUCE_PATH_MAX) /
-				vol->params.backing_io_unit_size;
 	for (i = 0; i < num_metadata_io_units; i++) {
 		spdk_bit_array_set(vol->allocated_backing_io_units, i);
 		vol->info.allocated_io_units++;
@@ -628,25 +1774,27 @@ spdk_reduce_vol_init(struct spdk_reduce_vol_params *params,
 	struct spdk_reduce_vol *vol;
 	struct reduce_init_load_ctx *init_ctx;
 	struct spdk_reduce_backing_io *backing_io;
-	uint64_t backing_dev_size;
+	uint64_t backing_dev_size, md_size;
 	size_t mapped_len;
-	int dir_len, max_dir_len, rc;
+	int dir_len = 0, max_dir_len, rc;
 
-	/* We need to append a path separator and the UUID to the supplied
-	 * path.
-	 */
-	max_dir_len = REDUCE_PATH_MAX - SPDK_UUID_STRING_LEN - 1;
-	dir_len = strnlen(pm_file_dir, max_dir_len);
-	/* Strip trailing slash if the user provided one - we will add it back
-	 * later when appending the filename.
-	 */
-	if (pm_file_dir[dir_len - 1] == '/') {
-		dir_len--;
-	}
-	if (dir_len == max_dir_len) {
-		SPDK_ERRLOG("pm_file_dir (%s) too long\n", pm_file_dir);
-		cb_fn(cb_arg, NULL, -EINVAL);
-		return;
+	if (pm_file_dir != NULL) {
+		/* We need to append a path separator and the UUID to the supplied
+		 * path.
+		 */
+		max_dir_len = REDUCE_PATH_MAX - SPDK_UUID_STRING_LEN - 1;
+		dir_len = strnlen(pm_file_dir, max_dir_len);
+		/* Strip trailing slash if the user provided one - we will add it back
+		 * later when appending the filename.
+		 */
+		if (pm_file_dir[dir_len - 1] == '/') {
+			dir_len--;
+		}
+		if (dir_len == max_dir_len) {
+			SPDK_ERRLOG("pm_file_dir (%s) too long\n", pm_file_dir);
+			cb_fn(cb_arg, NULL, -EINVAL);
+			return;
+		}
 	}
 
 	rc = _validate_vol_params(params);
@@ -658,6 +1806,14 @@ spdk_reduce_vol_init(struct spdk_reduce_vol_params *params,
 
 	backing_dev_size = backing_dev->blockcnt * backing_dev->blocklen;
 	params->vol_size = _get_vol_size(params->chunk_size, backing_dev_size);
+	if (pm_file_dir == NULL && params->vol_size > 0) {
+		/* The maps shrink with the vol size, so they still fit in front of a volume that is
+		 *  sized for the remaining space.
+		 */
+		md_size = _get_md_size(params);
+		params->vol_size = md_size < backing_dev_size ?
+				   _get_vol_size(params->chunk_size, backing_dev_size - md_size) : 0;
+	}
 	if (params->vol_size == 0) {
 		SPDK_ERRLOG("backing device is too small\n");
 		cb_fn(cb_arg, NULL, -EINVAL);
@@ -717,28 +1873,30 @@ spdk_reduce_vol_init(struct spdk_reduce_vol_params *params,
 		spdk_uuid_generate(&params->uuid);
 	}
 
-	memcpy(vol->pm_file.path, pm_file_dir, dir_len);
-	vol->pm_file.path[dir_len] = '/';
-	spdk_uuid_fmt_lower(&vol->pm_file.path[dir_len + 1], SPDK_UUID_STRING_LEN,
-			    &params->uuid);
-	vol->pm_file.size = _get_pm_file_size(params);
-	vol->pm_file.pm_buf = pmem_map_file(vol->pm_file.path, vol->pm_file.size,
-					    PMEM_FILE_CREATE | PMEM_FILE_EXCL, 0600,
-					    &mapped_len, &vol->pm_file.pm_is_pmem);
-	if (vol->pm_file.pm_buf == NULL) {
-		SPDK_ERRLOG("could not pmem_map_file(%s): %s\n",
-			    vol->pm_file.path, strerror(errno));
-		cb_fn(cb_arg, NULL, -errno);
-		_init_load_cleanup(vol, init_ctx);
-		return;
-	}
+	if (pm_file_dir != NULL) {
+		memcpy(vol->pm_file.path, pm_file_dir, dir_len);
+		vol->pm_file.path[dir_len] = '/';
+		spdk_uuid_fmt_lower(&vol->pm_file.path[dir_len + 1], SPDK_UUID_STRING_LEN,
+				    &params->uuid);
+		vol->pm_file.size = _get_pm_file_size(params);
+		vol->pm_file.pm_buf = pmem_map_file(vol->pm_file.path, vol->pm_file.size,
+						    PMEM_FILE_CREATE | PMEM_FILE_EXCL, 0600,
+						    &mapped_len, &vol->pm_file.pm_is_pmem);
+		if (vol->pm_file.pm_buf == NULL) {
+			SPDK_ERRLOG("could not pmem_map_file(%s): %s\n",
+				    vol->pm_file.path, strerror(errno));
+			cb_fn(cb_arg, NULL, -errno);
+			_init_load_cleanup(vol, init_ctx);
+			return;
+		}
 
-	if (vol->pm_file.size != mapped_len) {
-		SPDK_ERRLOG("could not map entire pmem file (size=%" PRIu64 " mapped=%" PRIu64 ")\n",
-			    vol->pm_file.size, mapped_len);
-		cb_fn(cb_arg, NULL, -ENOMEM);
-		_init_load_cleanup(vol, init_ctx);
-		return;
+		if (vol->pm_file.size != mapped_len) {
+			SPDK_ERRLOG("could not map entire pmem file (size=%" PRIu64 " mapped=%" PRIu64 ")\n",
+				    vol->pm_file.size, mapped_len);
+			cb_fn(cb_arg, NULL, -ENOMEM);
+			_init_load_cleanup(vol, init_ctx);
+			return;
+		}
 	}
 
 	vol->backing_io_units_per_chunk = params->chunk_size / params->backing_io_unit_size;
@@ -748,6 +1906,15 @@ spdk_reduce_vol_init(struct spdk_reduce_vol_params *params,
 
 	vol->backing_dev = backing_dev;
 
+	if (pm_file_dir == NULL) {
+		rc = _reduce_md_log_alloc(vol);
+		if (rc != 0) {
+			cb_fn(cb_arg, NULL, rc);
+			_init_load_cleanup(vol, init_ctx);
+			return;
+		}
+	}
+
 	rc = _allocate_bit_arrays(vol);
 	if (rc != 0) {
 		cb_fn(cb_arg, NULL, rc);
@@ -758,6 +1925,8 @@ spdk_reduce_vol_init(struct spdk_reduce_vol_params *params,
 	memcpy(vol->backing_super->signature, SPDK_REDUCE_SIGNATURE,
 	       sizeof(vol->backing_super->signature));
 	memcpy(&vol->backing_super->params, params, sizeof(*params));
+	vol->backing_super->md_type = vol->md_log != NULL ? REDUCE_MD_TYPE_BACKING_DEV :
+				      REDUCE_MD_TYPE_PM_FILE;
 
 	_initialize_vol_pm_pointers(vol);
 
@@ -766,45 +1935,74 @@ spdk_reduce_vol_init(struct spdk_reduce_vol_params *params,
 	 * Note that this writes 0xFF to not just the logical map but the chunk maps as well.
 	 */
 	memset(vol->pm_logical_map, 0xFF, vol->pm_file.size - sizeof(*vol->backing_super));
-	_reduce_persist(vol, vol->pm_file.pm_buf, vol->pm_file.size);
 
 	init_ctx->vol = vol;
 	init_ctx->cb_fn = cb_fn;
 	init_ctx->cb_arg = cb_arg;
 
-	memcpy(init_ctx->path, vol->pm_file.path, REDUCE_PATH_MAX);
-	init_ctx->iov[0].iov_base = init_ctx->path;
-	init_ctx->iov[0].iov_len = REDUCE_PATH_MAX;
-	init_ctx->backing_cb_args.cb_fn = _init_write_path_cpl;
-	init_ctx->backing_cb_args.cb_arg = init_ctx;
-	/* Write path to offset 4K on backing device - just after where the super
-	 *  block will be written.  We wait until this is committed before writing the
-	 *  super block to guarantee we don't get the super block written without the
-	 *  the path if the system crashed in the middle of a write operation.
+	if (vol->md_log != NULL) {
+		_reduce_md_format(vol, _init_md_format_cpl, init_ctx);
+		return;
+	}
+
+	_reduce_persist(vol, vol->pm_file.pm_buf, vol->pm_file.size);
+	_init_write_path(init_ctx);
+}
+
+static void destroy_load_cb(void *cb_arg, struct spdk_reduce_vol *vol, int reduce_errno);
+
+static void
+_load_allocated_maps(struct reduce_init_load_ctx *load_ctx)
+{
+	struct spdk_reduce_vol *vol = load_ctx->vol;
+	uint64_t i, num_chunks, logical_map_index;
+	struct spdk_reduce_chunk_map *chunk;
+	uint32_t j;
+
+	num_chunks = vol->params.vol_size / vol->params.chunk_size;
+	for (i = 0; i < num_chunks; i++) {
+		logical_map_index = vol->pm_logical_map[i];
+		if (logical_map_index == REDUCE_EMPTY_MAP_ENTRY) {
+			continue;
+		}
+		spdk_bit_array_set(vol->allocated_chunk_maps, logical_map_index);
+		chunk = _reduce_vol_get_chunk_map(vol, logical_map_index);
+		for (j = 0; j < vol->backing_io_units_per_chunk; j++) {
+			if (chunk->io_unit_index[j] != REDUCE_EMPTY_MAP_ENTRY) {
+				spdk_bit_array_set(vol->allocated_backing_io_units, chunk->io_unit_index[j]);
+				vol->info.allocated_io_units++;
+			}
+		}
+	}
+
+	load_ctx->cb_fn(load_ctx->cb_arg, vol, 0);
+	/* Only clean up the ctx - the vol has been passed to the application
+	 *  for use now that volume load was successful.
 	 */
-	backing_io->dev = vol->backing_dev;
-	backing_io->iov = init_ctx->iov;
-	backing_io->iovcnt = 1;
-	backing_io->lba = REDUCE_BACKING_DEV_PATH_OFFSET / vol->backing_dev->blocklen;
-	backing_io->lba_count = REDUCE_PATH_MAX / vol->backing_dev->blocklen;
-	backing_io->backing_cb_args = &init_ctx->backing_cb_args;
-	backing_io->backing_io_type = SPDK_REDUCE_BACKING_IO_WRITE;
+	_init_load_cleanup(NULL, load_ctx);
+}
+
+static void
+_load_md_cpl(void *cb_arg, int reduce_errno)
+{
+	struct reduce_init_load_ctx *load_ctx = cb_arg;
+
+	if (reduce_errno != 0) {
+		load_ctx->cb_fn(load_ctx->cb_arg, NULL, reduce_errno);
+		_init_load_cleanup(load_ctx->vol, load_ctx);
+		return;
+	}
 
-	vol->backing_dev->submit_backing_io(backing_io);
+	_load_allocated_maps(load_ctx);
 }
 
-static void destroy_load_cb(void *cb_arg, struct spdk_reduce_vol *vol, int reduce_errno);
-
 static void
 _load_read_super_and_path_cpl(void *cb_arg, int reduce_errno)
 {
 	struct reduce_init_load_ctx *load_ctx = cb_arg;
 	struct spdk_reduce_vol *vol = load_ctx->vol;
 	uint64_t backing_dev_size;
-	uint64_t i, num_chunks, logical_map_index;
-	struct spdk_reduce_chunk_map *chunk;
 	size_t mapped_len;
-	uint32_t j;
 	int rc;
 
 	if (reduce_errno != 0) {
@@ -842,6 +2040,17 @@ _load_read_super_and_path_cpl(void *cb_arg, int reduce_errno)
 	vol->logical_blocks_per_chunk = vol->params.chunk_size / vol->params.logical_block_size;
 	vol->backing_lba_per_io_unit = vol->params.backing_io_unit_size / vol->backing_dev->blocklen;
 
+	if (vol->backing_super->md_type == REDUCE_MD_TYPE_BACKING_DEV) {
+		rc = _reduce_md_log_alloc(vol);
+		if (rc != 0) {
+			goto error;
+		}
+	} else if (vol->backing_super->md_type != REDUCE_MD_TYPE_PM_FILE) {
+		SPDK_ERRLOG("unknown metadata type %" PRIu32 "\n", vol->backing_super->md_type);
+		rc = -EILSEQ;
+		goto error;
+	}
+
 	rc = _allocate_bit_arrays(vol);
 	if (rc != 0) {
 		goto error;
@@ -855,6 +2064,17 @@ _load_read_super_and_path_cpl(void *cb_arg, int reduce_errno)
 		goto error;
 	}
 
+	if (vol->md_log != NULL) {
+		rc = _allocate_vol_requests(vol);
+		if (rc != 0) {
+			goto error;
+		}
+
+		_initialize_vol_pm_pointers(vol);
+		_reduce_md_load(vol, _load_md_cpl, load_ctx);
+		return;
+	}
+
 	vol->pm_file.size = _get_pm_file_size(&vol->params);
 	vol->pm_file.pm_buf = pmem_map_file(vol->pm_file.path, 0, 0, 0, &mapped_len,
 					    &vol->pm_file.pm_is_pmem);
@@ -877,28 +2097,7 @@ _load_read_super_and_path_cpl(void *cb_arg, int reduce_errno)
 	}
 
 	_initialize_vol_pm_pointers(vol);
-
-	num_chunks = vol->params.vol_size / vol->params.chunk_size;
-	for (i = 0; i < num_chunks; i++) {
-		logical_map_index = vol->pm_logical_map[i];
-		if (logical_map_index == REDUCE_EMPTY_MAP_ENTRY) {
-			continue;
-		}
-		spdk_bit_array_set(vol->allocated_chunk_maps, logical_map_index);
-		chunk = _reduce_vol_get_chunk_map(vol, logical_map_index);
-		for (j = 0; j < vol->backing_io_units_per_chunk; j++) {
-			if (chunk->io_unit_index[j] != REDUCE_EMPTY_MAP_ENTRY) {
-				spdk_bit_array_set(vol->allocated_backing_io_units, chunk->io_unit_index[j]);
-				vol->info.allocated_io_units++;
-			}
-		}
-	}
-
-	load_ctx->cb_fn(load_ctx->cb_arg, vol, 0);
-	/* Only clean up the ctx - the vol has been passed to the application
-	 *  for use now that volume load was successful.
-	 */
-	_init_load_cleanup(NULL, load_ctx);
+	_load_allocated_maps(load_ctx);
 	return;
 
 error:
@@ -988,10 +2187,37 @@ spdk_reduce_vol_load(struct spdk_reduce_backing_dev *backing_dev,
 	vol->backing_dev->submit_backing_io(backing_io);
 }
 
+static void
+_unload_cleanup(struct spdk_reduce_vol *vol)
+{
+	if (--g_vol_count == 0) {
+		spdk_free(g_zero_buf);
+	}
+	assert(g_vol_count >= 0);
+	_init_load_cleanup(vol, NULL);
+}
+
+static void
+_unload_md_ckpt_cpl(void *cb_arg, int reduce_errno)
+{
+	struct spdk_reduce_vol *vol = cb_arg;
+	spdk_reduce_vol_op_complete cb_fn = vol->md_log->op_cb_fn;
+	void *_cb_arg = vol->md_log->op_cb_arg;
+
+	if (reduce_errno != 0) {
+		SPDK_ERRLOG("failed to write back metadata on unload: %s\n", spdk_strerror(-reduce_errno));
+	}
+
+	_unload_cleanup(vol);
+	cb_fn(_cb_arg, reduce_errno);
+}
+
 void
 spdk_reduce_vol_unload(struct spdk_reduce_vol *vol,
 		       spdk_reduce_vol_op_complete cb_fn, void *cb_arg)
 {
+	struct reduce_md_log *md;
+
 	if (vol == NULL) {
 		/* This indicates a programming error. */
 		assert(false);
@@ -999,11 +2225,17 @@ spdk_reduce_vol_unload(struct spdk_reduce_vol *vol,
 		return;
 	}
 
-	if (--g_vol_count == 0) {
-		spdk_free(g_zero_buf);
+	md = vol->md_log;
+	if (md != NULL && (md->num_dirty_pages > 0 || md->open_seq != md->ckpt_seq ||
+			   md->open_offset != 0)) {
+		/* Write back the maps so that the next load doesn't have to replay the log. */
+		md->op_cb_fn = cb_fn;
+		md->op_cb_arg = cb_arg;
+		_reduce_md_checkpoint(vol, _unload_md_ckpt_cpl, vol);
+		return;
 	}
-	assert(g_vol_count >= 0);
-	_init_load_cleanup(vol, NULL);
+
+	_unload_cleanup(vol);
 	cb_fn(cb_arg, 0);
 }
 
@@ -1024,7 +2256,7 @@ destroy_unload_cpl(void *cb_arg, int reduce_errno)
 {
 	struct reduce_destroy_ctx *destroy_ctx = cb_arg;
 
-	if (destroy_ctx->reduce_errno == 0) {
+	if (destroy_ctx->reduce_errno == 0 && destroy_ctx->pm_path[0] != '\0') {
 		if (unlink(destroy_ctx->pm_path)) {
 			SPDK_ERRLOG("%s could not be unlinked: %s\n",
 				    destroy_ctx->pm_path, strerror(errno));
@@ -1190,21 +2422,11 @@ _reduce_vol_reset_chunk(struct spdk_reduce_vol *vol, uint64_t chunk_map_index)
 }
 
 static void
-_write_write_done(void *_req, int reduce_errno)
+_write_write_finish(struct spdk_reduce_vol_request *req)
 {
-	struct spdk_reduce_vol_request *req = _req;
 	struct spdk_reduce_vol *vol = req->vol;
 	uint64_t old_chunk_map_index;
 
-	if (reduce_errno != 0) {
-		req->reduce_errno = reduce_errno;
-	}
-
-	assert(req->num_backing_ops > 0);
-	if (--req->num_backing_ops > 0) {
-		return;
-	}
-
 	if (req->reduce_errno != 0) {
 		_reduce_vol_reset_chunk(vol, req->chunk_map_index);
 		_reduce_vol_complete_req(req, req->reduce_errno);
@@ -1212,15 +2434,6 @@ _write_write_done(void *_req, int reduce_errno)
 	}
 
 	old_chunk_map_index = vol->pm_logical_map[req->logical_map_index];
-	if (old_chunk_map_index != REDUCE_EMPTY_MAP_ENTRY) {
-		_reduce_vol_reset_chunk(vol, old_chunk_map_index);
-	}
-
-	/*
-	 * We don't need to persist the clearing of the old chunk map here.  The old chunk map
-	 * becomes invalid after we update the logical map, since the old chunk map will no
-	 * longer have a reference to it in the logical map.
-	 */
 
 	/* Persist the new chunk map.  This must be persisted before we update the logical map. */
 	_reduce_persist(vol, req->chunk,
@@ -1230,7 +2443,51 @@ _write_write_done(void *_req, int reduce_errno)
 
 	_reduce_persist(vol, &vol->pm_logical_map[req->logical_map_index], sizeof(uint64_t));
 
-	_reduce_vol_complete_req(req, 0);
+	/*
+	 * We don't need to persist the clearing of the old chunk map.  The old chunk map
+	 * becomes invalid after we update the logical map, since the old chunk map will no
+	 * longer have a reference to it in the logical map.
+	 */
+	_reduce_vol_complete_persisted(req, old_chunk_map_index);
+}
+
+static void
+_write_write_done(void *_req, int reduce_errno)
+{
+	struct spdk_reduce_vol_request *req = _req;
+
+	if (reduce_errno != 0) {
+		req->reduce_errno = reduce_errno;
+	}
+
+	assert(req->num_backing_ops > 0);
+	if (--req->num_backing_ops > 0) {
+		return;
+	}
+
+	_write_write_finish(req);
+}
+
+static void
+_write_batch_write_done(void *_req, int reduce_errno)
+{
+	struct spdk_reduce_vol_request *parent = _req;
+	struct spdk_reduce_vol_request *req, *tmp;
+
+	if (reduce_errno != 0) {
+		parent->reduce_errno = reduce_errno;
+	}
+
+	assert(parent->num_backing_ops > 0);
+	if (--parent->num_backing_ops > 0) {
+		return;
+	}
+
+	/* Completing the last child releases the parent, so don't touch it afterwards. */
+	TAILQ_FOREACH_SAFE(req, &parent->children, child_tailq, tmp) {
+		req->reduce_errno = parent->reduce_errno;
+		_write_write_finish(req);
+	}
 }
 
 static struct spdk_reduce_backing_io *
@@ -1290,13 +2547,102 @@ _issue_backing_ops_without_merge(struct spdk_reduce_vol_request *req, struct spd
 	}
 }
 
+/* Write the chunks of all children of a multi-chunk write.  Io units that are contiguous on the
+ * backing device are merged into a single backing IO, even across chunks of different children.
+ */
+static void
+_issue_batch_backing_ops(struct spdk_reduce_vol_request *parent, struct spdk_reduce_vol *vol,
+			 reduce_request_fn next_fn)
+{
+	struct spdk_reduce_backing_io *ios[REDUCE_MAX_BATCH_CHUNKS * REDUCE_MAX_MERGED_IO_UNITS];
+	struct spdk_reduce_vol_request *reqs[REDUCE_MAX_BATCH_CHUNKS];
+	uint32_t num_io_units[REDUCE_MAX_BATCH_CHUNKS];
+	struct spdk_reduce_backing_io *backing_io = NULL;
+	struct spdk_reduce_vol_request *req;
+	struct iovec *iov = parent->split_iov;
+	uint64_t io_unit_index, prev_io_unit_index = REDUCE_EMPTY_MAP_ENTRY;
+	uint32_t num_reqs = 0, num_io = 0, iovcnt = 0;
+	uint32_t i, j;
+	uint8_t *buf;
+	bool merge;
+
+	merge = vol->backing_io_units_per_chunk <= REDUCE_MAX_MERGED_IO_UNITS;
+
+	TAILQ_FOREACH(req, &parent->children, child_tailq) {
+		reqs[num_reqs] = req;
+		num_io_units[num_reqs] = req->num_io_units;
+		num_reqs++;
+
+		if (req->chunk_is_compressed) {
+			buf = req->comp_buf;
+		} else {
+			buf = req->decomp_buf;
+		}
+
+		for (i = 0; i < req->num_io_units; i++) {
+			io_unit_index = req->chunk->io_unit_index[i];
+			if (merge && backing_io != NULL && io_unit_index == prev_io_unit_index + 1) {
+				if (i == 0) {
+					/* The IO continues into the next chunk's buffer */
+					iov[iovcnt].iov_base = buf;
+					iov[iovcnt].iov_len = vol->params.backing_io_unit_size;
+					iovcnt++;
+					backing_io->iovcnt++;
+				} else {
+					iov[iovcnt - 1].iov_len += vol->params.backing_io_unit_size;
+				}
+				backing_io->lba_count += vol->backing_lba_per_io_unit;
+				prev_io_unit_index = io_unit_index;
+				continue;
+			}
+
+			backing_io = _reduce_vol_req_get_backing_io(req, i);
+			if (merge) {
+				ios[num_io] = backing_io;
+				backing_io->iov = &iov[iovcnt++];
+			} else if (req->chunk_is_compressed) {
+				backing_io->iov = &req->comp_buf_iov[i];
+			} else {
+				backing_io->iov = &req->decomp_buf_iov[i];
+			}
+			backing_io->iov->iov_base = buf + i * vol->params.backing_io_unit_size;
+			backing_io->iov->iov_len = vol->params.backing_io_unit_size;
+			backing_io->dev = vol->backing_dev;
+			backing_io->iovcnt = 1;
+			backing_io->lba = io_unit_index * vol->backing_lba_per_io_unit;
+			backing_io->lba_count = vol->backing_lba_per_io_unit;
+			backing_io->backing_cb_args = &parent->backing_cb_args;
+			backing_io->backing_io_type = SPDK_REDUCE_BACKING_IO_WRITE;
+			prev_io_unit_index = io_unit_index;
+			num_io++;
+		}
+	}
+
+	parent->num_backing_ops = num_io;
+	parent->backing_cb_args.cb_fn = next_fn;
+	parent->backing_cb_args.cb_arg = parent;
+
+	/* The last completion may release all of the requests, so only use local state from now on */
+	if (merge) {
+		for (i = 0; i < num_io; i++) {
+			vol->backing_dev->submit_backing_io(ios[i]);
+		}
+	} else {
+		for (i = 0; i < num_reqs; i++) {
+			for (j = 0; j < num_io_units[i]; j++) {
+				vol->backing_dev->submit_backing_io(_reduce_vol_req_get_backing_io(reqs[i], j));
+			}
+		}
+	}
+}
+
 static void
 _issue_backing_ops(struct spdk_reduce_vol_request *req, struct spdk_reduce_vol *vol,
 		   reduce_request_fn next_fn, bool is_write)
 {
 	struct iovec *iov;
 	struct spdk_reduce_backing_io *backing_io;
-	struct reduce_merged_io_desc merged_io_desc[4];
+	struct reduce_merged_io_desc merged_io_desc[REDUCE_MAX_MERGED_IO_UNITS];
 	uint8_t *buf;
 	bool merge = false;
 	uint32_t num_io = 0;
@@ -1308,7 +2654,13 @@ _issue_backing_ops(struct spdk_reduce_vol_request *req, struct spdk_reduce_vol *
 	 * and the chunk size must be four times the maximum of the io unit.
 	 * if chunk size is too big, don't merge IO.
 	 */
-	if (vol->backing_io_units_per_chunk > 4) {
+	if (req->num_children > 0) {
+		assert(is_write);
+		_issue_batch_backing_ops(req, vol, next_fn);
+		return;
+	}
+
+	if (vol->backing_io_units_per_chunk > REDUCE_MAX_MERGED_IO_UNITS) {
 		_issue_backing_ops_without_merge(req, vol, next_fn, is_write);
 		return;
 	}
@@ -1367,8 +2719,7 @@ _issue_backing_ops(struct spdk_reduce_vol_request *req, struct spdk_reduce_vol *
 }
 
 static void
-_reduce_vol_write_chunk(struct spdk_reduce_vol_request *req, reduce_request_fn next_fn,
-			uint32_t compressed_size)
+_reduce_vol_alloc_chunk(struct spdk_reduce_vol_request *req, uint32_t compressed_size)
 {
 	struct spdk_reduce_vol *vol = req->vol;
 	uint32_t i;
@@ -1443,8 +2794,65 @@ _reduce_vol_write_chunk(struct spdk_reduce_vol_request *req, reduce_request_fn n
 		spdk_bit_array_set(vol->allocated_backing_io_units, req->chunk->io_unit_index[i]);
 		vol->info.allocated_io_units++;
 	}
+}
+
+static void
+_reduce_vol_write_chunk(struct spdk_reduce_vol_request *req, reduce_request_fn next_fn,
+			uint32_t compressed_size)
+{
+	_reduce_vol_alloc_chunk(req, compressed_size);
+	_issue_backing_ops(req, req->vol, next_fn, true /* write */);
+}
+
+static void
+_reduce_vol_write_batch(struct spdk_reduce_vol_request *parent)
+{
+	struct spdk_reduce_vol_request *req, *tmp;
+
+	if (parent->reduce_errno != 0) {
+		TAILQ_FOREACH_SAFE(req, &parent->children, child_tailq, tmp) {
+			_reduce_vol_complete_req(req, parent->reduce_errno);
+		}
+		return;
+	}
+
+	/* Allocate the chunks in order so that consecutive chunks are likely to end up on
+	 * contiguous backing io units and can be written with fewer, larger IOs. */
+	TAILQ_FOREACH(req, &parent->children, child_tailq) {
+		_reduce_vol_alloc_chunk(req, req->backing_cb_args.output_size);
+	}
+
+	_issue_backing_ops(parent, parent->vol, _write_batch_write_done, true /* write */);
+}
+
+/* Called once a child of a multi-chunk write has its compressed chunk ready, or has failed.
+ * The chunks are written together once all of the children get here. */
+static void
+_write_batch_child_ready(struct spdk_reduce_vol_request *req, int reduce_errno)
+{
+	struct spdk_reduce_vol_request *parent = req->parent;
+
+	if (reduce_errno != 0) {
+		parent->reduce_errno = reduce_errno;
+	}
+
+	assert(parent->num_children_compressing > 0);
+	if (--parent->num_children_compressing > 0) {
+		return;
+	}
+
+	_reduce_vol_write_batch(parent);
+}
+
+static void
+_write_fail(struct spdk_reduce_vol_request *req, int reduce_errno)
+{
+	if (req->parent != NULL) {
+		_write_batch_child_ready(req, reduce_errno);
+		return;
+	}
 
-	_issue_backing_ops(req, vol, next_fn, true /* write */);
+	_reduce_vol_complete_req(req, reduce_errno);
 }
 
 static void
@@ -1462,6 +2870,11 @@ _write_compress_done(void *_req, int reduce_errno)
 		req->backing_cb_args.output_size = req->vol->params.chunk_size;
 	}
 
+	if (req->parent != NULL) {
+		_write_batch_child_ready(req, 0);
+		return;
+	}
+
 	_reduce_vol_write_chunk(req, _write_write_done, req->backing_cb_args.output_size);
 }
 
@@ -1666,7 +3079,7 @@ _write_decompress_done(void *_req, int reduce_errno)
 
 	/* Negative reduce_errno indicates failure for compression operations. */
 	if (reduce_errno < 0) {
-		_reduce_vol_complete_req(req, reduce_errno);
+		_write_fail(req, reduce_errno);
 		return;
 	}
 
@@ -1674,7 +3087,7 @@ _write_decompress_done(void *_req, int reduce_errno)
 	 * represents the output_size.
 	 */
 	if (req->backing_cb_args.output_size != req->vol->params.chunk_size) {
-		_reduce_vol_complete_req(req, -EIO);
+		_write_fail(req, -EIO);
 		return;
 	}
 
@@ -1697,7 +3110,7 @@ _write_read_done(void *_req, int reduce_errno)
 	}
 
 	if (req->reduce_errno != 0) {
-		_reduce_vol_complete_req(req, req->reduce_errno);
+		_write_fail(req, req->reduce_errno);
 		return;
 	}
 
@@ -1830,6 +3243,167 @@ _start_readv_request(struct spdk_reduce_vol_request *req)
 	_reduce_vol_read_chunk(req, _read_read_done);
 }
 
+static void
+_reduce_vol_child_complete(void *cb_arg, int reduce_errno)
+{
+	struct spdk_reduce_vol_request *req = cb_arg;
+	struct spdk_reduce_vol_request *parent = req->parent;
+
+	if (reduce_errno != 0) {
+		parent->reduce_errno = reduce_errno;
+	}
+
+	assert(parent->num_children > 0);
+	if (--parent->num_children > 0) {
+		return;
+	}
+
+	parent->cb_fn(parent->cb_arg, parent->reduce_errno);
+	TAILQ_INSERT_HEAD(&parent->vol->free_requests, parent, tailq);
+}
+
+/* Fill dst with the next len bytes of the iovec array, starting at (*iov_index, *iov_offset),
+ * and advance the position past them.  Returns the number of iovecs in dst. */
+static int
+_reduce_vol_split_iovs(struct iovec *dst, struct iovec *iov, int *iov_index, size_t *iov_offset,
+		       uint64_t len)
+{
+	size_t iov_len;
+	int iovcnt = 0;
+
+	while (len > 0) {
+		iov_len = spdk_min(iov[*iov_index].iov_len - *iov_offset, len);
+		dst[iovcnt].iov_base = (uint8_t *)iov[*iov_index].iov_base + *iov_offset;
+		dst[iovcnt].iov_len = iov_len;
+		iovcnt++;
+
+		len -= iov_len;
+		*iov_offset += iov_len;
+		if (*iov_offset == iov[*iov_index].iov_len) {
+			(*iov_index)++;
+			*iov_offset = 0;
+		}
+	}
+
+	return iovcnt;
+}
+
+static void
+_reduce_vol_submit_child(struct spdk_reduce_vol_request *req)
+{
+	struct spdk_reduce_vol *vol = req->vol;
+	bool overlapped;
+	int i;
+
+	overlapped = _check_overlap(vol, req->logical_map_index);
+	if (req->type == REDUCE_IO_READV && !overlapped &&
+	    vol->pm_logical_map[req->logical_map_index] == REDUCE_EMPTY_MAP_ENTRY) {
+		for (i = 0; i < req->iovcnt; i++) {
+			memset(req->iov[i].iov_base, 0, req->iov[i].iov_len);
+		}
+		_reduce_vol_child_complete(req, 0);
+		TAILQ_INSERT_HEAD(&vol->free_requests, req, tailq);
+		return;
+	}
+
+	if (overlapped) {
+		TAILQ_INSERT_TAIL(&vol->queued_requests, req, tailq);
+	} else if (req->type == REDUCE_IO_READV) {
+		_start_readv_request(req);
+	} else {
+		_start_writev_request(req);
+	}
+}
+
+/*
+ * Split a request spanning multiple chunks into one child request per chunk.  All of the
+ *  children are started right away, so the compress and decompress operations of the chunks
+ *  are submitted back to back instead of one chunk at a time.  Write children wait for each
+ *  other once their chunk is compressed, so that their backing writes can be merged.
+ */
+static void
+_reduce_vol_split_request(struct spdk_reduce_vol *vol, int type,
+			  struct iovec *iov, int iovcnt, uint64_t offset, uint64_t length,
+			  spdk_reduce_vol_op_complete cb_fn, void *cb_arg)
+{
+	struct spdk_reduce_vol_request *parent, *req, *tmp;
+	uint64_t num_chunks, chunk_length;
+	size_t iov_offset = 0;
+	int iov_index = 0;
+	uint64_t i;
+
+	num_chunks = (offset + length - 1) / vol->logical_blocks_per_chunk -
+		     offset / vol->logical_blocks_per_chunk + 1;
+	if (num_chunks > REDUCE_MAX_BATCH_CHUNKS) {
+		cb_fn(cb_arg, -EINVAL);
+		return;
+	}
+
+	parent = TAILQ_FIRST(&vol->free_requests);
+	if (parent == NULL) {
+		cb_fn(cb_arg, -ENOMEM);
+		return;
+	}
+
+	TAILQ_REMOVE(&vol->free_requests, parent, tailq);
+	TAILQ_INIT(&parent->children);
+	for (i = 0; i < num_chunks; i++) {
+		req = TAILQ_FIRST(&vol->free_requests);
+		if (req == NULL) {
+			TAILQ_FOREACH_SAFE(req, &parent->children, child_tailq, tmp) {
+				TAILQ_INSERT_HEAD(&vol->free_requests, req, tailq);
+			}
+			TAILQ_INSERT_HEAD(&vol->free_requests, parent, tailq);
+			cb_fn(cb_arg, -ENOMEM);
+			return;
+		}
+
+		TAILQ_REMOVE(&vol->free_requests, req, tailq);
+		TAILQ_INSERT_TAIL(&parent->children, req, child_tailq);
+	}
+
+	parent->type = type;
+	parent->vol = vol;
+	parent->iov = iov;
+	parent->iovcnt = iovcnt;
+	parent->offset = offset;
+	parent->length = length;
+	parent->cb_fn = cb_fn;
+	parent->cb_arg = cb_arg;
+	parent->reduce_errno = 0;
+	parent->parent = NULL;
+	parent->num_children = num_chunks;
+	parent->num_children_compressing = num_chunks;
+
+	TAILQ_FOREACH(req, &parent->children, child_tailq) {
+		chunk_length = spdk_min(length, vol->logical_blocks_per_chunk -
+					offset % vol->logical_blocks_per_chunk);
+
+		req->type = type;
+		req->vol = vol;
+		req->iov = req->split_iov;
+		req->iovcnt = _reduce_vol_split_iovs(req->split_iov, iov, &iov_index, &iov_offset,
+						     chunk_length * vol->params.logical_block_size);
+		req->offset = offset;
+		req->logical_map_index = offset / vol->logical_blocks_per_chunk;
+		req->length = chunk_length;
+		req->copy_after_decompress = false;
+		req->cb_fn = _reduce_vol_child_complete;
+		req->cb_arg = req;
+		req->reduce_errno = 0;
+		req->parent = parent;
+		req->num_children = 0;
+
+		offset += chunk_length;
+		length -= chunk_length;
+	}
+
+	/* Once the last child is started, the whole request may complete and release the parent */
+	TAILQ_FOREACH_SAFE(req, &parent->children, child_tailq, tmp) {
+		_reduce_vol_submit_child(req);
+	}
+}
+
 void
 spdk_reduce_vol_readv(struct spdk_reduce_vol *vol,
 		      struct iovec *iov, int iovcnt, uint64_t offset, uint64_t length,
@@ -1845,13 +3419,14 @@ spdk_reduce_vol_readv(struct spdk_reduce_vol *vol,
 		return;
 	}
 
-	if (_request_spans_chunk_boundary(vol, offset, length)) {
+	if (!_iov_array_is_valid(vol, iov, iovcnt, length)) {
 		cb_fn(cb_arg, -EINVAL);
 		return;
 	}
 
-	if (!_iov_array_is_valid(vol, iov, iovcnt, length)) {
-		cb_fn(cb_arg, -EINVAL);
+	if (_request_spans_chunk_boundary(vol, offset, length)) {
+		_reduce_vol_split_request(vol, REDUCE_IO_READV, iov, iovcnt, offset, length,
+					  cb_fn, cb_arg);
 		return;
 	}
 
@@ -1889,6 +3464,8 @@ spdk_reduce_vol_readv(struct spdk_reduce_vol *vol,
 	req->cb_fn = cb_fn;
 	req->cb_arg = cb_arg;
 	req->reduce_errno = 0;
+	req->parent = NULL;
+	req->num_children = 0;
 
 	if (!overlapped) {
 		_start_readv_request(req);
@@ -1934,13 +3511,14 @@ spdk_reduce_vol_writev(struct spdk_reduce_vol *vol,
 		return;
 	}
 
-	if (_request_spans_chunk_boundary(vol, offset, length)) {
+	if (!_iov_array_is_valid(vol, iov, iovcnt, length)) {
 		cb_fn(cb_arg, -EINVAL);
 		return;
 	}
 
-	if (!_iov_array_is_valid(vol, iov, iovcnt, length)) {
-		cb_fn(cb_arg, -EINVAL);
+	if (_request_spans_chunk_boundary(vol, offset, length)) {
+		_reduce_vol_split_request(vol, REDUCE_IO_WRITEV, iov, iovcnt, offset, length,
+					  cb_fn, cb_arg);
 		return;
 	}
 
@@ -1965,6 +3543,8 @@ spdk_reduce_vol_writev(struct spdk_reduce_vol *vol,
 	req->cb_fn = cb_fn;
 	req->cb_arg = cb_arg;
 	req->reduce_errno = 0;
+	req->parent = NULL;
+	req->num_children = 0;
 
 	if (!overlapped) {
 		_start_writev_request(req);
@@ -1984,9 +3564,10 @@ _start_unmap_request_full_chunk(void *ctx)
 
 	chunk_map_index = vol->pm_logical_map[req->logical_map_index];
 	if (chunk_map_index != REDUCE_EMPTY_MAP_ENTRY) {
-		_reduce_vol_reset_chunk(vol, chunk_map_index);
 		vol->pm_logical_map[req->logical_map_index] = REDUCE_EMPTY_MAP_ENTRY;
 		_reduce_persist(vol, &vol->pm_logical_map[req->logical_map_index], sizeof(uint64_t));
+		_reduce_vol_complete_persisted(req, chunk_map_index);
+		return;
 	}
 	_reduce_vol_complete_req(req, 0);
 }
@@ -2034,6 +3615,8 @@ _reduce_vol_unmap_full_chunk(struct spdk_reduce_vol *vol,
 	req->cb_fn = cb_fn;
 	req->cb_arg = cb_arg;
 	req->reduce_errno = 0;
+	req->parent = NULL;
+	req->num_children = 0;
 
 	if (!overlapped) {
 		_start_unmap_request_full_chunk(req);
@@ -2140,6 +3723,16 @@ spdk_reduce_vol_print_info(struct spdk_reduce_vol *vol)
 	chunk_map_size = _get_pm_total_chunks_size(vol->params.vol_size, vol->params.chunk_size,
 			 vol->params.backing_io_unit_size);
 	SPDK_NOTICELOG("\tchunk_map_size = 0x%" PRIx64 "\n", chunk_map_size);
+
+	if (vol->md_log != NULL) {
+		SPDK_NOTICELOG("md log info:\n");
+		SPDK_NOTICELOG("\tlog_offset = 0x%" PRIx64 "\n", vol->md_log->log_offset);
+		SPDK_NOTICELOG("\tlog_pages = 0x%" PRIx32 "\n", vol->md_log->log_pages);
+		SPDK_NOTICELOG("\tmap_offset = 0x%" PRIx64 "\n", vol->md_log->map_offset);
+		SPDK_NOTICELOG("\tmap_pages = 0x%" PRIx64 "\n", vol->md_log->map_pages);
+		SPDK_NOTICELOG("\tckpt_seq = 0x%" PRIx64 "\n", vol->md_log->ckpt_seq);
+		SPDK_NOTICELOG("\tdurable_seq = 0x%" PRIx64 "\n", vol->md_log->durable_seq);
+	}
 }
 
 SPDK_LOG_REGISTER_COMPONENT(reduce)
@@ -21,9 +21,14 @@
 
 #define SPDK_SOCK_OPTS_FIELD_OK(opts, field) (offsetof(struct spdk_sock_opts, field) + sizeof(opts->field) <= (opts->opts_size))
 
+#define SOCK_GROUP_LOAD_PERIOD_MS 100
+
 static STAILQ_HEAD(, spdk_net_impl) g_net_impls = STAILQ_HEAD_INITIALIZER(g_net_impls);
 static struct spdk_net_impl *g_default_impl;
 
+static TAILQ_HEAD(, spdk_sock_group) g_sock_groups = TAILQ_HEAD_INITIALIZER(g_sock_groups);
+static pthread_mutex_t g_sock_groups_mtx = PTHREAD_MUTEX_INITIALIZER;
+
 struct spdk_sock_placement_id_entry {
 	int placement_id;
 	uint32_t ref;
@@ -492,6 +497,26 @@ spdk_sock_close(struct spdk_sock **_sock)
 	return sock->net_impl->close(sock);
 }
 
+static inline ssize_t
+sock_account_read(struct spdk_sock *sock, ssize_t rc)
+{
+	if (rc > 0 && sock->group_impl != NULL) {
+		sock->group_impl->group->stats.bytes_read += rc;
+	}
+
+	return rc;
+}
+
+static inline ssize_t
+sock_account_write(struct spdk_sock *sock, ssize_t rc)
+{
+	if (rc > 0 && sock->group_impl != NULL) {
+		sock->group_impl->group->stats.bytes_written += rc;
+	}
+
+	return rc;
+}
+
 ssize_t
 spdk_sock_recv(struct spdk_sock *sock, void *buf, size_t len)
 {
@@ -500,7 +525,7 @@ spdk_sock_recv(struct spdk_sock *sock, void *buf, size_t len)
 		return -1;
 	}
 
-	return sock->net_impl->recv(sock, buf, len);
+	return sock_account_read(sock, sock->net_impl->recv(sock, buf, len));
 }
 
 ssize_t
@@ -511,7 +536,7 @@ spdk_sock_readv(struct spdk_sock *sock, struct iovec *iov, int iovcnt)
 		return -1;
 	}
 
-	return sock->net_impl->readv(sock, iov, iovcnt);
+	return sock_account_read(sock, sock->net_impl->readv(sock, iov, iovcnt));
 }
 
 ssize_t
@@ -522,12 +547,15 @@ spdk_sock_writev(struct spdk_sock *sock, struct iovec *iov, int iovcnt)
 		return -1;
 	}
 
-	return sock->net_impl->writev(sock, iov, iovcnt);
+	return sock_account_write(sock, sock->net_impl->writev(sock, iov, iovcnt));
 }
 
 void
 spdk_sock_writev_async(struct spdk_sock *sock, struct spdk_sock_request *req)
 {
+	struct spdk_sock_group_stats *stats;
+	int i;
+
 	assert(req->cb_fn != NULL);
 
 	if (sock == NULL || sock->flags.closed) {
@@ -535,6 +563,13 @@ spdk_sock_writev_async(struct spdk_sock *sock, struct spdk_sock_request *req)
 		return;
 	}
 
+	if (sock->group_impl != NULL) {
+		stats = &sock->group_impl->group->stats;
+		for (i = 0; i < req->iovcnt; i++) {
+			stats->bytes_written += SPDK_SOCK_REQUEST_IOV(req, i)->iov_len;
+		}
+	}
+
 	sock->net_impl->writev_async(sock, req);
 }
 
@@ -551,7 +586,7 @@ spdk_sock_recv_next(struct spdk_sock *sock, void **buf, void **ctx)
 		return -1;
 	}
 
-	return sock->net_impl->recv_next(sock, buf, ctx);
+	return sock_account_read(sock, sock->net_impl->recv_next(sock, buf, ctx));
 }
 
 int
@@ -627,6 +662,12 @@ spdk_sock_group_create(void *ctx)
 	}
 
 	group->ctx = ctx;
+	group->load_period = spdk_get_ticks_hz() * SOCK_GROUP_LOAD_PERIOD_MS / 1000;
+	group->load_tsc = spdk_get_ticks();
+
+	pthread_mutex_lock(&g_sock_groups_mtx);
+	TAILQ_INSERT_TAIL(&g_sock_groups, group, link);
+	pthread_mutex_unlock(&g_sock_groups_mtx);
 
 	return group;
 }
@@ -676,6 +717,7 @@ spdk_sock_group_add_sock(struct spdk_sock_group *group, struct spdk_sock *sock,
 	sock->group_impl = group_impl;
 	sock->cb_fn = cb_fn;
 	sock->cb_arg = cb_arg;
+	group->stats.num_socks++;
 
 	return 0;
 }
@@ -700,6 +742,8 @@ spdk_sock_group_remove_sock(struct spdk_sock_group *group, struct spdk_sock *soc
 		sock->group_impl = NULL;
 		sock->cb_fn = NULL;
 		sock->cb_arg = NULL;
+		assert(group->stats.num_socks > 0);
+		group->stats.num_socks--;
 	}
 
 	return rc;
@@ -768,6 +812,29 @@ sock_group_impl_poll_count(struct spdk_sock_group_impl *group_impl,
 	return num_events;
 }
 
+static void
+sock_group_update_load(struct spdk_sock_group *group)
+{
+	uint64_t now, elapsed_ms, work;
+
+	now = spdk_get_ticks();
+	if (now - group->load_tsc < group->load_period) {
+		return;
+	}
+
+	elapsed_ms = (now - group->load_tsc) * 1000 / spdk_get_ticks_hz();
+	work = group->stats.bytes_read + group->stats.bytes_written +
+	       group->stats.events * SPDK_SOCK_GROUP_EVENT_LOAD;
+
+	/* Exponential moving average, weighting the last period by 1/4.  The load is read by other
+	 * threads, e.g. to place new connections, so publish it atomically. */
+	__atomic_store_n(&group->stats.load, (group->stats.load * 3 +
+			 (work - group->load_work) * 1000 / spdk_max(elapsed_ms, 1)) / 4,
+			 __ATOMIC_RELAXED);
+	__atomic_store_n(&group->load_tsc, now, __ATOMIC_RELAXED);
+	group->load_work = work;
+}
+
 int
 spdk_sock_group_poll_count(struct spdk_sock_group *group, int max_events)
 {
@@ -798,6 +865,11 @@ spdk_sock_group_poll_count(struct spdk_sock_group *group, int max_events)
 		}
 	}
 
+	if (num_events > 0) {
+		group->stats.events += num_events;
+	}
+	sock_group_update_load(group);
+
 	return num_events;
 }
 
@@ -826,12 +898,52 @@ spdk_sock_group_close(struct spdk_sock_group **group)
 		}
 	}
 
+	pthread_mutex_lock(&g_sock_groups_mtx);
+	TAILQ_REMOVE(&g_sock_groups, *group, link);
+	pthread_mutex_unlock(&g_sock_groups_mtx);
+
 	free(*group);
 	*group = NULL;
 
 	return 0;
 }
 
+uint64_t
+spdk_sock_group_get_load(struct spdk_sock_group *group)
+{
+	uint64_t load_tsc = __atomic_load_n(&group->load_tsc, __ATOMIC_RELAXED);
+
+	/* A group that isn't polled anymore, e.g. an idle one in interrupt mode, has no load */
+	if (spdk_get_ticks() - load_tsc > group->load_period * 4) {
+		return 0;
+	}
+
+	return __atomic_load_n(&group->stats.load, __ATOMIC_RELAXED);
+}
+
+void
+spdk_sock_group_get_stats(struct spdk_sock_group *group, struct spdk_sock_group_stats *stats)
+{
+	memset(stats, 0, sizeof(*stats));
+	stats->num_socks = __atomic_load_n(&group->stats.num_socks, __ATOMIC_RELAXED);
+	stats->bytes_read = __atomic_load_n(&group->stats.bytes_read, __ATOMIC_RELAXED);
+	stats->bytes_written = __atomic_load_n(&group->stats.bytes_written, __ATOMIC_RELAXED);
+	stats->events = __atomic_load_n(&group->stats.events, __ATOMIC_RELAXED);
+	stats->load = spdk_sock_group_get_load(group);
+}
+
+void
+spdk_sock_for_each_group(spdk_sock_group_fn fn, void *ctx)
+{
+	struct spdk_sock_group *group;
+
+	pthread_mutex_lock(&g_sock_groups_mtx);
+	TAILQ_FOREACH(group, &g_sock_groups, link) {
+		fn(group, ctx);
+	}
+	pthread_mutex_unlock(&g_sock_groups_mtx);
+}
+
 static inline struct spdk_net_impl *
 sock_get_impl_by_name(const char *impl_name)
 {
@@ -936,6 +1048,7 @@ spdk_sock_write_config_json(struct spdk_json_write_ctx *w)
 			spdk_json_write_named_uint32(w, "zerocopy_threshold", opts.zerocopy_threshold);
 			spdk_json_write_named_uint32(w, "tls_version", opts.tls_version);
 			spdk_json_write_named_bool(w, "enable_ktls", opts.enable_ktls);
+			spdk_json_write_named_uint32(w, "flush_batch_timeout", opts.flush_batch_timeout);
 			spdk_json_write_object_end(w);
 			spdk_json_write_object_end(w);
 		} else {
@@ -55,6 +55,7 @@ rpc_sock_impl_get_options(struct spdk_jsonrpc_request *request,
 	spdk_json_write_named_uint32(w, "zerocopy_threshold", sock_opts.zerocopy_threshold);
 	spdk_json_write_named_uint32(w, "tls_version", sock_opts.tls_version);
 	spdk_json_write_named_bool(w, "enable_ktls", sock_opts.enable_ktls);
+	spdk_json_write_named_uint32(w, "flush_batch_timeout", sock_opts.flush_batch_timeout);
 	spdk_json_write_object_end(w);
 	spdk_jsonrpc_end_result(request, w);
 	free(impl_name);
@@ -111,6 +112,10 @@ static const struct spdk_json_object_decoder rpc_sock_impl_set_opts_decoders[] =
 	{
 		"enable_ktls", offsetof(struct spdk_rpc_sock_impl_set_opts, sock_opts.enable_ktls),
 		spdk_json_decode_bool, true
+	},
+	{
+		"flush_batch_timeout", offsetof(struct spdk_rpc_sock_impl_set_opts, sock_opts.flush_batch_timeout),
+		spdk_json_decode_uint32, true
 	}
 };
 
@@ -219,3 +224,40 @@ rpc_sock_get_default_impl(struct spdk_jsonrpc_request *request,
 }
 SPDK_RPC_REGISTER("sock_get_default_impl", rpc_sock_get_default_impl,
 		  SPDK_RPC_STARTUP | SPDK_RPC_RUNTIME)
+
+static void
+rpc_sock_write_group_stats(struct spdk_sock_group *group, void *ctx)
+{
+	struct spdk_json_write_ctx *w = ctx;
+	struct spdk_sock_group_stats stats;
+
+	spdk_sock_group_get_stats(group, &stats);
+
+	spdk_json_write_object_begin(w);
+	spdk_json_write_named_uint32(w, "num_socks", stats.num_socks);
+	spdk_json_write_named_uint64(w, "bytes_read", stats.bytes_read);
+	spdk_json_write_named_uint64(w, "bytes_written", stats.bytes_written);
+	spdk_json_write_named_uint64(w, "events", stats.events);
+	spdk_json_write_named_uint64(w, "load", stats.load);
+	spdk_json_write_object_end(w);
+}
+
+static void
+rpc_sock_get_group_stats(struct spdk_jsonrpc_request *request,
+			 const struct spdk_json_val *params)
+{
+	struct spdk_json_write_ctx *w;
+
+	if (params) {
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INVALID_PARAMS,
+						 "sock_get_group_stats requires no parameters");
+		return;
+	}
+
+	w = spdk_jsonrpc_begin_result(request);
+	spdk_json_write_array_begin(w);
+	spdk_sock_for_each_group(rpc_sock_write_group_stats, w);
+	spdk_json_write_array_end(w);
+	spdk_jsonrpc_end_result(request, w);
+}
+SPDK_RPC_REGISTER("sock_get_group_stats", rpc_sock_get_group_stats, SPDK_RPC_RUNTIME)
@@ -23,6 +23,15 @@
  * for the default. */
 #define IOBUF_DEFAULT_LARGE_BUFSIZE	(132 * 1024)
 #define IOBUF_MAX_CHANNELS		64
+/* Adaptive caches are resized within [cache_size / SCALE, cache_size * SCALE] of the size
+ * requested by the module, once every ADAPT_INTERVAL gets and puts.  A cache grows if more
+ * than 1 / MISS_RATIO of the gets during the last interval had to go to the shared pool, unless
+ * less than 1 / RESERVE of the shared pool is free, and shrinks if some of its buffers were
+ * never used during the last interval. */
+#define IOBUF_ADAPT_SCALE		4
+#define IOBUF_ADAPT_INTERVAL		1024
+#define IOBUF_ADAPT_MISS_RATIO		16
+#define IOBUF_ADAPT_RESERVE		8
 
 SPDK_STATIC_ASSERT(sizeof(struct spdk_iobuf_buffer) <= IOBUF_MIN_SMALL_BUFSIZE,
 		   "Invalid data offset");
@@ -316,6 +325,11 @@ spdk_iobuf_set_opts(const struct spdk_iobuf_opts *opts)
 		return -EINVAL;
 	}
 
+	if (opts->numa_steal > SPDK_IOBUF_NUMA_STEAL_ANY) {
+		SPDK_ERRLOG("Invalid numa_steal policy %" PRIu8 "\n", opts->numa_steal);
+		return -EINVAL;
+	}
+
 	if (opts->enable_numa &&
 	    spdk_env_get_last_numa_id() >= SPDK_CONFIG_MAX_NUMA_NODES) {
 		SPDK_ERRLOG("max NUMA ID %" PRIu32 " cannot be supported with "
@@ -336,6 +350,8 @@ spdk_iobuf_set_opts(const struct spdk_iobuf_opts *opts)
 	SET_FIELD(small_bufsize);
 	SET_FIELD(large_bufsize);
 	SET_FIELD(enable_numa);
+	SET_FIELD(numa_steal);
+	SET_FIELD(enable_adaptive_cache);
 
 	g_iobuf.opts.opts_size = opts->opts_size;
 
@@ -369,6 +385,8 @@ spdk_iobuf_get_opts(struct spdk_iobuf_opts *opts, size_t opts_size)
 	SET_FIELD(small_bufsize);
 	SET_FIELD(large_bufsize);
 	SET_FIELD(enable_numa);
+	SET_FIELD(numa_steal);
+	SET_FIELD(enable_adaptive_cache);
 
 #undef SET_FIELD
 
@@ -377,6 +395,23 @@ spdk_iobuf_get_opts(struct spdk_iobuf_opts *opts, size_t opts_size)
 	SPDK_STATIC_ASSERT(sizeof(struct spdk_iobuf_opts) == 40, "Incorrect size");
 }
 
+static void
+iobuf_pool_cache_adapt_init(struct spdk_iobuf_pool_cache *pool, uint32_t cache_size)
+{
+	/* Modules that don't want a cache at all keep it that way */
+	if (g_iobuf.opts.enable_adaptive_cache && cache_size > 0) {
+		pool->cache_size_min = spdk_max(cache_size / IOBUF_ADAPT_SCALE, 1);
+		pool->cache_size_max = cache_size * IOBUF_ADAPT_SCALE;
+	} else {
+		pool->cache_size_min = cache_size;
+		pool->cache_size_max = 0;
+	}
+
+	pool->adapt_ops = 0;
+	pool->adapt_misses = 0;
+	pool->adapt_low = 0;
+}
+
 static void
 iobuf_channel_node_init(struct spdk_iobuf_channel *ch, struct iobuf_channel *iobuf_ch,
 			int32_t numa_id, uint32_t small_cache_size, uint32_t large_cache_size)
@@ -395,6 +430,8 @@ iobuf_channel_node_init(struct spdk_iobuf_channel *ch, struct iobuf_channel *iob
 	cache->large.cache_size = large_cache_size;
 	cache->small.cache_count = 0;
 	cache->large.cache_count = 0;
+	iobuf_pool_cache_adapt_init(&cache->small, small_cache_size);
+	iobuf_pool_cache_adapt_init(&cache->large, large_cache_size);
 
 	STAILQ_INIT(&cache->small.cache);
 	STAILQ_INIT(&cache->large.cache);
@@ -689,22 +726,168 @@ spdk_iobuf_entry_abort(struct spdk_iobuf_channel *ch, struct spdk_iobuf_entry *e
 
 #define IOBUF_BATCH_SIZE 32
 
+static inline int32_t
+iobuf_get_local_numa_id(void)
+{
+	int32_t numa_id;
+
+	if (!g_iobuf.opts.enable_numa) {
+		return 0;
+	}
+
+	/* SPDK threads may be moved between cores, so check where we're running right now */
+	numa_id = spdk_env_get_numa_id(spdk_env_get_current_core());
+	if (spdk_unlikely(numa_id < 0 || numa_id >= SPDK_CONFIG_MAX_NUMA_NODES ||
+			  g_iobuf.node[numa_id].small_pool == NULL)) {
+		return spdk_env_get_first_numa_id();
+	}
+
+	return numa_id;
+}
+
+static inline struct spdk_iobuf_pool_cache *
+iobuf_node_get_pool(struct spdk_iobuf_channel *ch, int32_t numa_id, bool small)
+{
+	return small ? &ch->cache[numa_id].small : &ch->cache[numa_id].large;
+}
+
+static inline uint64_t
+iobuf_pool_count(bool small)
+{
+	return small ? g_iobuf.opts.small_pool_count : g_iobuf.opts.large_pool_count;
+}
+
+static void
+iobuf_pool_adapt(struct spdk_iobuf_pool_cache *pool, bool small)
+{
+	uint32_t step;
+
+	if (pool->adapt_misses * IOBUF_ADAPT_MISS_RATIO > pool->adapt_ops) {
+		/* The cache runs dry too often, make it larger as long as the shared pool can
+		 * afford it. */
+		if (pool->cache_size < pool->cache_size_max &&
+		    spdk_ring_count(pool->pool) > iobuf_pool_count(small) / IOBUF_ADAPT_RESERVE) {
+			step = spdk_min(IOBUF_BATCH_SIZE, pool->cache_size_max - pool->cache_size);
+			pool->cache_size += step;
+		}
+	} else if (pool->adapt_low > 0 && pool->cache_size > pool->cache_size_min) {
+		/* Some buffers sat in the cache for the whole interval.  Give half of them back,
+		 * the surplus is returned to the shared pool by spdk_iobuf_put(). */
+		step = spdk_min(spdk_max(pool->adapt_low / 2, 1),
+				pool->cache_size - pool->cache_size_min);
+		pool->cache_size -= step;
+	}
+
+	pool->adapt_ops = 0;
+	pool->adapt_misses = 0;
+	pool->adapt_low = pool->cache_count;
+}
+
+static inline void
+iobuf_pool_account(struct spdk_iobuf_pool_cache *pool, bool small, bool miss)
+{
+	if (pool->cache_size_max == 0) {
+		return;
+	}
+
+	pool->adapt_misses += miss;
+	pool->adapt_low = spdk_min(pool->adapt_low, pool->cache_count);
+	if (spdk_unlikely(++pool->adapt_ops >= IOBUF_ADAPT_INTERVAL)) {
+		iobuf_pool_adapt(pool, small);
+	}
+}
+
+/* Whether the buffers of a node may be used by another node, according to the steal policy */
+static inline bool
+iobuf_node_can_lend(struct spdk_iobuf_pool_cache *pool, bool small)
+{
+	switch (g_iobuf.opts.numa_steal) {
+	case SPDK_IOBUF_NUMA_STEAL_NONE:
+		return false;
+	case SPDK_IOBUF_NUMA_STEAL_IDLE:
+		return spdk_ring_count(pool->pool) >= iobuf_pool_count(small) / 2;
+	case SPDK_IOBUF_NUMA_STEAL_ANY:
+	default:
+		return true;
+	}
+}
+
+static void *
+iobuf_steal(struct spdk_iobuf_channel *ch, int32_t local_id, bool small)
+{
+	struct spdk_iobuf_pool_cache *pool;
+	struct spdk_iobuf_buffer *buf;
+	int32_t i;
+
+	IOBUF_FOREACH_NUMA_ID(i) {
+		if (i == local_id) {
+			continue;
+		}
+
+		/* Buffers of another node that were returned on this thread are the cheapest to
+		 * take, nobody else can use them until this channel's cache is trimmed anyway. */
+		pool = iobuf_node_get_pool(ch, i, small);
+		buf = STAILQ_FIRST(&pool->cache);
+		if (buf != NULL) {
+			STAILQ_REMOVE_HEAD(&pool->cache, stailq);
+			assert(pool->cache_count > 0);
+			pool->cache_count--;
+			return buf;
+		}
+
+		if (!iobuf_node_can_lend(pool, small)) {
+			continue;
+		}
+
+		if (spdk_ring_dequeue(pool->pool, (void **)&buf, 1) == 1) {
+			return buf;
+		}
+	}
+
+	return NULL;
+}
+
+static struct spdk_iobuf_pool_cache *
+iobuf_steal_waiting_pool(struct spdk_iobuf_channel *ch, int32_t numa_id, bool small)
+{
+	struct spdk_iobuf_pool_cache *pool;
+	int32_t i;
+
+	IOBUF_FOREACH_NUMA_ID(i) {
+		if (i == numa_id) {
+			continue;
+		}
+
+		pool = iobuf_node_get_pool(ch, i, small);
+		if (!STAILQ_EMPTY(pool->queue)) {
+			return pool;
+		}
+	}
+
+	return NULL;
+}
+
 void *
 spdk_iobuf_get(struct spdk_iobuf_channel *ch, uint64_t len,
 	       struct spdk_iobuf_entry *entry, spdk_iobuf_get_cb cb_fn)
 {
 	struct spdk_iobuf_node_cache *cache;
 	struct spdk_iobuf_pool_cache *pool;
+	int32_t numa_id;
+	bool small;
 	void *buf;
 
-	cache = &ch->cache[0];
+	numa_id = iobuf_get_local_numa_id();
+	cache = &ch->cache[numa_id];
 
 	assert(spdk_io_channel_get_thread(ch->parent) == spdk_get_thread());
 	if (len <= cache->small.bufsize) {
 		pool = &cache->small;
+		small = true;
 	} else {
 		assert(len <= cache->large.bufsize);
 		pool = &cache->large;
+		small = false;
 	}
 
 	buf = (void *)STAILQ_FIRST(&pool->cache);
@@ -713,14 +896,25 @@ spdk_iobuf_get(struct spdk_iobuf_channel *ch, uint64_t len,
 		assert(pool->cache_count > 0);
 		pool->cache_count--;
 		pool->stats.cache++;
+		iobuf_pool_account(pool, small, false);
 	} else {
 		struct spdk_iobuf_buffer *bufs[IOBUF_BATCH_SIZE];
 		size_t sz, i;
 
+		iobuf_pool_account(pool, small, true);
+
 		/* If we're going to dequeue, we may as well dequeue a batch. */
 		sz = spdk_ring_dequeue(pool->pool, (void **)bufs, spdk_min(IOBUF_BATCH_SIZE,
 				       spdk_max(pool->cache_size, 1)));
 		if (sz == 0) {
+			if (g_iobuf.opts.numa_steal != SPDK_IOBUF_NUMA_STEAL_NONE) {
+				buf = iobuf_steal(ch, numa_id, small);
+				if (buf != NULL) {
+					pool->stats.steal++;
+					return buf;
+				}
+			}
+
 			if (entry) {
 				STAILQ_INSERT_TAIL(pool->queue, entry, stailq);
 				entry->module = ch->module;
@@ -732,6 +926,7 @@ spdk_iobuf_get(struct spdk_iobuf_channel *ch, uint64_t len,
 		}
 
 		pool->stats.main++;
+		pool->stats.refill += sz - 1;
 		for (i = 0; i < (sz - 1); i++) {
 			STAILQ_INSERT_HEAD(&pool->cache, bufs[i], stailq);
 			pool->cache_count++;
@@ -750,8 +945,9 @@ spdk_iobuf_put(struct spdk_iobuf_channel *ch, void *buf, uint64_t len)
 	struct spdk_iobuf_entry *entry;
 	struct spdk_iobuf_buffer *iobuf_buf;
 	struct spdk_iobuf_node_cache *cache;
-	struct spdk_iobuf_pool_cache *pool;
+	struct spdk_iobuf_pool_cache *pool, *waiting;
 	uint32_t numa_id;
+	bool small;
 	size_t sz;
 
 	if (g_iobuf.opts.enable_numa) {
@@ -765,11 +961,24 @@ spdk_iobuf_put(struct spdk_iobuf_channel *ch, void *buf, uint64_t len)
 	assert(spdk_io_channel_get_thread(ch->parent) == spdk_get_thread());
 	if (len <= cache->small.bufsize) {
 		pool = &cache->small;
+		small = true;
 	} else {
 		pool = &cache->large;
+		small = false;
 	}
 
-	if (STAILQ_EMPTY(pool->queue)) {
+	waiting = pool;
+	if (STAILQ_EMPTY(pool->queue) && iobuf_node_can_lend(pool, small)) {
+		/* Requests waiting for a buffer on another node can use this one too */
+		waiting = iobuf_steal_waiting_pool(ch, numa_id, small);
+		if (waiting != NULL) {
+			waiting->stats.steal++;
+		} else {
+			waiting = pool;
+		}
+	}
+
+	if (STAILQ_EMPTY(waiting->queue)) {
 		if (pool->cache_size == 0) {
 			spdk_ring_enqueue(pool->pool, (void **)&buf, 1, NULL);
 			return;
@@ -797,13 +1006,15 @@ spdk_iobuf_put(struct spdk_iobuf_channel *ch, void *buf, uint64_t len)
 
 			spdk_ring_enqueue(pool->pool, (void **)bufs, sz, NULL);
 		}
+
+		iobuf_pool_account(pool, small, false);
 	} else {
-		entry = STAILQ_FIRST(pool->queue);
-		STAILQ_REMOVE_HEAD(pool->queue, stailq);
+		entry = STAILQ_FIRST(waiting->queue);
+		STAILQ_REMOVE_HEAD(waiting->queue, stailq);
 		entry->cb_fn(entry, buf);
-		if (spdk_unlikely(entry == STAILQ_LAST(pool->queue, spdk_iobuf_entry, stailq))) {
-			STAILQ_REMOVE(pool->queue, entry, spdk_iobuf_entry, stailq);
-			STAILQ_INSERT_HEAD(pool->queue, entry, stailq);
+		if (spdk_unlikely(entry == STAILQ_LAST(waiting->queue, spdk_iobuf_entry, stailq))) {
+			STAILQ_REMOVE(waiting->queue, entry, spdk_iobuf_entry, stailq);
+			STAILQ_INSERT_HEAD(waiting->queue, entry, stailq);
 		}
 	}
 }
@@ -847,11 +1058,15 @@ iobuf_get_channel_stats(struct spdk_io_channel_iter *iter)
 					it->small_pool.cache += cache->stats.cache;
 					it->small_pool.main += cache->stats.main;
 					it->small_pool.retry += cache->stats.retry;
+					it->small_pool.steal += cache->stats.steal;
+					it->small_pool.refill += cache->stats.refill;
 
 					cache = &channel->cache[i].large;
 					it->large_pool.cache += cache->stats.cache;
 					it->large_pool.main += cache->stats.main;
 					it->large_pool.retry += cache->stats.retry;
+					it->large_pool.steal += cache->stats.steal;
+					it->large_pool.refill += cache->stats.refill;
 				}
 				break;
 			}
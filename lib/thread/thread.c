@@ -32,6 +32,7 @@
 #endif
 
 #define SPDK_MSG_BATCH_SIZE		8
+#define SPDK_MSG_CACHE_BULK_SIZE	(SPDK_MSG_MEMPOOL_CACHE_SIZE / 4)
 #define SPDK_MAX_DEVICE_NAME_LEN	256
 #define SPDK_THREAD_EXIT_TIMEOUT_SEC	5
 #define SPDK_MAX_POLLER_NAME_LEN	256
@@ -136,6 +137,11 @@ struct spdk_thread {
 	struct spdk_ring		*messages;
 	uint8_t				num_pp_handlers;
 	int				msg_fd;
+	/*
+	 * Set by the first sender that writes msg_fd and cleared by this thread before
+	 * it drains the message ring, so a burst of messages costs a single wakeup.
+	 */
+	bool				msg_notify_pending;
 	SLIST_HEAD(, spdk_msg)		msg_cache;
 	size_t				msg_cache_count;
 	spdk_msg_fn			critical_msg;
@@ -838,13 +844,97 @@ spdk_thread_get_from_ctx(void *ctx)
 	return SPDK_CONTAINEROF(ctx, struct spdk_thread, ctx);
 }
 
+static inline int
+thread_send_msg_notification(const struct spdk_thread *target_thread)
+{
+	uint64_t notify = 1;
+	int rc;
+
+	/* Not necessary to do notification if interrupt facility is not enabled */
+	if (spdk_likely(!spdk_interrupt_mode_is_enabled())) {
+		return 0;
+	}
+
+	/* When each spdk_thread can switch between poll and interrupt mode dynamically,
+	 * after sending thread msg, it is necessary to check whether target thread runs in
+	 * interrupt mode and then decide whether do event notification.
+	 */
+	if (spdk_unlikely(target_thread->in_interrupt)) {
+		/* Only the first sender after the target cleared msg_notify_pending writes
+		 * msg_fd. Everything enqueued before the target clears the flag again is
+		 * picked up by the same wakeup.
+		 */
+		if (__atomic_exchange_n((bool *)&target_thread->msg_notify_pending, true,
+					__ATOMIC_SEQ_CST)) {
+			return 0;
+		}
+
+		rc = write(target_thread->msg_fd, &notify, sizeof(notify));
+		if (rc < 0) {
+			SPDK_ERRLOG("failed to notify msg_queue: %s.\n", spdk_strerror(errno));
+			return -EIO;
+		}
+	}
+
+	return 0;
+}
+
+static struct spdk_msg *
+thread_msg_cache_get(struct spdk_thread *thread)
+{
+	struct spdk_msg *msgs[SPDK_MSG_CACHE_BULK_SIZE];
+	struct spdk_msg *msg;
+	int i;
+
+	if (spdk_unlikely(thread->msg_cache_count == 0)) {
+		/* Refill the cache in one go rather than hitting the shared mempool for
+		 * every message this thread sends. */
+		if (spdk_mempool_get_bulk(g_spdk_msg_mempool, (void **)msgs,
+					  SPDK_MSG_CACHE_BULK_SIZE) != 0) {
+			return NULL;
+		}
+
+		for (i = 0; i < SPDK_MSG_CACHE_BULK_SIZE; i++) {
+			SLIST_INSERT_HEAD(&thread->msg_cache, msgs[i], link);
+		}
+		thread->msg_cache_count = SPDK_MSG_CACHE_BULK_SIZE;
+	}
+
+	msg = SLIST_FIRST(&thread->msg_cache);
+	assert(msg != NULL);
+	SLIST_REMOVE_HEAD(&thread->msg_cache, link);
+	thread->msg_cache_count--;
+
+	return msg;
+}
+
+static void
+thread_msg_cache_put(struct spdk_thread *thread, struct spdk_msg *msg)
+{
+	struct spdk_msg *msgs[SPDK_MSG_CACHE_BULK_SIZE];
+	int i;
+
+	if (spdk_unlikely(thread->msg_cache_count >= SPDK_MSG_MEMPOOL_CACHE_SIZE)) {
+		/* Hand a whole chunk back to the mempool so that a thread which mostly
+		 * receives messages does not return them one at a time. */
+		for (i = 0; i < SPDK_MSG_CACHE_BULK_SIZE; i++) {
+			msgs[i] = SLIST_FIRST(&thread->msg_cache);
+			SLIST_REMOVE_HEAD(&thread->msg_cache, link);
+		}
+		thread->msg_cache_count -= SPDK_MSG_CACHE_BULK_SIZE;
+		spdk_mempool_put_bulk(g_spdk_msg_mempool, (void **)msgs, SPDK_MSG_CACHE_BULK_SIZE);
+	}
+
+	/* Insert the messages at the head. We want to re-use the hot ones. */
+	SLIST_INSERT_HEAD(&thread->msg_cache, msg, link);
+	thread->msg_cache_count++;
+}
+
 static inline uint32_t
 msg_queue_run_batch(struct spdk_thread *thread, uint32_t max_msgs)
 {
 	unsigned count, i;
 	void *messages[SPDK_MSG_BATCH_SIZE];
-	uint64_t notify = 1;
-	int rc;
 
 #ifdef DEBUG
 	/*
@@ -864,10 +954,7 @@ msg_queue_run_batch(struct spdk_thread *thread, uint32_t max_msgs)
 	count = spdk_ring_dequeue(thread->messages, messages, max_msgs);
 	if (spdk_unlikely(thread->in_interrupt) &&
 	    spdk_ring_count(thread->messages) != 0) {
-		rc = write(thread->msg_fd, &notify, sizeof(notify));
-		if (rc < 0) {
-			SPDK_ERRLOG("failed to notify msg_queue: %s.\n", spdk_strerror(errno));
-		}
+		thread_send_msg_notification(thread);
 	}
 	if (count == 0) {
 		return 0;
@@ -884,14 +971,7 @@ msg_queue_run_batch(struct spdk_thread *thread, uint32_t max_msgs)
 
 		SPIN_ASSERT(thread->lock_count == 0, SPIN_ERR_HOLD_DURING_SWITCH);
 
-		if (thread->msg_cache_count < SPDK_MSG_MEMPOOL_CACHE_SIZE) {
-			/* Insert the messages at the head. We want to re-use the hot
-			 * ones. */
-			SLIST_INSERT_HEAD(&thread->msg_cache, msg, link);
-			thread->msg_cache_count++;
-		} else {
-			spdk_mempool_put(g_spdk_msg_mempool, msg);
-		}
+		thread_msg_cache_put(thread, msg);
 	}
 
 	return count;
@@ -1373,32 +1453,6 @@ spdk_thread_get_last_tsc(struct spdk_thread *thread)
 	return thread->tsc_last;
 }
 
-static inline int
-thread_send_msg_notification(const struct spdk_thread *target_thread)
-{
-	uint64_t notify = 1;
-	int rc;
-
-	/* Not necessary to do notification if interrupt facility is not enabled */
-	if (spdk_likely(!spdk_interrupt_mode_is_enabled())) {
-		return 0;
-	}
-
-	/* When each spdk_thread can switch between poll and interrupt mode dynamically,
-	 * after sending thread msg, it is necessary to check whether target thread runs in
-	 * interrupt mode and then decide whether do event notification.
-	 */
-	if (spdk_unlikely(target_thread->in_interrupt)) {
-		rc = write(target_thread->msg_fd, &notify, sizeof(notify));
-		if (rc < 0) {
-			SPDK_ERRLOG("failed to notify msg_queue: %s.\n", spdk_strerror(errno));
-			return -EIO;
-		}
-	}
-
-	return 0;
-}
-
 int
 spdk_thread_send_msg(const struct spdk_thread *thread, spdk_msg_fn fn, void *ctx)
 {
@@ -1417,12 +1471,7 @@ spdk_thread_send_msg(const struct spdk_thread *thread, spdk_msg_fn fn, void *ctx
 
 	msg = NULL;
 	if (local_thread != NULL) {
-		if (local_thread->msg_cache_count > 0) {
-			msg = SLIST_FIRST(&local_thread->msg_cache);
-			assert(msg != NULL);
-			SLIST_REMOVE_HEAD(&local_thread->msg_cache, link);
-			local_thread->msg_cache_count--;
-		}
+		msg = thread_msg_cache_get(local_thread);
 	}
 
 	if (msg == NULL) {
@@ -2161,6 +2210,12 @@ spdk_thread_set_interrupt_mode(bool enable_interrupt)
 		poller_set_interrupt_mode(poller, enable_interrupt);
 	}
 
+	if (enable_interrupt) {
+		/* A stale flag from an earlier interrupt mode period would swallow the next
+		 * notification. */
+		__atomic_store_n(&thread->msg_notify_pending, false, __ATOMIC_SEQ_CST);
+	}
+
 	thread->in_interrupt = enable_interrupt;
 	return;
 }
@@ -2769,6 +2824,11 @@ thread_interrupt_msg_process(void *arg)
 	orig_thread = spdk_get_thread();
 	spdk_set_thread(thread);
 
+	/* msg_fd has been read by the fd_group. Re-arm the notification before looking
+	 * at the queue so that anything enqueued from now on triggers a new wakeup.
+	 */
+	__atomic_store_n(&thread->msg_notify_pending, false, __ATOMIC_SEQ_CST);
+
 	critical_msg = thread->critical_msg;
 	if (spdk_unlikely(critical_msg != NULL)) {
 		critical_msg(NULL);
@@ -6,6 +6,7 @@
 #include "util_internal.h"
 #include "crc_internal.h"
 #include "spdk/crc32.h"
+#include "spdk/util.h"
 
 #ifdef SPDK_HAVE_ISAL
 
@@ -126,6 +127,136 @@ spdk_crc32c_iov_update(struct iovec *iov, int iovcnt, uint32_t crc32c)
 	return crc32c;
 }
 
+#if !defined(SPDK_HAVE_ISAL) && (defined(SPDK_HAVE_SSE4_2) || defined(SPDK_HAVE_ARM_CRC))
+
+/*
+ * The CRC instruction has a latency of several cycles, but a new one can be issued every cycle.
+ * A single stream is bound by the latency, so several streams are processed interleaved.
+ */
+#define CRC32C_MULTI_LANES 3
+
+#ifdef SPDK_HAVE_SSE4_2
+#define crc32c_u64(crc, data) _mm_crc32_u64(crc, data)
+#else
+#define crc32c_u64(crc, data) __crc32cd((uint32_t)(crc), data)
+#endif
+
+struct crc32c_lane {
+	struct iovec	*iov;
+	int		iovcnt;
+	const uint8_t	*buf;
+	size_t		len;
+};
+
+static inline bool
+crc32c_lane_next(struct crc32c_lane *lane)
+{
+	while (lane->len == 0) {
+		if (lane->iovcnt == 0) {
+			return false;
+		}
+
+		lane->buf = lane->iov->iov_base;
+		lane->len = lane->iov->iov_len;
+		lane->iov++;
+		lane->iovcnt--;
+	}
+
+	return true;
+}
+
+static void
+crc32c_update_lanes(struct crc32c_lane *lanes, uint32_t *crcs, int count)
+{
+	uint64_t crc0, crc1, crc2, data0, data1, data2;
+	size_t words, i;
+	int j, shortest;
+
+	while (count == CRC32C_MULTI_LANES && crc32c_lane_next(&lanes[0]) &&
+	       crc32c_lane_next(&lanes[1]) && crc32c_lane_next(&lanes[2])) {
+		shortest = 0;
+		for (j = 1; j < CRC32C_MULTI_LANES; j++) {
+			if (lanes[j].len < lanes[shortest].len) {
+				shortest = j;
+			}
+		}
+
+		words = lanes[shortest].len / 8;
+		if (words == 0) {
+			/* Less than 8 bytes left in the segment, finish it on its own */
+			crcs[shortest] = spdk_crc32c_update(lanes[shortest].buf, lanes[shortest].len,
+							    crcs[shortest]);
+			lanes[shortest].len = 0;
+			continue;
+		}
+
+		crc0 = crcs[0];
+		crc1 = crcs[1];
+		crc2 = crcs[2];
+		for (i = 0; i < words; i++) {
+			memcpy(&data0, lanes[0].buf + i * 8, sizeof(data0));
+			memcpy(&data1, lanes[1].buf + i * 8, sizeof(data1));
+			memcpy(&data2, lanes[2].buf + i * 8, sizeof(data2));
+			crc0 = crc32c_u64(crc0, data0);
+			crc1 = crc32c_u64(crc1, data1);
+			crc2 = crc32c_u64(crc2, data2);
+		}
+		crcs[0] = (uint32_t)crc0;
+		crcs[1] = (uint32_t)crc1;
+		crcs[2] = (uint32_t)crc2;
+
+		for (j = 0; j < CRC32C_MULTI_LANES; j++) {
+			lanes[j].buf += words * 8;
+			lanes[j].len -= words * 8;
+		}
+	}
+
+	/* Finish whatever is left of each lane on its own */
+	for (j = 0; j < count; j++) {
+		if (lanes[j].len != 0) {
+			crcs[j] = spdk_crc32c_update(lanes[j].buf, lanes[j].len, crcs[j]);
+		}
+		crcs[j] = spdk_crc32c_iov_update(lanes[j].iov, lanes[j].iovcnt, crcs[j]);
+	}
+}
+
+void
+spdk_crc32c_iov_update_multi(struct iovec **iovs, const int *iovcnts, uint32_t *crcs, int count)
+{
+	struct crc32c_lane lanes[CRC32C_MULTI_LANES];
+	int i, j, num;
+
+	for (i = 0; i < count; i += num) {
+		num = spdk_min(count - i, CRC32C_MULTI_LANES);
+		for (j = 0; j < num; j++) {
+			lanes[j].iov = iovs[i + j];
+			lanes[j].iovcnt = iovcnts[i + j];
+			lanes[j].buf = NULL;
+			lanes[j].len = 0;
+		}
+
+		crc32c_update_lanes(lanes, &crcs[i], num);
+	}
+}
+
+#else
+
+/*
+ * ISA-L already interleaves the computation within a single buffer and the table based
+ * implementation isn't bound by an instruction's latency.
+ */
+void
+spdk_crc32c_iov_update_multi(struct iovec **iovs, const int *iovcnts, uint32_t *crcs, int count)
+{
+	int i;
+
+	for (i = 0; i < count; i++) {
+		crcs[i] = spdk_crc32c_iov_update(iovs[i], iovcnts[i], crcs[i]);
+	}
+}
+
+#endif
+
 uint32_t
 spdk_crc32c_nvme(const void *buf, size_t len, uint32_t crc)
 {
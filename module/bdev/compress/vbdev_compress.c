@@ -1185,12 +1185,15 @@ create_compress_bdev(const char *bdev_name, const char *pm_path, uint32_t lb_siz
 	struct stat info;
 	int rc;
 
-	if (stat(pm_path, &info) != 0) {
-		SPDK_ERRLOG("PM path %s does not exist.\n", pm_path);
-		return -EINVAL;
-	} else if (!S_ISDIR(info.st_mode)) {
-		SPDK_ERRLOG("PM path %s is not a directory.\n", pm_path);
-		return -EINVAL;
+	/* Without a PM path, libreduce keeps the metadata on the base bdev. */
+	if (pm_path != NULL) {
+		if (stat(pm_path, &info) != 0) {
+			SPDK_ERRLOG("PM path %s does not exist.\n", pm_path);
+			return -EINVAL;
+		} else if (!S_ISDIR(info.st_mode)) {
+			SPDK_ERRLOG("PM path %s is not a directory.\n", pm_path);
+			return -EINVAL;
+		}
 	}
 
 	if ((lb_size != 0) && (lb_size != LB_SIZE_4K) && (lb_size != LB_SIZE_512B)) {
@@ -1296,10 +1299,16 @@ vbdev_compress_claim(struct vbdev_compress *comp_bdev)
 	comp_bdev->comp_bdev.product_name = COMP_BDEV_NAME;
 	comp_bdev->comp_bdev.write_cache = comp_bdev->base_bdev->write_cache;
 
+	/* libreduce handles requests spanning several chunks as a single batch, so only split
+	 * on a multiple of the chunk size that still fits in a single large data buffer.
+	 */
 	comp_bdev->comp_bdev.optimal_io_boundary =
-		comp_bdev->params.chunk_size / comp_bdev->params.logical_block_size;
+		comp_bdev->params.chunk_size / comp_bdev->params.logical_block_size *
+		spdk_max(1, spdk_min(REDUCE_MAX_BATCH_CHUNKS,
+				     SPDK_BDEV_LARGE_BUF_MAX_SIZE / comp_bdev->params.chunk_size));
 
 	comp_bdev->comp_bdev.split_on_optimal_io_boundary = true;
+	comp_bdev->comp_bdev.max_num_segments = REDUCE_MAX_IOVECS;
 
 	comp_bdev->comp_bdev.blocklen = comp_bdev->params.logical_block_size;
 	comp_bdev->comp_bdev.blockcnt = comp_bdev->params.vol_size / comp_bdev->comp_bdev.blocklen;
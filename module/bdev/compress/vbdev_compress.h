@@ -53,7 +53,7 @@ typedef void (*spdk_delete_compress_complete)(void *cb_arg, int bdeverrno);
  * Create new compression bdev.
  *
  * \param bdev_name Bdev on which compression bdev will be created.
- * \param pm_path Path to persistent memory.
+ * \param pm_path Path to persistent memory. If NULL, the metadata is kept on the base bdev.
  * \param lb_size Logical block size for the compressed volume in bytes. Must be 4K or 512.
  * \param comp_algo compression algorithm for the compressed volume.
  * \param comp_level compression algorithm level for the compressed volume.
@@ -33,6 +33,23 @@ static const struct spdk_json_object_decoder rpc_ftl_basic_decoders[] = {
 	{"name", offsetof(struct rpc_ftl_basic_param, name), spdk_json_decode_string},
 };
 
+static int
+rpc_decode_gc_policy(const struct spdk_json_val *val, void *out)
+{
+	uint32_t *gc_policy = out;
+
+	if (spdk_json_strequal(val, "greedy")) {
+		*gc_policy = SPDK_FTL_GC_POLICY_GREEDY;
+	} else if (spdk_json_strequal(val, "cost_benefit")) {
+		*gc_policy = SPDK_FTL_GC_POLICY_COST_BENEFIT;
+	} else {
+		SPDK_NOTICELOG("Invalid parameter value: gc_policy\n");
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
 static const struct spdk_json_object_decoder rpc_bdev_ftl_create_decoders[] = {
 	{"name", offsetof(struct spdk_ftl_conf, name), spdk_json_decode_string},
 	{"base_bdev", offsetof(struct spdk_ftl_conf, base_bdev), spdk_json_decode_string},
@@ -54,6 +71,14 @@ static const struct spdk_json_object_decoder rpc_bdev_ftl_create_decoders[] = {
 		"fast_shutdown", offsetof(struct spdk_ftl_conf, fast_shutdown),
 		spdk_json_decode_bool, true
 	},
+	{
+		"gc_policy", offsetof(struct spdk_ftl_conf, gc_policy),
+		rpc_decode_gc_policy, true
+	},
+	{
+		"l2p_prefetch_depth", offsetof(struct spdk_ftl_conf, l2p_prefetch_depth),
+		spdk_json_decode_uint32, true
+	},
 };
 
 static void
@@ -188,6 +188,7 @@ static struct spdk_bdev_nvme_opts g_opts = {
 	.dhchap_digests = BDEV_NVME_DEFAULT_DIGESTS,
 	.dhchap_dhgroups = BDEV_NVME_DEFAULT_DHGROUPS,
 	.rdma_umr_per_io = false,
+	.tcp_zcopy_threshold = 0,
 };
 
 #define NVME_HOTPLUG_POLL_PERIOD_MAX			10000000ULL
@@ -943,8 +944,11 @@ bdev_nvme_create_bdev_channel_cb(void *io_device, void *ctx_buf)
 	STAILQ_INIT(&nbdev_ch->io_path_list);
 	TAILQ_INIT(&nbdev_ch->retry_io_list);
 
+	nbdev_ch->nbdev = nbdev;
+
 	pthread_mutex_lock(&nbdev->mutex);
 
+	nbdev_ch->io_path_gen = nbdev->io_path_gen;
 	nbdev_ch->mp_policy = nbdev->mp_policy;
 	nbdev_ch->mp_selector = nbdev->mp_selector;
 	nbdev_ch->rr_min_io = nbdev->rr_min_io;
@@ -963,6 +967,49 @@ bdev_nvme_create_bdev_channel_cb(void *io_device, void *ctx_buf)
 	return 0;
 }
 
+/* Add I/O paths for the nvme_ns which were added to the nvme_bdev after this
+ * nvme_bdev_channel last synchronized with it.
+ */
+static void
+bdev_nvme_sync_io_paths(struct nvme_bdev_channel *nbdev_ch)
+{
+	struct nvme_bdev *nbdev = nbdev_ch->nbdev;
+	struct nvme_ns *nvme_ns;
+	uint64_t io_path_gen;
+	int rc;
+
+	pthread_mutex_lock(&nbdev->mutex);
+
+	io_path_gen = nbdev->io_path_gen;
+
+	TAILQ_FOREACH(nvme_ns, &nbdev->nvme_ns_list, tailq) {
+		if (_bdev_nvme_get_io_path(nbdev_ch, nvme_ns) != NULL) {
+			continue;
+		}
+
+		rc = _bdev_nvme_add_io_path(nbdev_ch, nvme_ns);
+		if (rc != 0) {
+			SPDK_ERRLOG("Failed to add I/O path to bdev_channel dynamically.\n");
+		}
+	}
+
+	/* Record the generation even if adding failed. Retrying on every I/O would take the
+	 * mutex and log on the I/O path. A failed path is retried on the next generation change.
+	 */
+	nbdev_ch->io_path_gen = io_path_gen;
+
+	pthread_mutex_unlock(&nbdev->mutex);
+}
+
+static inline void
+bdev_nvme_check_io_paths(struct nvme_bdev_channel *nbdev_ch)
+{
+	if (spdk_unlikely(nbdev_ch->io_path_gen !=
+			  __atomic_load_n(&nbdev_ch->nbdev->io_path_gen, __ATOMIC_RELAXED))) {
+		bdev_nvme_sync_io_paths(nbdev_ch);
+	}
+}
+
 /* If cpl != NULL, complete the bdev_io with nvme status based on 'cpl'.
  * If cpl == NULL, complete the bdev_io with bdev status based on 'status'.
  */
@@ -1224,6 +1271,86 @@ _bdev_nvme_find_io_path_min_qd(struct nvme_bdev_channel *nbdev_ch)
 	return non_optimized;
 }
 
+/* Weight of a new sample in the moving average of the I/O latency of a path, as a shift. */
+#define NVME_IO_PATH_LATENCY_SHIFT	3
+
+/* Another path has to be expected to complete an I/O 1/8 sooner than the current one before
+ * the service_time selector switches to it, so that similar paths don't flap. */
+#define NVME_IO_PATH_HYSTERESIS_SHIFT	3
+
+static inline uint64_t
+nvme_io_path_get_service_time(struct nvme_io_path *io_path)
+{
+	uint32_t num_outstanding_reqs;
+
+	num_outstanding_reqs = spdk_nvme_qpair_get_num_outstanding_reqs(io_path->qpair->qpair);
+
+	/* A path without latency samples yet is preferred, but still balanced by queue depth */
+	return spdk_max(io_path->latency_ticks, 1) * (num_outstanding_reqs + 1);
+}
+
+static struct nvme_io_path *
+_bdev_nvme_find_io_path_service_time(struct nvme_bdev_channel *nbdev_ch)
+{
+	struct nvme_io_path *io_path, *current = NULL;
+	struct nvme_io_path *optimized = NULL, *non_optimized = NULL, *best;
+	uint64_t opt_min = UINT64_MAX, non_opt_min = UINT64_MAX, best_time;
+	uint64_t service_time, current_time = 0;
+
+	STAILQ_FOREACH(io_path, &nbdev_ch->io_path_list, stailq) {
+		if (spdk_unlikely(!nvme_qpair_is_connected(io_path->qpair))) {
+			/* The device is currently resetting. */
+			continue;
+		}
+
+		if (spdk_unlikely(!nvme_ns_is_active(io_path->nvme_ns))) {
+			continue;
+		}
+
+		service_time = nvme_io_path_get_service_time(io_path);
+		if (io_path == nbdev_ch->current_io_path) {
+			current = io_path;
+			current_time = service_time;
+		}
+
+		switch (io_path->nvme_ns->ana_state) {
+		case SPDK_NVME_ANA_OPTIMIZED_STATE:
+			if (service_time < opt_min) {
+				opt_min = service_time;
+				optimized = io_path;
+			}
+			break;
+		case SPDK_NVME_ANA_NON_OPTIMIZED_STATE:
+			if (service_time < non_opt_min) {
+				non_opt_min = service_time;
+				non_optimized = io_path;
+			}
+			break;
+		default:
+			break;
+		}
+	}
+
+	if (optimized != NULL) {
+		best = optimized;
+		best_time = opt_min;
+	} else {
+		best = non_optimized;
+		best_time = non_opt_min;
+	}
+
+	/* Stay on the current path unless the best one is clearly faster */
+	if (best != NULL && current != NULL && current != best &&
+	    current->nvme_ns->ana_state == best->nvme_ns->ana_state &&
+	    current_time - (current_time >> NVME_IO_PATH_HYSTERESIS_SHIFT) <= best_time) {
+		best = current;
+	}
+
+	nbdev_ch->current_io_path = best;
+
+	return best;
+}
+
 static inline struct nvme_io_path *
 bdev_nvme_find_io_path(struct nvme_bdev_channel *nbdev_ch)
 {
@@ -1241,6 +1368,8 @@ bdev_nvme_find_io_path(struct nvme_bdev_channel *nbdev_ch)
 	if (nbdev_ch->mp_policy == BDEV_NVME_MP_POLICY_ACTIVE_PASSIVE ||
 	    nbdev_ch->mp_selector == BDEV_NVME_MP_SELECTOR_ROUND_ROBIN) {
 		return _bdev_nvme_find_io_path(nbdev_ch);
+	} else if (nbdev_ch->mp_selector == BDEV_NVME_MP_SELECTOR_SERVICE_TIME) {
+		return _bdev_nvme_find_io_path_service_time(nbdev_ch);
 	} else {
 		return _bdev_nvme_find_io_path_min_qd(nbdev_ch);
 	}
@@ -1266,6 +1395,9 @@ any_io_path_may_become_available(struct nvme_bdev_channel *nbdev_ch)
 		return false;
 	}
 
+	/* A namespace may have been added to the nvme_bdev since the last I/O on this channel. */
+	bdev_nvme_check_io_paths(nbdev_ch);
+
 	STAILQ_FOREACH(io_path, &nbdev_ch->io_path_list, stailq) {
 		if (io_path->nvme_ns->ana_transition_timedout) {
 			continue;
@@ -1415,6 +1547,26 @@ bdev_nvme_update_nvme_error_stat(struct spdk_bdev_io *bdev_io, const struct spdk
 	pthread_mutex_unlock(&nbdev->mutex);
 }
 
+static inline void
+bdev_nvme_update_io_path_latency(struct nvme_bdev_io *bio)
+{
+	struct nvme_io_path *io_path = bio->io_path;
+	uint64_t tsc_diff;
+
+	if (io_path->nbdev_ch == NULL ||
+	    io_path->nbdev_ch->mp_selector != BDEV_NVME_MP_SELECTOR_SERVICE_TIME) {
+		return;
+	}
+
+	tsc_diff = spdk_get_ticks() - bio->submit_tsc;
+	if (io_path->latency_ticks == 0) {
+		io_path->latency_ticks = tsc_diff;
+	} else {
+		io_path->latency_ticks += (tsc_diff >> NVME_IO_PATH_LATENCY_SHIFT) -
+					  (io_path->latency_ticks >> NVME_IO_PATH_LATENCY_SHIFT);
+	}
+}
+
 static inline void
 bdev_nvme_update_io_path_stat(struct nvme_bdev_io *bio)
 {
@@ -1560,6 +1712,7 @@ bdev_nvme_io_complete_nvme_status(struct nvme_bdev_io *bio,
 
 	if (spdk_likely(spdk_nvme_cpl_is_success(cpl))) {
 		bdev_nvme_update_io_path_stat(bio);
+		bdev_nvme_update_io_path_latency(bio);
 		goto complete;
 	}
 
@@ -3435,6 +3588,7 @@ bdev_nvme_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_i
 	}
 
 	spdk_trace_record(TRACE_BDEV_NVME_IO_START, 0, 0, (uintptr_t)nbdev_io, (uintptr_t)bdev_io);
+	bdev_nvme_check_io_paths(nbdev_ch);
 	nbdev_io->io_path = bdev_nvme_find_io_path(nbdev_ch);
 	if (spdk_unlikely(!nbdev_io->io_path)) {
 		if (!bdev_nvme_io_type_is_admin(bdev_io->type)) {
@@ -4121,6 +4275,8 @@ nvme_bdev_get_mp_selector_str(struct nvme_bdev *nbdev)
 		return "round_robin";
 	case BDEV_NVME_MP_SELECTOR_QUEUE_DEPTH:
 		return "queue_depth";
+	case BDEV_NVME_MP_SELECTOR_SERVICE_TIME:
+		return "service_time";
 	default:
 		assert(false);
 		return "invalid";
@@ -4851,22 +5007,6 @@ nvme_ctrlr_populate_namespace_done(struct nvme_ns *nvme_ns, int rc)
 	}
 }
 
-static void
-bdev_nvme_add_io_path(struct nvme_bdev_channel_iter *i,
-		      struct nvme_bdev *nbdev,
-		      struct nvme_bdev_channel *nbdev_ch, void *ctx)
-{
-	struct nvme_ns *nvme_ns = ctx;
-	int rc;
-
-	rc = _bdev_nvme_add_io_path(nbdev_ch, nvme_ns);
-	if (rc != 0) {
-		SPDK_ERRLOG("Failed to add I/O path to bdev_channel dynamically.\n");
-	}
-
-	nvme_bdev_for_each_channel_continue(i, rc);
-}
-
 static void
 bdev_nvme_delete_io_path(struct nvme_bdev_channel_iter *i,
 			 struct nvme_bdev *nbdev,
@@ -4883,30 +5023,6 @@ bdev_nvme_delete_io_path(struct nvme_bdev_channel_iter *i,
 	nvme_bdev_for_each_channel_continue(i, 0);
 }
 
-static void
-bdev_nvme_add_io_path_failed(struct nvme_bdev *nbdev, void *ctx, int status)
-{
-	struct nvme_ns *nvme_ns = ctx;
-
-	nvme_ctrlr_populate_namespace_done(nvme_ns, -1);
-}
-
-static void
-bdev_nvme_add_io_path_done(struct nvme_bdev *nbdev, void *ctx, int status)
-{
-	struct nvme_ns *nvme_ns = ctx;
-
-	if (status == 0) {
-		nvme_ctrlr_populate_namespace_done(nvme_ns, 0);
-	} else {
-		/* Delete the added io_paths and fail populating the namespace. */
-		nvme_bdev_for_each_channel(nbdev,
-					   bdev_nvme_delete_io_path,
-					   nvme_ns,
-					   bdev_nvme_add_io_path_failed);
-	}
-}
-
 static int
 nvme_bdev_add_ns(struct nvme_bdev *nbdev, struct nvme_ns *nvme_ns)
 {
@@ -4934,13 +5050,12 @@ nvme_bdev_add_ns(struct nvme_bdev *nbdev, struct nvme_ns *nvme_ns)
 	TAILQ_INSERT_TAIL(&nbdev->nvme_ns_list, nvme_ns, tailq);
 	nvme_ns->bdev = nbdev;
 
-	pthread_mutex_unlock(&nbdev->mutex);
+	/* Do not message each nvme_bdev_channel. Each one adds the new nvme_io_path
+	 * by itself when it sees the updated generation on its next I/O.
+	 */
+	__atomic_store_n(&nbdev->io_path_gen, nbdev->io_path_gen + 1, __ATOMIC_RELAXED);
 
-	/* Add nvme_io_path to nvme_bdev_channels dynamically. */
-	nvme_bdev_for_each_channel(nbdev,
-				   bdev_nvme_add_io_path,
-				   nvme_ns,
-				   bdev_nvme_add_io_path_done);
+	pthread_mutex_unlock(&nbdev->mutex);
 
 	return 0;
 }
@@ -4971,9 +5086,6 @@ nvme_ctrlr_populate_namespace(struct nvme_ctrlr *nvme_ctrlr, struct nvme_ns *nvm
 		rc = nvme_bdev_create(nvme_ctrlr, nvme_ns);
 	} else {
 		rc = nvme_bdev_add_ns(bdev, nvme_ns);
-		if (rc == 0) {
-			return;
-		}
 	}
 done:
 	nvme_ctrlr_populate_namespace_done(nvme_ns, rc);
@@ -5345,6 +5457,9 @@ _bdev_nvme_set_preferred_path(struct nvme_bdev_channel_iter *i,
 	struct bdev_nvme_set_preferred_path_ctx *ctx = _ctx;
 	struct nvme_io_path *io_path, *prev;
 
+	/* The preferred path may not have been picked up by this channel yet. */
+	bdev_nvme_check_io_paths(nbdev_ch);
+
 	prev = NULL;
 	STAILQ_FOREACH(io_path, &nbdev_ch->io_path_list, stailq) {
 		if (io_path->nvme_ns == ctx->nvme_ns) {
@@ -5529,6 +5644,7 @@ spdk_bdev_nvme_set_multipath_policy(const char *name, enum spdk_bdev_nvme_multip
 			}
 			break;
 		case BDEV_NVME_MP_SELECTOR_QUEUE_DEPTH:
+		case BDEV_NVME_MP_SELECTOR_SERVICE_TIME:
 			break;
 		default:
 			rc = -EINVAL;
@@ -6185,6 +6301,7 @@ spdk_bdev_nvme_get_opts(struct spdk_bdev_nvme_opts *opts, size_t opts_size)
 	SET_FIELD(dhchap_digests, 0);
 	SET_FIELD(dhchap_dhgroups, 0);
 	SET_FIELD(rdma_umr_per_io, false);
+	SET_FIELD(tcp_zcopy_threshold, 0);
 
 #undef SET_FIELD
 
@@ -6261,6 +6378,8 @@ spdk_bdev_nvme_set_opts(const struct spdk_bdev_nvme_opts *opts)
 	if (drv_opts.rdma_umr_per_io != opts->rdma_umr_per_io) {
 		drv_opts.rdma_umr_per_io = opts->rdma_umr_per_io;
 	}
+	/* 0 disables zero-copy sends, so it has to be passed on as well. */
+	drv_opts.tcp_zcopy_threshold = opts->tcp_zcopy_threshold;
 	ret = spdk_nvme_transport_set_opts(&drv_opts, sizeof(drv_opts));
 	if (ret) {
 		SPDK_ERRLOG("Failed to set NVMe transport opts.\n");
@@ -6299,6 +6418,7 @@ spdk_bdev_nvme_set_opts(const struct spdk_bdev_nvme_opts *opts)
 	SET_FIELD(rdma_cm_event_timeout_ms, 0);
 	SET_FIELD(dhchap_digests, 0);
 	SET_FIELD(dhchap_dhgroups, 0);
+	SET_FIELD(tcp_zcopy_threshold, 0);
 
 	g_opts.opts_size = opts->opts_size;
 
@@ -8897,6 +9017,7 @@ bdev_nvme_opts_config_json(struct spdk_json_write_ctx *w)
 
 	spdk_json_write_array_end(w);
 	spdk_json_write_named_bool(w, "rdma_umr_per_io", g_opts.rdma_umr_per_io);
+	spdk_json_write_named_uint32(w, "tcp_zcopy_threshold", g_opts.tcp_zcopy_threshold);
 	spdk_json_write_object_end(w);
 
 	spdk_json_write_object_end(w);
@@ -169,6 +169,12 @@ struct nvme_bdev {
 	enum spdk_bdev_nvme_multipath_selector	mp_selector;
 	uint32_t				rr_min_io;
 	TAILQ_HEAD(, nvme_ns)			nvme_ns_list;
+
+	/* Incremented under mutex whenever an nvme_ns is added to nvme_ns_list.
+	 * nvme_bdev_channels compare it with their own copy and pick up the new
+	 * I/O paths lazily on their next I/O.
+	 */
+	uint64_t				io_path_gen;
 	bool					opal;
 	TAILQ_ENTRY(nvme_bdev)			tailq;
 	struct nvme_error_stat			*err_stat;
@@ -204,10 +210,15 @@ struct nvme_io_path {
 
 	/* allocation of stat is decided by option io_path_stat of RPC bdev_nvme_set_options */
 	struct spdk_bdev_io_stat	*stat;
+
+	/* Moving average of I/O latency, maintained for the service_time selector */
+	uint64_t			latency_ticks;
 };
 
 struct nvme_bdev_channel {
 	struct nvme_io_path			*current_io_path;
+	struct nvme_bdev			*nbdev;
+	uint64_t				io_path_gen;
 	enum spdk_bdev_nvme_multipath_policy	mp_policy;
 	enum spdk_bdev_nvme_multipath_selector	mp_selector;
 	uint32_t				rr_min_io;
@@ -139,6 +139,7 @@ static const struct spdk_json_object_decoder rpc_bdev_nvme_options_decoders[] =
 	{"dhchap_digests", offsetof(struct spdk_bdev_nvme_opts, dhchap_digests), rpc_decode_digest_array, true},
 	{"dhchap_dhgroups", offsetof(struct spdk_bdev_nvme_opts, dhchap_dhgroups), rpc_decode_dhgroup_array, true},
 	{"rdma_umr_per_io", offsetof(struct spdk_bdev_nvme_opts, rdma_umr_per_io), spdk_json_decode_bool, true},
+	{"tcp_zcopy_threshold", offsetof(struct spdk_bdev_nvme_opts, tcp_zcopy_threshold), spdk_json_decode_uint32, true},
 };
 
 static void
@@ -2322,6 +2323,8 @@ rpc_decode_mp_selector(const struct spdk_json_val *val, void *out)
 		*selector = BDEV_NVME_MP_SELECTOR_ROUND_ROBIN;
 	} else if (spdk_json_strequal(val, "queue_depth") == true) {
 		*selector = BDEV_NVME_MP_SELECTOR_QUEUE_DEPTH;
+	} else if (spdk_json_strequal(val, "service_time") == true) {
+		*selector = BDEV_NVME_MP_SELECTOR_SERVICE_TIME;
 	} else {
 		SPDK_NOTICELOG("Invalid parameter value: selector\n");
 		return -EINVAL;
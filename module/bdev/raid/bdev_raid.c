@@ -5,6 +5,7 @@
  */
 
 #include "bdev_raid.h"
+#include "spdk/bit_array.h"
 #include "spdk/env.h"
 #include "spdk/thread.h"
 #include "spdk/log.h"
@@ -20,6 +21,15 @@
 
 #define RAID_BDEV_PROCESS_WINDOW_SIZE_KB_DEFAULT	1024
 #define RAID_BDEV_PROCESS_MAX_BANDWIDTH_MB_SEC_DEFAULT	0
+#define RAID_BDEV_RAID5F_STRIPE_CACHE_SIZE_DEFAULT	0
+#define RAID_BDEV_RAID5F_STRIPE_CACHE_WINDOW_US_DEFAULT	100
+
+/* Maximum size in bytes of the write-intent bitmap and minimum size of a region it tracks */
+#define RAID_BDEV_BITMAP_MAX_SIZE		(64 * 1024)
+#define RAID_BDEV_BITMAP_MIN_REGION_SIZE	(64 * 1024)
+
+SPDK_STATIC_ASSERT(RAID_BDEV_SB_MAX_LENGTH + RAID_BDEV_BITMAP_MAX_SIZE + 0x1000 <=
+		   RAID_BDEV_MIN_DATA_OFFSET_SIZE, "Bitmap does not fit before the data offset");
 
 static bool g_shutdown_started = false;
 
@@ -75,7 +85,9 @@ struct raid_bdev_process {
 	uint64_t			window_remaining;
 	int				window_status;
 	uint64_t			window_offset;
+	uint64_t			window_range_size;
 	bool				window_range_locked;
+	bool				window_skip;
 	struct raid_base_bdev_info	*target;
 	int				status;
 	TAILQ_HEAD(, raid_process_finish_action) finish_actions;
@@ -91,6 +103,8 @@ struct raid_process_finish_action {
 static struct spdk_raid_bdev_opts g_opts = {
 	.process_window_size_kb = RAID_BDEV_PROCESS_WINDOW_SIZE_KB_DEFAULT,
 	.process_max_bandwidth_mb_sec = RAID_BDEV_PROCESS_MAX_BANDWIDTH_MB_SEC_DEFAULT,
+	.raid5f_stripe_cache_size = RAID_BDEV_RAID5F_STRIPE_CACHE_SIZE_DEFAULT,
+	.raid5f_stripe_cache_window_us = RAID_BDEV_RAID5F_STRIPE_CACHE_WINDOW_US_DEFAULT,
 };
 
 void
@@ -390,9 +404,28 @@ raid_bdev_cleanup(struct raid_bdev *raid_bdev)
 	TAILQ_REMOVE(&g_raid_bdev_list, raid_bdev, global_link);
 }
 
+static void
+raid_bdev_bitmap_free(struct raid_bdev *raid_bdev)
+{
+	struct raid_bdev_bitmap *bitmap = raid_bdev->bitmap;
+
+	if (bitmap == NULL) {
+		return;
+	}
+
+	assert(TAILQ_EMPTY(&bitmap->waiting));
+	assert(TAILQ_EMPTY(&bitmap->flushing));
+
+	spdk_bit_array_free(&bitmap->persisted);
+	spdk_dma_free(bitmap->buf);
+	free(bitmap);
+	raid_bdev->bitmap = NULL;
+}
+
 static void
 raid_bdev_free(struct raid_bdev *raid_bdev)
 {
+	raid_bdev_bitmap_free(raid_bdev);
 	raid_bdev_free_superblock(raid_bdev);
 	free(raid_bdev->base_bdev_info);
 	free(raid_bdev->bdev.name);
@@ -440,6 +473,7 @@ raid_bdev_free_base_bdev_resource(struct raid_base_bdev_info *base_info)
 		spdk_uuid_set_null(&base_info->uuid);
 	}
 	base_info->is_failed = false;
+	base_info->resync = false;
 
 	/* clear `data_offset` to allow it to be recalculated during configuration */
 	base_info->data_offset = 0;
@@ -869,6 +903,158 @@ raid_bdev_submit_rw_request(struct raid_bdev_io *raid_io)
 	raid_io->raid_bdev->module->submit_rw_request(raid_io);
 }
 
+static bool
+raid_bdev_bitmap_range_persisted(struct raid_bdev_bitmap *bitmap, uint64_t offset_blocks,
+				 uint64_t num_blocks)
+{
+	uint32_t first = offset_blocks >> bitmap->region_shift;
+	uint32_t last = (offset_blocks + num_blocks - 1) >> bitmap->region_shift;
+
+	return spdk_bit_array_find_first_clear(bitmap->persisted, first) > last;
+}
+
+static void raid_bdev_submit_write_request(struct raid_bdev_io *raid_io);
+
+static void
+_raid_bdev_bitmap_resubmit(void *ctx)
+{
+	raid_bdev_submit_write_request(ctx);
+}
+
+static void
+_raid_bdev_bitmap_fail(void *ctx)
+{
+	raid_bdev_io_complete(ctx, SPDK_BDEV_IO_STATUS_FAILED);
+}
+
+static void
+raid_bdev_bitmap_io_send_msg(struct raid_bdev_io *raid_io, spdk_msg_fn fn)
+{
+	struct spdk_thread *thread = spdk_bdev_io_get_thread(spdk_bdev_io_from_ctx(raid_io));
+
+	spdk_thread_send_msg(thread, fn, raid_io);
+}
+
+static void raid_bdev_bitmap_flush(struct raid_bdev *raid_bdev);
+
+static void
+raid_bdev_bitmap_write_cb(int status, struct raid_bdev *raid_bdev, void *ctx)
+{
+	struct raid_bdev_bitmap *bitmap = raid_bdev->bitmap;
+	uint64_t generation = (uintptr_t)ctx;
+	struct raid_bdev_io *raid_io;
+	uint32_t region, last;
+
+	assert(bitmap->write_in_progress);
+	bitmap->write_in_progress = false;
+
+	while ((raid_io = TAILQ_FIRST(&bitmap->flushing)) != NULL) {
+		TAILQ_REMOVE(&bitmap->flushing, raid_io, link);
+
+		if (status != 0) {
+			raid_bdev_bitmap_io_send_msg(raid_io, _raid_bdev_bitmap_fail);
+			continue;
+		}
+
+		/* Don't mark regions persisted if the bitmap was cleared during the write */
+		if (generation == bitmap->generation) {
+			region = raid_io->offset_blocks >> bitmap->region_shift;
+			last = (raid_io->offset_blocks + raid_io->num_blocks - 1) >> bitmap->region_shift;
+			for (; region <= last; region++) {
+				spdk_bit_array_set(bitmap->persisted, region);
+			}
+		}
+
+		raid_bdev_bitmap_io_send_msg(raid_io, _raid_bdev_bitmap_resubmit);
+	}
+
+	raid_bdev_bitmap_flush(raid_bdev);
+}
+
+static void
+raid_bdev_bitmap_flush(struct raid_bdev *raid_bdev)
+{
+	struct raid_bdev_bitmap *bitmap = raid_bdev->bitmap;
+	uint32_t start = bitmap->dirty_start;
+	uint32_t end = bitmap->dirty_end;
+
+	if (bitmap->write_in_progress || start >= end) {
+		return;
+	}
+
+	/* All writes marked so far are covered by this bitmap write */
+	TAILQ_CONCAT(&bitmap->flushing, &bitmap->waiting, link);
+	bitmap->dirty_start = UINT32_MAX;
+	bitmap->dirty_end = 0;
+	bitmap->write_in_progress = true;
+
+	raid_bdev_write_bitmap(raid_bdev, start, end - start, raid_bdev_bitmap_write_cb,
+			       (void *)(uintptr_t)bitmap->generation);
+}
+
+static void
+_raid_bdev_bitmap_mark(void *ctx)
+{
+	struct raid_bdev_io *raid_io = ctx;
+	struct raid_bdev *raid_bdev = raid_io->raid_bdev;
+	struct raid_bdev_bitmap *bitmap = raid_bdev->bitmap;
+	uint32_t bits_per_block = raid_bdev->bdev.blocklen * 8;
+	uint32_t region, last;
+
+	if (!bitmap->tracking) {
+		raid_bdev_bitmap_io_send_msg(raid_io, _raid_bdev_bitmap_resubmit);
+		return;
+	}
+
+	region = raid_io->offset_blocks >> bitmap->region_shift;
+	last = (raid_io->offset_blocks + raid_io->num_blocks - 1) >> bitmap->region_shift;
+
+	bitmap->dirty_start = spdk_min(bitmap->dirty_start, region / bits_per_block);
+	bitmap->dirty_end = spdk_max(bitmap->dirty_end, last / bits_per_block + 1);
+
+	for (; region <= last; region++) {
+		bitmap->buf[region / 8] |= 1 << (region % 8);
+	}
+
+	TAILQ_INSERT_TAIL(&bitmap->waiting, raid_io, link);
+
+	raid_bdev_bitmap_flush(raid_bdev);
+}
+
+/*
+ * brief:
+ * raid_bdev_submit_write_request submits a request modifying the data of the raid bdev. While
+ * base bdevs are missing, the request is held until the regions it modifies are marked in the
+ * write-intent bitmap on the base bdevs. The bitmap is updated on the app thread, which also
+ * batches the updates of the requests that arrive while a bitmap write is in progress.
+ * params:
+ * raid_io - pointer to raid_bdev_io
+ * returns:
+ * none
+ */
+static void
+raid_bdev_submit_write_request(struct raid_bdev_io *raid_io)
+{
+	struct raid_bdev *raid_bdev = raid_io->raid_bdev;
+	struct raid_bdev_bitmap *bitmap = raid_bdev->bitmap;
+	int rc;
+
+	if (spdk_unlikely(bitmap != NULL && bitmap->tracking) &&
+	    !raid_bdev_bitmap_range_persisted(bitmap, raid_io->offset_blocks, raid_io->num_blocks)) {
+		rc = spdk_thread_send_msg(spdk_thread_get_app_thread(), _raid_bdev_bitmap_mark, raid_io);
+		if (rc != 0) {
+			raid_bdev_io_complete(raid_io, SPDK_BDEV_IO_STATUS_NOMEM);
+		}
+		return;
+	}
+
+	if (raid_io->type == SPDK_BDEV_IO_TYPE_WRITE) {
+		raid_bdev_submit_rw_request(raid_io);
+	} else {
+		raid_bdev->module->submit_null_payload_request(raid_io);
+	}
+}
+
 /*
  * brief:
  * Callback function to spdk_bdev_io_get_buf.
@@ -954,7 +1140,7 @@ raid_bdev_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_i
 				     bdev_io->u.bdev.num_blocks * bdev_io->bdev->blocklen);
 		break;
 	case SPDK_BDEV_IO_TYPE_WRITE:
-		raid_bdev_submit_rw_request(raid_io);
+		raid_bdev_submit_write_request(raid_io);
 		break;
 
 	case SPDK_BDEV_IO_TYPE_RESET:
@@ -968,7 +1154,11 @@ raid_bdev_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_i
 			raid_bdev_io_complete(raid_io, SPDK_BDEV_IO_STATUS_FAILED);
 			return;
 		}
-		raid_io->raid_bdev->module->submit_null_payload_request(raid_io);
+		if (bdev_io->type == SPDK_BDEV_IO_TYPE_UNMAP) {
+			raid_bdev_submit_write_request(raid_io);
+		} else {
+			raid_io->raid_bdev->module->submit_null_payload_request(raid_io);
+		}
 		break;
 
 	default:
@@ -1077,6 +1267,10 @@ raid_bdev_write_info_json(struct raid_bdev *raid_bdev, struct spdk_json_write_ct
 	spdk_json_write_named_uint32(w, "strip_size_kb", raid_bdev->strip_size_kb);
 	spdk_json_write_named_string(w, "state", raid_bdev_state_to_str(raid_bdev->state));
 	spdk_json_write_named_string(w, "raid_level", raid_bdev_level_to_str(raid_bdev->level));
+	if (raid_bdev->module->read_policy_supported) {
+		spdk_json_write_named_string(w, "read_policy",
+					     raid_bdev_read_policy_to_str(raid_bdev->read_policy));
+	}
 	spdk_json_write_named_bool(w, "superblock", raid_bdev->superblock_enabled);
 	spdk_json_write_named_uint32(w, "num_base_bdevs", raid_bdev->num_base_bdevs);
 	spdk_json_write_named_uint32(w, "num_base_bdevs_discovered", raid_bdev->num_base_bdevs_discovered);
@@ -1113,6 +1307,10 @@ raid_bdev_write_info_json(struct raid_bdev *raid_bdev, struct spdk_json_write_ct
 		spdk_json_write_object_end(w);
 	}
 	spdk_json_write_array_end(w);
+
+	if (raid_bdev->state == RAID_BDEV_STATE_ONLINE && raid_bdev->module->dump_info_json) {
+		raid_bdev->module->dump_info_json(raid_bdev, w);
+	}
 }
 
 /*
@@ -1173,6 +1371,10 @@ raid_bdev_write_config_json(struct spdk_bdev *bdev, struct spdk_json_write_ctx *
 		spdk_json_write_named_uint32(w, "strip_size_kb", raid_bdev->strip_size_kb);
 	}
 	spdk_json_write_named_string(w, "raid_level", raid_bdev_level_to_str(raid_bdev->level));
+	if (raid_bdev->read_policy != RAID_READ_POLICY_OUTSTANDING_BLOCKS) {
+		spdk_json_write_named_string(w, "read_policy",
+					     raid_bdev_read_policy_to_str(raid_bdev->read_policy));
+	}
 
 	spdk_json_write_named_array_begin(w, "base_bdevs");
 	RAID_FOR_EACH_BASE_BDEV(raid_bdev, base_info) {
@@ -1296,12 +1498,20 @@ const char *g_raid_state_names[] = {
 static const char *g_raid_process_type_names[] = {
 	[RAID_PROCESS_NONE]	= "none",
 	[RAID_PROCESS_REBUILD]	= "rebuild",
+	[RAID_PROCESS_RESYNC]	= "resync",
 	[RAID_PROCESS_MAX]	= NULL
 };
 
+static const char *g_raid_read_policy_names[] = {
+	[RAID_READ_POLICY_OUTSTANDING_BLOCKS]	= "outstanding_blocks",
+	[RAID_READ_POLICY_LATENCY]		= "latency",
+	[RAID_READ_POLICY_MAX]			= NULL
+};
+
 /* We have to use the typedef in the function declaration to appease astyle. */
 typedef enum raid_level raid_level_t;
 typedef enum raid_bdev_state raid_bdev_state_t;
+typedef enum raid_read_policy raid_read_policy_t;
 
 raid_level_t
 raid_bdev_str_to_level(const char *str)
@@ -1369,6 +1579,32 @@ raid_bdev_process_to_str(enum raid_process_type value)
 	return g_raid_process_type_names[value];
 }
 
+raid_read_policy_t
+raid_bdev_str_to_read_policy(const char *str)
+{
+	unsigned int i;
+
+	assert(str != NULL);
+
+	for (i = 0; i < RAID_READ_POLICY_MAX; i++) {
+		if (strcasecmp(g_raid_read_policy_names[i], str) == 0) {
+			break;
+		}
+	}
+
+	return i;
+}
+
+const char *
+raid_bdev_read_policy_to_str(enum raid_read_policy read_policy)
+{
+	if (read_policy >= RAID_READ_POLICY_MAX) {
+		return "";
+	}
+
+	return g_raid_read_policy_names[read_policy];
+}
+
 /*
  * brief:
  * raid_bdev_fini_start is called when bdev layer is starting the
@@ -1428,6 +1664,10 @@ raid_bdev_opts_config_json(struct spdk_json_write_ctx *w)
 	spdk_json_write_named_uint32(w, "process_window_size_kb", g_opts.process_window_size_kb);
 	spdk_json_write_named_uint32(w, "process_max_bandwidth_mb_sec",
 				     g_opts.process_max_bandwidth_mb_sec);
+	spdk_json_write_named_uint32(w, "raid5f_stripe_cache_size",
+				     g_opts.raid5f_stripe_cache_size);
+	spdk_json_write_named_uint32(w, "raid5f_stripe_cache_window_us",
+				     g_opts.raid5f_stripe_cache_window_us);
 	spdk_json_write_object_end(w);
 
 	spdk_json_write_object_end(w);
@@ -1487,8 +1727,8 @@ raid_bdev_init(void)
 
 static int
 _raid_bdev_create(const char *name, uint32_t strip_size, uint8_t num_base_bdevs,
-		  enum raid_level level, bool superblock_enabled, const struct spdk_uuid *uuid,
-		  struct raid_bdev **raid_bdev_out)
+		  enum raid_level level, enum raid_read_policy read_policy, bool superblock_enabled,
+		  const struct spdk_uuid *uuid, struct raid_bdev **raid_bdev_out)
 {
 	struct raid_bdev *raid_bdev;
 	struct spdk_bdev *raid_bdev_gen;
@@ -1522,6 +1762,17 @@ _raid_bdev_create(const char *name, uint32_t strip_size, uint8_t num_base_bdevs,
 		return -EINVAL;
 	}
 
+	if (read_policy >= RAID_READ_POLICY_MAX) {
+		SPDK_ERRLOG("Invalid read policy '%d'\n", read_policy);
+		return -EINVAL;
+	}
+
+	if (read_policy != RAID_READ_POLICY_OUTSTANDING_BLOCKS && !module->read_policy_supported) {
+		SPDK_ERRLOG("Read policy '%s' is not supported by %s\n",
+			    raid_bdev_read_policy_to_str(read_policy), raid_bdev_level_to_str(level));
+		return -EINVAL;
+	}
+
 	assert(module->base_bdevs_min != 0);
 	if (num_base_bdevs < module->base_bdevs_min) {
 		SPDK_ERRLOG("At least %u base devices required for %s\n",
@@ -1585,6 +1836,7 @@ _raid_bdev_create(const char *name, uint32_t strip_size, uint8_t num_base_bdevs,
 	raid_bdev->strip_size_kb = strip_size;
 	raid_bdev->state = RAID_BDEV_STATE_CONFIGURING;
 	raid_bdev->level = level;
+	raid_bdev->read_policy = read_policy;
 	raid_bdev->min_base_bdevs_operational = min_operational;
 	raid_bdev->superblock_enabled = superblock_enabled;
 
@@ -1619,6 +1871,7 @@ _raid_bdev_create(const char *name, uint32_t strip_size, uint8_t num_base_bdevs,
  * strip_size - strip size in KB
  * num_base_bdevs - number of base bdevs
  * level - raid level
+ * read_policy - read balancing policy
  * superblock_enabled - true if raid should have superblock
  * uuid - uuid to set for the bdev
  * raid_bdev_out - the created raid bdev
@@ -1628,16 +1881,16 @@ _raid_bdev_create(const char *name, uint32_t strip_size, uint8_t num_base_bdevs,
  */
 int
 raid_bdev_create(const char *name, uint32_t strip_size, uint8_t num_base_bdevs,
-		 enum raid_level level, bool superblock_enabled, const struct spdk_uuid *uuid,
-		 struct raid_bdev **raid_bdev_out)
+		 enum raid_level level, enum raid_read_policy read_policy, bool superblock_enabled,
+		 const struct spdk_uuid *uuid, struct raid_bdev **raid_bdev_out)
 {
 	struct raid_bdev *raid_bdev;
 	int rc;
 
 	assert(uuid != NULL);
 
-	rc = _raid_bdev_create(name, strip_size, num_base_bdevs, level, superblock_enabled, uuid,
-			       &raid_bdev);
+	rc = _raid_bdev_create(name, strip_size, num_base_bdevs, level, read_policy,
+			       superblock_enabled, uuid, &raid_bdev);
 	if (rc != 0) {
 		return rc;
 	}
@@ -1797,6 +2050,181 @@ raid_bdev_configure_write_sb_cb(int status, struct raid_bdev *raid_bdev, void *c
 	}
 }
 
+static void
+raid_bdev_init_bitmap_sb(struct raid_bdev *raid_bdev)
+{
+	struct raid_bdev_superblock *sb = raid_bdev->sb;
+	uint32_t blocklen = raid_bdev->bdev.blocklen;
+	uint64_t region_size;
+
+	if (sb->bitmap_region_size != 0) {
+		return;
+	}
+
+	/* Only raid1 can resynchronize ranges of arbitrary alignment */
+	if (raid_bdev->level != RAID1 || spdk_bdev_is_md_interleaved(&raid_bdev->bdev)) {
+		return;
+	}
+
+	region_size = spdk_max(RAID_BDEV_BITMAP_MIN_REGION_SIZE / blocklen,
+			       spdk_divide_round_up(raid_bdev->bdev.blockcnt, RAID_BDEV_BITMAP_MAX_SIZE * 8));
+	region_size = spdk_align64pow2(spdk_max(region_size, 1));
+	if (region_size > UINT32_MAX) {
+		return;
+	}
+
+	sb->bitmap_region_size = region_size;
+	sb->bitmap_offset = spdk_divide_round_up(RAID_BDEV_SB_MAX_LENGTH, blocklen);
+	sb->version.minor = spdk_max(sb->version.minor, RAID_BDEV_SB_VERSION_MINOR);
+}
+
+static int
+raid_bdev_bitmap_alloc(struct raid_bdev *raid_bdev)
+{
+	struct raid_bdev_superblock *sb = raid_bdev->sb;
+	uint32_t blocklen = raid_bdev->bdev.blocklen;
+	struct raid_bdev_bitmap *bitmap;
+	uint8_t i;
+
+	assert(raid_bdev->bitmap == NULL);
+
+	if (!spdk_u64_is_pow2(sb->bitmap_region_size) ||
+	    (uint64_t)sb->bitmap_offset * blocklen < RAID_BDEV_SB_MAX_LENGTH ||
+	    spdk_divide_round_up(raid_bdev->bdev.blockcnt, sb->bitmap_region_size) >
+	    RAID_BDEV_BITMAP_MAX_SIZE * 8) {
+		return -EINVAL;
+	}
+
+	bitmap = calloc(1, sizeof(*bitmap));
+	if (bitmap == NULL) {
+		return -ENOMEM;
+	}
+
+	bitmap->region_size = sb->bitmap_region_size;
+	bitmap->region_shift = spdk_u64log2(bitmap->region_size);
+	bitmap->num_regions = spdk_divide_round_up(raid_bdev->bdev.blockcnt, bitmap->region_size);
+	bitmap->offset_blocks = sb->bitmap_offset;
+	bitmap->num_blocks = spdk_divide_round_up(spdk_divide_round_up(bitmap->num_regions, 8), blocklen);
+	bitmap->dirty_start = UINT32_MAX;
+	TAILQ_INIT(&bitmap->waiting);
+	TAILQ_INIT(&bitmap->flushing);
+	raid_bdev->bitmap = bitmap;
+
+	for (i = 0; i < sb->base_bdevs_size; i++) {
+		const struct raid_bdev_sb_base_bdev *sb_base_bdev = &sb->base_bdevs[i];
+
+		if (!spdk_uuid_is_null(&sb_base_bdev->uuid) &&
+		    sb_base_bdev->data_offset < bitmap->offset_blocks + bitmap->num_blocks) {
+			raid_bdev_bitmap_free(raid_bdev);
+			return -EINVAL;
+		}
+	}
+
+	bitmap->buf = spdk_dma_zmalloc((uint64_t)bitmap->num_blocks * blocklen, 0x1000, NULL);
+	bitmap->persisted = spdk_bit_array_create(bitmap->num_regions);
+	if (bitmap->buf == NULL || bitmap->persisted == NULL) {
+		raid_bdev_bitmap_free(raid_bdev);
+		return -ENOMEM;
+	}
+
+	return 0;
+}
+
+static void
+raid_bdev_bitmap_disable(struct raid_bdev *raid_bdev)
+{
+	struct raid_bdev_superblock *sb = raid_bdev->sb;
+	uint8_t i;
+
+	raid_bdev_bitmap_free(raid_bdev);
+
+	sb->bitmap_region_size = 0;
+	sb->bitmap_offset = 0;
+	for (i = 0; i < sb->base_bdevs_size; i++) {
+		sb->base_bdevs[i].flags &= ~RAID_SB_BASE_BDEV_FLAG_BITMAP;
+	}
+}
+
+/* Clear the bitmap after all base bdevs have been resynchronized */
+static void
+raid_bdev_bitmap_clear(struct raid_bdev *raid_bdev)
+{
+	struct raid_bdev_bitmap *bitmap = raid_bdev->bitmap;
+
+	assert(spdk_get_thread() == spdk_thread_get_app_thread());
+
+	bitmap->tracking = false;
+	bitmap->generation++;
+	memset(bitmap->buf, 0, (uint64_t)bitmap->num_blocks * raid_bdev->bdev.blocklen);
+	spdk_bit_array_clear_mask(bitmap->persisted);
+
+	bitmap->dirty_start = 0;
+	bitmap->dirty_end = bitmap->num_blocks;
+	raid_bdev_bitmap_flush(raid_bdev);
+}
+
+static void
+raid_bdev_configure_load_bitmap_cb(int status, struct raid_bdev *raid_bdev, void *ctx)
+{
+	struct raid_bdev_bitmap *bitmap = raid_bdev->bitmap;
+	uint32_t region;
+
+	if (status != 0) {
+		SPDK_WARNLOG("Failed to load raid bdev '%s' bitmap, missing base bdevs will be fully rebuilt\n",
+			     raid_bdev->bdev.name);
+		raid_bdev_bitmap_disable(raid_bdev);
+	} else {
+		for (region = 0; region < bitmap->num_regions; region++) {
+			if (bitmap->buf[region / 8] & (1 << (region % 8))) {
+				spdk_bit_array_set(bitmap->persisted, region);
+			}
+		}
+	}
+
+	raid_bdev_write_superblock(raid_bdev, raid_bdev_configure_write_sb_cb, NULL);
+}
+
+/*
+ * Set up the write-intent bitmap when configuring the raid bdev. If any of the missing base
+ * bdevs relies on the bitmap, it is loaded from one of the base bdevs.
+ */
+static int
+raid_bdev_configure_bitmap(struct raid_bdev *raid_bdev, bool *load)
+{
+	struct raid_bdev_superblock *sb = raid_bdev->sb;
+	uint8_t i;
+	int rc;
+
+	*load = false;
+
+	raid_bdev_bitmap_free(raid_bdev);
+	raid_bdev_init_bitmap_sb(raid_bdev);
+	if (sb->bitmap_region_size == 0) {
+		return 0;
+	}
+
+	rc = raid_bdev_bitmap_alloc(raid_bdev);
+	if (rc == -EINVAL) {
+		SPDK_WARNLOG("Invalid bitmap in raid bdev '%s' superblock, disabling it\n",
+			     raid_bdev->bdev.name);
+		raid_bdev_bitmap_disable(raid_bdev);
+		return 0;
+	} else if (rc != 0) {
+		return rc;
+	}
+
+	raid_bdev->bitmap->tracking = raid_bdev->num_base_bdevs_discovered < raid_bdev->num_base_bdevs;
+
+	for (i = 0; i < sb->base_bdevs_size; i++) {
+		if (sb->base_bdevs[i].state != RAID_SB_BASE_BDEV_CONFIGURED &&
+		    (sb->base_bdevs[i].flags & RAID_SB_BASE_BDEV_FLAG_BITMAP)) {
+			*load = true;
+		}
+	}
+
+	return 0;
+}
+
 /*
  * brief:
  * If raid bdev config is complete, then only register the raid bdev to
@@ -1812,6 +2240,8 @@ static int
 raid_bdev_configure(struct raid_bdev *raid_bdev, raid_bdev_configure_cb cb, void *cb_ctx)
 {
 	uint32_t data_block_size = spdk_bdev_get_data_block_size(&raid_bdev->bdev);
+	struct raid_base_bdev_info *base_info;
+	bool load_bitmap = false;
 	int rc;
 
 	assert(raid_bdev->state == RAID_BDEV_STATE_CONFIGURING);
@@ -1856,6 +2286,25 @@ raid_bdev_configure(struct raid_bdev *raid_bdev, raid_bdev_configure_cb cb, void
 			}
 		}
 
+		if (rc == 0) {
+			rc = raid_bdev_configure_bitmap(raid_bdev, &load_bitmap);
+		}
+
+		if (rc == 0 && load_bitmap) {
+			RAID_FOR_EACH_BASE_BDEV(raid_bdev, base_info) {
+				if (base_info->is_configured) {
+					break;
+				}
+			}
+			assert(base_info < raid_bdev->base_bdev_info + raid_bdev->num_base_bdevs);
+			rc = raid_bdev_load_bitmap(raid_bdev, base_info, raid_bdev_configure_load_bitmap_cb, NULL);
+			if (rc == 0) {
+				return 0;
+			}
+			SPDK_ERRLOG("Failed to load raid bdev '%s' bitmap: %s\n",
+				    raid_bdev->bdev.name, spdk_strerror(-rc));
+		}
+
 		if (rc != 0) {
 			raid_bdev->configure_cb = NULL;
 			if (raid_bdev->module->stop != NULL) {
@@ -2050,6 +2499,14 @@ raid_bdev_remove_base_bdev_on_quiesced(void *ctx, int status)
 					sb_base_bdev->state = RAID_SB_BASE_BDEV_MISSING;
 				}
 
+				if (raid_bdev->bitmap != NULL) {
+					/* Record the writes from now on to resynchronize the base bdev when it is back */
+					raid_bdev->bitmap->tracking = true;
+					if (!base_info->is_failed) {
+						sb_base_bdev->flags |= RAID_SB_BASE_BDEV_FLAG_BITMAP;
+					}
+				}
+
 				raid_bdev_write_superblock(raid_bdev, raid_bdev_remove_base_bdev_write_sb_cb, base_info);
 				return;
 			}
@@ -2447,10 +2904,28 @@ raid_bdev_delete(struct raid_bdev *raid_bdev, raid_bdev_destruct_cb cb_fn, void
 static void
 raid_bdev_process_finish_write_sb_cb(int status, struct raid_bdev *raid_bdev, void *ctx)
 {
+	struct raid_bdev_superblock *sb = raid_bdev->sb;
+	uint8_t i;
+
 	if (status != 0) {
 		SPDK_ERRLOG("Failed to write raid bdev '%s' superblock after background process finished: %s\n",
 			    raid_bdev->bdev.name, spdk_strerror(-status));
+		return;
+	}
+
+	if (raid_bdev->bitmap == NULL ||
+	    raid_bdev->num_base_bdevs_discovered < raid_bdev->num_base_bdevs) {
+		return;
 	}
+
+	for (i = 0; i < sb->base_bdevs_size; i++) {
+		if (sb->base_bdevs[i].state != RAID_SB_BASE_BDEV_CONFIGURED) {
+			return;
+		}
+	}
+
+	/* No base bdev relies on the bitmap anymore */
+	raid_bdev_bitmap_clear(raid_bdev);
 }
 
 static void
@@ -2470,6 +2945,7 @@ raid_bdev_process_finish_write_sb(void *ctx)
 			base_info = &raid_bdev->base_bdev_info[sb_base_bdev->slot];
 			if (base_info->is_configured) {
 				sb_base_bdev->state = RAID_SB_BASE_BDEV_CONFIGURED;
+				sb_base_bdev->flags &= ~RAID_SB_BASE_BDEV_FLAG_BITMAP;
 				sb_base_bdev->data_offset = base_info->data_offset;
 				spdk_uuid_copy(&sb_base_bdev->uuid, &base_info->uuid);
 			}
@@ -2682,6 +3158,12 @@ raid_bdev_process_window_range_unlocked(void *ctx, int status)
 	process->window_range_locked = false;
 	process->window_offset += process->window_size;
 
+	if (process->window_skip) {
+		/* Nothing was copied, so don't account the skipped range in the bandwidth limit */
+		process->window_skip = false;
+		process->window_size = 0;
+	}
+
 	raid_bdev_process_thread_run(process);
 }
 
@@ -2693,7 +3175,7 @@ raid_bdev_process_unlock_window_range(struct raid_bdev_process *process)
 	assert(process->window_range_locked == true);
 
 	rc = spdk_bdev_unquiesce_range(&process->raid_bdev->bdev, &g_raid_if,
-				       process->window_offset, process->max_window_size,
+				       process->window_offset, process->window_range_size,
 				       raid_bdev_process_window_range_unlocked, process);
 	if (rc != 0) {
 		raid_bdev_process_window_range_unlocked(process, rc);
@@ -2782,14 +3264,62 @@ raid_bdev_submit_process_request(struct raid_bdev_process *process, uint64_t off
 	return ret;
 }
 
+static bool
+raid_bdev_process_range_clean(struct raid_bdev_process *process, uint64_t offset_blocks,
+			      uint64_t num_blocks)
+{
+	struct raid_bdev_bitmap *bitmap = process->raid_bdev->bitmap;
+	uint32_t first = offset_blocks >> bitmap->region_shift;
+	uint32_t last = (offset_blocks + num_blocks - 1) >> bitmap->region_shift;
+
+	return spdk_bit_array_find_first_set(bitmap->persisted, first) > last;
+}
+
+/*
+ * Resync only copies the regions marked in the bitmap. If the window starts in a clean region,
+ * lock the whole range up to the next marked region and skip it without copying.
+ */
+static void
+raid_bdev_process_resync_window(struct raid_bdev_process *process)
+{
+	struct raid_bdev *raid_bdev = process->raid_bdev;
+	struct raid_bdev_bitmap *bitmap = raid_bdev->bitmap;
+	uint32_t region = process->window_offset >> bitmap->region_shift;
+	uint64_t clean_end;
+
+	region = spdk_bit_array_find_first_set(bitmap->persisted, region);
+	if (region == UINT32_MAX) {
+		clean_end = raid_bdev->bdev.blockcnt;
+	} else {
+		clean_end = spdk_min((uint64_t)region << bitmap->region_shift, raid_bdev->bdev.blockcnt);
+	}
+
+	if (clean_end > process->window_offset) {
+		process->window_range_size = clean_end - process->window_offset;
+		process->window_skip = true;
+	}
+}
+
 static void
 _raid_bdev_process_thread_run(struct raid_bdev_process *process)
 {
 	struct raid_bdev *raid_bdev = process->raid_bdev;
 	uint64_t offset = process->window_offset;
-	const uint64_t offset_end = spdk_min(offset + process->max_window_size, raid_bdev->bdev.blockcnt);
+	const uint64_t offset_end = spdk_min(offset + spdk_min(process->max_window_size,
+					     process->window_range_size), raid_bdev->bdev.blockcnt);
 	int ret;
 
+	if (process->window_skip) {
+		/* Check again, the range could have been written before it was locked */
+		if (raid_bdev_process_range_clean(process, offset, process->window_range_size)) {
+			process->window_size = process->window_range_size;
+			spdk_for_each_channel(raid_bdev, raid_bdev_process_channel_update, process,
+					      raid_bdev_process_channels_update_done);
+			return;
+		}
+		process->window_skip = false;
+	}
+
 	while (offset < offset_end) {
 		ret = raid_bdev_submit_process_request(process, offset, offset_end - offset);
 		if (ret <= 0) {
@@ -2863,7 +3393,7 @@ raid_bdev_process_lock_window_range(struct raid_bdev_process *process)
 	}
 
 	rc = spdk_bdev_quiesce_range(&raid_bdev->bdev, &g_raid_if,
-				     process->window_offset, process->max_window_size,
+				     process->window_offset, process->window_range_size,
 				     raid_bdev_process_window_range_locked, process);
 	if (rc != 0) {
 		raid_bdev_process_window_range_locked(process, rc);
@@ -2904,6 +3434,10 @@ raid_bdev_process_thread_run(struct raid_bdev_process *process)
 
 	process->max_window_size = spdk_min(raid_bdev->bdev.blockcnt - process->window_offset,
 					    process->max_window_size);
+	process->window_range_size = process->max_window_size;
+	if (process->type == RAID_PROCESS_RESYNC) {
+		raid_bdev_process_resync_window(process);
+	}
 	raid_bdev_process_lock_window_range(process);
 }
 
@@ -3124,10 +3658,17 @@ static int
 raid_bdev_start_rebuild(struct raid_base_bdev_info *target)
 {
 	struct raid_bdev_process *process;
+	enum raid_process_type type;
 
 	assert(spdk_get_thread() == spdk_thread_get_app_thread());
 
-	process = raid_bdev_process_alloc(target->raid_bdev, RAID_PROCESS_REBUILD, target);
+	if (target->resync && target->raid_bdev->bitmap != NULL) {
+		type = RAID_PROCESS_RESYNC;
+	} else {
+		type = RAID_PROCESS_REBUILD;
+	}
+
+	process = raid_bdev_process_alloc(target->raid_bdev, type, target);
 	if (process == NULL) {
 		return -ENOMEM;
 	}
@@ -3514,7 +4055,7 @@ raid_bdev_create_from_sb(const struct raid_bdev_superblock *sb, struct raid_bdev
 	int rc;
 
 	rc = _raid_bdev_create(sb->name, (sb->strip_size * sb->block_size) / 1024, sb->num_base_bdevs,
-			       sb->level, true, &sb->uuid, &raid_bdev);
+			       sb->level, sb->read_policy, true, &sb->uuid, &raid_bdev);
 	if (rc != 0) {
 		return rc;
 	}
@@ -3755,6 +4296,9 @@ raid_bdev_examine_sb(const struct raid_bdev_superblock *sb, struct spdk_bdev *bd
 		       sb_base_bdev->state == RAID_SB_BASE_BDEV_FAILED);
 		assert(spdk_uuid_is_null(&base_info->uuid));
 		spdk_uuid_copy(&base_info->uuid, &sb_base_bdev->uuid);
+		base_info->resync = raid_bdev->bitmap != NULL &&
+				    sb_base_bdev->state == RAID_SB_BASE_BDEV_MISSING &&
+				    (sb_base_bdev->flags & RAID_SB_BASE_BDEV_FLAG_BITMAP);
 		SPDK_NOTICELOG("Re-adding bdev %s to raid bdev %s.\n", bdev->name, raid_bdev->bdev.name);
 		rc = raid_bdev_configure_base_bdev(base_info, true, cb_fn, cb_ctx);
 		if (rc != 0) {
@@ -43,9 +43,27 @@ enum raid_bdev_state {
 	RAID_BDEV_STATE_MAX
 };
 
+/*
+ * Read policy of a raid bdev. Determines how reads are balanced between base bdevs holding
+ * copies of the same data. Only used by raid levels with mirroring.
+ */
+enum raid_read_policy {
+	/* pick the base bdev with the lowest number of outstanding read blocks */
+	RAID_READ_POLICY_OUTSTANDING_BLOCKS	= 0,
+
+	/*
+	 * pick the base bdev with the lowest expected service time, based on the observed
+	 * completion latency and queue depth, keeping sequential streams on the same base bdev
+	 */
+	RAID_READ_POLICY_LATENCY		= 1,
+
+	RAID_READ_POLICY_MAX
+};
+
 enum raid_process_type {
 	RAID_PROCESS_NONE,
 	RAID_PROCESS_REBUILD,
+	RAID_PROCESS_RESYNC,
 	RAID_PROCESS_MAX
 };
 
@@ -106,6 +124,12 @@ struct raid_base_bdev_info {
 	/* Set to true to indicate that the base bdev is being removed because of a failure */
 	bool			is_failed;
 
+	/*
+	 * Set to true if the base bdev was missing while the write-intent bitmap was tracking
+	 * writes, so only the regions marked in the bitmap need to be resynchronized
+	 */
+	bool			resync;
+
 	/* callback for base bdev configuration */
 	raid_base_bdev_cb	configure_cb;
 
@@ -153,6 +177,9 @@ struct raid_bdev_io {
 	/* Custom completion callback. Overrides bdev_io completion if set. */
 	raid_bdev_io_completion_cb	completion_cb;
 
+	/* Link for queueing the I/O inside of the raid module */
+	TAILQ_ENTRY(raid_bdev_io)	link;
+
 	struct {
 		uint64_t		offset;
 		struct iovec		*iov;
@@ -177,6 +204,54 @@ struct raid_bdev_process_request {
 
 typedef void (*raid_bdev_configure_cb)(void *cb_ctx, int rc);
 
+/*
+ * Write-intent bitmap of a raid bdev. While base bdevs are missing, every region of the raid
+ * bdev that is written is marked in the bitmap, which is stored on the base bdevs next to the
+ * superblock, before the write is submitted. When a missing base bdev comes back, only the
+ * marked regions are resynchronized instead of rebuilding the whole base bdev.
+ */
+struct raid_bdev_bitmap {
+	/* size in blocks of the region tracked by a single bit, a power of 2 */
+	uint64_t			region_size;
+
+	/* region size bit shift */
+	uint32_t			region_shift;
+
+	/* number of regions of the raid bdev */
+	uint64_t			num_regions;
+
+	/* offset in blocks of the bitmap from the start of the base bdevs */
+	uint64_t			offset_blocks;
+
+	/* size in blocks of the bitmap on the base bdevs */
+	uint32_t			num_blocks;
+
+	/* bitmap in the on-disk format, only modified on the app thread */
+	uint8_t				*buf;
+
+	/* regions that are marked in the bitmap stored on the base bdevs */
+	struct spdk_bit_array		*persisted;
+
+	/* set to true while writes have to be recorded in the bitmap */
+	bool				tracking;
+
+	/* incremented when the bitmap is cleared */
+	uint64_t			generation;
+
+	/* range of bitmap blocks modified since the last bitmap write */
+	uint32_t			dirty_start;
+	uint32_t			dirty_end;
+
+	/* set to true while the bitmap is being written to the base bdevs */
+	bool				write_in_progress;
+
+	/* writes waiting for the next bitmap write */
+	TAILQ_HEAD(, raid_bdev_io)	waiting;
+
+	/* writes waiting for the bitmap write in progress */
+	TAILQ_HEAD(, raid_bdev_io)	flushing;
+};
+
 /*
  * raid_bdev is the single entity structure which contains SPDK block device
  * and the information related to any raid bdev either configured or
@@ -225,6 +300,9 @@ struct raid_bdev {
 	/* Raid Level of this raid bdev */
 	enum raid_level			level;
 
+	/* Read balancing policy of this raid bdev */
+	enum raid_read_policy		read_policy;
+
 	/* Set to true if destroy of this raid bdev is started. */
 	bool				destroy_started;
 
@@ -242,6 +320,9 @@ struct raid_bdev {
 	void				*sb_io_buf;
 	uint32_t			sb_io_buf_size;
 
+	/* Write-intent bitmap, NULL if not used */
+	struct raid_bdev_bitmap		*bitmap;
+
 	/* Raid bdev background process, e.g. rebuild */
 	struct raid_bdev_process	*process;
 
@@ -263,8 +344,8 @@ extern struct raid_all_tailq		g_raid_bdev_list;
 typedef void (*raid_bdev_destruct_cb)(void *cb_ctx, int rc);
 
 int raid_bdev_create(const char *name, uint32_t strip_size, uint8_t num_base_bdevs,
-		     enum raid_level level, bool superblock, const struct spdk_uuid *uuid,
-		     struct raid_bdev **raid_bdev_out);
+		     enum raid_level level, enum raid_read_policy read_policy, bool superblock,
+		     const struct spdk_uuid *uuid, struct raid_bdev **raid_bdev_out);
 void raid_bdev_delete(struct raid_bdev *raid_bdev, raid_bdev_destruct_cb cb_fn, void *cb_ctx);
 int raid_bdev_add_base_bdev(struct raid_bdev *raid_bdev, const char *name,
 			    raid_base_bdev_cb cb_fn, void *cb_ctx);
@@ -274,6 +355,8 @@ const char *raid_bdev_level_to_str(enum raid_level level);
 enum raid_bdev_state raid_bdev_str_to_state(const char *str);
 const char *raid_bdev_state_to_str(enum raid_bdev_state state);
 const char *raid_bdev_process_to_str(enum raid_process_type value);
+enum raid_read_policy raid_bdev_str_to_read_policy(const char *str);
+const char *raid_bdev_read_policy_to_str(enum raid_read_policy read_policy);
 void raid_bdev_write_info_json(struct raid_bdev *raid_bdev, struct spdk_json_write_ctx *w);
 int raid_bdev_remove_base_bdev(struct spdk_bdev *base_bdev, raid_base_bdev_cb cb_fn, void *cb_ctx);
 
@@ -306,6 +389,9 @@ struct raid_bdev_module {
 	/* Set to true if this module supports DIF/DIX */
 	bool dif_supported;
 
+	/* Set to true if this module supports read policies other than the default */
+	bool read_policy_supported;
+
 	/*
 	 * Called when the raid is starting, right before changing the state to
 	 * online and registering the bdev. Parameters of the bdev like blockcnt
@@ -349,6 +435,12 @@ struct raid_bdev_module {
 	int (*submit_process_request)(struct raid_bdev_process_request *process_req,
 				      struct raid_bdev_io_channel *raid_ch);
 
+	/*
+	 * Called when the raid bdev information is dumped to add module specific data, e.g.
+	 * statistics. Only called while the raid bdev is online. Optional.
+	 */
+	void (*dump_info_json)(struct raid_bdev *raid_bdev, struct spdk_json_write_ctx *w);
+
 	TAILQ_ENTRY(raid_bdev_module) link;
 };
 
@@ -468,7 +560,7 @@ raid_bdev_flush_blocks(struct raid_base_bdev_info *base_info, struct spdk_io_cha
  */
 
 #define RAID_BDEV_SB_VERSION_MAJOR	1
-#define RAID_BDEV_SB_VERSION_MINOR	0
+#define RAID_BDEV_SB_VERSION_MINOR	2
 
 #define RAID_BDEV_SB_NAME_SIZE		64
 
@@ -479,6 +571,9 @@ enum raid_bdev_sb_base_bdev_state {
 	RAID_SB_BASE_BDEV_SPARE		= 3,
 };
 
+/* all writes since the base bdev went missing are marked in the write-intent bitmap */
+#define RAID_SB_BASE_BDEV_FLAG_BITMAP	(1 << 0)
+
 struct raid_bdev_sb_base_bdev {
 	/* uuid of the base bdev */
 	struct spdk_uuid	uuid;
@@ -530,8 +625,17 @@ struct raid_bdev_superblock {
 	uint64_t		seq_number;
 	/* number of raid base devices */
 	uint8_t			num_base_bdevs;
+	/* read balancing policy, added in minor version 1 */
+	uint8_t			read_policy;
+
+	uint8_t			reserved0[2];
+
+	/* write-intent bitmap region size in blocks, 0 if there is no bitmap, added in minor version 2 */
+	uint32_t		bitmap_region_size;
+	/* offset in blocks of the write-intent bitmap from the start of the base bdevs */
+	uint32_t		bitmap_offset;
 
-	uint8_t			reserved[118];
+	uint8_t			reserved[107];
 
 	/* size of the base bdevs array */
 	uint8_t			base_bdevs_size;
@@ -555,12 +659,20 @@ void raid_bdev_write_superblock(struct raid_bdev *raid_bdev, raid_bdev_write_sb_
 				void *cb_ctx);
 int raid_bdev_load_base_bdev_superblock(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
 					raid_bdev_load_sb_cb cb, void *cb_ctx);
+void raid_bdev_write_bitmap(struct raid_bdev *raid_bdev, uint32_t offset_blocks, uint32_t num_blocks,
+			    raid_bdev_write_sb_cb cb, void *cb_ctx);
+int raid_bdev_load_bitmap(struct raid_bdev *raid_bdev, struct raid_base_bdev_info *base_info,
+			  raid_bdev_write_sb_cb cb, void *cb_ctx);
 
 struct spdk_raid_bdev_opts {
 	/* Size of the background process window in KiB */
 	uint32_t process_window_size_kb;
 	/* Maximum bandwidth in MiB to process per second */
 	uint32_t process_max_bandwidth_mb_sec;
+	/* Number of raid5f stripe cache entries per io channel, 0 disables partial stripe writes */
+	uint32_t raid5f_stripe_cache_size;
+	/* Time in microseconds for which raid5f collects partial writes before flushing a stripe */
+	uint32_t raid5f_stripe_cache_window_us;
 };
 
 void raid_bdev_get_opts(struct spdk_raid_bdev_opts *opts);
@@ -129,6 +129,9 @@ struct rpc_bdev_raid_create {
 	/* RAID raid level */
 	enum raid_level                      level;
 
+	/* RAID read balancing policy */
+	enum raid_read_policy                read_policy;
+
 	/* Base bdevs information */
 	struct rpc_bdev_raid_create_base_bdevs base_bdevs;
 
@@ -163,6 +166,30 @@ decode_raid_level(const struct spdk_json_val *val, void *out)
 	return ret;
 }
 
+/*
+ * Decoder function for RPC bdev_raid_create to decode read policy
+ */
+static int
+decode_read_policy(const struct spdk_json_val *val, void *out)
+{
+	int ret;
+	char *str = NULL;
+	enum raid_read_policy read_policy;
+
+	ret = spdk_json_decode_string(val, &str);
+	if (ret == 0 && str != NULL) {
+		read_policy = raid_bdev_str_to_read_policy(str);
+		if (read_policy == RAID_READ_POLICY_MAX) {
+			ret = -EINVAL;
+		} else {
+			*(enum raid_read_policy *)out = read_policy;
+		}
+	}
+
+	free(str);
+	return ret;
+}
+
 /*
  * Decoder function for RPC bdev_raid_create to decode base bdevs list
  */
@@ -184,6 +211,7 @@ static const struct spdk_json_object_decoder rpc_bdev_raid_create_decoders[] = {
 	{"base_bdevs", offsetof(struct rpc_bdev_raid_create, base_bdevs), decode_base_bdevs},
 	{"uuid", offsetof(struct rpc_bdev_raid_create, uuid), spdk_json_decode_uuid, true},
 	{"superblock", offsetof(struct rpc_bdev_raid_create, superblock_enabled), spdk_json_decode_bool, true},
+	{"read_policy", offsetof(struct rpc_bdev_raid_create, read_policy), decode_read_policy, true},
 };
 
 struct rpc_bdev_raid_create_ctx {
@@ -287,8 +315,8 @@ rpc_bdev_raid_create(struct spdk_jsonrpc_request *request,
 		}
 	}
 
-	rc = raid_bdev_create(req->name, req->strip_size_kb, num_base_bdevs,
-			      req->level, req->superblock_enabled, &req->uuid, &raid_bdev);
+	rc = raid_bdev_create(req->name, req->strip_size_kb, num_base_bdevs, req->level,
+			      req->read_policy, req->superblock_enabled, &req->uuid, &raid_bdev);
 	if (rc != 0) {
 		spdk_jsonrpc_send_error_response_fmt(request, rc,
 						     "Failed to create RAID bdev %s: %s",
@@ -608,6 +636,8 @@ SPDK_RPC_REGISTER("bdev_raid_remove_base_bdev", rpc_bdev_raid_remove_base_bdev,
 static const struct spdk_json_object_decoder rpc_bdev_raid_options_decoders[] = {
 	{"process_window_size_kb", offsetof(struct spdk_raid_bdev_opts, process_window_size_kb), spdk_json_decode_uint32, true},
 	{"process_max_bandwidth_mb_sec", offsetof(struct spdk_raid_bdev_opts, process_max_bandwidth_mb_sec), spdk_json_decode_uint32, true},
+	{"raid5f_stripe_cache_size", offsetof(struct spdk_raid_bdev_opts, raid5f_stripe_cache_size), spdk_json_decode_uint32, true},
+	{"raid5f_stripe_cache_window_us", offsetof(struct spdk_raid_bdev_opts, raid5f_stripe_cache_window_us), spdk_json_decode_uint32, true},
 };
 
 static void
@@ -14,6 +14,9 @@
 
 struct raid_bdev_write_sb_ctx {
 	struct raid_bdev *raid_bdev;
+	void *buf;
+	uint64_t offset;
+	uint64_t nbytes;
 	int status;
 	uint8_t submitted;
 	uint8_t remaining;
@@ -76,6 +79,7 @@ raid_bdev_init_superblock(struct raid_bdev *raid_bdev)
 	sb->raid_size = raid_bdev->bdev.blockcnt;
 	sb->block_size = spdk_bdev_get_data_block_size(&raid_bdev->bdev);
 	sb->level = raid_bdev->level;
+	sb->read_policy = raid_bdev->read_policy;
 	sb->strip_size = raid_bdev->strip_size;
 	/* TODO: sb->state */
 	sb->num_base_bdevs = sb->base_bdevs_size = raid_bdev->num_base_bdevs;
@@ -327,7 +331,8 @@ raid_bdev_write_superblock_cb(struct spdk_bdev_io *bdev_io, bool success, void *
 	int status = 0;
 
 	if (!success) {
-		SPDK_ERRLOG("Failed to save superblock on bdev %s\n", bdev_io->bdev->name);
+		SPDK_ERRLOG("Failed to save %s on bdev %s\n",
+			    ctx->offset == 0 ? "superblock" : "bitmap", bdev_io->bdev->name);
 		status = -EIO;
 	}
 
@@ -356,7 +361,7 @@ _raid_bdev_write_superblock(void *_ctx)
 		}
 
 		rc = spdk_bdev_write(base_info->desc, base_info->app_thread_ch,
-				     raid_bdev->sb_io_buf, 0, raid_bdev->sb_io_buf_size,
+				     ctx->buf, ctx->offset, ctx->nbytes,
 				     raid_bdev_write_superblock_cb, ctx);
 		if (rc != 0) {
 			struct spdk_bdev *bdev = spdk_bdev_desc_get_bdev(base_info->desc);
@@ -404,6 +409,9 @@ raid_bdev_write_superblock(struct raid_bdev *raid_bdev, raid_bdev_write_sb_cb cb
 	}
 
 	ctx->raid_bdev = raid_bdev;
+	ctx->buf = raid_bdev->sb_io_buf;
+	ctx->offset = 0;
+	ctx->nbytes = raid_bdev->sb_io_buf_size;
 	ctx->remaining = raid_bdev->num_base_bdevs + 1;
 	ctx->cb = cb;
 	ctx->cb_ctx = cb_ctx;
@@ -427,4 +435,86 @@ err:
 	cb(rc, raid_bdev, cb_ctx);
 }
 
+void
+raid_bdev_write_bitmap(struct raid_bdev *raid_bdev, uint32_t offset_blocks, uint32_t num_blocks,
+		       raid_bdev_write_sb_cb cb, void *cb_ctx)
+{
+	struct raid_bdev_bitmap *bitmap = raid_bdev->bitmap;
+	struct raid_bdev_write_sb_ctx *ctx;
+	uint32_t blocklen = raid_bdev->bdev.blocklen;
+
+	assert(spdk_get_thread() == spdk_thread_get_app_thread());
+	assert(bitmap != NULL);
+	assert(cb != NULL);
+	assert(offset_blocks + num_blocks <= bitmap->num_blocks);
+
+	ctx = calloc(1, sizeof(*ctx));
+	if (!ctx) {
+		cb(-ENOMEM, raid_bdev, cb_ctx);
+		return;
+	}
+
+	ctx->raid_bdev = raid_bdev;
+	ctx->buf = bitmap->buf + (uint64_t)offset_blocks * blocklen;
+	ctx->offset = (bitmap->offset_blocks + offset_blocks) * blocklen;
+	ctx->nbytes = (uint64_t)num_blocks * blocklen;
+	ctx->remaining = raid_bdev->num_base_bdevs + 1;
+	ctx->cb = cb;
+	ctx->cb_ctx = cb_ctx;
+
+	_raid_bdev_write_superblock(ctx);
+}
+
+struct raid_bdev_read_bitmap_ctx {
+	struct raid_bdev *raid_bdev;
+	raid_bdev_write_sb_cb cb;
+	void *cb_ctx;
+};
+
+static void
+raid_bdev_read_bitmap_cb(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct raid_bdev_read_bitmap_ctx *ctx = cb_arg;
+
+	if (!success) {
+		SPDK_ERRLOG("Failed to read bitmap from bdev %s\n", bdev_io->bdev->name);
+	}
+
+	spdk_bdev_free_io(bdev_io);
+
+	ctx->cb(success ? 0 : -EIO, ctx->raid_bdev, ctx->cb_ctx);
+	free(ctx);
+}
+
+int
+raid_bdev_load_bitmap(struct raid_bdev *raid_bdev, struct raid_base_bdev_info *base_info,
+		      raid_bdev_write_sb_cb cb, void *cb_ctx)
+{
+	struct raid_bdev_bitmap *bitmap = raid_bdev->bitmap;
+	struct raid_bdev_read_bitmap_ctx *ctx;
+	uint32_t blocklen = raid_bdev->bdev.blocklen;
+	int rc;
+
+	assert(bitmap != NULL);
+	assert(cb != NULL);
+
+	ctx = calloc(1, sizeof(*ctx));
+	if (!ctx) {
+		return -ENOMEM;
+	}
+
+	ctx->raid_bdev = raid_bdev;
+	ctx->cb = cb;
+	ctx->cb_ctx = cb_ctx;
+
+	rc = spdk_bdev_read(base_info->desc, base_info->app_thread_ch, bitmap->buf,
+			    bitmap->offset_blocks * blocklen, (uint64_t)bitmap->num_blocks * blocklen,
+			    raid_bdev_read_bitmap_cb, ctx);
+	if (rc != 0) {
+		free(ctx);
+	}
+
+	return rc;
+}
+
 SPDK_LOG_REGISTER_COMPONENT(bdev_raid_sb)
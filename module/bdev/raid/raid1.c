@@ -5,17 +5,86 @@
 
 #include "bdev_raid.h"
 
+#include "spdk/env.h"
 #include "spdk/likely.h"
 #include "spdk/log.h"
+#include "spdk/json.h"
+
+/* Weight of a new sample in the read latency moving average, as a power of 2 divisor */
+#define RAID1_LATENCY_EWMA_SHIFT	3
+
+/*
+ * With the latency read policy, every Nth read on a channel is sent to the base bdevs in turn,
+ * regardless of their expected service time, to keep latency of the unused ones up to date.
+ */
+#define RAID1_LATENCY_PROBE_INTERVAL	256
+
+/* Number of sequential read streams tracked per channel */
+#define RAID1_SEQ_STREAMS_MAX		8
+
+/*
+ * A sequential read stream stays on its base bdev unless that base bdev's expected service
+ * time is higher than this multiple of the lowest one.
+ */
+#define RAID1_SEQ_AFFINITY_FACTOR	2
+
+struct raid1_base_read_stats {
+	/* Number of outstanding read blocks */
+	uint64_t read_blocks_outstanding;
+
+	/* Number of outstanding reads */
+	uint64_t reads_outstanding;
+
+	/* Moving average of read completion latency in ticks, 0 until the first completion */
+	uint64_t latency_ewma_ticks;
+
+	/* Number of successfully completed reads */
+	uint64_t reads_completed;
+
+	/* Number of successfully completed read blocks */
+	uint64_t read_blocks_completed;
+};
 
 struct raid1_info {
 	/* The parent raid bdev */
 	struct raid_bdev *raid_bdev;
+
+	/* Protects the list of channels, which is used to collect the read statistics */
+	pthread_mutex_t mutex;
+
+	/* List of all io channels of this raid bdev */
+	TAILQ_HEAD(, raid1_io_channel) channels;
+
+	/* Completed read counters of already destroyed channels */
+	struct raid1_base_read_stats base_stats_retired[0];
+};
+
+struct raid1_seq_stream {
+	/* Offset right after the last read of the stream */
+	uint64_t next_offset_blocks;
+
+	/* Base bdev serving the stream */
+	uint8_t idx;
 };
 
 struct raid1_io_channel {
-	/* Array of per-base_bdev counters of outstanding read blocks on this channel */
-	uint64_t read_blocks_outstanding[0];
+	/* Link on the parent raid1_info channel list */
+	TAILQ_ENTRY(raid1_io_channel) link;
+
+	/* Number of reads left until the next probe read */
+	uint32_t reads_until_probe;
+
+	/* Base bdev to use for the next probe read */
+	uint8_t probe_idx;
+
+	/* Slot to reuse for the next new sequential read stream */
+	uint8_t seq_stream_next;
+
+	/* Recently seen sequential read streams */
+	struct raid1_seq_stream seq_streams[RAID1_SEQ_STREAMS_MAX];
+
+	/* Array of per-base_bdev read statistics of this channel */
+	struct raid1_base_read_stats base_stats[0];
 };
 
 static void
@@ -23,9 +92,11 @@ raid1_channel_inc_read_counters(struct raid_bdev_io_channel *raid_ch, uint8_t id
 				uint64_t num_blocks)
 {
 	struct raid1_io_channel *raid1_ch = raid_bdev_channel_get_module_ctx(raid_ch);
+	struct raid1_base_read_stats *stats = &raid1_ch->base_stats[idx];
 
-	assert(raid1_ch->read_blocks_outstanding[idx] <= UINT64_MAX - num_blocks);
-	raid1_ch->read_blocks_outstanding[idx] += num_blocks;
+	assert(stats->read_blocks_outstanding <= UINT64_MAX - num_blocks);
+	stats->read_blocks_outstanding += num_blocks;
+	stats->reads_outstanding++;
 }
 
 static void
@@ -33,9 +104,30 @@ raid1_channel_dec_read_counters(struct raid_bdev_io_channel *raid_ch, uint8_t id
 				uint64_t num_blocks)
 {
 	struct raid1_io_channel *raid1_ch = raid_bdev_channel_get_module_ctx(raid_ch);
+	struct raid1_base_read_stats *stats = &raid1_ch->base_stats[idx];
+
+	assert(stats->read_blocks_outstanding >= num_blocks);
+	stats->read_blocks_outstanding -= num_blocks;
+	assert(stats->reads_outstanding > 0);
+	stats->reads_outstanding--;
+}
+
+static void
+raid1_channel_update_read_latency(struct raid_bdev_io_channel *raid_ch, uint8_t idx,
+				  uint64_t num_blocks, uint64_t latency_ticks)
+{
+	struct raid1_io_channel *raid1_ch = raid_bdev_channel_get_module_ctx(raid_ch);
+	struct raid1_base_read_stats *stats = &raid1_ch->base_stats[idx];
 
-	assert(raid1_ch->read_blocks_outstanding[idx] >= num_blocks);
-	raid1_ch->read_blocks_outstanding[idx] -= num_blocks;
+	if (stats->latency_ewma_ticks == 0) {
+		stats->latency_ewma_ticks = latency_ticks;
+	} else {
+		stats->latency_ewma_ticks += ((int64_t)latency_ticks - (int64_t)stats->latency_ewma_ticks) >>
+					     RAID1_LATENCY_EWMA_SHIFT;
+	}
+
+	stats->reads_completed++;
+	stats->read_blocks_completed += num_blocks;
 }
 
 static void
@@ -192,10 +284,15 @@ raid1_read_bdev_io_completion(struct spdk_bdev_io *bdev_io, bool success, void *
 {
 	struct raid_bdev_io *raid_io = cb_arg;
 
-	spdk_bdev_free_io(bdev_io);
-
 	raid1_channel_dec_read_counters(raid_io->raid_ch, raid_io->base_bdev_io_submitted,
 					raid_io->num_blocks);
+	if (spdk_likely(success)) {
+		raid1_channel_update_read_latency(raid_io->raid_ch, raid_io->base_bdev_io_submitted,
+						  raid_io->num_blocks,
+						  spdk_get_ticks() - spdk_bdev_io_get_submit_tsc(bdev_io));
+	}
+
+	spdk_bdev_free_io(bdev_io);
 
 	if (!success) {
 		raid_io->base_bdev_io_remaining = raid_io->raid_bdev->num_base_bdevs;
@@ -217,7 +314,8 @@ _raid1_submit_rw_request(void *_raid_io)
 }
 
 static uint8_t
-raid1_channel_next_read_base_bdev(struct raid_bdev *raid_bdev, struct raid_bdev_io_channel *raid_ch)
+raid1_channel_next_read_base_bdev_outstanding(struct raid_bdev *raid_bdev,
+		struct raid_bdev_io_channel *raid_ch)
 {
 	struct raid1_io_channel *raid1_ch = raid_bdev_channel_get_module_ctx(raid_ch);
 	uint64_t read_blocks_min = UINT64_MAX;
@@ -226,8 +324,8 @@ raid1_channel_next_read_base_bdev(struct raid_bdev *raid_bdev, struct raid_bdev_
 
 	for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
 		if (raid_bdev_channel_get_base_channel(raid_ch, i) != NULL &&
-		    raid1_ch->read_blocks_outstanding[i] < read_blocks_min) {
-			read_blocks_min = raid1_ch->read_blocks_outstanding[i];
+		    raid1_ch->base_stats[i].read_blocks_outstanding < read_blocks_min) {
+			read_blocks_min = raid1_ch->base_stats[i].read_blocks_outstanding;
 			idx = i;
 		}
 	}
@@ -235,6 +333,108 @@ raid1_channel_next_read_base_bdev(struct raid_bdev *raid_bdev, struct raid_bdev_
 	return idx;
 }
 
+/*
+ * Expected time to serve a new read: the latency of one read multiplied by the number of reads
+ * that have to complete before it, including itself. Base bdevs without a latency sample yet
+ * are only weighed by their queue depth so that they get reads until they are measured.
+ */
+static inline uint64_t
+raid1_read_expected_service_time(const struct raid1_base_read_stats *stats)
+{
+	return (stats->latency_ewma_ticks + 1) * (stats->reads_outstanding + 1);
+}
+
+static uint8_t
+raid1_channel_next_read_base_bdev_probe(struct raid_bdev *raid_bdev,
+					struct raid_bdev_io_channel *raid_ch)
+{
+	struct raid1_io_channel *raid1_ch = raid_bdev_channel_get_module_ctx(raid_ch);
+	uint8_t idx;
+	uint8_t i;
+
+	for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
+		idx = (raid1_ch->probe_idx + i) % raid_bdev->num_base_bdevs;
+
+		if (raid_bdev_channel_get_base_channel(raid_ch, idx) != NULL) {
+			raid1_ch->probe_idx = (idx + 1) % raid_bdev->num_base_bdevs;
+			return idx;
+		}
+	}
+
+	return UINT8_MAX;
+}
+
+static uint8_t
+raid1_channel_next_read_base_bdev_latency(struct raid_bdev *raid_bdev,
+		struct raid_bdev_io_channel *raid_ch,
+		uint64_t offset_blocks, uint64_t num_blocks)
+{
+	struct raid1_io_channel *raid1_ch = raid_bdev_channel_get_module_ctx(raid_ch);
+	struct raid1_seq_stream *stream = NULL;
+	uint64_t est, est_min = UINT64_MAX;
+	uint8_t idx = UINT8_MAX;
+	uint8_t i;
+
+	if (spdk_unlikely(--raid1_ch->reads_until_probe == 0)) {
+		raid1_ch->reads_until_probe = RAID1_LATENCY_PROBE_INTERVAL;
+		return raid1_channel_next_read_base_bdev_probe(raid_bdev, raid_ch);
+	}
+
+	for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
+		if (raid_bdev_channel_get_base_channel(raid_ch, i) == NULL) {
+			continue;
+		}
+
+		est = raid1_read_expected_service_time(&raid1_ch->base_stats[i]);
+		if (est < est_min) {
+			est_min = est;
+			idx = i;
+		}
+	}
+
+	if (spdk_unlikely(idx == UINT8_MAX)) {
+		return idx;
+	}
+
+	for (i = 0; i < RAID1_SEQ_STREAMS_MAX; i++) {
+		if (raid1_ch->seq_streams[i].next_offset_blocks == offset_blocks) {
+			stream = &raid1_ch->seq_streams[i];
+			break;
+		}
+	}
+
+	if (stream != NULL) {
+		/* Keep the stream on its base bdev unless it became much slower than the others */
+		if (raid_bdev_channel_get_base_channel(raid_ch, stream->idx) != NULL &&
+		    raid1_read_expected_service_time(&raid1_ch->base_stats[stream->idx]) <=
+		    est_min * RAID1_SEQ_AFFINITY_FACTOR) {
+			idx = stream->idx;
+		}
+	} else {
+		stream = &raid1_ch->seq_streams[raid1_ch->seq_stream_next];
+		raid1_ch->seq_stream_next = (raid1_ch->seq_stream_next + 1) % RAID1_SEQ_STREAMS_MAX;
+	}
+
+	stream->next_offset_blocks = offset_blocks + num_blocks;
+	stream->idx = idx;
+
+	return idx;
+}
+
+static uint8_t
+raid1_channel_next_read_base_bdev(struct raid_bdev *raid_bdev, struct raid_bdev_io_channel *raid_ch,
+				  struct raid_bdev_io *raid_io)
+{
+	switch (raid_bdev->read_policy) {
+	case RAID_READ_POLICY_LATENCY:
+		return raid1_channel_next_read_base_bdev_latency(raid_bdev, raid_ch, raid_io->offset_blocks,
+				raid_io->num_blocks);
+	case RAID_READ_POLICY_OUTSTANDING_BLOCKS:
+	default:
+		return raid1_channel_next_read_base_bdev_outstanding(raid_bdev, raid_ch);
+	}
+}
+
 static int
 raid1_submit_read_request(struct raid_bdev_io *raid_io)
 {
@@ -246,7 +446,7 @@ raid1_submit_read_request(struct raid_bdev_io *raid_io)
 	uint8_t idx;
 	int ret;
 
-	idx = raid1_channel_next_read_base_bdev(raid_bdev, raid_ch);
+	idx = raid1_channel_next_read_base_bdev(raid_bdev, raid_ch, raid_io);
 	if (spdk_unlikely(idx == UINT8_MAX)) {
 		raid_bdev_io_complete(raid_io, SPDK_BDEV_IO_STATUS_FAILED);
 		return 0;
@@ -352,11 +552,36 @@ raid1_submit_rw_request(struct raid_bdev_io *raid_io)
 static void
 raid1_ioch_destroy(void *io_device, void *ctx_buf)
 {
+	struct raid1_info *r1info = io_device;
+	struct raid1_io_channel *raid1_ch = ctx_buf;
+	uint8_t i;
+
+	pthread_mutex_lock(&r1info->mutex);
+	TAILQ_REMOVE(&r1info->channels, raid1_ch, link);
+	for (i = 0; i < r1info->raid_bdev->num_base_bdevs; i++) {
+		r1info->base_stats_retired[i].reads_completed += raid1_ch->base_stats[i].reads_completed;
+		r1info->base_stats_retired[i].read_blocks_completed +=
+			raid1_ch->base_stats[i].read_blocks_completed;
+	}
+	pthread_mutex_unlock(&r1info->mutex);
 }
 
 static int
 raid1_ioch_create(void *io_device, void *ctx_buf)
 {
+	struct raid1_info *r1info = io_device;
+	struct raid1_io_channel *raid1_ch = ctx_buf;
+	uint8_t i;
+
+	raid1_ch->reads_until_probe = RAID1_LATENCY_PROBE_INTERVAL;
+	for (i = 0; i < RAID1_SEQ_STREAMS_MAX; i++) {
+		raid1_ch->seq_streams[i].next_offset_blocks = UINT64_MAX;
+	}
+
+	pthread_mutex_lock(&r1info->mutex);
+	TAILQ_INSERT_TAIL(&r1info->channels, raid1_ch, link);
+	pthread_mutex_unlock(&r1info->mutex);
+
 	return 0;
 }
 
@@ -367,6 +592,7 @@ raid1_io_device_unregister_done(void *io_device)
 
 	raid_bdev_module_stop_done(r1info->raid_bdev);
 
+	pthread_mutex_destroy(&r1info->mutex);
 	free(r1info);
 }
 
@@ -378,12 +604,20 @@ raid1_start(struct raid_bdev *raid_bdev)
 	struct raid1_info *r1info;
 	char name[256];
 
-	r1info = calloc(1, sizeof(*r1info));
+	r1info = calloc(1, sizeof(*r1info) +
+			raid_bdev->num_base_bdevs * sizeof(struct raid1_base_read_stats));
 	if (!r1info) {
 		SPDK_ERRLOG("Failed to allocate RAID1 info device structure\n");
 		return -ENOMEM;
 	}
 	r1info->raid_bdev = raid_bdev;
+	TAILQ_INIT(&r1info->channels);
+
+	if (pthread_mutex_init(&r1info->mutex, NULL) != 0) {
+		SPDK_ERRLOG("Failed to initialize RAID1 info mutex\n");
+		free(r1info);
+		return -ENOMEM;
+	}
 
 	RAID_FOR_EACH_BASE_BDEV(raid_bdev, base_info) {
 		min_blockcnt = spdk_min(min_blockcnt, base_info->data_size);
@@ -398,7 +632,8 @@ raid1_start(struct raid_bdev *raid_bdev)
 
 	snprintf(name, sizeof(name), "raid1_%s", raid_bdev->bdev.name);
 	spdk_io_device_register(r1info, raid1_ioch_create, raid1_ioch_destroy,
-				sizeof(struct raid1_io_channel) + raid_bdev->num_base_bdevs * sizeof(uint64_t),
+				sizeof(struct raid1_io_channel) +
+				raid_bdev->num_base_bdevs * sizeof(struct raid1_base_read_stats),
 				name);
 
 	return 0;
@@ -533,17 +768,71 @@ raid1_resize(struct raid_bdev *raid_bdev)
 	return true;
 }
 
+/*
+ * Collect the read statistics of all channels. The counters are updated by the channels'
+ * threads without synchronization, so the result is a best effort snapshot.
+ */
+static void
+raid1_dump_info_json(struct raid_bdev *raid_bdev, struct spdk_json_write_ctx *w)
+{
+	struct raid1_info *r1info = raid_bdev->module_private;
+	struct raid1_io_channel *raid1_ch;
+	struct raid_base_bdev_info *base_info;
+	uint64_t ticks_hz = spdk_get_ticks_hz();
+
+	spdk_json_write_named_array_begin(w, "base_bdevs_read_stats");
+	pthread_mutex_lock(&r1info->mutex);
+	RAID_FOR_EACH_BASE_BDEV(raid_bdev, base_info) {
+		uint8_t i = raid_bdev_base_bdev_slot(base_info);
+		struct raid1_base_read_stats stats = r1info->base_stats_retired[i];
+		uint64_t latency_sum = 0;
+		uint32_t latency_cnt = 0;
+
+		TAILQ_FOREACH(raid1_ch, &r1info->channels, link) {
+			const struct raid1_base_read_stats *ch_stats = &raid1_ch->base_stats[i];
+
+			stats.reads_outstanding += ch_stats->reads_outstanding;
+			stats.read_blocks_outstanding += ch_stats->read_blocks_outstanding;
+			stats.reads_completed += ch_stats->reads_completed;
+			stats.read_blocks_completed += ch_stats->read_blocks_completed;
+			if (ch_stats->latency_ewma_ticks != 0) {
+				latency_sum += ch_stats->latency_ewma_ticks;
+				latency_cnt++;
+			}
+		}
+
+		spdk_json_write_object_begin(w);
+		spdk_json_write_name(w, "name");
+		if (base_info->name) {
+			spdk_json_write_string(w, base_info->name);
+		} else {
+			spdk_json_write_null(w);
+		}
+		spdk_json_write_named_uint64(w, "reads_completed", stats.reads_completed);
+		spdk_json_write_named_uint64(w, "read_blocks_completed", stats.read_blocks_completed);
+		spdk_json_write_named_uint64(w, "reads_outstanding", stats.reads_outstanding);
+		spdk_json_write_named_uint64(w, "read_blocks_outstanding", stats.read_blocks_outstanding);
+		spdk_json_write_named_uint64(w, "latency_ewma_us", latency_cnt == 0 ? 0 :
+					     latency_sum * SPDK_SEC_TO_USEC / latency_cnt / ticks_hz);
+		spdk_json_write_object_end(w);
+	}
+	pthread_mutex_unlock(&r1info->mutex);
+	spdk_json_write_array_end(w);
+}
+
 static struct raid_bdev_module g_raid1_module = {
 	.level = RAID1,
 	.base_bdevs_min = 2,
 	.base_bdevs_constraint = {CONSTRAINT_MIN_BASE_BDEVS_OPERATIONAL, 1},
 	.memory_domains_supported = true,
+	.read_policy_supported = true,
 	.start = raid1_start,
 	.stop = raid1_stop,
 	.submit_rw_request = raid1_submit_rw_request,
 	.get_io_channel = raid1_get_io_channel,
 	.submit_process_request = raid1_submit_process_request,
 	.resize = raid1_resize,
+	.dump_info_json = raid1_dump_info_json,
 };
 RAID_MODULE_REGISTER(&g_raid1_module)
 
@@ -7,6 +7,7 @@
 
 #include "spdk/env.h"
 #include "spdk/thread.h"
+#include "spdk/bit_array.h"
 #include "spdk/string.h"
 #include "spdk/util.h"
 #include "spdk/likely.h"
@@ -16,6 +17,9 @@
 /* Maximum concurrent full stripe writes per io channel */
 #define RAID5F_MAX_STRIPES 32
 
+/* Number of stripe lock buckets, each tracks locked stripes and a modification generation */
+#define RAID5F_STRIPE_LOCK_BUCKETS 1024
+
 struct chunk {
 	/* Corresponds to base_bdev index */
 	uint8_t index;
@@ -33,6 +37,36 @@ struct chunk {
 	void *md_buf;
 };
 
+struct stripe_lock;
+typedef void (*stripe_lock_cb)(struct stripe_lock *lock);
+
+struct stripe_lock {
+	/* Index of the locked stripe */
+	uint64_t stripe_index;
+
+	/* Thread on which cb is called if the lock could not be granted immediately */
+	struct spdk_thread *thread;
+
+	/* Called when the lock is granted after the previous holder released it */
+	stripe_lock_cb cb;
+
+	/* Generation of the stripe's lock bucket when the lock was granted or released */
+	uint64_t gen;
+
+	/* Locks waiting for this one to be released, only valid for the holder */
+	TAILQ_HEAD(, stripe_lock) waiters;
+
+	TAILQ_ENTRY(stripe_lock) link;
+};
+
+struct stripe_lock_bucket {
+	/* Held locks of the stripes mapped to this bucket */
+	TAILQ_HEAD(, stripe_lock) held;
+
+	/* Incremented on each modification of a stripe mapped to this bucket */
+	uint64_t gen;
+};
+
 struct stripe_request;
 typedef void (*stripe_req_xor_cb)(struct stripe_request *stripe_req, int status);
 
@@ -96,10 +130,102 @@ struct stripe_request {
 
 	TAILQ_ENTRY(stripe_request) link;
 
+	/* Stripe lock, used by reconstruct requests when partial stripe writes are enabled */
+	struct stripe_lock lock;
+	bool locked;
+
 	/* Array of chunks corresponding to base_bdevs */
 	struct chunk chunks[0];
 };
 
+/* Chunk flags used when flushing a stripe cache entry */
+#define STRIPE_CACHE_CHUNK_DIRTY	(1 << 0)
+#define STRIPE_CACHE_CHUNK_FULL		(1 << 1)
+#define STRIPE_CACHE_CHUNK_READ		(1 << 2)
+#define STRIPE_CACHE_CHUNK_WRITE	(1 << 3)
+
+struct stripe_cache_entry {
+	struct raid5f_io_channel *r5ch;
+
+	/* The raid channel of the collected writes, provides the base bdev channels */
+	struct raid_bdev_io_channel *raid_ch;
+
+	/* The stripe's index in the raid array. */
+	uint64_t stripe_index;
+
+	enum stripe_cache_entry_state {
+		/* No pending writes, the buffers may still hold a copy of the stripe */
+		STRIPE_CACHE_ENTRY_IDLE,
+		/* Collecting writes until the stripe is complete or the window expires */
+		STRIPE_CACHE_ENTRY_COLLECTING,
+		/* Updating the stripe on the base bdevs */
+		STRIPE_CACHE_ENTRY_FLUSHING,
+	} state;
+
+	/* The buffers hold the current contents of the whole stripe, including parity */
+	bool valid;
+
+	/* Generation of the stripe's lock bucket matching the cached contents */
+	uint64_t valid_gen;
+
+	/* Time when a collecting entry is flushed */
+	uint64_t flush_tsc;
+
+	/* Time of the last use, for choosing an entry to reuse */
+	uint64_t last_used_tsc;
+
+	/* Data blocks of the stripe updated by the collected writes */
+	struct spdk_bit_array *dirty;
+
+	/* Chunk buffers and buffers for the chunks' old contents, indexed like base_bdevs */
+	void **bufs;
+	void **old_bufs;
+
+	/* Collected writes */
+	TAILQ_HEAD(, raid_bdev_io) ios;
+
+	/* Writes to this stripe received during the flush */
+	TAILQ_HEAD(, raid_bdev_io) deferred;
+
+	struct {
+		/* STRIPE_CACHE_CHUNK_* flags for each chunk */
+		uint8_t *chunk_flags;
+
+		/* Chunk whose old contents are reconstructed from the other chunks */
+		uint8_t reconstruct_idx;
+
+		/* Parity is updated (read-modify-write) instead of being recomputed */
+		bool rmw;
+
+		/* Parity chunk is present and gets written */
+		bool write_parity;
+
+		/* Set once the reads are done and the chunks are being written */
+		bool writing;
+
+		/* Old chunk contents are reconstructed by the current xor */
+		bool reconstructing;
+
+		/* Next chunk to submit and number of outstanding base bdev I/Os */
+		uint8_t submit_idx;
+		uint8_t remaining;
+
+		int status;
+
+		/* Base bdev I/O iovecs, indexed like base_bdevs */
+		struct iovec *iovs;
+
+		/* Sources for parity calculation */
+		void **xor_srcs;
+	} flush;
+
+	struct stripe_lock lock;
+
+	struct spdk_bdev_io_wait_entry waitq_entry;
+
+	TAILQ_ENTRY(stripe_cache_entry) link;
+};
+
 struct raid5f_info {
 	/* The parent raid bdev */
 	struct raid_bdev *raid_bdev;
@@ -115,6 +241,19 @@ struct raid5f_info {
 
 	/* block length bit shift for optimized calculation, only valid when no interleaved md */
 	uint32_t blocklen_shift;
+
+	/* Number of stripe cache entries per io channel, 0 if partial stripe writes are disabled */
+	uint32_t stripe_cache_size;
+
+	/* Time window for collecting partial writes to a stripe */
+	uint32_t stripe_cache_window_us;
+	uint64_t stripe_cache_window_ticks;
+
+	/* Serialize stripe updates and reconstruction when partial stripe writes are enabled */
+	struct {
+		struct spdk_spinlock lock;
+		struct stripe_lock_bucket *buckets;
+	} stripe_locks;
 };
 
 struct raid5f_io_channel {
@@ -134,6 +273,20 @@ struct raid5f_io_channel {
 	void **chunk_xor_buffers;
 	struct iovec **chunk_xor_iovs;
 	size_t *chunk_xor_iovcnt;
+
+	/* Stripe cache for partial stripe writes */
+	struct {
+		struct stripe_cache_entry **entries;
+
+		/* Flushes entries when their window expires */
+		struct spdk_poller *poller;
+
+		/* For retrying xor if accel_ch runs out of resources */
+		TAILQ_HEAD(, stripe_cache_entry) xor_retry_queue;
+
+		/* For copying write data to the chunk buffers */
+		struct iovec *iovs;
+	} stripe_cache;
 };
 
 #define __CHUNK_IN_RANGE(req, c) \
@@ -176,9 +329,89 @@ raid5f_stripe_parity_chunk_index(const struct raid_bdev *raid_bdev, uint64_t str
 	return raid5f_stripe_data_chunks_num(raid_bdev) - stripe_index % raid_bdev->num_base_bdevs;
 }
 
+static inline struct stripe_lock_bucket *
+raid5f_stripe_lock_bucket(struct raid5f_info *r5f_info, uint64_t stripe_index)
+{
+	return &r5f_info->stripe_locks.buckets[stripe_index % RAID5F_STRIPE_LOCK_BUCKETS];
+}
+
+/*
+ * Lock a stripe for an update or reconstruction. Returns true if the lock was granted
+ * immediately. Otherwise, lock->cb is called on the current thread once it is granted.
+ */
+static bool
+raid5f_stripe_lock(struct raid5f_info *r5f_info, struct stripe_lock *lock)
+{
+	struct stripe_lock_bucket *bucket = raid5f_stripe_lock_bucket(r5f_info, lock->stripe_index);
+	struct stripe_lock *holder;
+	bool granted = true;
+
+	lock->thread = spdk_get_thread();
+	TAILQ_INIT(&lock->waiters);
+
+	spdk_spin_lock(&r5f_info->stripe_locks.lock);
+	TAILQ_FOREACH(holder, &bucket->held, link) {
+		if (holder->stripe_index == lock->stripe_index) {
+			TAILQ_INSERT_TAIL(&holder->waiters, lock, link);
+			granted = false;
+			break;
+		}
+	}
+	if (granted) {
+		TAILQ_INSERT_TAIL(&bucket->held, lock, link);
+		lock->gen = bucket->gen;
+	}
+	spdk_spin_unlock(&r5f_info->stripe_locks.lock);
+
+	return granted;
+}
+
+static void
+_raid5f_stripe_lock_granted(void *ctx)
+{
+	struct stripe_lock *lock = ctx;
+
+	lock->cb(lock);
+}
+
+static void
+raid5f_stripe_unlock(struct raid5f_info *r5f_info, struct stripe_lock *lock, bool modified)
+{
+	struct stripe_lock_bucket *bucket = raid5f_stripe_lock_bucket(r5f_info, lock->stripe_index);
+	struct stripe_lock *next;
+	int rc;
+
+	spdk_spin_lock(&r5f_info->stripe_locks.lock);
+	TAILQ_REMOVE(&bucket->held, lock, link);
+	if (modified) {
+		bucket->gen++;
+	}
+	lock->gen = bucket->gen;
+
+	next = TAILQ_FIRST(&lock->waiters);
+	if (next != NULL) {
+		TAILQ_REMOVE(&lock->waiters, next, link);
+		TAILQ_CONCAT(&next->waiters, &lock->waiters, link);
+		TAILQ_INSERT_TAIL(&bucket->held, next, link);
+		next->gen = bucket->gen;
+	}
+	spdk_spin_unlock(&r5f_info->stripe_locks.lock);
+
+	if (next != NULL) {
+		rc = spdk_thread_send_msg(next->thread, _raid5f_stripe_lock_granted, next);
+		assert(rc == 0);
+		(void)rc;
+	}
+}
+
 static inline void
 raid5f_stripe_request_release(struct stripe_request *stripe_req)
 {
+	if (spdk_unlikely(stripe_req->locked)) {
+		stripe_req->locked = false;
+		raid5f_stripe_unlock(raid5f_ch_to_r5f_info(stripe_req->r5ch), &stripe_req->lock, false);
+	}
+
 	if (spdk_likely(stripe_req->type == STRIPE_REQ_WRITE)) {
 		TAILQ_INSERT_HEAD(&stripe_req->r5ch->free_stripe_requests.write, stripe_req, link);
 	} else if (stripe_req->type == STRIPE_REQ_RECONSTRUCT) {
@@ -702,11 +935,20 @@ raid5f_reconstruct_reads_completed_cb(struct raid_bdev_io *raid_io, enum spdk_bd
 	raid5f_xor_stripe(stripe_req, stripe_req->xor.cb);
 }
 
+static void
+raid5f_stripe_request_locked(struct stripe_lock *lock)
+{
+	struct stripe_request *stripe_req = SPDK_CONTAINEROF(lock, struct stripe_request, lock);
+
+	raid5f_stripe_request_submit_chunks(stripe_req);
+}
+
 static int
 raid5f_submit_reconstruct_read(struct raid_bdev_io *raid_io, uint64_t stripe_index,
 			       uint8_t chunk_idx, uint64_t chunk_offset, stripe_req_xor_cb cb)
 {
 	struct raid_bdev *raid_bdev = raid_io->raid_bdev;
+	struct raid5f_info *r5f_info = raid_bdev->module_private;
 	struct raid5f_io_channel *r5ch = raid_bdev_channel_get_module_ctx(raid_io->raid_ch);
 	void *raid_io_md = raid_io->md_buf;
 	struct stripe_request *stripe_req;
@@ -763,6 +1005,16 @@ raid5f_submit_reconstruct_read(struct raid_bdev_io *raid_io, uint64_t stripe_ind
 
 	TAILQ_REMOVE(&r5ch->free_stripe_requests.reconstruct, stripe_req, link);
 
+	if (r5f_info->stripe_cache_size != 0) {
+		/* Don't read the stripe while a partial write is updating it */
+		stripe_req->lock.stripe_index = stripe_index;
+		stripe_req->lock.cb = raid5f_stripe_request_locked;
+		stripe_req->locked = true;
+		if (!raid5f_stripe_lock(r5f_info, &stripe_req->lock)) {
+			return 0;
+		}
+	}
+
 	raid5f_stripe_request_submit_chunks(stripe_req);
 
 	return 0;
@@ -801,6 +1053,557 @@ raid5f_submit_read_request(struct raid_bdev_io *raid_io, uint64_t stripe_index,
 	return ret;
 }
 
+static inline uint8_t
+raid5f_stripe_cache_data_chunk_num(struct stripe_cache_entry *entry, uint8_t chunk_idx)
+{
+	struct raid_bdev *raid_bdev = raid5f_ch_to_r5f_info(entry->r5ch)->raid_bdev;
+	uint8_t p_idx = raid5f_stripe_parity_chunk_index(raid_bdev, entry->stripe_index);
+
+	assert(chunk_idx != p_idx);
+
+	return chunk_idx < p_idx ? chunk_idx : chunk_idx - 1;
+}
+
+static uint8_t
+raid5f_stripe_cache_chunk_dirty_flags(struct stripe_cache_entry *entry, uint8_t chunk_idx)
+{
+	struct raid_bdev *raid_bdev = raid5f_ch_to_r5f_info(entry->r5ch)->raid_bdev;
+	uint32_t start = raid5f_stripe_cache_data_chunk_num(entry, chunk_idx) * raid_bdev->strip_size;
+	uint32_t end = start + raid_bdev->strip_size;
+
+	if (spdk_bit_array_find_first_set(entry->dirty, start) >= end) {
+		return 0;
+	}
+
+	if (spdk_bit_array_find_first_clear(entry->dirty, start) >= end) {
+		return STRIPE_CACHE_CHUNK_DIRTY | STRIPE_CACHE_CHUNK_FULL;
+	}
+
+	return STRIPE_CACHE_CHUNK_DIRTY;
+}
+
+/* Copy the blocks not written by the collected writes from the chunk's old contents */
+static void
+raid5f_stripe_cache_chunk_merge(struct stripe_cache_entry *entry, uint8_t chunk_idx)
+{
+	struct raid_bdev *raid_bdev = raid5f_ch_to_r5f_info(entry->r5ch)->raid_bdev;
+	uint32_t blocklen = raid_bdev->bdev.blocklen;
+	uint32_t start = raid5f_stripe_cache_data_chunk_num(entry, chunk_idx) * raid_bdev->strip_size;
+	uint32_t end = start + raid_bdev->strip_size;
+	uint32_t clear, set;
+
+	for (clear = spdk_bit_array_find_first_clear(entry->dirty, start); clear < end;
+	     clear = spdk_bit_array_find_first_clear(entry->dirty, set)) {
+		set = spdk_min(spdk_bit_array_find_first_set(entry->dirty, clear), end);
+		memcpy(entry->bufs[chunk_idx] + (clear - start) * blocklen,
+		       entry->old_bufs[chunk_idx] + (clear - start) * blocklen,
+		       (set - clear) * blocklen);
+		if (set == end) {
+			break;
+		}
+	}
+}
+
+static void raid5f_stripe_cache_flush(struct stripe_cache_entry *entry);
+
+static void
+raid5f_stripe_cache_entry_finish(struct stripe_cache_entry *entry)
+{
+	struct raid5f_info *r5f_info = raid5f_ch_to_r5f_info(entry->r5ch);
+	enum spdk_bdev_io_status status = entry->flush.status == 0 ? SPDK_BDEV_IO_STATUS_SUCCESS :
+					  SPDK_BDEV_IO_STATUS_FAILED;
+	TAILQ_HEAD(, raid_bdev_io) ios = TAILQ_HEAD_INITIALIZER(ios);
+	TAILQ_HEAD(, raid_bdev_io) deferred = TAILQ_HEAD_INITIALIZER(deferred);
+	struct raid_bdev_io *raid_io;
+
+	if (entry->flush.status != 0) {
+		SPDK_ERRLOG("stripe %" PRIu64 " update failed: %s\n", entry->stripe_index,
+			    spdk_strerror(-entry->flush.status));
+	}
+
+	/*
+	 * Unless parity was updated from the old contents of only some chunks, all the buffers
+	 * now match the stripe on the base bdevs and can be used for the following writes.
+	 */
+	entry->valid = entry->flush.status == 0 && !entry->flush.rmw && entry->flush.write_parity;
+
+	raid5f_stripe_unlock(r5f_info, &entry->lock, true);
+	entry->valid_gen = entry->lock.gen;
+
+	spdk_bit_array_clear_mask(entry->dirty);
+	entry->state = STRIPE_CACHE_ENTRY_IDLE;
+	entry->last_used_tsc = spdk_get_ticks();
+
+	TAILQ_CONCAT(&ios, &entry->ios, link);
+	TAILQ_CONCAT(&deferred, &entry->deferred, link);
+
+	while ((raid_io = TAILQ_FIRST(&deferred))) {
+		TAILQ_REMOVE(&deferred, raid_io, link);
+		raid5f_submit_rw_request(raid_io);
+	}
+
+	while ((raid_io = TAILQ_FIRST(&ios))) {
+		TAILQ_REMOVE(&ios, raid_io, link);
+		raid_bdev_io_complete(raid_io, status);
+	}
+}
+
+static void raid5f_stripe_cache_entry_submit(struct stripe_cache_entry *entry);
+static void raid5f_stripe_cache_entry_xor(struct stripe_cache_entry *entry);
+
+static void
+raid5f_stripe_cache_entry_write(struct stripe_cache_entry *entry)
+{
+	entry->flush.writing = true;
+	entry->flush.submit_idx = 0;
+	raid5f_stripe_cache_entry_submit(entry);
+}
+
+static void
+raid5f_stripe_cache_entry_xor_cb(void *_entry, int status)
+{
+	struct stripe_cache_entry *entry = _entry;
+
+	if (status != 0) {
+		entry->flush.status = status;
+		raid5f_stripe_cache_entry_finish(entry);
+		return;
+	}
+
+	if (entry->flush.reconstructing) {
+		entry->flush.reconstructing = false;
+		raid5f_stripe_cache_entry_xor(entry);
+		return;
+	}
+
+	raid5f_stripe_cache_entry_write(entry);
+}
+
+static void
+raid5f_stripe_cache_entry_xor(struct stripe_cache_entry *entry)
+{
+	struct raid5f_io_channel *r5ch = entry->r5ch;
+	struct raid_bdev *raid_bdev = raid5f_ch_to_r5f_info(r5ch)->raid_bdev;
+	uint8_t p_idx = raid5f_stripe_parity_chunk_index(raid_bdev, entry->stripe_index);
+	uint8_t *chunk_flags = entry->flush.chunk_flags;
+	void **srcs = entry->flush.xor_srcs;
+	uint32_t n_src = 0;
+	void *dest;
+	uint8_t i;
+	int ret;
+
+	if (entry->flush.reconstructing) {
+		/* Recover the old contents of the missing chunk from the rest of the stripe */
+		for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
+			if (i != entry->flush.reconstruct_idx) {
+				srcs[n_src++] = entry->old_bufs[i];
+			}
+		}
+		dest = entry->old_bufs[entry->flush.reconstruct_idx];
+	} else {
+		for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
+			if (i != p_idx && (chunk_flags[i] & STRIPE_CACHE_CHUNK_READ ||
+					   i == entry->flush.reconstruct_idx)) {
+				raid5f_stripe_cache_chunk_merge(entry, i);
+			}
+		}
+
+		if (!entry->flush.write_parity) {
+			raid5f_stripe_cache_entry_write(entry);
+			return;
+		}
+
+		if (entry->flush.rmw) {
+			/* new parity = old parity ^ old data ^ new data of the updated chunks */
+			srcs[n_src++] = entry->old_bufs[p_idx];
+			for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
+				if (i != p_idx && chunk_flags[i] & STRIPE_CACHE_CHUNK_DIRTY) {
+					srcs[n_src++] = entry->old_bufs[i];
+					srcs[n_src++] = entry->bufs[i];
+				}
+			}
+		} else {
+			for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
+				if (i != p_idx) {
+					srcs[n_src++] = entry->bufs[i];
+				}
+			}
+		}
+		dest = entry->bufs[p_idx];
+	}
+
+	ret = spdk_accel_submit_xor(r5ch->accel_ch, dest, srcs, n_src,
+				    raid_bdev->strip_size * raid_bdev->bdev.blocklen,
+				    raid5f_stripe_cache_entry_xor_cb, entry);
+	if (spdk_unlikely(ret)) {
+		if (ret == -ENOMEM) {
+			TAILQ_INSERT_TAIL(&r5ch->stripe_cache.xor_retry_queue, entry, link);
+		} else {
+			entry->flush.status = ret;
+			raid5f_stripe_cache_entry_finish(entry);
+		}
+	}
+}
+
+static void
+raid5f_stripe_cache_entry_io_done(struct stripe_cache_entry *entry)
+{
+	if (entry->flush.status != 0 || entry->flush.writing) {
+		raid5f_stripe_cache_entry_finish(entry);
+		return;
+	}
+
+	entry->flush.reconstructing = entry->flush.reconstruct_idx != UINT8_MAX;
+	raid5f_stripe_cache_entry_xor(entry);
+}
+
+static void
+raid5f_stripe_cache_complete_bdev_io(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct stripe_cache_entry *entry = cb_arg;
+	struct raid_bdev *raid_bdev = raid5f_ch_to_r5f_info(entry->r5ch)->raid_bdev;
+
+	spdk_bdev_free_io(bdev_io);
+
+	if (!success) {
+		entry->flush.status = -EIO;
+	}
+
+	assert(entry->flush.remaining > 0);
+	if (--entry->flush.remaining == 0 && entry->flush.submit_idx == raid_bdev->num_base_bdevs) {
+		raid5f_stripe_cache_entry_io_done(entry);
+	}
+}
+
+static void
+_raid5f_stripe_cache_entry_submit(void *_entry)
+{
+	struct stripe_cache_entry *entry = _entry;
+
+	raid5f_stripe_cache_entry_submit(entry);
+}
+
+static void
+raid5f_stripe_cache_entry_submit(struct stripe_cache_entry *entry)
+{
+	struct raid_bdev *raid_bdev = raid5f_ch_to_r5f_info(entry->r5ch)->raid_bdev;
+	uint8_t flag = entry->flush.writing ? STRIPE_CACHE_CHUNK_WRITE : STRIPE_CACHE_CHUNK_READ;
+	uint64_t base_offset_blocks = entry->stripe_index << raid_bdev->strip_size_shift;
+	struct spdk_bdev_ext_io_opts io_opts = {};
+	struct raid_base_bdev_info *base_info;
+	struct spdk_io_channel *base_ch;
+	struct iovec *iov;
+	uint8_t i;
+	int ret;
+
+	io_opts.size = sizeof(io_opts);
+
+	for (; entry->flush.submit_idx < raid_bdev->num_base_bdevs; entry->flush.submit_idx++) {
+		i = entry->flush.submit_idx;
+		base_ch = raid_bdev_channel_get_base_channel(entry->raid_ch, i);
+		if (!(entry->flush.chunk_flags[i] & flag) || base_ch == NULL) {
+			continue;
+		}
+
+		base_info = &raid_bdev->base_bdev_info[i];
+		iov = &entry->flush.iovs[i];
+		iov->iov_len = raid_bdev->strip_size * raid_bdev->bdev.blocklen;
+
+		if (entry->flush.writing) {
+			iov->iov_base = entry->bufs[i];
+			ret = raid_bdev_writev_blocks_ext(base_info, base_ch, iov, 1, base_offset_blocks,
+							  raid_bdev->strip_size,
+							  raid5f_stripe_cache_complete_bdev_io, entry, &io_opts);
+		} else {
+			iov->iov_base = entry->old_bufs[i];
+			ret = raid_bdev_readv_blocks_ext(base_info, base_ch, iov, 1, base_offset_blocks,
+							 raid_bdev->strip_size,
+							 raid5f_stripe_cache_complete_bdev_io, entry, &io_opts);
+		}
+
+		if (spdk_likely(ret == 0)) {
+			entry->flush.remaining++;
+		} else if (ret == -ENOMEM) {
+			entry->waitq_entry.bdev = spdk_bdev_desc_get_bdev(base_info->desc);
+			entry->waitq_entry.cb_fn = _raid5f_stripe_cache_entry_submit;
+			entry->waitq_entry.cb_arg = entry;
+			spdk_bdev_queue_io_wait(entry->waitq_entry.bdev, base_ch, &entry->waitq_entry);
+			return;
+		} else {
+			entry->flush.status = ret;
+			entry->flush.submit_idx = raid_bdev->num_base_bdevs;
+			break;
+		}
+	}
+
+	if (entry->flush.remaining == 0) {
+		raid5f_stripe_cache_entry_io_done(entry);
+	}
+}
+
+/*
+ * Decide how to update the stripe. Writes that cover the whole stripe, or a stripe whose
+ * contents are cached, only need the parity computed. Otherwise, the old contents of either
+ * the chunks not fully written (reconstruct-write) or the written chunks and the parity
+ * (read-modify-write) are read, whichever requires fewer reads.
+ */
+static void
+raid5f_stripe_cache_entry_plan(struct stripe_cache_entry *entry)
+{
+	struct raid_bdev *raid_bdev = raid5f_ch_to_r5f_info(entry->r5ch)->raid_bdev;
+	uint8_t p_idx = raid5f_stripe_parity_chunk_index(raid_bdev, entry->stripe_index);
+	uint8_t *chunk_flags = entry->flush.chunk_flags;
+	uint8_t missing_idx = UINT8_MAX;
+	uint8_t rcw_reads = 0, rmw_reads = 1;
+	uint8_t missing_flags = 0;
+	uint8_t i;
+
+	for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
+		if (raid_bdev_channel_get_base_channel(entry->raid_ch, i) == NULL) {
+			missing_idx = i;
+		}
+
+		if (i == p_idx) {
+			chunk_flags[i] = STRIPE_CACHE_CHUNK_WRITE;
+			continue;
+		}
+
+		chunk_flags[i] = raid5f_stripe_cache_chunk_dirty_flags(entry, i);
+		if (chunk_flags[i] & STRIPE_CACHE_CHUNK_DIRTY) {
+			chunk_flags[i] |= STRIPE_CACHE_CHUNK_WRITE;
+			rmw_reads++;
+		}
+		if (!(chunk_flags[i] & STRIPE_CACHE_CHUNK_FULL)) {
+			rcw_reads++;
+		}
+	}
+
+	if (missing_idx != UINT8_MAX) {
+		missing_flags = chunk_flags[missing_idx];
+	}
+
+	entry->flush.reconstruct_idx = UINT8_MAX;
+	entry->flush.write_parity = missing_idx != p_idx;
+	entry->flush.rmw = false;
+	entry->flush.writing = false;
+	entry->flush.submit_idx = 0;
+	entry->flush.remaining = 0;
+	entry->flush.status = 0;
+
+	if (entry->valid) {
+		return;
+	}
+
+	if (missing_idx == UINT8_MAX) {
+		entry->flush.rmw = rmw_reads < rcw_reads;
+	} else if (missing_idx != p_idx) {
+		if (!(missing_flags & STRIPE_CACHE_CHUNK_DIRTY)) {
+			/* The missing chunk is not needed to update the parity */
+			entry->flush.rmw = true;
+		} else if (!(missing_flags & STRIPE_CACHE_CHUNK_FULL)) {
+			/* Need the missing chunk's old contents to fill in the blocks not written */
+			entry->flush.reconstruct_idx = missing_idx;
+		}
+	}
+
+	for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
+		if (i == missing_idx) {
+			continue;
+		}
+
+		if (entry->flush.reconstruct_idx != UINT8_MAX) {
+			chunk_flags[i] |= STRIPE_CACHE_CHUNK_READ;
+		} else if (entry->flush.rmw) {
+			if (i == p_idx || chunk_flags[i] & STRIPE_CACHE_CHUNK_DIRTY) {
+				chunk_flags[i] |= STRIPE_CACHE_CHUNK_READ;
+			}
+		} else if (i != p_idx && !(chunk_flags[i] & STRIPE_CACHE_CHUNK_FULL)) {
+			/* Without parity, only the partially written chunks need their old contents */
+			if (entry->flush.write_parity || chunk_flags[i] & STRIPE_CACHE_CHUNK_DIRTY) {
+				chunk_flags[i] |= STRIPE_CACHE_CHUNK_READ;
+			}
+		}
+	}
+}
+
+static void
+raid5f_stripe_cache_entry_locked(struct stripe_lock *lock)
+{
+	struct stripe_cache_entry *entry = SPDK_CONTAINEROF(lock, struct stripe_cache_entry, lock);
+
+	/* The stripe could have been written through another io channel */
+	if (entry->valid && entry->valid_gen != lock->gen) {
+		entry->valid = false;
+	}
+
+	raid5f_stripe_cache_entry_plan(entry);
+	raid5f_stripe_cache_entry_submit(entry);
+}
+
+static void
+raid5f_stripe_cache_flush(struct stripe_cache_entry *entry)
+{
+	struct raid5f_info *r5f_info = raid5f_ch_to_r5f_info(entry->r5ch);
+
+	assert(entry->state == STRIPE_CACHE_ENTRY_COLLECTING);
+
+	entry->state = STRIPE_CACHE_ENTRY_FLUSHING;
+	entry->lock.stripe_index = entry->stripe_index;
+	entry->lock.cb = raid5f_stripe_cache_entry_locked;
+
+	if (raid5f_stripe_lock(r5f_info, &entry->lock)) {
+		raid5f_stripe_cache_entry_locked(&entry->lock);
+	}
+}
+
+static void
+raid5f_stripe_cache_entry_add_io(struct stripe_cache_entry *entry, struct raid_bdev_io *raid_io,
+				 uint64_t stripe_offset)
+{
+	struct raid5f_io_channel *r5ch = entry->r5ch;
+	struct raid5f_info *r5f_info = raid5f_ch_to_r5f_info(r5ch);
+	struct raid_bdev *raid_bdev = r5f_info->raid_bdev;
+	uint8_t p_idx = raid5f_stripe_parity_chunk_index(raid_bdev, entry->stripe_index);
+	uint64_t offset = stripe_offset;
+	uint64_t remaining = raid_io->num_blocks;
+	int iovcnt = 0;
+	uint64_t i;
+
+	if (entry->state == STRIPE_CACHE_ENTRY_IDLE) {
+		entry->state = STRIPE_CACHE_ENTRY_COLLECTING;
+		entry->raid_ch = raid_io->raid_ch;
+		entry->flush_tsc = spdk_get_ticks() + r5f_info->stripe_cache_window_ticks;
+	}
+
+	while (remaining > 0) {
+		uint8_t data_chunk_idx = offset >> raid_bdev->strip_size_shift;
+		uint8_t chunk_idx = data_chunk_idx < p_idx ? data_chunk_idx : data_chunk_idx + 1;
+		uint64_t chunk_offset = offset - ((uint64_t)data_chunk_idx << raid_bdev->strip_size_shift);
+		uint64_t len = spdk_min(remaining, raid_bdev->strip_size - chunk_offset);
+		struct iovec *iov = &r5ch->stripe_cache.iovs[iovcnt++];
+
+		iov->iov_base = entry->bufs[chunk_idx] + chunk_offset * raid_bdev->bdev.blocklen;
+		iov->iov_len = len * raid_bdev->bdev.blocklen;
+		offset += len;
+		remaining -= len;
+	}
+
+	spdk_iovcpy(raid_io->iovs, raid_io->iovcnt, r5ch->stripe_cache.iovs, iovcnt);
+
+	for (i = stripe_offset; i < stripe_offset + raid_io->num_blocks; i++) {
+		spdk_bit_array_set(entry->dirty, i);
+	}
+
+	TAILQ_INSERT_TAIL(&entry->ios, raid_io, link);
+
+	if (spdk_bit_array_count_set(entry->dirty) == r5f_info->stripe_blocks) {
+		raid5f_stripe_cache_flush(entry);
+	}
+}
+
+static struct stripe_cache_entry *
+raid5f_stripe_cache_get_entry(struct raid5f_io_channel *r5ch, uint64_t stripe_index)
+{
+	struct raid5f_info *r5f_info = raid5f_ch_to_r5f_info(r5ch);
+	struct stripe_cache_entry *entry, *victim = NULL, *oldest = NULL;
+	uint32_t i;
+
+	for (i = 0; i < r5f_info->stripe_cache_size; i++) {
+		entry = r5ch->stripe_cache.entries[i];
+
+		if (entry->stripe_index == stripe_index &&
+		    (entry->state != STRIPE_CACHE_ENTRY_IDLE || entry->valid)) {
+			return entry;
+		}
+
+		if (entry->state == STRIPE_CACHE_ENTRY_IDLE) {
+			if (victim == NULL || entry->last_used_tsc < victim->last_used_tsc) {
+				victim = entry;
+			}
+		} else if (entry->state == STRIPE_CACHE_ENTRY_COLLECTING) {
+			if (oldest == NULL || entry->flush_tsc < oldest->flush_tsc) {
+				oldest = entry;
+			}
+		}
+	}
+
+	if (victim == NULL) {
+		/* Make room for the following writes */
+		if (oldest != NULL) {
+			raid5f_stripe_cache_flush(oldest);
+		}
+		return NULL;
+	}
+
+	victim->stripe_index = stripe_index;
+	victim->valid = false;
+
+	return victim;
+}
+
+static int
+raid5f_stripe_cache_write(struct raid_bdev_io *raid_io, uint64_t stripe_index,
+			  uint64_t stripe_offset)
+{
+	struct raid5f_io_channel *r5ch = raid_bdev_channel_get_module_ctx(raid_io->raid_ch);
+	struct stripe_cache_entry *entry;
+
+	entry = raid5f_stripe_cache_get_entry(r5ch, stripe_index);
+	if (entry == NULL) {
+		return -ENOMEM;
+	}
+
+	switch (entry->state) {
+	case STRIPE_CACHE_ENTRY_COLLECTING:
+		if (spdk_likely(entry->raid_ch == raid_io->raid_ch)) {
+			break;
+		}
+		/* Writes routed to a different raid channel by a background process */
+		TAILQ_INSERT_TAIL(&entry->deferred, raid_io, link);
+		raid5f_stripe_cache_flush(entry);
+		return 0;
+	case STRIPE_CACHE_ENTRY_FLUSHING:
+		TAILQ_INSERT_TAIL(&entry->deferred, raid_io, link);
+		return 0;
+	default:
+		break;
+	}
+
+	raid5f_stripe_cache_entry_add_io(entry, raid_io, stripe_offset);
+
+	return 0;
+}
+
+static int
+raid5f_stripe_cache_poll(void *ctx)
+{
+	struct raid5f_io_channel *r5ch = ctx;
+	struct raid5f_info *r5f_info = raid5f_ch_to_r5f_info(r5ch);
+	TAILQ_HEAD(, stripe_cache_entry) retry_queue = TAILQ_HEAD_INITIALIZER(retry_queue);
+	struct stripe_cache_entry *entry;
+	uint64_t now = spdk_get_ticks();
+	int busy = 0;
+	uint32_t i;
+
+	TAILQ_CONCAT(&retry_queue, &r5ch->stripe_cache.xor_retry_queue, link);
+	while ((entry = TAILQ_FIRST(&retry_queue))) {
+		TAILQ_REMOVE(&retry_queue, entry, link);
+		raid5f_stripe_cache_entry_xor(entry);
+		busy++;
+	}
+
+	for (i = 0; i < r5f_info->stripe_cache_size; i++) {
+		entry = r5ch->stripe_cache.entries[i];
+
+		if (entry->state == STRIPE_CACHE_ENTRY_COLLECTING && entry->flush_tsc <= now) {
+			raid5f_stripe_cache_flush(entry);
+			busy++;
+		}
+	}
+
+	return busy > 0 ? SPDK_POLLER_BUSY : SPDK_POLLER_IDLE;
+}
+
 static void
 raid5f_submit_rw_request(struct raid_bdev_io *raid_io)
 {
@@ -816,6 +1619,11 @@ raid5f_submit_rw_request(struct raid_bdev_io *raid_io)
 		ret = raid5f_submit_read_request(raid_io, stripe_index, stripe_offset);
 		break;
 	case SPDK_BDEV_IO_TYPE_WRITE:
+		if (r5f_info->stripe_cache_size != 0) {
+			assert(stripe_offset + raid_io->num_blocks <= r5f_info->stripe_blocks);
+			ret = raid5f_stripe_cache_write(raid_io, stripe_index, stripe_offset);
+			break;
+		}
 		assert(stripe_offset == 0);
 		assert(raid_io->num_blocks == r5f_info->stripe_blocks);
 		ret = raid5f_submit_write_request(raid_io, stripe_index);
@@ -974,6 +1782,141 @@ err:
 	return NULL;
 }
 
+static void
+raid5f_stripe_cache_entry_free(struct stripe_cache_entry *entry)
+{
+	struct raid_bdev *raid_bdev = raid5f_ch_to_r5f_info(entry->r5ch)->raid_bdev;
+	uint8_t i;
+
+	for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
+		if (entry->bufs) {
+			spdk_dma_free(entry->bufs[i]);
+		}
+		if (entry->old_bufs) {
+			spdk_dma_free(entry->old_bufs[i]);
+		}
+	}
+
+	free(entry->bufs);
+	free(entry->old_bufs);
+	free(entry->flush.chunk_flags);
+	free(entry->flush.iovs);
+	free(entry->flush.xor_srcs);
+	spdk_bit_array_free(&entry->dirty);
+	free(entry);
+}
+
+static struct stripe_cache_entry *
+raid5f_stripe_cache_entry_alloc(struct raid5f_io_channel *r5ch)
+{
+	struct raid5f_info *r5f_info = raid5f_ch_to_r5f_info(r5ch);
+	struct raid_bdev *raid_bdev = r5f_info->raid_bdev;
+	size_t chunk_len = raid_bdev->strip_size * raid_bdev->bdev.blocklen;
+	struct stripe_cache_entry *entry;
+	uint8_t i;
+
+	entry = calloc(1, sizeof(*entry));
+	if (!entry) {
+		return NULL;
+	}
+
+	entry->r5ch = r5ch;
+	TAILQ_INIT(&entry->ios);
+	TAILQ_INIT(&entry->deferred);
+
+	entry->dirty = spdk_bit_array_create(r5f_info->stripe_blocks);
+	if (!entry->dirty) {
+		goto err;
+	}
+
+	entry->bufs = calloc(raid_bdev->num_base_bdevs, sizeof(entry->bufs[0]));
+	entry->old_bufs = calloc(raid_bdev->num_base_bdevs, sizeof(entry->old_bufs[0]));
+	if (!entry->bufs || !entry->old_bufs) {
+		goto err;
+	}
+
+	for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
+		entry->bufs[i] = spdk_dma_malloc(chunk_len, r5f_info->buf_alignment, NULL);
+		entry->old_bufs[i] = spdk_dma_malloc(chunk_len, r5f_info->buf_alignment, NULL);
+		if (!entry->bufs[i] || !entry->old_bufs[i]) {
+			goto err;
+		}
+	}
+
+	entry->flush.chunk_flags = calloc(raid_bdev->num_base_bdevs, sizeof(entry->flush.chunk_flags[0]));
+	entry->flush.iovs = calloc(raid_bdev->num_base_bdevs, sizeof(entry->flush.iovs[0]));
+	entry->flush.xor_srcs = calloc(raid_bdev->num_base_bdevs * 2, sizeof(entry->flush.xor_srcs[0]));
+	if (!entry->flush.chunk_flags || !entry->flush.iovs || !entry->flush.xor_srcs) {
+		goto err;
+	}
+
+	return entry;
+err:
+	raid5f_stripe_cache_entry_free(entry);
+	return NULL;
+}
+
+static void
+raid5f_stripe_cache_destroy(struct raid5f_io_channel *r5ch)
+{
+	struct raid5f_info *r5f_info = raid5f_ch_to_r5f_info(r5ch);
+	uint32_t i;
+
+	spdk_poller_unregister(&r5ch->stripe_cache.poller);
+
+	if (r5ch->stripe_cache.entries) {
+		for (i = 0; i < r5f_info->stripe_cache_size; i++) {
+			if (r5ch->stripe_cache.entries[i]) {
+				assert(r5ch->stripe_cache.entries[i]->state == STRIPE_CACHE_ENTRY_IDLE);
+				raid5f_stripe_cache_entry_free(r5ch->stripe_cache.entries[i]);
+			}
+		}
+		free(r5ch->stripe_cache.entries);
+	}
+
+	free(r5ch->stripe_cache.iovs);
+}
+
+static int
+raid5f_stripe_cache_create(struct raid5f_io_channel *r5ch)
+{
+	struct raid5f_info *r5f_info = raid5f_ch_to_r5f_info(r5ch);
+	uint32_t i;
+
+	TAILQ_INIT(&r5ch->stripe_cache.xor_retry_queue);
+
+	if (r5f_info->stripe_cache_size == 0) {
+		return 0;
+	}
+
+	r5ch->stripe_cache.entries = calloc(r5f_info->stripe_cache_size,
+					    sizeof(r5ch->stripe_cache.entries[0]));
+	if (!r5ch->stripe_cache.entries) {
+		return -ENOMEM;
+	}
+
+	for (i = 0; i < r5f_info->stripe_cache_size; i++) {
+		r5ch->stripe_cache.entries[i] = raid5f_stripe_cache_entry_alloc(r5ch);
+		if (!r5ch->stripe_cache.entries[i]) {
+			return -ENOMEM;
+		}
+	}
+
+	r5ch->stripe_cache.iovs = calloc(r5f_info->raid_bdev->num_base_bdevs,
+					 sizeof(r5ch->stripe_cache.iovs[0]));
+	if (!r5ch->stripe_cache.iovs) {
+		return -ENOMEM;
+	}
+
+	r5ch->stripe_cache.poller = SPDK_POLLER_REGISTER(raid5f_stripe_cache_poll, r5ch,
+				    r5f_info->stripe_cache_window_us);
+	if (!r5ch->stripe_cache.poller) {
+		return -ENOMEM;
+	}
+
+	return 0;
+}
+
 static void
 raid5f_ioch_destroy(void *io_device, void *ctx_buf)
 {
@@ -982,6 +1925,8 @@ raid5f_ioch_destroy(void *io_device, void *ctx_buf)
 
 	assert(TAILQ_EMPTY(&r5ch->xor_retry_queue));
 
+	raid5f_stripe_cache_destroy(r5ch);
+
 	while ((stripe_req = TAILQ_FIRST(&r5ch->free_stripe_requests.write))) {
 		TAILQ_REMOVE(&r5ch->free_stripe_requests.write, stripe_req, link);
 		raid5f_stripe_request_free(stripe_req);
@@ -1053,6 +1998,10 @@ raid5f_ioch_create(void *io_device, void *ctx_buf)
 		goto err;
 	}
 
+	if (raid5f_stripe_cache_create(r5ch) != 0) {
+		goto err;
+	}
+
 	return 0;
 err:
 	SPDK_ERRLOG("Failed to initialize io channel\n");
@@ -1068,7 +2017,9 @@ raid5f_start(struct raid_bdev *raid_bdev)
 	struct raid_base_bdev_info *base_info;
 	struct spdk_bdev *base_bdev;
 	struct raid5f_info *r5f_info;
+	struct spdk_raid_bdev_opts opts;
 	size_t alignment = 0;
+	uint32_t i;
 
 	r5f_info = calloc(1, sizeof(*r5f_info));
 	if (!r5f_info) {
@@ -1098,11 +2049,39 @@ raid5f_start(struct raid_bdev *raid_bdev)
 		r5f_info->blocklen_shift = spdk_u32log2(raid_bdev->bdev.blocklen);
 	}
 
+	raid_bdev_get_opts(&opts);
+	if (opts.raid5f_stripe_cache_size != 0) {
+		if (raid_bdev->bdev.md_len != 0 && !raid_bdev->bdev.md_interleave) {
+			SPDK_NOTICELOG("Partial stripe writes are not supported with separate metadata, "
+				       "disabling stripe cache for %s\n", raid_bdev->bdev.name);
+		} else {
+			r5f_info->stripe_locks.buckets = calloc(RAID5F_STRIPE_LOCK_BUCKETS,
+							       sizeof(*r5f_info->stripe_locks.buckets));
+			if (!r5f_info->stripe_locks.buckets) {
+				SPDK_ERRLOG("Failed to allocate stripe locks\n");
+				free(r5f_info);
+				return -ENOMEM;
+			}
+
+			for (i = 0; i < RAID5F_STRIPE_LOCK_BUCKETS; i++) {
+				TAILQ_INIT(&r5f_info->stripe_locks.buckets[i].held);
+			}
+			spdk_spin_init(&r5f_info->stripe_locks.lock);
+
+			r5f_info->stripe_cache_size = opts.raid5f_stripe_cache_size;
+			r5f_info->stripe_cache_window_us = opts.raid5f_stripe_cache_window_us;
+			r5f_info->stripe_cache_window_ticks = opts.raid5f_stripe_cache_window_us *
+							      spdk_get_ticks_hz() / SPDK_SEC_TO_USEC;
+		}
+	}
+
 	raid_bdev->bdev.blockcnt = r5f_info->stripe_blocks * r5f_info->total_stripes;
 	raid_bdev->bdev.optimal_io_boundary = raid_bdev->strip_size;
 	raid_bdev->bdev.split_on_optimal_io_boundary = true;
-	raid_bdev->bdev.write_unit_size = r5f_info->stripe_blocks;
-	raid_bdev->bdev.split_on_write_unit = true;
+	if (r5f_info->stripe_cache_size == 0) {
+		raid_bdev->bdev.write_unit_size = r5f_info->stripe_blocks;
+		raid_bdev->bdev.split_on_write_unit = true;
+	}
 
 	raid_bdev->module_private = r5f_info;
 
@@ -1119,6 +2098,10 @@ raid5f_io_device_unregister_done(void *io_device)
 
 	raid_bdev_module_stop_done(r5f_info->raid_bdev);
 
+	if (r5f_info->stripe_locks.buckets) {
+		spdk_spin_destroy(&r5f_info->stripe_locks.lock);
+		free(r5f_info->stripe_locks.buckets);
+	}
 	free(r5f_info);
 }
 
@@ -9,6 +9,12 @@
 #include "spdk/thread.h"
 #include "spdk_internal/init.h"
 
+static const char *g_numa_steal_names[] = {
+	[SPDK_IOBUF_NUMA_STEAL_NONE] = "none",
+	[SPDK_IOBUF_NUMA_STEAL_IDLE] = "idle",
+	[SPDK_IOBUF_NUMA_STEAL_ANY] = "any",
+};
+
 static void
 iobuf_subsystem_initialize(void)
 {
@@ -52,6 +58,8 @@ iobuf_write_config_json(struct spdk_json_write_ctx *w)
 	spdk_json_write_named_uint32(w, "small_bufsize", opts.small_bufsize);
 	spdk_json_write_named_uint32(w, "large_bufsize", opts.large_bufsize);
 	spdk_json_write_named_bool(w, "enable_numa", opts.enable_numa);
+	spdk_json_write_named_string(w, "numa_steal", g_numa_steal_names[opts.numa_steal]);
+	spdk_json_write_named_bool(w, "enable_adaptive_cache", opts.enable_adaptive_cache);
 	spdk_json_write_object_end(w);
 	spdk_json_write_object_end(w);
 
@@ -9,12 +9,32 @@
 #include "spdk/string.h"
 #include "spdk_internal/init.h"
 
+static int
+rpc_decode_numa_steal(const struct spdk_json_val *val, void *out)
+{
+	uint8_t *numa_steal = out;
+
+	if (spdk_json_strequal(val, "none")) {
+		*numa_steal = SPDK_IOBUF_NUMA_STEAL_NONE;
+	} else if (spdk_json_strequal(val, "idle")) {
+		*numa_steal = SPDK_IOBUF_NUMA_STEAL_IDLE;
+	} else if (spdk_json_strequal(val, "any")) {
+		*numa_steal = SPDK_IOBUF_NUMA_STEAL_ANY;
+	} else {
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
 static const struct spdk_json_object_decoder rpc_iobuf_set_options_decoders[] = {
 	{"small_pool_count", offsetof(struct spdk_iobuf_opts, small_pool_count), spdk_json_decode_uint64, true},
 	{"large_pool_count", offsetof(struct spdk_iobuf_opts, large_pool_count), spdk_json_decode_uint64, true},
 	{"small_bufsize", offsetof(struct spdk_iobuf_opts, small_bufsize), spdk_json_decode_uint32, true},
 	{"large_bufsize", offsetof(struct spdk_iobuf_opts, large_bufsize), spdk_json_decode_uint32, true},
 	{"enable_numa", offsetof(struct spdk_iobuf_opts, enable_numa), spdk_json_decode_bool, true},
+	{"numa_steal", offsetof(struct spdk_iobuf_opts, numa_steal), rpc_decode_numa_steal, true},
+	{"enable_adaptive_cache", offsetof(struct spdk_iobuf_opts, enable_adaptive_cache), spdk_json_decode_bool, true},
 };
 
 static void
@@ -64,12 +84,16 @@ rpc_iobuf_get_stats_done(struct spdk_iobuf_module_stats *modules, uint32_t num_m
 		spdk_json_write_named_uint64(w, "cache", it->small_pool.cache);
 		spdk_json_write_named_uint64(w, "main", it->small_pool.main);
 		spdk_json_write_named_uint64(w, "retry", it->small_pool.retry);
+		spdk_json_write_named_uint64(w, "steal", it->small_pool.steal);
+		spdk_json_write_named_uint64(w, "refill", it->small_pool.refill);
 		spdk_json_write_object_end(w);
 
 		spdk_json_write_named_object_begin(w, "large_pool");
 		spdk_json_write_named_uint64(w, "cache", it->large_pool.cache);
 		spdk_json_write_named_uint64(w, "main", it->large_pool.main);
 		spdk_json_write_named_uint64(w, "retry", it->large_pool.retry);
+		spdk_json_write_named_uint64(w, "steal", it->large_pool.steal);
+		spdk_json_write_named_uint64(w, "refill", it->large_pool.refill);
 		spdk_json_write_object_end(w);
 
 		spdk_json_write_object_end(w);
@@ -51,6 +51,13 @@ struct spdk_posix_sock {
 	bool			socket_has_data;
 	bool			zcopy;
 
+	/* Tick until which the group poller may hold back queued writes, 0 if not holding them */
+	uint64_t		flush_deadline;
+	/* Number of queued iovecs when the writes started being held back */
+	int			flush_batch_iovcnt;
+	/* Number of flushes not to hold back, since holding back recently didn't batch anything */
+	uint32_t		flush_batch_backoff;
+
 	int			placement_id;
 
 	SSL_CTX			*ctx;
@@ -88,7 +95,8 @@ static struct spdk_sock_impl_opts g_posix_impl_opts = {
 	.psk_identity = NULL,
 	.get_key = NULL,
 	.get_key_ctx = NULL,
-	.tls_cipher_suites = NULL
+	.tls_cipher_suites = NULL,
+	.flush_batch_timeout = 0,
 };
 
 static struct spdk_sock_impl_opts g_ssl_impl_opts = {
@@ -103,7 +111,8 @@ static struct spdk_sock_impl_opts g_ssl_impl_opts = {
 	.tls_version = 0,
 	.enable_ktls = false,
 	.psk_key = NULL,
-	.psk_identity = NULL
+	.psk_identity = NULL,
+	.flush_batch_timeout = 0,
 };
 
 static struct spdk_sock_map g_map = {
@@ -149,6 +158,7 @@ posix_sock_copy_impl_opts(struct spdk_sock_impl_opts *dest, const struct spdk_so
 	SET_FIELD(get_key);
 	SET_FIELD(get_key_ctx);
 	SET_FIELD(tls_cipher_suites);
+	SET_FIELD(flush_batch_timeout);
 
 #undef SET_FIELD
 #undef FIELD_OK
@@ -1466,6 +1476,56 @@ _sock_flush(struct spdk_sock *sock)
 	return sent;
 }
 
+/* Number of flushes which are not held back after doing so didn't gather more writes */
+#define POSIX_SOCK_FLUSH_BATCH_BACKOFF	16
+
+/*
+ * Decide whether the group poller can hold back the writes queued on a socket, so that they're
+ * sent with a single sendmsg() together with the writes queued during the next polls. Only small
+ * batches are held back and only while the peer keeps sending data, i.e. while it has more
+ * requests (and so more responses) in flight. The oldest write is held back for no longer than
+ * flush_batch_timeout. If that didn't gather any more writes, holding back is disabled for a while.
+ */
+static bool
+posix_sock_flush_hold(struct spdk_sock *sock, uint64_t now)
+{
+	struct spdk_posix_sock *psock = __posix_sock(sock);
+
+	if (sock->queued_iovcnt == 0) {
+		psock->flush_deadline = 0;
+		return false;
+	}
+
+	if (psock->flush_deadline == 0) {
+		if (psock->flush_batch_backoff > 0) {
+			psock->flush_batch_backoff--;
+			return false;
+		}
+
+		if (sock->queued_iovcnt >= IOV_BATCH_SIZE / 2 ||
+		    (!psock->socket_has_data && !psock->pipe_has_data)) {
+			return false;
+		}
+
+		psock->flush_deadline = now + sock->impl_opts.flush_batch_timeout *
+					spdk_get_ticks_hz() / SPDK_SEC_TO_USEC;
+		psock->flush_batch_iovcnt = sock->queued_iovcnt;
+		return true;
+	}
+
+	if (now < psock->flush_deadline && sock->queued_iovcnt < IOV_BATCH_SIZE / 2 &&
+	    (psock->socket_has_data || psock->pipe_has_data)) {
+		return true;
+	}
+
+	if (sock->queued_iovcnt == psock->flush_batch_iovcnt) {
+		psock->flush_batch_backoff = POSIX_SOCK_FLUSH_BATCH_BACKOFF;
+	}
+	psock->flush_deadline = 0;
+
+	return false;
+}
+
 static int
 posix_sock_flush(struct spdk_sock *sock)
 {
@@ -1572,13 +1632,36 @@ posix_sock_read(struct spdk_posix_sock *sock)
 	return bytes_recvd;
 }
 
+static ssize_t
+posix_sock_recv_split(struct spdk_posix_sock *sock, struct iovec *iov, int iovcnt)
+{
+	struct iovec tail[IOV_BATCH_SIZE];
+	ssize_t bytes, rc;
+	int tailcnt;
+
+	bytes = posix_sock_recv_from_pipe(sock, iov, iovcnt);
+	if (bytes <= 0) {
+		return bytes;
+	}
+
+	tailcnt = spdk_sock_iovs_skip(iov, iovcnt, bytes, tail, SPDK_COUNTOF(tail));
+	if (sock->ssl) {
+		rc = SSL_readv(sock->ssl, tail, tailcnt);
+	} else {
+		rc = readv(sock->fd, tail, tailcnt);
+	}
+
+	/* Any error is reported by the next read, the data from the pipe has to be returned now */
+	return rc > 0 ? bytes + rc : bytes;
+}
+
 static ssize_t
 posix_sock_readv(struct spdk_sock *_sock, struct iovec *iov, int iovcnt)
 {
 	struct spdk_posix_sock *sock = __posix_sock(_sock);
 	struct spdk_posix_sock_group_impl *group = __posix_group_impl(sock->base.group_impl);
 	int rc, i;
-	size_t len;
+	size_t len, piped;
 
 	if (sock->recv_pipe == NULL) {
 		assert(sock->pipe_has_data == false);
@@ -1593,16 +1676,26 @@ posix_sock_readv(struct spdk_sock *_sock, struct iovec *iov, int iovcnt)
 		}
 	}
 
+	len = 0;
+	for (i = 0; i < iovcnt; i++) {
+		len += iov[i].iov_len;
+	}
+
+	if (sock->pipe_has_data && (group == NULL || sock->socket_has_data)) {
+		/* The pipe holds only the beginning of a large read (e.g. a payload which came in
+		 * along with its PDU header). Receive the rest directly to the user's buffers, rather
+		 * than refilling the pipe and copying it out again. */
+		piped = spdk_pipe_reader_bytes_available(sock->recv_pipe);
+		if (len > piped && len - piped >= MIN_SOCK_PIPE_SIZE) {
+			return posix_sock_recv_split(sock, iov, iovcnt);
+		}
+	}
+
 	/* If the socket is not in a group, we must assume it always has
 	 * data waiting for us because it is not epolled */
 	if (!sock->pipe_has_data && (group == NULL || sock->socket_has_data)) {
 		/* If the user is receiving a sufficiently large amount of data,
 		 * receive directly to their buffers. */
-		len = 0;
-		for (i = 0; i < iovcnt; i++) {
-			len += iov[i].iov_len;
-		}
-
 		if (len >= MIN_SOCK_PIPE_SIZE) {
 			/* TODO: Should this detect if kernel socket is drained? */
 			if (sock->ssl) {
@@ -2011,6 +2104,7 @@ posix_sock_group_impl_poll(struct spdk_sock_group_impl *_group, int max_events,
 	struct spdk_sock *sock, *tmp;
 	int num_events, i, rc;
 	struct spdk_posix_sock *psock, *ptmp;
+	uint64_t now = 0;
 #if defined(SPDK_EPOLL)
 	struct epoll_event events[MAX_EVENTS_PER_POLL];
 #elif defined(SPDK_KEVENT)
@@ -2067,6 +2161,15 @@ posix_sock_group_impl_poll(struct spdk_sock_group_impl *_group, int max_events,
 	 * a completion callback could remove the sock from the
 	 * group. */
 	TAILQ_FOREACH_SAFE(sock, &_group->socks, link, tmp) {
+		if (sock->impl_opts.flush_batch_timeout != 0) {
+			if (now == 0) {
+				now = spdk_get_ticks();
+			}
+			if (posix_sock_flush_hold(sock, now)) {
+				continue;
+			}
+		}
+
 		rc = _sock_flush(sock);
 		if (rc < 0 && errno != EAGAIN) {
 			spdk_sock_abort_requests(sock);
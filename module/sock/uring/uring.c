@@ -986,12 +986,31 @@ uring_sock_readv_no_pipe(struct spdk_sock *_sock, struct iovec *iovs, int iovcnt
 	return total;
 }
 
+static ssize_t
+uring_sock_recv_split(struct spdk_uring_sock *sock, struct iovec *iov, int iovcnt)
+{
+	struct iovec tail[IOV_BATCH_SIZE];
+	ssize_t bytes, rc;
+	int tailcnt;
+
+	bytes = uring_sock_recv_from_pipe(sock, iov, iovcnt);
+	if (bytes <= 0) {
+		return bytes;
+	}
+
+	tailcnt = spdk_sock_iovs_skip(iov, iovcnt, bytes, tail, SPDK_COUNTOF(tail));
+	rc = sock_readv(sock->fd, tail, tailcnt);
+
+	/* Any error is reported by the next read, the data from the pipe has to be returned now */
+	return rc > 0 ? bytes + rc : bytes;
+}
+
 static ssize_t
 uring_sock_readv(struct spdk_sock *_sock, struct iovec *iov, int iovcnt)
 {
 	struct spdk_uring_sock *sock = __uring_sock(_sock);
 	int rc, i;
-	size_t len;
+	size_t len, piped;
 
 	if (sock->connection_status < 0) {
 		errno = -sock->connection_status;
@@ -1007,7 +1026,8 @@ uring_sock_readv(struct spdk_sock *_sock, struct iovec *iov, int iovcnt)
 		len += iov[i].iov_len;
 	}
 
-	if (spdk_pipe_reader_bytes_available(sock->recv_pipe) == 0) {
+	piped = spdk_pipe_reader_bytes_available(sock->recv_pipe);
+	if (piped == 0) {
 		/* If the user is receiving a sufficiently large amount of data,
 		 * receive directly to their buffers. */
 		if (len >= MIN_SOCK_PIPE_SIZE) {
@@ -1019,6 +1039,10 @@ uring_sock_readv(struct spdk_sock *_sock, struct iovec *iov, int iovcnt)
 		if (rc <= 0) {
 			return rc;
 		}
+	} else if (len > piped && len - piped >= MIN_SOCK_PIPE_SIZE) {
+		/* The pipe holds only the beginning of a large read, receive the rest directly to
+		 * the user's buffers instead of copying it through the pipe. */
+		return uring_sock_recv_split(sock, iov, iovcnt);
 	}
 
 	return uring_sock_recv_from_pipe(sock, iov, iovcnt);
@@ -47,11 +47,11 @@ def bdev_wait_for_examine(client):
     return client.call('bdev_wait_for_examine')
 
 
-def bdev_compress_create(client, base_bdev_name, pm_path, lb_size=None, comp_algo=None, comp_level=None):
+def bdev_compress_create(client, base_bdev_name, pm_path=None, lb_size=None, comp_algo=None, comp_level=None):
     """Construct a compress virtual block device.
     Args:
         base_bdev_name: name of the underlying base bdev
-        pm_path: path to persistent memory
+        pm_path: path to persistent memory (optional, metadata is kept on the base bdev if not given)
         lb_size: logical block size for the compressed vol in bytes.  Must be 4K or 512.
         comp_algo: compression algorithm for the compressed vol. Default is deflate.
         comp_level: compression algorithm level for the compressed vol. Default is 1.
@@ -60,7 +60,8 @@ def bdev_compress_create(client, base_bdev_name, pm_path, lb_size=None, comp_alg
     """
     params = dict()
     params['base_bdev_name'] = base_bdev_name
-    params['pm_path'] = pm_path
+    if pm_path is not None:
+        params['pm_path'] = pm_path
     if lb_size is not None:
         params['lb_size'] = lb_size
     if comp_algo is not None:
@@ -363,11 +364,14 @@ def bdev_null_resize(client, name, new_size):
     return client.call('bdev_null_resize', params)
 
 
-def bdev_raid_set_options(client, process_window_size_kb=None, process_max_bandwidth_mb_sec=None):
+def bdev_raid_set_options(client, process_window_size_kb=None, process_max_bandwidth_mb_sec=None,
+                          raid5f_stripe_cache_size=None, raid5f_stripe_cache_window_us=None):
     """Set options for bdev raid.
     Args:
         process_window_size_kb: Background process (e.g. rebuild) window size in KiB
         process_max_bandwidth_mb_sec: Background process (e.g. rebuild) maximum bandwidth in MiB/Sec
+        raid5f_stripe_cache_size: Number of raid5f stripes cached per channel for partial writes, 0 disables
+        raid5f_stripe_cache_window_us: Time a partially written raid5f stripe waits for more writes in microseconds
     """
     params = dict()
     if process_window_size_kb is not None:
@@ -376,6 +380,12 @@ def bdev_raid_set_options(client, process_window_size_kb=None, process_max_bandw
     if process_max_bandwidth_mb_sec is not None:
         params['process_max_bandwidth_mb_sec'] = process_max_bandwidth_mb_sec
 
+    if raid5f_stripe_cache_size is not None:
+        params['raid5f_stripe_cache_size'] = raid5f_stripe_cache_size
+
+    if raid5f_stripe_cache_window_us is not None:
+        params['raid5f_stripe_cache_window_us'] = raid5f_stripe_cache_window_us
+
     return client.call('bdev_raid_set_options', params)
 
 
@@ -391,7 +401,8 @@ def bdev_raid_get_bdevs(client, category):
     return client.call('bdev_raid_get_bdevs', params)
 
 
-def bdev_raid_create(client, name, raid_level, base_bdevs, strip_size_kb=None, uuid=None, superblock=None):
+def bdev_raid_create(client, name, raid_level, base_bdevs, strip_size_kb=None, uuid=None, superblock=None,
+                     read_policy=None):
     """Create raid bdev. Either strip size arg will work but one is required.
     Args:
         name: user defined raid bdev name
@@ -401,6 +412,7 @@ def bdev_raid_create(client, name, raid_level, base_bdevs, strip_size_kb=None, u
         uuid: UUID for this raid bdev (optional)
         superblock: information about raid bdev will be stored in superblock on each base bdev,
                     disabled by default due to backward compatibility
+        read_policy: read balancing policy, outstanding_blocks or latency (optional, raid1 only)
     Returns:
         None
     """
@@ -414,6 +426,8 @@ def bdev_raid_create(client, name, raid_level, base_bdevs, strip_size_kb=None, u
         params['uuid'] = uuid
     if superblock is not None:
         params['superblock'] = superblock
+    if read_policy is not None:
+        params['read_policy'] = read_policy
     return client.call('bdev_raid_create', params)
 
 
@@ -578,7 +592,8 @@ def bdev_nvme_set_options(client, action_on_timeout=None, timeout_us=None, timeo
                           fast_io_fail_timeout_sec=None, disable_auto_failback=None, generate_uuids=None,
                           transport_tos=None, nvme_error_stat=None, rdma_srq_size=None, io_path_stat=None,
                           allow_accel_sequence=None, rdma_max_cq_size=None, rdma_cm_event_timeout_ms=None,
-                          dhchap_digests=None, dhchap_dhgroups=None, rdma_umr_per_io=None):
+                          dhchap_digests=None, dhchap_dhgroups=None, rdma_umr_per_io=None,
+                          tcp_zcopy_threshold=None):
     """Set options for the bdev nvme. This is startup command.
     Args:
         action_on_timeout:  action to take on command time out. Valid values are: none, reset, abort (optional)
@@ -628,6 +643,8 @@ def bdev_nvme_set_options(client, action_on_timeout=None, timeout_us=None, timeo
         dhchap_digests: List of allowed DH-HMAC-CHAP digests. (optional)
         dhchap_dhgroups: List of allowed DH-HMAC-CHAP DH groups. (optional)
         rdma_umr_per_io: Enable/disable scatter-gather UMR per IO in RDMA transport if supported by system (optional).
+        tcp_zcopy_threshold: Send I/O qpair data of TCP transport with zero-copy once a batch of PDUs
+        reaches this many bytes. Default: 0 (use the sock implementation's options) (optional)
     """
     params = dict()
     if action_on_timeout is not None:
@@ -690,6 +707,8 @@ def bdev_nvme_set_options(client, action_on_timeout=None, timeout_us=None, timeo
         params['dhchap_dhgroups'] = dhchap_dhgroups
     if rdma_umr_per_io is not None:
         params['rdma_umr_per_io'] = rdma_umr_per_io
+    if tcp_zcopy_threshold is not None:
+        params['tcp_zcopy_threshold'] = tcp_zcopy_threshold
     return client.call('bdev_nvme_set_options', params)
 
 
@@ -981,7 +1000,7 @@ def bdev_nvme_set_multipath_policy(client, name, policy, selector=None, rr_min_i
     Args:
         name: NVMe bdev name
         policy: Multipath policy (active_passive or active_active)
-        selector: Multipath selector (round_robin, queue_depth)
+        selector: Multipath selector (round_robin, queue_depth, service_time)
         rr_min_io: Number of IO to route to a path before switching to another one (optional)
     """
     params = dict()
@@ -1671,6 +1690,21 @@ def bdev_set_qos_limit(
     return client.call('bdev_set_qos_limit', params)
 
 
+def bdev_set_qos_latency_target(client, name, latency_target_us, weight=None):
+    """Set QoS latency target on a block device.
+    Args:
+        name: name of block device
+        latency_target_us: p99 R/W latency target in microseconds. 0 disables the latency target.
+        weight: weight of the block device relative to others sharing the same device (1-100, default 1)
+    """
+    params = dict()
+    params['name'] = name
+    params['latency_target_us'] = latency_target_us
+    if weight is not None:
+        params['weight'] = weight
+    return client.call('bdev_set_qos_latency_target', params)
+
+
 def bdev_nvme_apply_firmware(client, bdev_name, filename):
     """Download and commit firmware to NVMe device.
     Args:
@@ -3,7 +3,8 @@
 #  All rights reserved.
 
 
-def iobuf_set_options(client, small_pool_count, large_pool_count, small_bufsize, large_bufsize, enable_numa=None):
+def iobuf_set_options(client, small_pool_count, large_pool_count, small_bufsize, large_bufsize, enable_numa=None,
+                      numa_steal=None, enable_adaptive_cache=None):
     """Set iobuf pool options.
 
     Args:
@@ -12,6 +13,8 @@ def iobuf_set_options(client, small_pool_count, large_pool_count, small_bufsize,
         small_bufsize: size of a small buffer
         large_bufsize: size of a large buffer
         enable_numa: enable per-NUMA buffer pools
+        numa_steal: policy for using other NUMA nodes' buffers when the local pool is empty: none, idle or any
+        enable_adaptive_cache: resize per-thread buffer caches based on their usage
     """
     params = {}
 
@@ -25,6 +28,10 @@ def iobuf_set_options(client, small_pool_count, large_pool_count, small_bufsize,
         params['large_bufsize'] = large_bufsize
     if enable_numa is not None:
         params['enable_numa'] = enable_numa
+    if numa_steal is not None:
+        params['numa_steal'] = numa_steal
+    if enable_adaptive_cache is not None:
+        params['enable_adaptive_cache'] = enable_adaptive_cache
 
     return client.call('iobuf_set_options', params)
 
@@ -27,7 +27,8 @@ def sock_impl_set_options(client,
                           enable_zerocopy_send_client=None,
                           zerocopy_threshold=None,
                           tls_version=None,
-                          enable_ktls=None):
+                          enable_ktls=None,
+                          flush_batch_timeout=None):
     """Set parameters for the socket layer implementation.
 
     Args:
@@ -42,6 +43,7 @@ def sock_impl_set_options(client,
         zerocopy_threshold: set zerocopy_threshold in bytes(optional)
         tls_version: set TLS protocol version (optional)
         enable_ktls: enable or disable Kernel TLS (optional)
+        flush_batch_timeout: max time in usec to hold back small batches of writes (optional)
     """
     params = {}
 
@@ -66,6 +68,8 @@ def sock_impl_set_options(client,
         params['tls_version'] = tls_version
     if enable_ktls is not None:
         params['enable_ktls'] = enable_ktls
+    if flush_batch_timeout is not None:
+        params['flush_batch_timeout'] = flush_batch_timeout
 
     return client.call('sock_impl_set_options', params)
 
@@ -87,3 +91,9 @@ def sock_get_default_impl(client):
     "Get the default socket implementation name."
 
     return client.call('sock_get_default_impl')
+
+
+def sock_get_group_stats(client):
+    "Get the statistics of all sock groups."
+
+    return client.call('sock_get_group_stats')
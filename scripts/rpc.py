@@ -269,7 +269,8 @@ if __name__ == "__main__":
 
     p = subparsers.add_parser('bdev_compress_create', help='Add a compress vbdev')
     p.add_argument('-b', '--base-bdev-name', help="Name of the base bdev", required=True)
-    p.add_argument('-p', '--pm-path', help="Path to persistent memory", required=True)
+    p.add_argument('-p', '--pm-path', help="""Path to persistent memory (optional).
+                   If not given, the metadata is kept on the base bdev""")
     p.add_argument('-l', '--lb-size', help="Compressed vol logical block size (optional, if used must be 512 or 4096)", type=int)
     p.add_argument('-c', '--comp-algo', help='Compression algorithm, (deflate, lz4). Default is deflate')
     p.add_argument('-L', '--comp-level',
@@ -627,7 +628,8 @@ if __name__ == "__main__":
                                        rdma_cm_event_timeout_ms=args.rdma_cm_event_timeout_ms,
                                        dhchap_digests=args.dhchap_digests,
                                        dhchap_dhgroups=args.dhchap_dhgroups,
-                                       rdma_umr_per_io=args.rdma_umr_per_io)
+                                       rdma_umr_per_io=args.rdma_umr_per_io,
+                                       tcp_zcopy_threshold=args.tcp_zcopy_threshold)
 
     p = subparsers.add_parser('bdev_nvme_set_options',
                               help='Set options for the bdev nvme type. This is startup command.')
@@ -720,6 +722,9 @@ if __name__ == "__main__":
     p.add_argument('--disable-rdma-umr-per-io',
                    help='''Disable scatter-gather RDMA Memory Region per IO.''',
                    action='store_false', dest='rdma_umr_per_io')
+    p.add_argument('--tcp-zcopy-threshold',
+                   help='''Send I/O qpair data of TCP transport with zero-copy once a batch of PDUs
+                   reaches this many bytes. Default: 0 (use the sock implementation's options)''', type=int)
 
     p.set_defaults(func=bdev_nvme_set_options)
 
@@ -990,7 +995,7 @@ if __name__ == "__main__":
                               help="""Set multipath policy of the NVMe bdev""")
     p.add_argument('-b', '--name', help='Name of the NVMe bdev', required=True)
     p.add_argument('-p', '--policy', help='Multipath policy (active_passive or active_active)', required=True)
-    p.add_argument('-s', '--selector', help='Multipath selector (round_robin, queue_depth)')
+    p.add_argument('-s', '--selector', help='Multipath selector (round_robin, queue_depth, service_time)')
     p.add_argument('-r', '--rr-min-io',
                    help='Number of IO to route to a path before switching to another for round-robin',
                    type=int)
@@ -1360,6 +1365,23 @@ if __name__ == "__main__":
                    type=int)
     p.set_defaults(func=bdev_set_qos_limit)
 
+    def bdev_set_qos_latency_target(args):
+        rpc.bdev.bdev_set_qos_latency_target(args.client,
+                                             name=args.name,
+                                             latency_target_us=args.latency_target_us,
+                                             weight=args.weight)
+
+    p = subparsers.add_parser('bdev_set_qos_latency_target',
+                              help='Set QoS latency target on a blockdev')
+    p.add_argument('name', help='Blockdev name to set QoS. Example: Malloc0')
+    p.add_argument('-l', '--latency-target-us',
+                   help='p99 R/W latency target in microseconds. 0 disables the latency target.',
+                   type=int, required=True)
+    p.add_argument('-w', '--weight',
+                   help='Weight of the blockdev relative to others sharing the same device (1-100, default 1)',
+                   type=int)
+    p.set_defaults(func=bdev_set_qos_latency_target)
+
     def bdev_error_inject_error(args):
         rpc.bdev.bdev_error_inject_error(args.client,
                                          name=args.name,
@@ -2271,7 +2293,9 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
     def bdev_raid_set_options(args):
         rpc.bdev.bdev_raid_set_options(args.client,
                                        process_window_size_kb=args.process_window_size_kb,
-                                       process_max_bandwidth_mb_sec=args.process_max_bandwidth_mb_sec)
+                                       process_max_bandwidth_mb_sec=args.process_max_bandwidth_mb_sec,
+                                       raid5f_stripe_cache_size=args.raid5f_stripe_cache_size,
+                                       raid5f_stripe_cache_window_us=args.raid5f_stripe_cache_window_us)
 
     p = subparsers.add_parser('bdev_raid_set_options',
                               help='Set options for bdev raid.')
@@ -2279,6 +2303,10 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
                    help="Background process (e.g. rebuild) window size in KiB")
     p.add_argument('-b', '--process-max-bandwidth-mb-sec', type=int,
                    help="Background process (e.g. rebuild) maximum bandwidth in MiB/Sec")
+    p.add_argument('--raid5f-stripe-cache-size', type=int,
+                   help="Number of raid5f stripes cached per channel for partial writes, 0 disables")
+    p.add_argument('--raid5f-stripe-cache-window-us', type=int,
+                   help="Time a partially written raid5f stripe waits for more writes in microseconds")
 
     p.set_defaults(func=bdev_raid_set_options)
 
@@ -2306,7 +2334,8 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
                                   raid_level=args.raid_level,
                                   base_bdevs=base_bdevs,
                                   uuid=args.uuid,
-                                  superblock=args.superblock)
+                                  superblock=args.superblock,
+                                  read_policy=args.read_policy)
     p = subparsers.add_parser('bdev_raid_create', help='Create new raid bdev')
     p.add_argument('-n', '--name', help='raid bdev name', required=True)
     p.add_argument('-z', '--strip-size-kb', help='strip size in KB', type=int)
@@ -2315,6 +2344,8 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
     p.add_argument('--uuid', help='UUID for this raid bdev')
     p.add_argument('-s', '--superblock', help='information about raid bdev will be stored in superblock on each base bdev, '
                                               'disabled by default due to backward compatibility', action='store_true')
+    p.add_argument('-p', '--read-policy', help='read balancing policy (raid1 only): outstanding_blocks (default) or latency',
+                   choices=['outstanding_blocks', 'latency'])
     p.set_defaults(func=bdev_raid_create)
 
     def bdev_raid_delete(args):
@@ -2375,7 +2406,9 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
                                             overprovisioning=args.overprovisioning,
                                             l2p_dram_limit=args.l2p_dram_limit,
                                             core_mask=args.core_mask,
-                                            fast_shutdown=args.fast_shutdown))
+                                            fast_shutdown=args.fast_shutdown,
+                                            gc_policy=args.gc_policy,
+                                            l2p_prefetch_depth=args.l2p_prefetch_depth))
 
     p = subparsers.add_parser('bdev_ftl_create', help='Add FTL bdev')
     p.add_argument('-b', '--name', help="Name of the bdev", required=True)
@@ -2392,6 +2425,10 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
     p.add_argument('--core-mask', help='CPU core mask - which cores will be used for ftl core thread, '
                    'by default core thread will be set to the main application core (optional)')
     p.add_argument('-f', '--fast-shutdown', help="Enable fast shutdown", action='store_true')
+    p.add_argument('--gc-policy', help='Band selection policy for garbage collection (optional); default greedy',
+                   choices=['greedy', 'cost_benefit'])
+    p.add_argument('--l2p-prefetch-depth', help='Number of L2P pages paged in ahead of sequential IO, '
+                   '0 disables prefetching (optional); default 8', type=int)
     p.set_defaults(func=bdev_ftl_create)
 
     def bdev_ftl_load(args):
@@ -2403,7 +2440,9 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
                                           overprovisioning=args.overprovisioning,
                                           l2p_dram_limit=args.l2p_dram_limit,
                                           core_mask=args.core_mask,
-                                          fast_shutdown=args.fast_shutdown))
+                                          fast_shutdown=args.fast_shutdown,
+                                          gc_policy=args.gc_policy,
+                                          l2p_prefetch_depth=args.l2p_prefetch_depth))
 
     p = subparsers.add_parser('bdev_ftl_load', help='Load FTL bdev')
     p.add_argument('-b', '--name', help="Name of the bdev", required=True)
@@ -2419,6 +2458,10 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
     p.add_argument('--core-mask', help='CPU core mask - which cores will be used for ftl core thread, '
                    'by default core thread will be set to the main application core (optional)')
     p.add_argument('-f', '--fast-shutdown', help="Enable fast shutdown", action='store_true')
+    p.add_argument('--gc-policy', help='Band selection policy for garbage collection (optional); default greedy',
+                   choices=['greedy', 'cost_benefit'])
+    p.add_argument('--l2p-prefetch-depth', help='Number of L2P pages paged in ahead of sequential IO, '
+                   '0 disables prefetching (optional); default 8', type=int)
     p.set_defaults(func=bdev_ftl_load)
 
     def bdev_ftl_unload(args):
@@ -3736,7 +3779,8 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
                                        enable_zerocopy_send_client=args.enable_zerocopy_send_client,
                                        zerocopy_threshold=args.zerocopy_threshold,
                                        tls_version=args.tls_version,
-                                       enable_ktls=args.enable_ktls)
+                                       enable_ktls=args.enable_ktls,
+                                       flush_batch_timeout=args.flush_batch_timeout)
 
     p = subparsers.add_parser('sock_impl_set_options', help="""Set options of socket layer implementation""")
     p.add_argument('-i', '--impl', help='Socket implementation name, e.g. posix', required=True)
@@ -3765,9 +3809,11 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
                    action='store_true', dest='enable_ktls')
     p.add_argument('--disable-ktls', help='Disable Kernel TLS',
                    action='store_false', dest='enable_ktls')
+    p.add_argument('--flush-batch-timeout', help='Max time in usec small batches of writes are held back '
+                   'to be sent together with later writes, 0 disables it', type=int)
     p.set_defaults(func=sock_impl_set_options, enable_recv_pipe=None, enable_quickack=None,
                    enable_placement_id=None, enable_zerocopy_send_server=None, enable_zerocopy_send_client=None,
-                   zerocopy_threshold=None, tls_version=None, enable_ktls=None)
+                   zerocopy_threshold=None, tls_version=None, enable_ktls=None, flush_batch_timeout=None)
 
     def sock_set_default_impl(args):
         print_json(rpc.sock.sock_set_default_impl(args.client,
@@ -3783,6 +3829,12 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
     p = subparsers.add_parser('sock_get_default_impl', help="Get the default sock implementation name")
     p.set_defaults(func=sock_get_default_impl)
 
+    def sock_get_group_stats(args):
+        print_json(rpc.sock.sock_get_group_stats(args.client))
+
+    p = subparsers.add_parser('sock_get_group_stats', help="Get the statistics of all sock groups")
+    p.set_defaults(func=sock_get_group_stats)
+
     def framework_get_pci_devices(args):
         def splitbuf(buf, step):
             return [buf[i:i+step] for i in range(0, len(buf), step)]
@@ -3888,13 +3940,20 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
                                     large_pool_count=args.large_pool_count,
                                     small_bufsize=args.small_bufsize,
                                     large_bufsize=args.large_bufsize,
-                                    enable_numa=args.enable_numa)
+                                    enable_numa=args.enable_numa,
+                                    numa_steal=args.numa_steal,
+                                    enable_adaptive_cache=args.enable_adaptive_cache)
     p = subparsers.add_parser('iobuf_set_options', help='Set iobuf pool options')
     p.add_argument('--small-pool-count', help='number of small buffers in the global pool', type=int)
     p.add_argument('--large-pool-count', help='number of large buffers in the global pool', type=int)
     p.add_argument('--small-bufsize', help='size of a small buffer', type=int)
     p.add_argument('--large-bufsize', help='size of a large buffer', type=int)
     p.add_argument('--enable-numa', help='enable per-NUMA node buffer pools', action='store_true')
+    p.add_argument('--numa-steal', help="""policy for using other NUMA nodes' buffers when the local pool is empty:
+                   none - never, idle - only if at least half of the other node's pool is free,
+                   any - whenever the other node has free buffers""", choices=['none', 'idle', 'any'])
+    p.add_argument('--enable-adaptive-cache', help='resize per-thread buffer caches based on their usage',
+                   action='store_true')
     p.set_defaults(func=iobuf_set_options)
 
     def iobuf_get_stats(args):
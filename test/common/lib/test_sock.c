@@ -19,6 +19,7 @@ DEFINE_STUB(spdk_sock_listen_ext, struct spdk_sock *, (const char *ip, int port,
 DEFINE_STUB_V(spdk_sock_get_default_opts, (struct spdk_sock_opts *opts));
 DEFINE_STUB(spdk_sock_impl_get_opts, int, (const char *impl_name, struct spdk_sock_impl_opts *opts,
 		size_t *len), 0);
+DEFINE_STUB(spdk_sock_get_default_impl, const char *, (void), NULL);
 DEFINE_STUB(spdk_sock_accept, struct spdk_sock *, (struct spdk_sock *sock), NULL);
 DEFINE_STUB(spdk_sock_close, int, (struct spdk_sock **sock), 0);
 DEFINE_STUB(spdk_sock_recv, ssize_t, (struct spdk_sock *sock, void *buf, size_t len), 1);
@@ -42,6 +43,14 @@ DEFINE_STUB(spdk_sock_group_poll_count, int, (struct spdk_sock_group *group, int
 DEFINE_STUB(spdk_sock_group_close, int, (struct spdk_sock_group **group), 0);
 DEFINE_STUB(spdk_sock_group_provide_buf, int, (struct spdk_sock_group *group, void *buf, size_t len,
 		void *ctx), 0);
+DEFINE_STUB_V(spdk_sock_for_each_group, (spdk_sock_group_fn fn, void *ctx));
+DEFINE_STUB(spdk_sock_group_get_load, uint64_t, (struct spdk_sock_group *group), 0);
+
+void
+spdk_sock_group_get_stats(struct spdk_sock_group *group, struct spdk_sock_group_stats *stats)
+{
+	memset(stats, 0, sizeof(*stats));
+}
 
 static uint8_t g_buf[0x1000] = {};
 
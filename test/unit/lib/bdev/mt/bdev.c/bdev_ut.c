@@ -1911,6 +1911,90 @@ qos_dynamic_enable(void)
 	teardown_test();
 }
 
+static void
+qos_latency_target(void)
+{
+	struct spdk_io_channel *io_ch;
+	struct spdk_bdev_channel *bdev_ch;
+	struct spdk_bdev *bdev = &g_bdev.bdev;
+	struct spdk_bdev_qos *qos;
+	enum spdk_bdev_io_status bdev_io_status[200];
+	uint64_t latency_target_us;
+	uint32_t weight;
+	int status, rc, i;
+
+	setup_test();
+	MOCK_SET(spdk_get_ticks, 0);
+
+	set_thread(0);
+	io_ch = spdk_bdev_get_io_channel(g_desc);
+	bdev_ch = spdk_io_channel_get_ctx(io_ch);
+	CU_ASSERT(bdev_ch->flags == 0);
+
+	/* Invalid weight */
+	status = -1;
+	spdk_bdev_set_qos_latency_target(bdev, 100, 0, qos_dynamic_enable_done, &status);
+	poll_threads();
+	CU_ASSERT(status == -EINVAL);
+	CU_ASSERT(bdev->internal.qos == NULL);
+
+	/* A latency target alone enables QoS */
+	status = -1;
+	spdk_bdev_set_qos_latency_target(bdev, 100, 2, qos_dynamic_enable_done, &status);
+	poll_threads();
+	CU_ASSERT(status == 0);
+	CU_ASSERT((bdev_ch->flags & BDEV_CH_QOS_ENABLED) != 0);
+	spdk_bdev_get_qos_latency_target(bdev, &latency_target_us, &weight);
+	CU_ASSERT(latency_target_us == 100);
+	CU_ASSERT(weight == 2);
+
+	qos = bdev->internal.qos;
+	SPDK_CU_ASSERT_FATAL(qos != NULL);
+	CU_ASSERT(qos->latency_rate == 0);
+	CU_ASSERT(qos->rate_limits[SPDK_BDEV_QOS_RW_IOPS_RATE_LIMIT].max_per_timeslice == 0);
+
+	/* The first poll makes the channels start collecting latencies */
+	spdk_delay_us(SPDK_BDEV_QOS_TIMESLICE_IN_USEC);
+	poll_threads();
+	CU_ASSERT(bdev_ch->qos_latency_hist != NULL);
+
+	/* Complete I/O well above the latency target, nothing is throttled yet */
+	for (i = 0; i < (int)SPDK_COUNTOF(bdev_io_status); i++) {
+		bdev_io_status[i] = SPDK_BDEV_IO_STATUS_PENDING;
+		rc = spdk_bdev_read_blocks(g_desc, io_ch, NULL, 0, 1, io_during_io_done, &bdev_io_status[i]);
+		CU_ASSERT(rc == 0);
+	}
+	poll_thread(0);
+	spdk_delay_us(1000);
+	CU_ASSERT(stub_complete_io(g_bdev.io_target, 0) == SPDK_COUNTOF(bdev_io_status));
+	poll_threads();
+	for (i = 0; i < (int)SPDK_COUNTOF(bdev_io_status); i++) {
+		CU_ASSERT(bdev_io_status[i] == SPDK_BDEV_IO_STATUS_SUCCESS);
+	}
+
+	/* The latency controller should now limit the IOPS */
+	spdk_delay_us(SPDK_BDEV_QOS_LATENCY_PERIOD_IN_USEC);
+	poll_threads();
+	CU_ASSERT(qos->latency_rate >= SPDK_BDEV_QOS_MIN_IOS_PER_SEC);
+	CU_ASSERT(qos->rate_limits[SPDK_BDEV_QOS_RW_IOPS_RATE_LIMIT].max_per_timeslice ==
+		  qos->latency_rate * SPDK_BDEV_QOS_TIMESLICE_IN_USEC / SPDK_SEC_TO_USEC);
+	CU_ASSERT(qos->rate_limits[SPDK_BDEV_QOS_RW_IOPS_RATE_LIMIT].queue_io != NULL);
+
+	/* Disable the latency target, which disables QoS too */
+	status = -1;
+	spdk_bdev_set_qos_latency_target(bdev, 0, 0, qos_dynamic_enable_done, &status);
+	poll_threads();
+	CU_ASSERT(status == 0);
+	CU_ASSERT((bdev_ch->flags & BDEV_CH_QOS_ENABLED) == 0);
+	CU_ASSERT(bdev_ch->qos_latency_hist == NULL);
+	CU_ASSERT(bdev->internal.qos == NULL);
+
+	spdk_put_io_channel(io_ch);
+	poll_threads();
+
+	teardown_test();
+}
+
 static void
 histogram_status_cb(void *cb_arg, int status)
 {
@@ -2892,6 +2976,7 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, enomem_multi_io_target);
 	CU_ADD_TEST(suite, enomem_retry_during_abort);
 	CU_ADD_TEST(suite, qos_dynamic_enable);
+	CU_ADD_TEST(suite, qos_latency_target);
 	CU_ADD_TEST(suite, bdev_histograms_mt);
 	CU_ADD_TEST(suite, bdev_set_io_timeout_mt);
 	CU_ADD_TEST(suite, lock_lba_range_then_submit_io);
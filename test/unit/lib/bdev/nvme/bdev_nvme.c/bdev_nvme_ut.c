@@ -3952,6 +3952,18 @@ test_add_multi_io_paths_to_nbdev_ch(void)
 	nvme_ns3 = _nvme_bdev_get_ns(nbdev, nvme_ctrlr3);
 	SPDK_CU_ASSERT_FATAL(nvme_ns3 != NULL);
 
+	/* The I/O path is not added until the nvme_bdev_channel submits the next I/O. */
+	CU_ASSERT(nbdev_ch->io_path_gen != nbdev->io_path_gen);
+	CU_ASSERT(_bdev_nvme_get_io_path(nbdev_ch, nvme_ns3) == NULL);
+
+	set_thread(0);
+
+	/* Deciding whether to retry an I/O also picks up the new I/O path. */
+	CU_ASSERT(any_io_path_may_become_available(nbdev_ch) == true);
+	CU_ASSERT(nbdev_ch->io_path_gen == nbdev->io_path_gen);
+
+	set_thread(1);
+
 	io_path3 = _bdev_nvme_get_io_path(nbdev_ch, nvme_ns3);
 	SPDK_CU_ASSERT_FATAL(io_path3 != NULL);
 
@@ -4929,6 +4941,9 @@ test_retry_io_for_io_path_error(void)
 	CU_ASSERT(nvme_ns2 != NULL);
 	CU_ASSERT(nvme_ns2 == _nvme_bdev_get_ns(nbdev, nvme_ctrlr2));
 
+	/* io_path2 is picked up by nbdev_ch on the next I/O. */
+	bdev_nvme_check_io_paths(nbdev_ch);
+
 	io_path2 = ut_get_io_path_by_ctrlr(nbdev_ch, nvme_ctrlr2);
 	SPDK_CU_ASSERT_FATAL(io_path2 != NULL);
 
@@ -6471,6 +6486,77 @@ test_find_io_path_min_qd(void)
 	CU_ASSERT(bdev_nvme_find_io_path(&nbdev_ch) == &io_path1);
 }
 
+static void
+test_find_io_path_service_time(void)
+{
+	struct nvme_bdev_channel nbdev_ch = {
+		.io_path_list = STAILQ_HEAD_INITIALIZER(nbdev_ch.io_path_list),
+		.mp_policy = BDEV_NVME_MP_POLICY_ACTIVE_ACTIVE,
+		.mp_selector = BDEV_NVME_MP_SELECTOR_SERVICE_TIME,
+	};
+	struct spdk_nvme_qpair qpair1 = {}, qpair2 = {};
+	struct spdk_nvme_ctrlr ctrlr1 = {}, ctrlr2 = {};
+	struct spdk_nvme_ns ns1 = {}, ns2 = {};
+	struct nvme_ctrlr nvme_ctrlr1 = { .ctrlr = &ctrlr1, };
+	struct nvme_ctrlr nvme_ctrlr2 = { .ctrlr = &ctrlr2, };
+	struct nvme_ctrlr_channel ctrlr_ch1 = {};
+	struct nvme_ctrlr_channel ctrlr_ch2 = {};
+	struct nvme_qpair nvme_qpair1 = { .ctrlr_ch = &ctrlr_ch1, .ctrlr = &nvme_ctrlr1, .qpair = &qpair1, };
+	struct nvme_qpair nvme_qpair2 = { .ctrlr_ch = &ctrlr_ch2, .ctrlr = &nvme_ctrlr2, .qpair = &qpair2, };
+	struct nvme_ns nvme_ns1 = { .ns = &ns1, }, nvme_ns2 = { .ns = &ns2, };
+	struct nvme_io_path io_path1 = {
+		.qpair = &nvme_qpair1, .nvme_ns = &nvme_ns1, .nbdev_ch = &nbdev_ch,
+	};
+	struct nvme_io_path io_path2 = {
+		.qpair = &nvme_qpair2, .nvme_ns = &nvme_ns2, .nbdev_ch = &nbdev_ch,
+	};
+	struct nvme_bdev_io bio = {};
+
+	STAILQ_INSERT_TAIL(&nbdev_ch.io_path_list, &io_path1, stailq);
+	STAILQ_INSERT_TAIL(&nbdev_ch.io_path_list, &io_path2, stailq);
+
+	nvme_ns1.ana_state = SPDK_NVME_ANA_OPTIMIZED_STATE;
+	nvme_ns2.ana_state = SPDK_NVME_ANA_OPTIMIZED_STATE;
+
+	/* Paths without latency samples are balanced by queue depth */
+	qpair1.num_outstanding_reqs = 1;
+	qpair2.num_outstanding_reqs = 0;
+	CU_ASSERT(bdev_nvme_find_io_path(&nbdev_ch) == &io_path2);
+
+	/* The first sample initializes the latency, the following ones are averaged */
+	spdk_delay_us(1000);
+	bio.io_path = &io_path1;
+	bio.submit_tsc = spdk_get_ticks() - 100;
+	bdev_nvme_update_io_path_latency(&bio);
+	CU_ASSERT(io_path1.latency_ticks == 100);
+	bio.io_path = &io_path2;
+	bio.submit_tsc = spdk_get_ticks() - 400;
+	bdev_nvme_update_io_path_latency(&bio);
+	CU_ASSERT(io_path2.latency_ticks == 400);
+	bio.submit_tsc = spdk_get_ticks() - 800;
+	bdev_nvme_update_io_path_latency(&bio);
+	CU_ASSERT(io_path2.latency_ticks == 400 - 50 + 100);
+
+	/* The faster path is chosen even with more outstanding I/O */
+	qpair1.num_outstanding_reqs = 2;
+	qpair2.num_outstanding_reqs = 0;
+	CU_ASSERT(bdev_nvme_find_io_path(&nbdev_ch) == &io_path1);
+
+	/* The current path is kept unless the other one is clearly faster */
+	qpair1.num_outstanding_reqs = 4;
+	CU_ASSERT(bdev_nvme_find_io_path(&nbdev_ch) == &io_path1);
+	qpair1.num_outstanding_reqs = 5;
+	CU_ASSERT(bdev_nvme_find_io_path(&nbdev_ch) == &io_path2);
+	qpair1.num_outstanding_reqs = 3;
+	CU_ASSERT(bdev_nvme_find_io_path(&nbdev_ch) == &io_path2);
+	qpair1.num_outstanding_reqs = 2;
+	CU_ASSERT(bdev_nvme_find_io_path(&nbdev_ch) == &io_path1);
+
+	/* ANA optimized paths are still preferred */
+	nvme_ns1.ana_state = SPDK_NVME_ANA_NON_OPTIMIZED_STATE;
+	CU_ASSERT(bdev_nvme_find_io_path(&nbdev_ch) == &io_path2);
+}
+
 static void
 test_disable_auto_failback(void)
 {
@@ -8208,6 +8294,7 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_set_preferred_path);
 	CU_ADD_TEST(suite, test_find_next_io_path);
 	CU_ADD_TEST(suite, test_find_io_path_min_qd);
+	CU_ADD_TEST(suite, test_find_io_path_service_time);
 	CU_ADD_TEST(suite, test_disable_auto_failback);
 	CU_ADD_TEST(suite, test_set_multipath_policy);
 	CU_ADD_TEST(suite, test_uuid_generation);
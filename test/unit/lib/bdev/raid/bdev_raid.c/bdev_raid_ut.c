@@ -185,8 +185,6 @@ DEFINE_STUB(spdk_bdev_notify_blockcnt_change, int, (struct spdk_bdev *bdev, uint
 DEFINE_STUB(spdk_json_write_named_uuid, int, (struct spdk_json_write_ctx *w, const char *name,
 		const struct spdk_uuid *val), 0);
 DEFINE_STUB_V(raid_bdev_init_superblock, (struct raid_bdev *raid_bdev));
-DEFINE_STUB(raid_bdev_alloc_superblock, int, (struct raid_bdev *raid_bdev, uint32_t block_size), 0);
-DEFINE_STUB_V(raid_bdev_free_superblock, (struct raid_bdev *raid_bdev));
 DEFINE_STUB(spdk_bdev_readv_blocks_ext, int, (struct spdk_bdev_desc *desc,
 		struct spdk_io_channel *ch, struct iovec *iov, int iovcnt, uint64_t offset_blocks,
 		uint64_t num_blocks, spdk_bdev_io_completion_cb cb, void *cb_arg,
@@ -217,6 +215,44 @@ raid_bdev_write_superblock(struct raid_bdev *raid_bdev, raid_bdev_write_sb_cb cb
 	cb(0, raid_bdev, cb_ctx);
 }
 
+int
+raid_bdev_alloc_superblock(struct raid_bdev *raid_bdev, uint32_t block_size)
+{
+	raid_bdev->sb = calloc(1, RAID_BDEV_SB_MAX_LENGTH);
+	SPDK_CU_ASSERT_FATAL(raid_bdev->sb != NULL);
+
+	return 0;
+}
+
+void
+raid_bdev_free_superblock(struct raid_bdev *raid_bdev)
+{
+	free(raid_bdev->sb);
+	raid_bdev->sb = NULL;
+}
+
+void
+raid_bdev_write_bitmap(struct raid_bdev *raid_bdev, uint32_t offset_blocks, uint32_t num_blocks,
+		       raid_bdev_write_sb_cb cb, void *cb_ctx)
+{
+	cb(0, raid_bdev, cb_ctx);
+}
+
+int
+raid_bdev_load_bitmap(struct raid_bdev *raid_bdev, struct raid_base_bdev_info *base_info,
+		      raid_bdev_write_sb_cb cb, void *cb_ctx)
+{
+	cb(0, raid_bdev, cb_ctx);
+
+	return 0;
+}
+
+struct spdk_thread *
+spdk_bdev_io_get_thread(struct spdk_bdev_io *bdev_io)
+{
+	return spdk_get_thread();
+}
+
 const struct spdk_uuid *
 spdk_bdev_get_uuid(const struct spdk_bdev *bdev)
 {
@@ -1416,6 +1452,93 @@ test_raid_process(void)
 	reset_globals();
 }
 
+static void
+test_raid_process_resync(void)
+{
+	struct rpc_bdev_raid_create req;
+	struct rpc_bdev_raid_delete destroy_req;
+	struct raid_bdev *pbdev;
+	struct spdk_bdev *base_bdev;
+	struct spdk_thread *process_thread;
+	struct raid_bdev_bitmap *bitmap;
+	struct spdk_raid_bdev_opts opts, saved_opts;
+	uint64_t num_blocks_processed = 0;
+
+	set_globals();
+	CU_ASSERT(raid_bdev_init() == 0);
+
+	create_raid_bdev_create_req(&req, "raid1", 0, true, 0, false);
+	verify_raid_bdev_present("raid1", false);
+	TAILQ_FOREACH(base_bdev, &g_bdev_list, internal.link) {
+		base_bdev->blockcnt = 128;
+	}
+	rpc_bdev_raid_create(NULL, NULL);
+	CU_ASSERT(g_rpc_err == 0);
+	verify_raid_bdev(&req, true, RAID_BDEV_STATE_ONLINE);
+	free_test_req(&req);
+
+	TAILQ_FOREACH(pbdev, &g_raid_bdev_list, global_link) {
+		if (strcmp(pbdev->bdev.name, "raid1") == 0) {
+			break;
+		}
+	}
+	CU_ASSERT(pbdev != NULL);
+
+	pbdev->module_private = &num_blocks_processed;
+	pbdev->min_base_bdevs_operational = 0;
+
+	/* 16 regions of 8 blocks, regions 2 and 9 are dirty */
+	bitmap = calloc(1, sizeof(*bitmap));
+	SPDK_CU_ASSERT_FATAL(bitmap != NULL);
+	bitmap->region_size = 8;
+	bitmap->region_shift = 3;
+	bitmap->num_regions = 16;
+	bitmap->persisted = spdk_bit_array_create(bitmap->num_regions);
+	SPDK_CU_ASSERT_FATAL(bitmap->persisted != NULL);
+	TAILQ_INIT(&bitmap->waiting);
+	TAILQ_INIT(&bitmap->flushing);
+	spdk_bit_array_set(bitmap->persisted, 2);
+	spdk_bit_array_set(bitmap->persisted, 9);
+	pbdev->bitmap = bitmap;
+	pbdev->base_bdev_info[0].resync = true;
+
+	raid_bdev_get_opts(&saved_opts);
+	opts = saved_opts;
+	opts.process_window_size_kb = bitmap->region_size * g_block_len / 1024;
+	CU_ASSERT(raid_bdev_set_opts(&opts) == 0);
+
+	CU_ASSERT(raid_bdev_start_rebuild(&pbdev->base_bdev_info[0]) == 0);
+	poll_app_thread();
+
+	SPDK_CU_ASSERT_FATAL(pbdev->process != NULL);
+	CU_ASSERT(pbdev->process->type == RAID_PROCESS_RESYNC);
+
+	process_thread = g_latest_thread;
+	spdk_thread_poll(process_thread, 0, 0);
+	SPDK_CU_ASSERT_FATAL(pbdev->process->thread == process_thread);
+
+	while (spdk_thread_poll(process_thread, 0, 0) > 0) {
+		poll_app_thread();
+	}
+
+	/* Only the dirty regions should have been copied */
+	CU_ASSERT(pbdev->process == NULL);
+	CU_ASSERT(num_blocks_processed == 2 * bitmap->region_size);
+
+	poll_app_thread();
+
+	CU_ASSERT(raid_bdev_set_opts(&saved_opts) == 0);
+
+	create_raid_bdev_delete_req(&destroy_req, "raid1", 0);
+	rpc_bdev_raid_delete(NULL, NULL);
+	CU_ASSERT(g_rpc_err == 0);
+	verify_raid_bdev_present("raid1", false);
+
+	raid_bdev_exit();
+	base_bdevs_cleanup();
+	reset_globals();
+}
+
 static void
 test_raid_process_with_qos(void)
 {
@@ -1795,6 +1918,7 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_raid_level_conversions);
 	CU_ADD_TEST(suite, test_raid_io_split);
 	CU_ADD_TEST(suite, test_raid_process);
+	CU_ADD_TEST(suite, test_raid_process_resync);
 	CU_ADD_TEST(suite, test_raid_process_with_qos);
 
 	spdk_thread_lib_init(test_new_thread_fn, 0);
@@ -12,6 +12,7 @@
 #include "bdev/raid/bdev_raid_sb.c"
 
 #define TEST_BUF_ALIGN	64
+#define TEST_BITMAP_BLOCKS	4
 
 DEFINE_STUB(spdk_bdev_queue_io_wait, int, (struct spdk_bdev *bdev, struct spdk_io_channel *ch,
 		struct spdk_bdev_io_wait_entry *entry), 0);
@@ -34,7 +35,8 @@ _test_setup(uint32_t blocklen, uint32_t md_len)
 	g_bdev.md_len = md_len;
 
 	g_buf = spdk_dma_zmalloc(SPDK_ALIGN_CEIL(RAID_BDEV_SB_MAX_LENGTH,
-				 spdk_bdev_get_data_block_size(&g_bdev)), TEST_BUF_ALIGN, NULL);
+				 spdk_bdev_get_data_block_size(&g_bdev)) + TEST_BITMAP_BLOCKS * blocklen,
+				 TEST_BUF_ALIGN, NULL);
 	if (!g_buf) {
 		return -ENOMEM;
 	}
@@ -134,12 +136,17 @@ spdk_bdev_write(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
 	struct spdk_bdev *bdev = spdk_bdev_desc_get_bdev(desc);
 	struct raid_bdev_superblock *sb = buf;
 	struct spdk_bdev_io *bdev_io;
-	void *dest = g_buf;
 	uint32_t data_block_size = spdk_bdev_get_data_block_size(bdev);
+	void *dest = g_buf + offset / bdev->blocklen * data_block_size;
 
 	g_write_counter++;
-	CU_ASSERT(offset == 0);
-	CU_ASSERT(nbytes == spdk_divide_round_up(sb->length, data_block_size) * bdev->blocklen);
+	if (offset == 0) {
+		CU_ASSERT(nbytes == spdk_divide_round_up(sb->length, data_block_size) * bdev->blocklen);
+	} else {
+		/* bitmap write */
+		CU_ASSERT(offset % bdev->blocklen == 0);
+		CU_ASSERT(nbytes % bdev->blocklen == 0);
+	}
 
 	while (nbytes > 0) {
 		memcpy(dest, buf, data_block_size);
@@ -245,6 +252,69 @@ test_raid_bdev_write_superblock(void)
 	raid_bdev_free_superblock(&raid_bdev);
 }
 
+static void
+test_raid_bdev_write_load_bitmap(void)
+{
+	struct raid_base_bdev_info base_info[3] = {{0}};
+	struct raid_bdev_bitmap bitmap = {0};
+	struct raid_bdev raid_bdev = {
+		.num_base_bdevs = SPDK_COUNTOF(base_info),
+		.base_bdev_info = base_info,
+		.bdev = g_bdev,
+		.bitmap = &bitmap,
+	};
+	uint32_t blocklen = g_bdev.blocklen;
+	void *disk_bitmap;
+	int status;
+	int rc;
+	uint8_t i;
+
+	/* The bitmap is never enabled with interleaved metadata */
+	if (spdk_bdev_is_md_interleaved(&g_bdev)) {
+		return;
+	}
+
+	for (i = 0; i < SPDK_COUNTOF(base_info); i++) {
+		base_info[i].raid_bdev = &raid_bdev;
+		if (i > 0) {
+			base_info[i].is_configured = true;
+		}
+	}
+
+	bitmap.offset_blocks = spdk_divide_round_up(RAID_BDEV_SB_MAX_LENGTH, blocklen);
+	bitmap.num_blocks = TEST_BITMAP_BLOCKS;
+	bitmap.buf = spdk_dma_zmalloc(bitmap.num_blocks * blocklen, TEST_BUF_ALIGN, NULL);
+	SPDK_CU_ASSERT_FATAL(bitmap.buf != NULL);
+	disk_bitmap = g_buf + bitmap.offset_blocks * blocklen;
+	memset(disk_bitmap, 0, bitmap.num_blocks * blocklen);
+
+	/* write only the middle blocks of the bitmap */
+	memset(bitmap.buf, 0x5a, bitmap.num_blocks * blocklen);
+
+	status = INT_MAX;
+	g_write_counter = 0;
+	raid_bdev_write_bitmap(&raid_bdev, 1, 2, write_sb_cb, &status);
+	CU_ASSERT(g_write_counter == raid_bdev.num_base_bdevs - 1);
+	process_io_completions();
+	CU_ASSERT(status == 0);
+	CU_ASSERT(spdk_mem_all_zero(disk_bitmap, blocklen));
+	CU_ASSERT(memcmp(disk_bitmap + blocklen, bitmap.buf + blocklen, 2 * blocklen) == 0);
+	CU_ASSERT(spdk_mem_all_zero(disk_bitmap + 3 * blocklen, blocklen));
+
+	/* load it back */
+	memset(bitmap.buf, 0, bitmap.num_blocks * blocklen);
+
+	status = INT_MAX;
+	g_read_counter = 0;
+	rc = raid_bdev_load_bitmap(&raid_bdev, &base_info[1], write_sb_cb, &status);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(status == 0);
+	CU_ASSERT(g_read_counter == 1);
+	CU_ASSERT(memcmp(disk_bitmap, bitmap.buf, bitmap.num_blocks * blocklen) == 0);
+
+	spdk_dma_free(bitmap.buf);
+}
+
 static void
 load_sb_cb(const struct raid_bdev_superblock *sb, int status, void *ctx)
 {
@@ -384,6 +454,7 @@ main(int argc, char **argv)
 	CU_TestInfo tests[] = {
 		{ "test_raid_bdev_write_superblock", test_raid_bdev_write_superblock },
 		{ "test_raid_bdev_load_base_bdev_superblock", test_raid_bdev_load_base_bdev_superblock },
+		{ "test_raid_bdev_write_load_bitmap", test_raid_bdev_write_load_bitmap },
 		{ "test_raid_bdev_parse_superblock", test_raid_bdev_parse_superblock },
 		CU_TEST_INFO_NULL,
 	};
@@ -15,6 +15,7 @@
 static enum spdk_bdev_io_status g_io_status;
 static struct spdk_bdev_desc *g_last_io_desc;
 static spdk_bdev_io_completion_cb g_last_io_cb;
+static uint64_t g_submit_tsc;
 
 DEFINE_STUB_V(raid_bdev_module_list_add, (struct raid_bdev_module *raid_module));
 DEFINE_STUB_V(raid_bdev_module_stop_done, (struct raid_bdev *raid_bdev));
@@ -32,6 +33,12 @@ DEFINE_STUB(raid_bdev_remap_dix_reftag, int, (void *md_buf, uint64_t num_blocks,
 		struct spdk_bdev *bdev, uint32_t remapped_offset), -1);
 DEFINE_STUB(spdk_bdev_notify_blockcnt_change, int, (struct spdk_bdev *bdev, uint64_t size), 0);
 
+uint64_t
+spdk_bdev_io_get_submit_tsc(struct spdk_bdev_io *bdev_io)
+{
+	return g_submit_tsc;
+}
+
 int
 spdk_bdev_readv_blocks_ext(struct spdk_bdev_desc *desc,
 			   struct spdk_io_channel *ch,
@@ -217,8 +224,8 @@ _test_raid1_read_balancing(struct raid_bdev *raid_bdev, struct raid_bdev_io_chan
 	}
 
 	for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
-		CU_ASSERT(raid1_ch->read_blocks_outstanding[i] == n * small_io_blocks);
-		raid1_ch->read_blocks_outstanding[i] = 0;
+		CU_ASSERT(raid1_ch->base_stats[i].read_blocks_outstanding == n * small_io_blocks);
+		raid1_ch->base_stats[i].read_blocks_outstanding = 0;
 	}
 
 	/*
@@ -240,7 +247,7 @@ _test_raid1_read_balancing(struct raid_bdev *raid_bdev, struct raid_bdev_io_chan
 	}
 
 	for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
-		CU_ASSERT(raid1_ch->read_blocks_outstanding[i] == big_io_blocks);
+		CU_ASSERT(raid1_ch->base_stats[i].read_blocks_outstanding == big_io_blocks);
 	}
 
 	raid_io = get_raid_io(r1_info, raid_ch, SPDK_BDEV_IO_TYPE_READ, small_io_blocks);
@@ -255,6 +262,110 @@ test_raid1_read_balancing(void)
 	run_for_each_raid1_config(_test_raid1_read_balancing);
 }
 
+static uint8_t
+submit_read_at(struct raid_bdev *raid_bdev, struct raid_bdev_io_channel *raid_ch,
+	       uint64_t offset_blocks, uint64_t num_blocks)
+{
+	struct raid_bdev_io *raid_io;
+	uint8_t idx;
+
+	raid_io = get_raid_io(raid_bdev->module_private, raid_ch, SPDK_BDEV_IO_TYPE_READ, num_blocks);
+	raid_io->offset_blocks = offset_blocks;
+	raid1_submit_read_request(raid_io);
+	idx = raid_io->base_bdev_io_submitted;
+	put_raid_io(raid_io);
+
+	return idx;
+}
+
+static void
+_test_raid1_read_balancing_latency(struct raid_bdev *raid_bdev,
+				   struct raid_bdev_io_channel *raid_ch)
+{
+	struct raid1_info *r1_info = raid_bdev->module_private;
+	struct raid1_io_channel *raid1_ch = raid_bdev_channel_get_module_ctx(raid_ch);
+	size_t stats_size = raid_bdev->num_base_bdevs * sizeof(raid1_ch->base_stats[0]);
+	struct spdk_bdev_io bdev_io = {};
+	struct raid_bdev_io *raid_io;
+	uint8_t idx, seq_idx;
+	uint8_t i;
+	int n;
+
+	raid_bdev->read_policy = RAID_READ_POLICY_LATENCY;
+
+	/* reads should avoid the slow base bdev until the queue depth of the others outweighs it */
+	memset(raid1_ch->base_stats, 0, stats_size);
+	for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
+		raid1_ch->base_stats[i].latency_ewma_ticks = (i == 0) ? 1000 : 10;
+	}
+	for (n = 0; n < 50; n++) {
+		idx = submit_read_at(raid_bdev, raid_ch, n * 1000, 8);
+		CU_ASSERT(idx != 0);
+	}
+	for (i = 1; i < raid_bdev->num_base_bdevs; i++) {
+		CU_ASSERT(raid1_ch->base_stats[i].reads_outstanding > 0);
+	}
+
+	/* completion latency is folded into the moving average */
+	memset(raid1_ch->base_stats, 0, stats_size);
+	raid_io = get_raid_io(r1_info, raid_ch, SPDK_BDEV_IO_TYPE_READ, 8);
+	raid1_submit_read_request(raid_io);
+	idx = raid_io->base_bdev_io_submitted;
+	CU_ASSERT(raid1_ch->base_stats[idx].reads_outstanding == 1);
+	g_submit_tsc = 100;
+	MOCK_SET(spdk_get_ticks, 180);
+	raid1_read_bdev_io_completion(&bdev_io, true, raid_io);
+	CU_ASSERT(raid1_ch->base_stats[idx].reads_outstanding == 0);
+	CU_ASSERT(raid1_ch->base_stats[idx].latency_ewma_ticks == 80);
+	CU_ASSERT(raid1_ch->base_stats[idx].reads_completed == 1);
+	CU_ASSERT(raid1_ch->base_stats[idx].read_blocks_completed == 8);
+
+	for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
+		raid1_ch->base_stats[i].latency_ewma_ticks = 80;
+	}
+	raid_io = get_raid_io(r1_info, raid_ch, SPDK_BDEV_IO_TYPE_READ, 8);
+	raid_io->offset_blocks = 1000;
+	raid1_submit_read_request(raid_io);
+	idx = raid_io->base_bdev_io_submitted;
+	MOCK_SET(spdk_get_ticks, g_submit_tsc + 80 + (8 << RAID1_LATENCY_EWMA_SHIFT));
+	raid1_read_bdev_io_completion(&bdev_io, true, raid_io);
+	CU_ASSERT(raid1_ch->base_stats[idx].latency_ewma_ticks == 80 + 8);
+	MOCK_CLEAR(spdk_get_ticks);
+
+	/* a sequential stream stays on its base bdev while it is not much slower than the others */
+	memset(raid1_ch->base_stats, 0, stats_size);
+	for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
+		raid1_ch->base_stats[i].latency_ewma_ticks = 10;
+	}
+	seq_idx = submit_read_at(raid_bdev, raid_ch, 4096, 8);
+	CU_ASSERT(submit_read_at(raid_bdev, raid_ch, 4104, 8) == seq_idx);
+	CU_ASSERT(submit_read_at(raid_bdev, raid_ch, 12345, 8) != seq_idx);
+	raid1_ch->base_stats[seq_idx].latency_ewma_ticks = 1000;
+	CU_ASSERT(submit_read_at(raid_bdev, raid_ch, 4112, 8) != seq_idx);
+
+	/* the probe read goes to the next base bdev regardless of its latency */
+	memset(raid1_ch->base_stats, 0, stats_size);
+	raid1_ch->base_stats[0].latency_ewma_ticks = 1000000;
+	raid1_ch->reads_until_probe = 1;
+	raid1_ch->probe_idx = 0;
+	CU_ASSERT(submit_read_at(raid_bdev, raid_ch, 777, 8) == 0);
+	CU_ASSERT(raid1_ch->reads_until_probe == RAID1_LATENCY_PROBE_INTERVAL);
+	CU_ASSERT(submit_read_at(raid_bdev, raid_ch, 999, 8) != 0);
+
+	/* missing base bdevs are skipped */
+	memset(raid1_ch->base_stats, 0, stats_size);
+	raid_ch->_base_channels[1] = NULL;
+	for (n = 0; n < 10; n++) {
+		CU_ASSERT(submit_read_at(raid_bdev, raid_ch, n * 1000, 8) != 1);
+	}
+}
+
+static void
+test_raid1_read_balancing_latency(void)
+{
+	run_for_each_raid1_config(_test_raid1_read_balancing_latency);
+}
+
 static void
 _test_raid1_write_error(struct raid_bdev *raid_bdev, struct raid_bdev_io_channel *raid_ch)
 {
@@ -440,7 +551,7 @@ _test_raid1_read_error(struct raid_bdev *raid_bdev, struct raid_bdev_io_channel
 	/* read from base bdev #1 fails, read from #0 succeeds */
 	base_info->is_failed = false;
 	base_info = &raid_bdev->base_bdev_info[1];
-	raid1_ch->read_blocks_outstanding[0] = 123;
+	raid1_ch->base_stats[0].read_blocks_outstanding = 123;
 	g_io_status = SPDK_BDEV_IO_STATUS_PENDING;
 	raid_io = get_raid_io(r1_info, raid_ch, SPDK_BDEV_IO_TYPE_READ, 64);
 	raid1_submit_read_request(raid_io);
@@ -513,6 +624,7 @@ main(int argc, char **argv)
 	suite = CU_add_suite("raid1", test_setup, test_cleanup);
 	CU_ADD_TEST(suite, test_raid1_start);
 	CU_ADD_TEST(suite, test_raid1_read_balancing);
+	CU_ADD_TEST(suite, test_raid1_read_balancing_latency);
 	CU_ADD_TEST(suite, test_raid1_write_error);
 	CU_ADD_TEST(suite, test_raid1_read_error);
 
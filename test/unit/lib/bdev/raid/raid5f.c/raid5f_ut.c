@@ -15,6 +15,7 @@
 
 static void *g_accel_p = (void *)0xdeadbeaf;
 static bool g_test_degraded;
+static struct spdk_raid_bdev_opts g_raid_opts;
 
 DEFINE_STUB_V(raid_bdev_module_list_add, (struct raid_bdev_module *raid_module));
 DEFINE_STUB(spdk_bdev_get_buf_align, size_t, (const struct spdk_bdev *bdev), 0);
@@ -30,6 +31,14 @@ DEFINE_STUB_V(raid_bdev_io_init, (struct raid_bdev_io *raid_io,
 				  struct spdk_memory_domain *memory_domain, void *memory_domain_ctx));
 DEFINE_STUB(raid_bdev_remap_dix_reftag, int, (void *md_buf, uint64_t num_blocks,
 		struct spdk_bdev *bdev, uint32_t remapped_offset), -1);
+DEFINE_STUB(spdk_bdev_queue_io_wait, int, (struct spdk_bdev *bdev, struct spdk_io_channel *ch,
+		struct spdk_bdev_io_wait_entry *entry), 0);
+
+void
+raid_bdev_get_opts(struct spdk_raid_bdev_opts *opts)
+{
+	*opts = g_raid_opts;
+}
 
 struct spdk_io_channel *
 spdk_accel_get_io_channel(void)
@@ -397,6 +406,58 @@ process_io_completions(struct raid_io_info *io_info)
 	}
 }
 
+/* Contents of the base bdevs for the stripe cache tests */
+static void **g_disks;
+
+struct disk_io {
+	struct spdk_bdev_io *bdev_io;
+	spdk_bdev_io_completion_cb cb;
+	void *cb_arg;
+};
+
+static void
+finish_disk_io(void *_disk_io)
+{
+	struct disk_io *disk_io = _disk_io;
+
+	disk_io->cb(disk_io->bdev_io, true, disk_io->cb_arg);
+	free(disk_io);
+}
+
+static int
+stripe_cache_disk_io(struct spdk_bdev_desc *desc, struct iovec *iov, int iovcnt,
+		     uint64_t offset_blocks, uint64_t num_blocks, bool write,
+		     spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	struct raid_base_bdev_info *base_info = desc->bdev->ctxt;
+	struct raid_bdev *raid_bdev = base_info->raid_bdev;
+	struct iovec disk_iov;
+	struct disk_io *disk_io;
+
+	SPDK_CU_ASSERT_FATAL(g_disks != NULL);
+
+	disk_iov.iov_base = g_disks[base_info - raid_bdev->base_bdev_info] +
+			    offset_blocks * raid_bdev->bdev.blocklen;
+	disk_iov.iov_len = num_blocks * raid_bdev->bdev.blocklen;
+
+	if (write) {
+		spdk_iovcpy(iov, iovcnt, &disk_iov, 1);
+	} else {
+		spdk_iovcpy(&disk_iov, 1, iov, iovcnt);
+	}
+
+	disk_io = calloc(1, sizeof(*disk_io));
+	SPDK_CU_ASSERT_FATAL(disk_io != NULL);
+	disk_io->bdev_io = calloc(1, sizeof(*disk_io->bdev_io));
+	SPDK_CU_ASSERT_FATAL(disk_io->bdev_io != NULL);
+	disk_io->cb = cb;
+	disk_io->cb_arg = cb_arg;
+
+	spdk_thread_send_msg(spdk_get_thread(), finish_disk_io, disk_io);
+
+	return 0;
+}
+
 int
 spdk_bdev_writev_blocks_with_md(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
 				struct iovec *iov, int iovcnt, void *md_buf,
@@ -414,6 +475,10 @@ spdk_bdev_writev_blocks_with_md(struct spdk_bdev_desc *desc, struct spdk_io_chan
 	struct iovec dest;
 	void *dest_md_buf;
 
+	if (cb == raid5f_stripe_cache_complete_bdev_io) {
+		return stripe_cache_disk_io(desc, iov, iovcnt, offset_blocks, num_blocks, true, cb, cb_arg);
+	}
+
 	SPDK_CU_ASSERT_FATAL(cb == raid5f_chunk_complete_bdev_io);
 
 	stripe_req = raid5f_chunk_stripe_req(chunk);
@@ -532,6 +597,10 @@ spdk_bdev_readv_blocks_with_md(struct spdk_bdev_desc *desc, struct spdk_io_chann
 			raid_io);
 	struct iovec src;
 
+	if (cb == raid5f_stripe_cache_complete_bdev_io) {
+		return stripe_cache_disk_io(desc, iov, iovcnt, offset_blocks, num_blocks, false, cb, cb_arg);
+	}
+
 	if (cb == raid5f_chunk_complete_bdev_io) {
 		return spdk_bdev_readv_blocks_degraded(desc, ch, iov, iovcnt, md_buf, offset_blocks,
 						       num_blocks, cb, cb_arg);
@@ -1115,6 +1184,279 @@ test_raid5f_submit_read_request_degraded(void)
 	run_for_each_raid5f_config(__test_raid5f_submit_read_request);
 }
 
+static void
+stripe_cache_verify(struct raid5f_info *r5f_info, struct raid_bdev_io_channel *raid_ch,
+		    void *expected)
+{
+	struct raid_bdev *raid_bdev = r5f_info->raid_bdev;
+	size_t strip_len = raid_bdev->strip_size * raid_bdev->bdev.blocklen;
+	uint8_t n_data = raid5f_stripe_data_chunks_num(raid_bdev);
+	uint8_t missing = UINT8_MAX;
+	uint64_t stripe_index;
+	uint8_t p_idx, d, c, i;
+	size_t offset;
+	void *chunk;
+
+	chunk = malloc(strip_len);
+	SPDK_CU_ASSERT_FATAL(chunk != NULL);
+
+	for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
+		if (raid_bdev_channel_get_base_channel(raid_ch, i) == NULL) {
+			missing = i;
+		}
+	}
+
+	for (stripe_index = 0; stripe_index < r5f_info->total_stripes; stripe_index++) {
+		p_idx = raid5f_stripe_parity_chunk_index(raid_bdev, stripe_index);
+		offset = stripe_index * strip_len;
+
+		for (d = 0; d < n_data; d++) {
+			c = d < p_idx ? d : d + 1;
+			if (c != missing) {
+				memcpy(chunk, g_disks[c] + offset, strip_len);
+			} else {
+				memcpy(chunk, g_disks[p_idx] + offset, strip_len);
+				for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
+					if (i != c && i != p_idx) {
+						xor_block(chunk, g_disks[i] + offset, strip_len);
+					}
+				}
+			}
+			CU_ASSERT(memcmp(chunk, expected + (stripe_index * n_data + d) * strip_len, strip_len) == 0);
+		}
+
+		if (missing == UINT8_MAX) {
+			memcpy(chunk, g_disks[p_idx] + offset, strip_len);
+			for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
+				if (i != p_idx) {
+					xor_block(chunk, g_disks[i] + offset, strip_len);
+				}
+			}
+			CU_ASSERT(spdk_mem_all_zero(chunk, strip_len));
+		}
+	}
+
+	free(chunk);
+}
+
+static void
+stripe_cache_submit_write(struct raid_io_info *io_info, struct raid5f_info *r5f_info,
+			  struct raid_bdev_io_channel *raid_ch, void *expected,
+			  uint64_t stripe_index, uint64_t stripe_offset, uint64_t num_blocks)
+{
+	uint32_t blocklen = r5f_info->raid_bdev->bdev.blocklen;
+	size_t i;
+
+	init_io_info(io_info, r5f_info, raid_ch, SPDK_BDEV_IO_TYPE_WRITE, stripe_index,
+		     stripe_offset, num_blocks);
+
+	for (i = 0; i < io_info->buf_size; i++) {
+		((uint8_t *)io_info->src_buf)[i] = rand();
+	}
+	memcpy(expected + io_info->offset_blocks * blocklen, io_info->src_buf, io_info->buf_size);
+
+	raid5f_submit_rw_request(get_raid_io(io_info));
+}
+
+static void
+stripe_cache_init_disks(struct raid5f_info *r5f_info, void *expected)
+{
+	struct raid_bdev *raid_bdev = r5f_info->raid_bdev;
+	size_t strip_len = raid_bdev->strip_size * raid_bdev->bdev.blocklen;
+	size_t disk_len = r5f_info->total_stripes * strip_len;
+	uint8_t n_data = raid5f_stripe_data_chunks_num(raid_bdev);
+	uint64_t stripe_index;
+	uint8_t p_idx, d, c;
+	size_t i;
+
+	for (c = 0; c < raid_bdev->num_base_bdevs; c++) {
+		for (i = 0; i < disk_len; i++) {
+			((uint8_t *)g_disks[c])[i] = rand();
+		}
+	}
+
+	for (stripe_index = 0; stripe_index < r5f_info->total_stripes; stripe_index++) {
+		p_idx = raid5f_stripe_parity_chunk_index(raid_bdev, stripe_index);
+		memset(g_disks[p_idx] + stripe_index * strip_len, 0, strip_len);
+
+		for (d = 0; d < n_data; d++) {
+			c = d < p_idx ? d : d + 1;
+			xor_block(g_disks[p_idx] + stripe_index * strip_len, g_disks[c] + stripe_index * strip_len,
+				  strip_len);
+			memcpy(expected + (stripe_index * n_data + d) * strip_len,
+			       g_disks[c] + stripe_index * strip_len, strip_len);
+		}
+	}
+}
+
+/* Recover the contents of a base bdev that was missing from the rest of the array */
+static void
+stripe_cache_rebuild_disk(struct raid5f_info *r5f_info, uint8_t idx)
+{
+	struct raid_bdev *raid_bdev = r5f_info->raid_bdev;
+	size_t disk_len = r5f_info->total_stripes * raid_bdev->strip_size * raid_bdev->bdev.blocklen;
+	uint8_t i;
+
+	memset(g_disks[idx], 0, disk_len);
+	for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
+		if (i != idx) {
+			xor_block(g_disks[idx], g_disks[i], disk_len);
+		}
+	}
+}
+
+static void
+stripe_cache_test_partial_write(struct raid5f_info *r5f_info, struct raid_bdev_io_channel *raid_ch,
+				void *expected, uint64_t stripe_index, uint64_t stripe_offset,
+				uint64_t num_blocks)
+{
+	struct raid_io_info io_info;
+
+	stripe_cache_submit_write(&io_info, r5f_info, raid_ch, expected, stripe_index, stripe_offset,
+				  num_blocks);
+	poll_threads();
+
+	/* Partial writes wait for the rest of the stripe until the window expires */
+	CU_ASSERT(io_info.status == SPDK_BDEV_IO_STATUS_PENDING);
+
+	spdk_delay_us(g_raid_opts.raid5f_stripe_cache_window_us);
+	poll_threads();
+
+	CU_ASSERT(io_info.status == SPDK_BDEV_IO_STATUS_SUCCESS);
+	stripe_cache_verify(r5f_info, raid_ch, expected);
+
+	deinit_io_info(&io_info);
+}
+
+static void
+__test_raid5f_stripe_cache(struct raid_bdev *raid_bdev, struct raid_bdev_io_channel *_raid_ch)
+{
+	struct raid5f_info *r5f_info = raid_bdev->module_private;
+	uint8_t n_data = raid5f_stripe_data_chunks_num(raid_bdev);
+	uint32_t strip_size = raid_bdev->strip_size;
+	size_t strip_len = strip_size * raid_bdev->bdev.blocklen;
+	size_t disk_len = r5f_info->total_stripes * strip_len;
+	struct raid_bdev_io_channel *raid_ch, *raid_ch2;
+	struct raid_io_info *io_infos;
+	uint64_t last_stripe = r5f_info->total_stripes - 1;
+	uint8_t missing;
+	void *expected;
+	uint8_t i;
+
+	if (r5f_info->stripe_cache_size == 0) {
+		/* Not supported with separate metadata */
+		CU_ASSERT(raid_bdev->bdev.md_len != 0 && !raid_bdev->bdev.md_interleave);
+		CU_ASSERT(raid_bdev->bdev.split_on_write_unit);
+		return;
+	}
+
+	CU_ASSERT(!raid_bdev->bdev.split_on_write_unit);
+
+	if (r5f_info->total_stripes > 1024) {
+		return;
+	}
+
+	g_disks = calloc(raid_bdev->num_base_bdevs, sizeof(*g_disks));
+	SPDK_CU_ASSERT_FATAL(g_disks != NULL);
+	for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
+		g_disks[i] = malloc(disk_len);
+		SPDK_CU_ASSERT_FATAL(g_disks[i] != NULL);
+	}
+
+	expected = malloc(disk_len * n_data);
+	SPDK_CU_ASSERT_FATAL(expected != NULL);
+
+	io_infos = calloc(n_data, sizeof(*io_infos));
+	SPDK_CU_ASSERT_FATAL(io_infos != NULL);
+
+	stripe_cache_init_disks(r5f_info, expected);
+
+	/* missing == num_base_bdevs means not degraded */
+	for (missing = 0; missing <= raid_bdev->num_base_bdevs; missing++) {
+		raid_ch = raid_test_create_io_channel(raid_bdev);
+		if (missing < raid_bdev->num_base_bdevs) {
+			raid_ch->_base_channels[missing] = NULL;
+		}
+
+		/* A single block, the stripe has to be read */
+		stripe_cache_test_partial_write(r5f_info, raid_ch, expected, 0, strip_size / 2, 1);
+
+		/* Another chunk of the same stripe, its contents are now cached */
+		if (n_data > 1) {
+			stripe_cache_test_partial_write(r5f_info, raid_ch, expected, 0, strip_size, strip_size);
+		}
+
+		/* Across a chunk boundary */
+		if (r5f_info->stripe_blocks > 2) {
+			stripe_cache_test_partial_write(r5f_info, raid_ch, expected, last_stripe, strip_size - 1, 2);
+		}
+
+		/* Strip-sized writes completing a stripe are written without waiting */
+		if (r5f_info->total_stripes > 1) {
+			for (i = 0; i < n_data; i++) {
+				stripe_cache_submit_write(&io_infos[i], r5f_info, raid_ch, expected, 1,
+							  i * strip_size, strip_size);
+			}
+			poll_threads();
+
+			for (i = 0; i < n_data; i++) {
+				CU_ASSERT(io_infos[i].status == SPDK_BDEV_IO_STATUS_SUCCESS);
+				deinit_io_info(&io_infos[i]);
+			}
+			stripe_cache_verify(r5f_info, raid_ch, expected);
+		}
+
+		if (missing < raid_bdev->num_base_bdevs) {
+			stripe_cache_rebuild_disk(r5f_info, missing);
+		}
+
+		raid_test_destroy_io_channel(raid_ch);
+	}
+
+	/* Updates of the same stripe through two channels */
+	raid_ch = raid_test_create_io_channel(raid_bdev);
+	raid_ch2 = raid_test_create_io_channel(raid_bdev);
+
+	stripe_cache_test_partial_write(r5f_info, raid_ch, expected, 0, 0, 1);
+
+	stripe_cache_submit_write(&io_infos[0], r5f_info, raid_ch, expected, 0, 0, 1);
+	stripe_cache_submit_write(&io_infos[1 % n_data], r5f_info, raid_ch2, expected, 0,
+				  (n_data - 1) * strip_size + strip_size - 1, 1);
+	poll_threads();
+	spdk_delay_us(g_raid_opts.raid5f_stripe_cache_window_us);
+	poll_threads();
+	CU_ASSERT(io_infos[0].status == SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(io_infos[1 % n_data].status == SPDK_BDEV_IO_STATUS_SUCCESS);
+	deinit_io_info(&io_infos[0]);
+	if (n_data > 1) {
+		deinit_io_info(&io_infos[1]);
+	}
+	stripe_cache_verify(r5f_info, raid_ch, expected);
+
+	/* The stripe contents cached after both updates are used for the next write */
+	stripe_cache_test_partial_write(r5f_info, raid_ch, expected, 0, 1 % strip_size, 1);
+
+	raid_test_destroy_io_channel(raid_ch2);
+	raid_test_destroy_io_channel(raid_ch);
+
+	for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
+		free(g_disks[i]);
+	}
+	free(g_disks);
+	g_disks = NULL;
+	free(expected);
+	free(io_infos);
+}
+
+static void
+test_raid5f_stripe_cache(void)
+{
+	g_raid_opts.raid5f_stripe_cache_size = 4;
+	g_raid_opts.raid5f_stripe_cache_window_us = 100;
+	run_for_each_raid5f_config(__test_raid5f_stripe_cache);
+	memset(&g_raid_opts, 0, sizeof(g_raid_opts));
+}
+
 int
 main(int argc, char **argv)
 {
@@ -1133,6 +1475,7 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_raid5f_chunk_write_error_with_enomem);
 	CU_ADD_TEST(suite, test_raid5f_submit_full_stripe_write_request_degraded);
 	CU_ADD_TEST(suite, test_raid5f_submit_read_request_degraded);
+	CU_ADD_TEST(suite, test_raid5f_stripe_cache);
 
 	allocate_threads(1);
 	set_thread(0);
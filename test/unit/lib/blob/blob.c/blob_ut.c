@@ -4468,7 +4468,7 @@ blob_insert_cluster_msg_test(void)
 	 * This is to simulate behaviour when cluster is allocated after blob creation.
 	 * Such as _spdk_bs_allocate_and_copy_cluster(). */
 	spdk_spin_lock(&bs->used_lock);
-	bs_allocate_cluster(blob, cluster_num, &new_cluster, &extent_page, false);
+	bs_allocate_cluster(blob, NULL, cluster_num, &new_cluster, &extent_page, false);
 	CU_ASSERT(blob->active.clusters[cluster_num] == 0);
 	spdk_spin_unlock(&bs->used_lock);
 
@@ -4495,6 +4495,83 @@ blob_insert_cluster_msg_test(void)
 	ut_blob_close_and_delete(bs, blob);
 }
 
+static void
+blob_insert_cluster_batch_test(void)
+{
+	struct spdk_blob_store *bs = g_bs;
+	struct spdk_blob *blob;
+	struct spdk_blob_opts opts;
+	struct {
+		struct spdk_blob_md_page page;
+		uint8_t pad[DEV_MAX_PHYS_BLOCKLEN - sizeof(struct spdk_blob_md_page)];
+	} md[4] = {};
+	spdk_blob_id blobid;
+	uint64_t new_cluster[4] = {};
+	uint32_t extent_page[4] = {};
+	uint64_t write_bytes;
+	uint32_t i;
+
+	ut_spdk_blob_opts_init(&opts);
+	opts.thin_provision = true;
+	opts.num_clusters = 4;
+
+	blob = ut_blob_create_and_open(bs, &opts);
+	blobid = spdk_blob_get_id(blob);
+
+	/* The first insert allocates the extent page the other clusters go to. */
+	spdk_spin_lock(&bs->used_lock);
+	bs_allocate_cluster(blob, NULL, 0, &new_cluster[0], &extent_page[0], false);
+	spdk_spin_unlock(&bs->used_lock);
+	blob_insert_cluster_on_md_thread(blob, 0, new_cluster[0], extent_page[0], &md[0].page,
+					 blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+
+	spdk_spin_lock(&bs->used_lock);
+	for (i = 1; i < 4; i++) {
+		bs_allocate_cluster(blob, NULL, i, &new_cluster[i], &extent_page[i], false);
+		CU_ASSERT(extent_page[i] == 0);
+	}
+	spdk_spin_unlock(&bs->used_lock);
+
+	/* Insert the remaining clusters at once.  The write of the extent page is deferred until
+	 * the md thread processed all of them, so a single write covers them.
+	 */
+	write_bytes = g_dev_write_bytes;
+	for (i = 1; i < 4; i++) {
+		blob_insert_cluster_on_md_thread(blob, i, new_cluster[i], extent_page[i], &md[i].page,
+						 blob_op_complete, NULL);
+	}
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(TAILQ_EMPTY(&blob->ep_writes_in_progress));
+	CU_ASSERT(TAILQ_EMPTY(&blob->pending_ep_writes));
+	for (i = 0; i < 4; i++) {
+		CU_ASSERT(blob->active.clusters[i] == bs_cluster_to_lba(bs, new_cluster[i]));
+	}
+	if (g_use_extent_table) {
+		CU_ASSERT(g_dev_write_bytes - write_bytes == spdk_bs_get_page_size(bs));
+	}
+
+	spdk_blob_close(blob, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+
+	ut_bs_reload(&bs, NULL);
+
+	spdk_bs_open_blob(bs, blobid, blob_op_with_handle_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_blob != NULL);
+	blob = g_blob;
+
+	for (i = 0; i < 4; i++) {
+		CU_ASSERT(blob->active.clusters[i] == bs_cluster_to_lba(bs, new_cluster[i]));
+	}
+
+	ut_blob_close_and_delete(bs, blob);
+}
+
 static void
 blob_thin_prov_rw(void)
 {
@@ -4755,6 +4832,220 @@ blob_thin_prov_write_count_io(void)
 	g_bs = NULL;
 }
 
+static void
+blob_thin_prov_reserved_clusters(void)
+{
+	struct spdk_blob_store *bs;
+	struct spdk_blob *blob;
+	struct spdk_io_channel *ch;
+	struct spdk_bs_channel *bs_ch;
+	struct spdk_bs_dev *dev;
+	struct spdk_bs_opts bs_opts;
+	struct spdk_blob_opts opts;
+	spdk_blob_id blobid;
+	uint64_t free_clusters;
+	uint64_t io_units_per_cluster;
+	uint8_t payload_write[BLOCKLEN];
+
+	/* Use a small cluster size, so that there are enough free clusters for channels to
+	 * reserve some.
+	 */
+	dev = init_dev();
+	spdk_bs_opts_init(&bs_opts, sizeof(bs_opts));
+	bs_opts.cluster_sz = g_phys_blocklen * 2;
+	bs_opts.num_md_pages = 128;
+
+	spdk_bs_init(dev, &bs_opts, bs_op_with_handle_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_bs != NULL);
+	bs = g_bs;
+
+	free_clusters = spdk_bs_free_cluster_count(bs);
+	SPDK_CU_ASSERT_FATAL(free_clusters >= 64 * SPDK_BS_CHANNEL_RESERVED_CLUSTERS);
+	io_units_per_cluster = bs_opts.cluster_sz / spdk_bs_get_io_unit_size(bs);
+
+	ut_spdk_blob_opts_init(&opts);
+	opts.thin_provision = true;
+	opts.num_clusters = 4;
+
+	blob = ut_blob_create_and_open(bs, &opts);
+	blobid = spdk_blob_get_id(blob);
+
+	/* Use a channel on another thread than the md thread, so that it can be freed. */
+	set_thread(1);
+	ch = spdk_bs_alloc_io_channel(bs);
+	SPDK_CU_ASSERT_FATAL(ch != NULL);
+	bs_ch = spdk_io_channel_get_ctx(ch);
+	CU_ASSERT(bs_ch->num_reserved_clusters == 0);
+
+	/* The first allocation reserves clusters for the channel.  Reserved clusters still
+	 * count as free.
+	 */
+	memset(payload_write, 0xE5, sizeof(payload_write));
+	spdk_blob_io_write(blob, ch, payload_write, 0, 1, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(bs_ch->num_reserved_clusters == SPDK_BS_CHANNEL_RESERVED_CLUSTERS - 1);
+	CU_ASSERT(bs->num_free_clusters == free_clusters - SPDK_BS_CHANNEL_RESERVED_CLUSTERS);
+	CU_ASSERT(spdk_bs_free_cluster_count(bs) == free_clusters - 1);
+
+	/* The next one takes the next reserved cluster. */
+	spdk_blob_io_write(blob, ch, payload_write, io_units_per_cluster, 1, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(bs_ch->num_reserved_clusters == SPDK_BS_CHANNEL_RESERVED_CLUSTERS - 2);
+	CU_ASSERT(spdk_bs_free_cluster_count(bs) == free_clusters - 2);
+	CU_ASSERT(blob->active.clusters[1] == blob->active.clusters[0] + bs_cluster_to_lba(bs, 1));
+
+	/* Freeing the channel returns the rest of its reservation. */
+	spdk_bs_free_io_channel(ch);
+	poll_threads();
+	CU_ASSERT(bs->num_free_clusters == free_clusters - 2);
+	CU_ASSERT(bs->num_reserved_clusters == 0);
+
+	ch = spdk_bs_alloc_io_channel(bs);
+	SPDK_CU_ASSERT_FATAL(ch != NULL);
+	bs_ch = spdk_io_channel_get_ctx(ch);
+
+	spdk_blob_io_write(blob, ch, payload_write, 2 * io_units_per_cluster, 1, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(bs_ch->num_reserved_clusters == SPDK_BS_CHANNEL_RESERVED_CLUSTERS - 1);
+
+	set_thread(0);
+	spdk_blob_close(blob, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+
+	/* Unloading returns the reservations of channels that are still allocated, so that
+	 * they aren't marked used on disk.
+	 */
+	spdk_bs_unload(bs, bs_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(bs_ch->num_reserved_clusters == 0);
+	set_thread(1);
+	spdk_bs_free_io_channel(ch);
+	poll_threads();
+	set_thread(0);
+	g_bs = NULL;
+
+	dev = init_dev();
+	spdk_bs_load(dev, &bs_opts, bs_op_with_handle_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_bs != NULL);
+	bs = g_bs;
+	CU_ASSERT(spdk_bs_free_cluster_count(bs) == free_clusters - 3);
+
+	spdk_bs_delete_blob(bs, blobid, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(spdk_bs_free_cluster_count(bs) == free_clusters);
+
+	spdk_bs_unload(bs, bs_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	g_bs = NULL;
+}
+
+static void
+blob_thick_prov_reserved_clusters(void)
+{
+	struct spdk_blob_store *bs;
+	struct spdk_blob *thin_blob, *thick_blob;
+	struct spdk_io_channel *ch;
+	struct spdk_bs_channel *bs_ch;
+	struct spdk_bs_dev *dev;
+	struct spdk_bs_opts bs_opts;
+	struct spdk_blob_opts opts;
+	uint64_t free_clusters;
+	uint8_t payload_write[BLOCKLEN];
+
+	dev = init_dev();
+	spdk_bs_opts_init(&bs_opts, sizeof(bs_opts));
+	bs_opts.cluster_sz = g_phys_blocklen * 2;
+	bs_opts.num_md_pages = 128;
+
+	spdk_bs_init(dev, &bs_opts, bs_op_with_handle_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_bs != NULL);
+	bs = g_bs;
+
+	ut_spdk_blob_opts_init(&opts);
+	opts.thin_provision = true;
+	opts.num_clusters = 4;
+	thin_blob = ut_blob_create_and_open(bs, &opts);
+
+	set_thread(1);
+	ch = spdk_bs_alloc_io_channel(bs);
+	SPDK_CU_ASSERT_FATAL(ch != NULL);
+	bs_ch = spdk_io_channel_get_ctx(ch);
+
+	memset(payload_write, 0xE5, sizeof(payload_write));
+	spdk_blob_io_write(thin_blob, ch, payload_write, 0, 1, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(bs_ch->num_reserved_clusters == SPDK_BS_CHANNEL_RESERVED_CLUSTERS - 1);
+	set_thread(0);
+
+	/* A thick blob can use all the free clusters, including the ones reserved by channels. */
+	free_clusters = spdk_bs_free_cluster_count(bs);
+	ut_spdk_blob_opts_init(&opts);
+	opts.num_clusters = free_clusters;
+	thick_blob = ut_blob_create_and_open(bs, &opts);
+	CU_ASSERT(spdk_blob_get_num_clusters(thick_blob) == free_clusters);
+	CU_ASSERT(bs_ch->num_reserved_clusters == 0);
+	CU_ASSERT(spdk_bs_free_cluster_count(bs) == 0);
+
+	ut_blob_close_and_delete(bs, thick_blob);
+	CU_ASSERT(spdk_bs_free_cluster_count(bs) == free_clusters);
+
+	/* The same goes for resizing a thick blob. */
+	set_thread(1);
+	spdk_blob_io_write(thin_blob, ch, payload_write,
+			   bs_opts.cluster_sz / spdk_bs_get_io_unit_size(bs), 1,
+			   blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(bs_ch->num_reserved_clusters == SPDK_BS_CHANNEL_RESERVED_CLUSTERS - 1);
+	set_thread(0);
+
+	free_clusters = spdk_bs_free_cluster_count(bs);
+	ut_spdk_blob_opts_init(&opts);
+	opts.num_clusters = 1;
+	thick_blob = ut_blob_create_and_open(bs, &opts);
+	CU_ASSERT(bs_ch->num_reserved_clusters == SPDK_BS_CHANNEL_RESERVED_CLUSTERS - 1);
+
+	spdk_blob_resize(thick_blob, free_clusters, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(spdk_blob_get_num_clusters(thick_blob) == free_clusters);
+	CU_ASSERT(bs_ch->num_reserved_clusters == 0);
+	CU_ASSERT(spdk_bs_free_cluster_count(bs) == 0);
+
+	/* Without reservations to take back, running out of space still fails. */
+	spdk_blob_resize(thick_blob, free_clusters + 1, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == -ENOSPC);
+	CU_ASSERT(spdk_blob_get_num_clusters(thick_blob) == free_clusters);
+
+	ut_blob_close_and_delete(bs, thick_blob);
+	ut_blob_close_and_delete(bs, thin_blob);
+
+	set_thread(1);
+	spdk_bs_free_io_channel(ch);
+	poll_threads();
+	set_thread(0);
+
+	spdk_bs_unload(bs, bs_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	g_bs = NULL;
+}
+
 static void
 blob_thin_prov_unmap_cluster(void)
 {
@@ -10238,8 +10529,11 @@ main(int argc, char **argv)
 		CU_ADD_TEST(suite_bs, blob_set_xattrs_test);
 		CU_ADD_TEST(suite_bs, blob_thin_prov_alloc);
 		CU_ADD_TEST(suite_bs, blob_insert_cluster_msg_test);
+		CU_ADD_TEST(suite_bs, blob_insert_cluster_batch_test);
 		CU_ADD_TEST(suite_bs, blob_thin_prov_rw);
 		CU_ADD_TEST(suite, blob_thin_prov_write_count_io);
+		CU_ADD_TEST(suite, blob_thin_prov_reserved_clusters);
+		CU_ADD_TEST(suite, blob_thick_prov_reserved_clusters);
 		CU_ADD_TEST(suite, blob_thin_prov_unmap_cluster);
 		CU_ADD_TEST(suite_bs, blob_thin_prov_rle);
 		CU_ADD_TEST(suite_bs, blob_thin_prov_rw_iov);
@@ -385,6 +385,183 @@ test_next_xfer_addr(void)
 	cleanup_band();
 }
 
+#define TEST_GC_NUM_GROUPS	((TEST_BAND_IDX + 1) / 2)
+
+static void
+gc_index_set_band(struct ftl_band *band, uint64_t num_valid, uint64_t close_seq_id)
+{
+	band->p2l_map.num_valid = num_valid;
+	band->md->close_seq_id = close_seq_id;
+}
+
+static void
+gc_index_invalidate(struct ftl_band *band, uint64_t num_blocks)
+{
+	while (num_blocks--) {
+		band->p2l_map.num_valid--;
+		ftl_band_gc_index_dec_valid(band);
+	}
+}
+
+static void
+test_gc_index(void)
+{
+	struct ftl_band *band;
+	uint64_t i, user_blocks;
+	int rc;
+
+	g_dev = test_init_ftl_dev(&g_geo);
+	g_dev->sb = calloc(1, sizeof(*g_dev->sb));
+	g_dev->sb_shm = calloc(1, sizeof(*g_dev->sb_shm));
+	SPDK_CU_ASSERT_FATAL(g_dev->sb != NULL && g_dev->sb_shm != NULL);
+	g_dev->num_logical_bands_in_physical = 2;
+	g_dev->sb->seq_id = 1000;
+
+	for (i = 0; i < TEST_GC_NUM_GROUPS * 2; i++) {
+		band = test_init_ftl_band(g_dev, i, ftl_get_num_blocks_in_band(g_dev));
+		band->phys_id = i / 2;
+	}
+	user_blocks = ftl_band_user_blocks(&g_dev->bands[0]);
+	g_dev->num_bands = TEST_GC_NUM_GROUPS * 2;
+
+	rc = ftl_band_gc_index_init(g_dev, TEST_GC_NUM_GROUPS);
+	CU_ASSERT_EQUAL_FATAL(rc, 0);
+	ftl_band_reset_gc_iter(g_dev);
+
+	/* Fully valid bands have nothing to reclaim */
+	for (i = 0; i < g_dev->num_bands; i++) {
+		gc_index_set_band(&g_dev->bands[i], user_blocks, 900);
+	}
+	CU_ASSERT_PTR_NULL(ftl_band_search_next_to_reloc(g_dev));
+	CU_ASSERT_TRUE(g_dev->gc_index.valid);
+	for (i = 0; i < FTL_GC_NUM_BUCKETS; i++) {
+		CU_ASSERT_TRUE(TAILQ_EMPTY(&g_dev->gc_index.buckets[i]));
+	}
+
+	/* Group 3 is 25% invalid and young, group 5 is ~17% invalid and old, group 7 is 12.5%
+	 * invalid and half old.
+	 */
+	gc_index_invalidate(&g_dev->bands[6], user_blocks / 2);
+	for (i = 10; i < 12; i++) {
+		band = &g_dev->bands[i];
+		band_gc_index_remove(band);
+		band->md->close_seq_id = 100;
+		band_gc_index_add(band);
+		gc_index_invalidate(band, user_blocks / 6);
+	}
+	band = &g_dev->bands[14];
+	band_gc_index_remove(band);
+	band->md->close_seq_id = 100;
+	band_gc_index_add(band);
+	gc_index_invalidate(band, user_blocks / 4);
+
+	CU_ASSERT_EQUAL(g_dev->gc_index.groups[3].bucket, 2);
+	CU_ASSERT_EQUAL(g_dev->gc_index.groups[5].bucket, 1);
+	CU_ASSERT_EQUAL(g_dev->gc_index.groups[7].bucket, 1);
+	CU_ASSERT_EQUAL(g_dev->gc_index.groups[0].bucket, FTL_GC_NUM_BUCKETS);
+	CU_ASSERT_EQUAL(g_dev->gc_index.groups[5].num_valid, 2 * (user_blocks - user_blocks / 6));
+
+	/* A rebuild from the band state yields the same index */
+	gc_index_rebuild(g_dev);
+	CU_ASSERT_EQUAL(g_dev->gc_index.groups[3].bucket, 2);
+	CU_ASSERT_EQUAL(g_dev->gc_index.groups[5].bucket, 1);
+	CU_ASSERT_EQUAL(g_dev->gc_index.groups[5].num_bands, 2);
+	CU_ASSERT_EQUAL(g_dev->gc_index.groups[5].close_seq_id_sum, 200);
+
+	/* Greedy goes for the most invalid group, cost-benefit prefers the old data */
+	CU_ASSERT_EQUAL(gc_select_greedy(g_dev), 3);
+	CU_ASSERT_EQUAL(gc_select_cost_benefit(g_dev), 5);
+
+	g_dev->conf.gc_policy = SPDK_FTL_GC_POLICY_COST_BENEFIT;
+	band = ftl_band_search_next_to_reloc(g_dev);
+	CU_ASSERT_PTR_EQUAL(band, &g_dev->bands[10]);
+	CU_ASSERT_TRUE(band->reloc);
+	CU_ASSERT_FALSE(band->gc_indexed);
+	CU_ASSERT_EQUAL(g_dev->gc_index.groups[5].num_bands, 1);
+
+	/* The rest of the group is relocated before another group is picked */
+	band = ftl_band_search_next_to_reloc(g_dev);
+	CU_ASSERT_PTR_EQUAL(band, &g_dev->bands[11]);
+	CU_ASSERT_EQUAL(g_dev->gc_index.groups[5].num_bands, 0);
+	CU_ASSERT_EQUAL(g_dev->gc_index.groups[5].bucket, FTL_GC_NUM_BUCKETS);
+
+	g_dev->conf.gc_policy = SPDK_FTL_GC_POLICY_GREEDY;
+	band = ftl_band_search_next_to_reloc(g_dev);
+	CU_ASSERT_PTR_EQUAL(band, &g_dev->bands[6]);
+
+	ftl_band_gc_index_deinit(g_dev);
+	for (i = 0; i < TEST_GC_NUM_GROUPS * 2; i++) {
+		test_free_ftl_band(&g_dev->bands[i]);
+	}
+	free(g_dev->sb);
+	free(g_dev->sb_shm);
+	test_free_ftl_dev(g_dev);
+}
+
+static void
+test_gc_index_close_before_search(void)
+{
+	struct ftl_band *band;
+	uint64_t i, user_blocks;
+	int rc;
+
+	g_dev = test_init_ftl_dev(&g_geo);
+	g_dev->sb = calloc(1, sizeof(*g_dev->sb));
+	g_dev->sb_shm = calloc(1, sizeof(*g_dev->sb_shm));
+	SPDK_CU_ASSERT_FATAL(g_dev->sb != NULL && g_dev->sb_shm != NULL);
+	g_dev->num_logical_bands_in_physical = 2;
+	g_dev->sb->seq_id = 1000;
+
+	for (i = 0; i < 4; i++) {
+		band = test_init_ftl_band(g_dev, i, ftl_get_num_blocks_in_band(g_dev));
+		band->phys_id = i / 2;
+	}
+	user_blocks = ftl_band_user_blocks(&g_dev->bands[0]);
+	g_dev->num_bands = 4;
+
+	rc = ftl_band_gc_index_init(g_dev, 2);
+	CU_ASSERT_EQUAL_FATAL(rc, 0);
+	ftl_band_reset_gc_iter(g_dev);
+	CU_ASSERT_FALSE(g_dev->gc_index.valid);
+	for (i = 0; i < g_dev->num_bands; i++) {
+		gc_index_set_band(&g_dev->bands[i], user_blocks, 900);
+	}
+
+	/* Close bands before anything searched the index, one of them ends up in bucket 0 */
+	for (i = 1; i < 3; i++) {
+		band = &g_dev->bands[i];
+		TAILQ_REMOVE(&g_dev->shut_bands, band, queue_entry);
+		band->md->state = FTL_BAND_STATE_OPEN;
+		rc = ftl_band_alloc_p2l_map(band);
+		CU_ASSERT_EQUAL_FATAL(rc, 0);
+		band->p2l_map.num_valid = i == 1 ? user_blocks / 2 : user_blocks - 1;
+		_ftl_band_set_closed_cb(band, true);
+		CU_ASSERT_TRUE(band->gc_indexed);
+	}
+
+	CU_ASSERT_NOT_EQUAL(g_dev->gc_index.groups[0].bucket, FTL_GC_NUM_BUCKETS);
+	CU_ASSERT_PTR_EQUAL(TAILQ_FIRST(&g_dev->gc_index.buckets[g_dev->gc_index.groups[0].bucket]),
+			    &g_dev->gc_index.groups[0]);
+	CU_ASSERT_EQUAL(g_dev->gc_index.groups[1].bucket, 0);
+	CU_ASSERT_PTR_EQUAL(TAILQ_FIRST(&g_dev->gc_index.buckets[0]), &g_dev->gc_index.groups[1]);
+
+	/* Requeues before the first search work as well */
+	gc_index_invalidate(&g_dev->bands[2], 1);
+	CU_ASSERT_EQUAL(g_dev->gc_index.groups[1].num_valid, user_blocks - 2);
+
+	band = ftl_band_search_next_to_reloc(g_dev);
+	CU_ASSERT_TRUE(g_dev->gc_index.valid);
+	CU_ASSERT_PTR_EQUAL(band, &g_dev->bands[0]);
+
+	ftl_band_gc_index_deinit(g_dev);
+	for (i = 0; i < 4; i++) {
+		test_free_ftl_band(&g_dev->bands[i]);
+	}
+	free(g_dev->sb);
+	free(g_dev->sb_shm);
+	test_free_ftl_dev(g_dev);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -402,6 +579,8 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_band_set_addr);
 	CU_ADD_TEST(suite, test_invalidate_addr);
 	CU_ADD_TEST(suite, test_next_xfer_addr);
+	CU_ADD_TEST(suite, test_gc_index);
+	CU_ADD_TEST(suite, test_gc_index_close_before_search);
 
 	num_failures = spdk_ut_run_tests(argc, argv, NULL);
 	CU_cleanup_registry();
@@ -195,6 +195,43 @@ test_ftl_bitmap_count_set(void)
 	CU_ASSERT_EQUAL(count_set_bits(g_bitmap), ftl_bitmap_count_set(g_bitmap));
 }
 
+static void
+test_ftl_bitmap_count_set_range(void)
+{
+	size_t i;
+	uint64_t start, end, bit, expected;
+
+	memset(g_buf, 0, BITMAP_SIZE);
+
+	for (i = 0; i < g_test_bits_count; i++) {
+		ftl_bitmap_set(g_bitmap, g_test_bits[i].bit_idx);
+	}
+
+	CU_ASSERT_EQUAL(ftl_bitmap_count_set_range(g_bitmap, 0, BITMAP_CAPACITY - 1), g_test_bits_count);
+
+	for (i = 0; i < g_test_bits_count; i++) {
+		bit = g_test_bits[i].bit_idx;
+
+		CU_ASSERT_EQUAL(ftl_bitmap_count_set_range(g_bitmap, bit, bit), 1);
+		if (bit > 0) {
+			CU_ASSERT_EQUAL(ftl_bitmap_count_set_range(g_bitmap, bit - 1, bit - 1),
+					ftl_bitmap_get(g_bitmap, bit - 1) ? 1 : 0);
+		}
+	}
+
+	/* Ranges starting and ending within and across words */
+	for (start = 0; start < BITMAP_CAPACITY; start += 13) {
+		for (end = start; end < BITMAP_CAPACITY; end += 29) {
+			expected = 0;
+			for (bit = start; bit <= end; bit++) {
+				expected += ftl_bitmap_get(g_bitmap, bit) ? 1 : 0;
+			}
+
+			CU_ASSERT_EQUAL(ftl_bitmap_count_set_range(g_bitmap, start, end), expected);
+		}
+	}
+}
+
 static int
 test_setup(void)
 {
@@ -230,6 +267,7 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_ftl_bitmap_find_first_set);
 	CU_ADD_TEST(suite, test_ftl_bitmap_find_first_clear);
 	CU_ADD_TEST(suite, test_ftl_bitmap_count_set);
+	CU_ADD_TEST(suite, test_ftl_bitmap_count_set_range);
 
 	num_failures = spdk_ut_run_tests(argc, argv, NULL);
 	CU_cleanup_registry();
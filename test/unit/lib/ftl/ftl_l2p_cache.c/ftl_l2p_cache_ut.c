@@ -0,0 +1,487 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2022 Intel Corporation.
+ *   All rights reserved.
+ */
+
+#include "spdk/stdinc.h"
+
+#include "spdk_internal/cunit.h"
+#include "common/lib/test_env.c"
+
+#include "ftl/ftl_l2p_cache.c"
+#include "ftl/utils/ftl_bitmap.c"
+
+#define TEST_NUM_PAGES		64
+#define TEST_RESIDENT_PAGES	8
+#define TEST_LBAS_IN_PAGE	1024
+
+static struct spdk_ftl_dev g_dev;
+static struct ftl_l2p_cache *g_cache;
+static struct ftl_l2p_page g_pages[TEST_RESIDENT_PAGES];
+static bool g_page_used[TEST_RESIDENT_PAGES];
+static char g_page_buf[TEST_RESIDENT_PAGES][FTL_BLOCK_SIZE];
+static struct ftl_l2p_page *g_page_in_pages[TEST_RESIDENT_PAGES];
+static size_t g_page_in_cnt;
+void *g_ftl_read_buf;
+
+DEFINE_STUB(spdk_bdev_get_md_size, uint32_t, (const struct spdk_bdev *bdev), 0);
+DEFINE_STUB(spdk_bdev_desc_get_bdev, struct spdk_bdev *, (struct spdk_bdev_desc *desc), NULL);
+DEFINE_STUB(spdk_bdev_read_blocks_with_md, int, (struct spdk_bdev_desc *desc,
+		struct spdk_io_channel *ch, void *buf, void *md, uint64_t offset_blocks,
+		uint64_t num_blocks, spdk_bdev_io_completion_cb cb, void *cb_arg), 0);
+DEFINE_STUB(spdk_bdev_queue_io_wait, int, (struct spdk_bdev *bdev, struct spdk_io_channel *ch,
+		struct spdk_bdev_io_wait_entry *entry), 0);
+DEFINE_STUB_V(spdk_bdev_free_io, (struct spdk_bdev_io *bdev_io));
+DEFINE_STUB_V(ftl_stats_bdev_io_completed, (struct spdk_ftl_dev *dev, enum ftl_stats_type type,
+		struct spdk_bdev_io *bdev_io));
+DEFINE_STUB_V(ftl_l2p_pin_complete, (struct spdk_ftl_dev *dev, int status,
+				     struct ftl_l2p_pin_ctx *pin_ctx));
+DEFINE_STUB(ftl_md_get_buffer, void *, (struct ftl_md *md), g_page_buf);
+
+void *
+ftl_mempool_get(struct ftl_mempool *mpool)
+{
+	size_t i;
+
+	for (i = 0; i < TEST_RESIDENT_PAGES; i++) {
+		if (!g_page_used[i]) {
+			g_page_used[i] = true;
+			return &g_pages[i];
+		}
+	}
+
+	return NULL;
+}
+
+void
+ftl_mempool_put(struct ftl_mempool *mpool, void *element)
+{
+	struct ftl_l2p_page *page = element;
+
+	CU_ASSERT(g_page_used[page - g_pages]);
+	g_page_used[page - g_pages] = false;
+}
+
+size_t
+ftl_mempool_get_df_obj_index(struct ftl_mempool *mpool, void *df_obj_ptr)
+{
+	return (struct ftl_l2p_page *)df_obj_ptr - g_pages;
+}
+
+ftl_df_obj_id
+ftl_mempool_get_df_obj_id(struct ftl_mempool *mpool, void *df_obj_ptr)
+{
+	return ftl_mempool_get_df_obj_index(mpool, df_obj_ptr);
+}
+
+void *
+ftl_mempool_get_df_ptr(struct ftl_mempool *mpool, ftl_df_obj_id df_obj_id)
+{
+	return &g_pages[df_obj_id];
+}
+
+int
+spdk_bdev_read_blocks(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		      void *buf, uint64_t offset_blocks, uint64_t num_blocks,
+		      spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	SPDK_CU_ASSERT_FATAL(g_page_in_cnt < TEST_RESIDENT_PAGES);
+	CU_ASSERT_EQUAL(cb, page_in_io_cb);
+	g_page_in_pages[g_page_in_cnt++] = cb_arg;
+
+	return 0;
+}
+
+static void
+setup_cache(void)
+{
+	struct ftl_l2p_cache *cache;
+	uint64_t i;
+
+	memset(&g_dev, 0, sizeof(g_dev));
+	memset(g_pages, 0, sizeof(g_pages));
+	memset(g_page_used, 0, sizeof(g_page_used));
+	g_page_in_cnt = 0;
+
+	cache = calloc(1, sizeof(*cache));
+	SPDK_CU_ASSERT_FATAL(cache != NULL);
+	cache->dev = &g_dev;
+	g_dev.l2p = cache;
+
+	cache->l2_mapping = calloc(TEST_NUM_PAGES, sizeof(*cache->l2_mapping));
+	SPDK_CU_ASSERT_FATAL(cache->l2_mapping != NULL);
+	for (i = 0; i < TEST_NUM_PAGES; i++) {
+		cache->l2_mapping[i].page_obj_id = FTL_DF_OBJ_ID_INVALID;
+	}
+
+	cache->lbas_in_page = TEST_LBAS_IN_PAGE;
+	cache->num_pages = TEST_NUM_PAGES;
+	cache->l2_pgs_resident_max = TEST_RESIDENT_PAGES;
+	cache->l2_pgs_avail = TEST_RESIDENT_PAGES;
+	cache->evict_keep = 2;
+	cache->state = L2P_CACHE_RUNNING;
+	TAILQ_INIT(&cache->lru_list);
+	TAILQ_INIT(&cache->protected_list);
+	TAILQ_INIT(&cache->deferred_page_set_list);
+
+	/* Same sizing as ftl_l2p_cache_init() */
+	cache->protected_max = TEST_RESIDENT_PAGES * FTL_L2P_CACHE_PROTECTED_RATIO / 100;
+	cache->ghost.size = TEST_RESIDENT_PAGES * FTL_L2P_CACHE_GHOST_RATIO / 100;
+	cache->ghost.ring = calloc(cache->ghost.size, sizeof(*cache->ghost.ring));
+	cache->ghost.map_buf = calloc(1, ftl_bitmap_bits_to_size(TEST_NUM_PAGES));
+	SPDK_CU_ASSERT_FATAL(cache->ghost.ring != NULL && cache->ghost.map_buf != NULL);
+	cache->ghost.map = ftl_bitmap_create(cache->ghost.map_buf,
+					     ftl_bitmap_bits_to_size(TEST_NUM_PAGES));
+	SPDK_CU_ASSERT_FATAL(cache->ghost.map != NULL);
+
+	g_cache = cache;
+}
+
+static void
+cleanup_cache(void)
+{
+	ftl_bitmap_destroy(g_cache->ghost.map);
+	free(g_cache->ghost.map_buf);
+	free(g_cache->ghost.ring);
+	free(g_cache->l2_mapping);
+	free(g_cache);
+	g_cache = NULL;
+	g_dev.l2p = NULL;
+}
+
+static void
+complete_page_ins(void)
+{
+	size_t i;
+
+	for (i = 0; i < g_page_in_cnt; i++) {
+		page_in_io_cb(NULL, true, g_page_in_pages[i]);
+	}
+	g_page_in_cnt = 0;
+}
+
+/* Page in the page the same way page_in() does and access it once */
+static struct ftl_l2p_page *
+access_page(uint64_t page_no, bool internal)
+{
+	struct ftl_l2p_pin_ctx pin_ctx = { .internal = internal };
+	struct ftl_l2p_page *page;
+
+	page = get_l2p_page_by_df_id(g_cache, page_no);
+	if (!page) {
+		page = page_allocate(g_cache, page_no);
+		ftl_l2p_cache_page_classify(g_cache, page, &pin_ctx);
+		page_in_io(&g_dev, g_cache, page);
+		complete_page_ins();
+	}
+
+	ftl_l2p_cache_page_pin(g_cache, page, &pin_ctx);
+	ftl_l2p_cache_page_unpin(g_cache, page);
+
+	return page;
+}
+
+static struct ftl_l2p_page *
+evict_page(void)
+{
+	struct ftl_l2p_page *page = eviction_get_page(&g_dev, g_cache);
+
+	SPDK_CU_ASSERT_FATAL(page != NULL);
+	eviction_page_remove(g_cache, page);
+
+	return page;
+}
+
+static void
+test_l2p_cache_2q_promotion(void)
+{
+	struct ftl_l2p_page *page;
+	uint64_t avail;
+
+	setup_cache();
+	avail = g_cache->l2_pgs_avail;
+
+	/* New pages start on probation */
+	page = access_page(0, false);
+	CU_ASSERT_EQUAL(page->lru_class, L2P_CACHE_PAGE_PROBATION);
+	CU_ASSERT_EQUAL(page->state, L2P_CACHE_PAGE_READY);
+	CU_ASSERT_EQUAL(TAILQ_FIRST(&g_cache->lru_list), page);
+	CU_ASSERT(TAILQ_EMPTY(&g_cache->protected_list));
+	CU_ASSERT_EQUAL(g_cache->ios_in_flight, 0);
+
+	/* A user accessed page evicted from probation is remembered in the ghost ring */
+	CU_ASSERT_EQUAL(evict_page(), page);
+	CU_ASSERT(ftl_bitmap_get(g_cache->ghost.map, 0));
+	CU_ASSERT_EQUAL(g_cache->stats.evictions, 1);
+	CU_ASSERT_EQUAL(g_cache->l2_pgs_avail, avail);
+
+	/* Internal IO paging the page in again doesn't promote it */
+	page = access_page(0, true);
+	CU_ASSERT_EQUAL(page->lru_class, L2P_CACHE_PAGE_PROBATION);
+	CU_ASSERT_EQUAL(g_cache->stats.ghost_hits, 0);
+	CU_ASSERT_EQUAL(evict_page(), page);
+
+	/* User IO does, the page moves to the protected list */
+	page = access_page(0, false);
+	CU_ASSERT_EQUAL(page->lru_class, L2P_CACHE_PAGE_PROTECTED);
+	CU_ASSERT_EQUAL(g_cache->stats.ghost_hits, 1);
+	CU_ASSERT_EQUAL(g_cache->protected_pages, 1);
+	CU_ASSERT_EQUAL(TAILQ_FIRST(&g_cache->protected_list), page);
+	CU_ASSERT(TAILQ_EMPTY(&g_cache->lru_list));
+	CU_ASSERT(!ftl_bitmap_get(g_cache->ghost.map, 0));
+
+	/* Pages which were only used by internal IO aren't remembered */
+	page = access_page(1, true);
+	CU_ASSERT_EQUAL(evict_page(), page);
+	CU_ASSERT(!ftl_bitmap_get(g_cache->ghost.map, 1));
+
+	cleanup_cache();
+}
+
+static void
+test_l2p_cache_2q_eviction(void)
+{
+	struct ftl_l2p_pin_ctx pin_ctx = {};
+	struct ftl_l2p_page *protected, *hot, *cold;
+
+	setup_cache();
+
+	ftl_l2p_cache_ghost_add(g_cache, 0);
+	protected = access_page(0, false);
+	CU_ASSERT_EQUAL(protected->lru_class, L2P_CACHE_PAGE_PROTECTED);
+
+	/* Pages used by user IO are ranked above ones only used by internal IO */
+	hot = access_page(1, false);
+	cold = access_page(2, true);
+	CU_ASSERT_EQUAL(TAILQ_FIRST(&g_cache->lru_list), hot);
+	CU_ASSERT_EQUAL(TAILQ_LAST(&g_cache->lru_list, l2p_lru_list), cold);
+
+	/* Probation pages go first, even though the protected page is older */
+	CU_ASSERT_EQUAL(evict_page(), cold);
+	CU_ASSERT_EQUAL(evict_page(), hot);
+	CU_ASSERT_EQUAL(g_cache->protected_pages, 1);
+
+	/* The protected list is evicted from only once probation is empty */
+	CU_ASSERT_EQUAL(evict_page(), protected);
+	CU_ASSERT_EQUAL(g_cache->protected_pages, 0);
+	CU_ASSERT_EQUAL(g_cache->l2_pgs_avail, TEST_RESIDENT_PAGES);
+	CU_ASSERT_PTR_NULL(eviction_get_page(&g_dev, g_cache));
+
+	/* Pinned pages aren't ranked, so they can't be evicted */
+	hot = access_page(1, false);
+	ftl_l2p_cache_page_pin(g_cache, hot, &pin_ctx);
+	CU_ASSERT_PTR_NULL(eviction_get_page(&g_dev, g_cache));
+	ftl_l2p_cache_page_unpin(g_cache, hot);
+	CU_ASSERT_EQUAL(evict_page(), hot);
+
+	cleanup_cache();
+}
+
+static void
+test_l2p_cache_2q_protected_cap(void)
+{
+	struct ftl_l2p_page *pages[TEST_RESIDENT_PAGES];
+	uint64_t i, protected_max;
+
+	setup_cache();
+	protected_max = g_cache->protected_max;
+	SPDK_CU_ASSERT_FATAL(protected_max > 0 && protected_max < TEST_RESIDENT_PAGES);
+
+	for (i = 0; i < protected_max; i++) {
+		ftl_l2p_cache_ghost_add(g_cache, i);
+		pages[i] = access_page(i, false);
+		CU_ASSERT_EQUAL(pages[i]->lru_class, L2P_CACHE_PAGE_PROTECTED);
+	}
+	CU_ASSERT_EQUAL(g_cache->protected_pages, protected_max);
+	CU_ASSERT(TAILQ_EMPTY(&g_cache->lru_list));
+
+	/* Promoting one more page demotes the least recently used protected one */
+	ftl_l2p_cache_ghost_add(g_cache, protected_max);
+	pages[protected_max] = access_page(protected_max, false);
+	CU_ASSERT_EQUAL(pages[protected_max]->lru_class, L2P_CACHE_PAGE_PROTECTED);
+	CU_ASSERT_EQUAL(g_cache->protected_pages, protected_max);
+	CU_ASSERT_EQUAL(pages[0]->lru_class, L2P_CACHE_PAGE_PROBATION);
+	CU_ASSERT_EQUAL(TAILQ_FIRST(&g_cache->lru_list), pages[0]);
+	CU_ASSERT_EQUAL(TAILQ_LAST(&g_cache->protected_list, l2p_lru_list), pages[1]);
+
+	/* The demoted page is the first one to go */
+	CU_ASSERT_EQUAL(evict_page(), pages[0]);
+	CU_ASSERT_EQUAL(g_cache->protected_pages, protected_max);
+
+	cleanup_cache();
+}
+
+static void
+test_l2p_cache_ghost_ring(void)
+{
+	uint64_t i, size;
+
+	setup_cache();
+	size = g_cache->ghost.size;
+
+	for (i = 0; i < size; i++) {
+		ftl_l2p_cache_ghost_add(g_cache, i);
+	}
+
+	/* Adding a page which is already remembered doesn't take another slot */
+	ftl_l2p_cache_ghost_add(g_cache, 0);
+	CU_ASSERT_EQUAL(g_cache->ghost.count, size);
+	CU_ASSERT(ftl_bitmap_get(g_cache->ghost.map, 0));
+
+	/* Once the ring is full, the oldest page is forgotten */
+	ftl_l2p_cache_ghost_add(g_cache, size);
+	CU_ASSERT_EQUAL(g_cache->ghost.count, size);
+	CU_ASSERT(!ftl_bitmap_get(g_cache->ghost.map, 0));
+	for (i = 1; i <= size; i++) {
+		CU_ASSERT(ftl_bitmap_get(g_cache->ghost.map, i));
+	}
+
+	/* So it's paged in on probation again */
+	CU_ASSERT_EQUAL(access_page(0, false)->lru_class, L2P_CACHE_PAGE_PROBATION);
+	CU_ASSERT_EQUAL(access_page(1, false)->lru_class, L2P_CACHE_PAGE_PROTECTED);
+
+	cleanup_cache();
+}
+
+static void
+pin_pages(uint64_t start, uint64_t end)
+{
+	ftl_l2p_cache_prefetch(&g_dev, g_cache, start, end);
+}
+
+static void
+test_l2p_cache_prefetch_trigger(void)
+{
+	uint64_t seq = 10 + FTL_L2P_CACHE_PREFETCH_TRIGGER;
+	struct ftl_l2p_page *page;
+	uint64_t i;
+
+	setup_cache();
+	g_dev.conf.l2p_prefetch_depth = 2;
+
+	/* Nothing is prefetched until the stream advanced over enough pages */
+	for (i = 10; i < seq; i++) {
+		pin_pages(i, i);
+		CU_ASSERT_EQUAL(g_cache->stats.prefetches, 0);
+	}
+
+	pin_pages(seq, seq);
+	CU_ASSERT_EQUAL(g_cache->stats.prefetches, 2);
+	CU_ASSERT_EQUAL(g_page_in_cnt, 2);
+	CU_ASSERT_EQUAL(g_cache->ios_in_flight, 2);
+	for (i = seq + 1; i <= seq + 2; i++) {
+		page = get_l2p_page_by_df_id(g_cache, i);
+		SPDK_CU_ASSERT_FATAL(page != NULL);
+		CU_ASSERT_EQUAL(page->lru_class, L2P_CACHE_PAGE_PROBATION);
+		CU_ASSERT(page->user_ref);
+	}
+
+	/* Prefetched pages are ranked once paged in, nobody has to pin them */
+	complete_page_ins();
+	CU_ASSERT_EQUAL(g_cache->ios_in_flight, 0);
+	CU_ASSERT_EQUAL(TAILQ_FIRST(&g_cache->lru_list)->page_no, seq + 2);
+
+	/* Pages prefetched already aren't paged in again as the stream advances */
+	pin_pages(seq + 1, seq + 1);
+	CU_ASSERT_EQUAL(g_cache->stats.prefetches, 3);
+	CU_ASSERT_EQUAL(g_page_in_pages[0]->page_no, seq + 3);
+	complete_page_ins();
+
+	/* Random access doesn't prefetch, nor does it break the sequential stream */
+	pin_pages(40, 40);
+	pin_pages(30, 31);
+	CU_ASSERT_EQUAL(g_cache->stats.prefetches, 3);
+	pin_pages(seq + 2, seq + 2);
+	CU_ASSERT_EQUAL(g_cache->stats.prefetches, 4);
+	CU_ASSERT_EQUAL(g_page_in_pages[0]->page_no, seq + 4);
+	complete_page_ins();
+
+	/* Prefetching can be disabled */
+	g_dev.conf.l2p_prefetch_depth = 0;
+	pin_pages(seq + 3, seq + 3);
+	CU_ASSERT_EQUAL(g_cache->stats.prefetches, 4);
+	CU_ASSERT_EQUAL(g_page_in_cnt, 0);
+
+	cleanup_cache();
+}
+
+static void
+test_l2p_cache_prefetch_cap(void)
+{
+	uint64_t seq = 10 + FTL_L2P_CACHE_PREFETCH_TRIGGER;
+	struct ftl_l2p_page_set page_set = {};
+	uint64_t i;
+
+	/* Half of the eviction reserve is kept for demand page ins */
+	setup_cache();
+	g_dev.conf.l2p_prefetch_depth = 4;
+	g_cache->l2_pgs_avail = g_cache->evict_keep / 2 + 1;
+	for (i = 10; i <= seq; i++) {
+		pin_pages(i, i);
+	}
+	CU_ASSERT_EQUAL(g_cache->stats.prefetches, 1);
+	CU_ASSERT_EQUAL(g_cache->l2_pgs_avail, g_cache->evict_keep / 2);
+	CU_ASSERT_EQUAL(g_cache->prefetch[0].next_page, seq + 2);
+	complete_page_ins();
+	cleanup_cache();
+
+	/* No prefetching while too many IOs are in flight */
+	setup_cache();
+	g_dev.conf.l2p_prefetch_depth = 4;
+	g_cache->ios_in_flight = FTL_L2P_CACHE_MAX_IOS_IN_FLIGHT + 1;
+	for (i = 10; i <= seq; i++) {
+		pin_pages(i, i);
+	}
+	CU_ASSERT_EQUAL(g_cache->stats.prefetches, 0);
+	CU_ASSERT_EQUAL(g_page_in_cnt, 0);
+
+	/* Prefetched pages count towards the limit too */
+	g_cache->ios_in_flight = FTL_L2P_CACHE_MAX_IOS_IN_FLIGHT;
+	pin_pages(seq + 1, seq + 1);
+	CU_ASSERT_EQUAL(g_cache->stats.prefetches, 1);
+	CU_ASSERT_EQUAL(g_cache->ios_in_flight, FTL_L2P_CACHE_MAX_IOS_IN_FLIGHT + 1);
+
+	/* The same limit defers demand page ins */
+	page_set.to_pin_cnt = 1;
+	page_set.deferred = 1;
+	TAILQ_INSERT_TAIL(&g_cache->deferred_page_set_list, &page_set, list_entry);
+	CU_ASSERT_EQUAL(ftl_l2p_cache_process_page_sets(&g_dev, g_cache), -EBUSY);
+	CU_ASSERT_EQUAL(TAILQ_FIRST(&g_cache->deferred_page_set_list), &page_set);
+	TAILQ_REMOVE(&g_cache->deferred_page_set_list, &page_set, list_entry);
+	complete_page_ins();
+	cleanup_cache();
+
+	/* Prefetching stops at the end of the L2P */
+	setup_cache();
+	g_dev.conf.l2p_prefetch_depth = 4;
+	for (i = TEST_NUM_PAGES - 2 - FTL_L2P_CACHE_PREFETCH_TRIGGER; i < TEST_NUM_PAGES - 1; i++) {
+		pin_pages(i, i);
+	}
+	CU_ASSERT_EQUAL(g_cache->stats.prefetches, 1);
+	CU_ASSERT_EQUAL(g_page_in_pages[0]->page_no, TEST_NUM_PAGES - 1);
+	complete_page_ins();
+	cleanup_cache();
+}
+
+int
+main(int argc, char **argv)
+{
+	CU_pSuite suite = NULL;
+	unsigned int num_failures;
+
+	CU_initialize_registry();
+
+	suite = CU_add_suite("ftl_l2p_cache_suite", NULL, NULL);
+
+	CU_ADD_TEST(suite, test_l2p_cache_2q_promotion);
+	CU_ADD_TEST(suite, test_l2p_cache_2q_eviction);
+	CU_ADD_TEST(suite, test_l2p_cache_2q_protected_cap);
+	CU_ADD_TEST(suite, test_l2p_cache_ghost_ring);
+	CU_ADD_TEST(suite, test_l2p_cache_prefetch_trigger);
+	CU_ADD_TEST(suite, test_l2p_cache_prefetch_cap);
+
+	num_failures = spdk_ut_run_tests(argc, argv, NULL);
+	CU_cleanup_registry();
+
+	return num_failures;
+}
@@ -0,0 +1,226 @@
+/*   SPDX-License-Identifier: BSD-3-Clause
+ *   Copyright (C) 2022 Intel Corporation.
+ *   All rights reserved.
+ */
+
+#include "spdk/stdinc.h"
+
+#include "spdk_internal/cunit.h"
+#include "common/lib/test_env.c"
+
+#include "ftl/ftl_writer.c"
+
+#define TEST_BAND_COUNT 4
+
+static struct spdk_ftl_dev g_dev;
+static struct ftl_band g_bands[TEST_BAND_COUNT];
+static struct ftl_band_md g_band_md[TEST_BAND_COUNT];
+static size_t g_num_free_bands;
+static struct ftl_band *g_written_band;
+static struct ftl_rq *g_written_rq;
+
+DEFINE_STUB_V(ftl_band_close, (struct ftl_band *band));
+DEFINE_STUB(ftl_band_user_blocks_left, size_t, (const struct ftl_band *band, size_t offset), 0);
+DEFINE_STUB(ftl_rq_new, struct ftl_rq *, (struct spdk_ftl_dev *dev, uint32_t io_md_size), NULL);
+DEFINE_STUB_V(ftl_rq_del, (struct ftl_rq *rq));
+
+struct ftl_band *
+ftl_band_get_next_free(struct spdk_ftl_dev *dev)
+{
+	if (g_num_free_bands == 0) {
+		return NULL;
+	}
+
+	return &g_bands[TEST_BAND_COUNT - g_num_free_bands--];
+}
+
+int
+ftl_band_write_prep(struct ftl_band *band)
+{
+	band->md->state = FTL_BAND_STATE_PREP;
+	return 0;
+}
+
+void
+ftl_band_open(struct ftl_band *band, enum ftl_band_type type)
+{
+	band->md->state = FTL_BAND_STATE_OPEN;
+	band->md->type = type;
+}
+
+void
+ftl_band_rq_write(struct ftl_band *band, struct ftl_rq *rq)
+{
+	g_written_band = band;
+	g_written_rq = rq;
+}
+
+static void
+setup_writer(struct ftl_writer *writer, size_t num_free_bands)
+{
+	size_t i;
+
+	memset(&g_dev, 0, sizeof(g_dev));
+	memset(g_bands, 0, sizeof(g_bands));
+	memset(g_band_md, 0, sizeof(g_band_md));
+
+	for (i = 0; i < TEST_BAND_COUNT; i++) {
+		g_bands[i].id = i;
+		g_bands[i].md = &g_band_md[i];
+		g_band_md[i].state = FTL_BAND_STATE_FREE;
+	}
+
+	g_num_free_bands = num_free_bands;
+	g_written_band = NULL;
+	g_written_rq = NULL;
+
+	ftl_writer_init(&g_dev, writer, 0, FTL_BAND_TYPE_GC);
+	ftl_writer_resume(writer);
+}
+
+static void
+init_rq(struct ftl_rq *rq, bool cold)
+{
+	memset(rq, 0, sizeof(*rq));
+	rq->owner.cold = cold;
+}
+
+static void
+test_writer_cold_band(void)
+{
+	struct ftl_writer writer;
+	struct ftl_rq hot_rq, cold_rq;
+
+	setup_writer(&writer, TEST_BAND_COUNT);
+	init_rq(&hot_rq, false);
+	init_rq(&cold_rq, true);
+
+	ftl_writer_queue_rq(&writer, &hot_rq);
+	ftl_writer_queue_rq(&writer, &cold_rq);
+	CU_ASSERT_EQUAL(TAILQ_FIRST(&writer.rq_queue), &hot_rq);
+	CU_ASSERT_EQUAL(TAILQ_FIRST(&writer.cold_rq_queue), &cold_rq);
+
+	/* First pass only allocates and opens a band for each class */
+	ftl_writer_run(&writer);
+	CU_ASSERT_EQUAL(writer.num_bands, 2);
+	CU_ASSERT_EQUAL(writer.band, &g_bands[0]);
+	CU_ASSERT_EQUAL(writer.cold_band, &g_bands[1]);
+	CU_ASSERT_PTR_NULL(g_written_rq);
+	CU_ASSERT_EQUAL(g_bands[0].owner.priv, &writer);
+	CU_ASSERT_EQUAL(g_bands[1].owner.priv, &writer);
+
+	/* Once the bands are open, each request goes to the band of its class */
+	ftl_writer_run(&writer);
+	CU_ASSERT(TAILQ_EMPTY(&writer.rq_queue));
+	CU_ASSERT(TAILQ_EMPTY(&writer.cold_rq_queue));
+	CU_ASSERT_EQUAL(g_written_band, &g_bands[1]);
+	CU_ASSERT_EQUAL(g_written_rq, &cold_rq);
+
+	init_rq(&hot_rq, false);
+	ftl_writer_queue_rq(&writer, &hot_rq);
+	ftl_writer_run(&writer);
+	CU_ASSERT_EQUAL(g_written_band, &g_bands[0]);
+	CU_ASSERT_EQUAL(g_written_rq, &hot_rq);
+
+	/* A full cold band releases the cold slot only */
+	g_band_md[1].state = FTL_BAND_STATE_FULL;
+	ftl_writer_band_state_change(&g_bands[1]);
+	CU_ASSERT_PTR_NULL(writer.cold_band);
+	CU_ASSERT_EQUAL(writer.band, &g_bands[0]);
+	CU_ASSERT_EQUAL(TAILQ_FIRST(&writer.full_bands), &g_bands[1]);
+
+	ftl_writer_run(&writer);
+	CU_ASSERT(TAILQ_EMPTY(&writer.full_bands));
+
+	g_band_md[1].state = FTL_BAND_STATE_CLOSED;
+	ftl_writer_band_state_change(&g_bands[1]);
+	CU_ASSERT_EQUAL(writer.num_bands, 1);
+	CU_ASSERT_PTR_NULL(g_bands[1].owner.priv);
+
+	/* A full hot band releases the hot slot only */
+	g_band_md[0].state = FTL_BAND_STATE_FULL;
+	ftl_writer_band_state_change(&g_bands[0]);
+	CU_ASSERT_PTR_NULL(writer.band);
+	CU_ASSERT_EQUAL(TAILQ_FIRST(&writer.full_bands), &g_bands[0]);
+}
+
+static void
+test_writer_cold_band_fallback(void)
+{
+	struct ftl_writer writer;
+	struct ftl_rq hot_rq, cold_rq;
+
+	/* Only one free band - cold requests share the hot band */
+	setup_writer(&writer, 1);
+	init_rq(&hot_rq, false);
+	init_rq(&cold_rq, true);
+
+	ftl_writer_queue_rq(&writer, &hot_rq);
+	ftl_writer_run(&writer);
+	CU_ASSERT_EQUAL(writer.band, &g_bands[TEST_BAND_COUNT - 1]);
+	ftl_writer_run(&writer);
+	CU_ASSERT_EQUAL(g_written_rq, &hot_rq);
+
+	ftl_writer_queue_rq(&writer, &cold_rq);
+	ftl_writer_run(&writer);
+	CU_ASSERT_PTR_NULL(writer.cold_band);
+	CU_ASSERT(TAILQ_EMPTY(&writer.cold_rq_queue));
+	CU_ASSERT_EQUAL(g_written_band, &g_bands[TEST_BAND_COUNT - 1]);
+	CU_ASSERT_EQUAL(g_written_rq, &cold_rq);
+	CU_ASSERT_EQUAL(writer.num_bands, 1);
+
+	/* No fallback while the other class has no open band either */
+	setup_writer(&writer, 0);
+	init_rq(&cold_rq, true);
+	ftl_writer_queue_rq(&writer, &cold_rq);
+	ftl_writer_run(&writer);
+	CU_ASSERT_PTR_NULL(g_written_rq);
+	CU_ASSERT_EQUAL(TAILQ_FIRST(&writer.cold_rq_queue), &cold_rq);
+
+	/* Hot requests fall back to the cold band when the open band limit is reached */
+	setup_writer(&writer, TEST_BAND_COUNT);
+	init_rq(&hot_rq, false);
+	init_rq(&cold_rq, true);
+	ftl_writer_queue_rq(&writer, &cold_rq);
+	ftl_writer_run(&writer);
+	ftl_writer_run(&writer);
+	CU_ASSERT_EQUAL(writer.cold_band, &g_bands[0]);
+	CU_ASSERT_EQUAL(g_written_rq, &cold_rq);
+
+	writer.num_bands = FTL_LAYOUT_REGION_TYPE_P2L_COUNT / 2;
+	ftl_writer_queue_rq(&writer, &hot_rq);
+	ftl_writer_run(&writer);
+	CU_ASSERT_PTR_NULL(writer.band);
+	CU_ASSERT(TAILQ_EMPTY(&writer.rq_queue));
+	CU_ASSERT_EQUAL(g_written_band, &g_bands[0]);
+	CU_ASSERT_EQUAL(g_written_rq, &hot_rq);
+	CU_ASSERT_EQUAL(g_num_free_bands, TEST_BAND_COUNT - 1);
+
+	/* The fallback band still has to be writable */
+	init_rq(&hot_rq, false);
+	g_written_rq = NULL;
+	ftl_writer_halt(&writer);
+	ftl_writer_queue_rq(&writer, &hot_rq);
+	ftl_writer_run(&writer);
+	CU_ASSERT_PTR_NULL(g_written_rq);
+	CU_ASSERT_EQUAL(TAILQ_FIRST(&writer.rq_queue), &hot_rq);
+}
+
+int
+main(int argc, char **argv)
+{
+	CU_pSuite suite = NULL;
+	unsigned int num_failures;
+
+	CU_initialize_registry();
+
+	suite = CU_add_suite("ftl_writer_suite", NULL, NULL);
+
+	CU_ADD_TEST(suite, test_writer_cold_band);
+	CU_ADD_TEST(suite, test_writer_cold_band_fallback);
+
+	num_failures = spdk_ut_run_tests(argc, argv, NULL);
+	CU_cleanup_registry();
+
+	return num_failures;
+}
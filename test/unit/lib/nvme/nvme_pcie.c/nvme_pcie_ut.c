@@ -1115,6 +1115,111 @@ test_nvme_pcie_ctrlr_map_io_pmr(void)
 	CU_ASSERT(rt_size == 0x1FE00000);
 }
 
+static void
+test_nvme_pcie_qpair_submit_tracker_batch(void)
+{
+	struct nvme_pcie_ctrlr pctrlr = {};
+	struct nvme_pcie_qpair pqpair = {};
+	struct spdk_nvme_pcie_stat stat = {};
+	struct spdk_nvme_cmd cmd[8] = {};
+	struct nvme_request req = {};
+	struct nvme_tracker tr = {};
+	volatile uint32_t sq_tdbl = 0;
+	uint32_t i;
+
+	pqpair.qpair.ctrlr = &pctrlr.ctrlr;
+	pqpair.cmd = cmd;
+	pqpair.num_entries = 8;
+	pqpair.stat = &stat;
+	pqpair.sq_tdbl = &sq_tdbl;
+	tr.req = &req;
+
+	/* Without delay_cmd_submit, the doorbell is rung for each command. */
+	pqpair.qpair.num_outstanding_reqs = 4;
+	for (i = 0; i < 4; i++) {
+		nvme_pcie_qpair_submit_tracker(&pqpair.qpair, &tr);
+	}
+	CU_ASSERT(stat.sq_mmio_doorbell_updates == 4);
+	CU_ASSERT(sq_tdbl == 4);
+
+	/* With delay_cmd_submit and nothing outstanding, the doorbell is still rung. */
+	pqpair.flags.delay_cmd_submit = 1;
+	pqpair.last_sq_tail = pqpair.sq_tail;
+	pqpair.qpair.num_outstanding_reqs = 1;
+	nvme_pcie_qpair_submit_tracker(&pqpair.qpair, &tr);
+	CU_ASSERT(stat.sq_mmio_doorbell_updates == 5);
+	CU_ASSERT(sq_tdbl == 5);
+	CU_ASSERT(pqpair.last_sq_tail == 5);
+
+	/* With 8 commands outstanding, up to 2 commands are held back. The SQ wraps around. */
+	pqpair.qpair.num_outstanding_reqs = 9;
+	nvme_pcie_qpair_submit_tracker(&pqpair.qpair, &tr);
+	CU_ASSERT(stat.sq_mmio_doorbell_updates == 5);
+
+	pqpair.qpair.num_outstanding_reqs = 10;
+	nvme_pcie_qpair_submit_tracker(&pqpair.qpair, &tr);
+	CU_ASSERT(stat.sq_mmio_doorbell_updates == 5);
+	CU_ASSERT(pqpair.sq_tail == 7);
+
+	pqpair.qpair.num_outstanding_reqs = 11;
+	nvme_pcie_qpair_submit_tracker(&pqpair.qpair, &tr);
+	CU_ASSERT(stat.sq_mmio_doorbell_updates == 6);
+	CU_ASSERT(sq_tdbl == 0);
+	CU_ASSERT(pqpair.last_sq_tail == 0);
+}
+
+static void
+test_nvme_pcie_poll_group_get_next_completion(void)
+{
+	struct spdk_nvme_transport_poll_group tgroup = {};
+	struct nvme_pcie_qpair pqpair = {};
+	struct nvme_request req1 = {}, req2 = {};
+	struct nvme_tracker tr1 = {}, tr2 = {};
+
+	STAILQ_INIT(&tgroup.connected_qpairs);
+	STAILQ_INSERT_TAIL(&tgroup.connected_qpairs, &pqpair.qpair, poll_group_stailq);
+	TAILQ_INIT(&pqpair.outstanding_tr);
+	pqpair.flags.track_latency = 1;
+	tr1.req = &req1;
+	tr2.req = &req2;
+
+	/* No latency has been measured yet. */
+	MOCK_SET(spdk_get_ticks, 1000);
+	req1.submit_tick = 900;
+	TAILQ_INSERT_TAIL(&pqpair.outstanding_tr, &tr1, tq_list);
+	CU_ASSERT(nvme_pcie_poll_group_get_next_completion(&tgroup) == UINT64_MAX);
+
+	/* The first latency sample is taken as is, later ones are averaged. */
+	req2.submit_tick = 800;
+	nvme_pcie_qpair_update_latency(&pqpair, &req2, 1000);
+	CU_ASSERT(pqpair.lat_ticks == 200);
+
+	req2.submit_tick = 920;
+	nvme_pcie_qpair_update_latency(&pqpair, &req2, 1000);
+	CU_ASSERT(pqpair.lat_ticks == 200 - 25 + 10);
+
+	/* The oldest outstanding command is due at 900 + 185. */
+	CU_ASSERT(nvme_pcie_poll_group_get_next_completion(&tgroup) == 85);
+
+	TAILQ_INSERT_TAIL(&pqpair.outstanding_tr, &tr2, tq_list);
+	CU_ASSERT(nvme_pcie_poll_group_get_next_completion(&tgroup) == 85);
+
+	/* The command is overdue. */
+	MOCK_SET(spdk_get_ticks, 1100);
+	CU_ASSERT(nvme_pcie_poll_group_get_next_completion(&tgroup) == 0);
+
+	/* Nothing is outstanding. */
+	TAILQ_INIT(&pqpair.outstanding_tr);
+	CU_ASSERT(nvme_pcie_poll_group_get_next_completion(&tgroup) == UINT64_MAX);
+
+	/* Latency is not tracked without interrupts. */
+	TAILQ_INSERT_TAIL(&pqpair.outstanding_tr, &tr1, tq_list);
+	pqpair.flags.track_latency = 0;
+	CU_ASSERT(nvme_pcie_poll_group_get_next_completion(&tgroup) == UINT64_MAX);
+
+	MOCK_CLEAR(spdk_get_ticks);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -1138,6 +1243,8 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_nvme_pcie_ctrlr_map_unmap_pmr);
 	CU_ADD_TEST(suite, test_nvme_pcie_ctrlr_config_pmr);
 	CU_ADD_TEST(suite, test_nvme_pcie_ctrlr_map_io_pmr);
+	CU_ADD_TEST(suite, test_nvme_pcie_qpair_submit_tracker_batch);
+	CU_ADD_TEST(suite, test_nvme_pcie_poll_group_get_next_completion);
 
 	num_failures = spdk_ut_run_tests(argc, argv, NULL);
 	CU_cleanup_registry();
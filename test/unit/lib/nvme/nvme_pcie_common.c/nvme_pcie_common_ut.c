@@ -37,9 +37,6 @@ DEFINE_STUB_V(nvme_qpair_deinit, (struct spdk_nvme_qpair *qpair));
 DEFINE_STUB(nvme_ctrlr_get_current_process, struct spdk_nvme_ctrlr_process *,
 	    (struct spdk_nvme_ctrlr *ctrlr), NULL);
 
-DEFINE_STUB(spdk_nvme_qpair_process_completions, int32_t,
-	    (struct spdk_nvme_qpair *qpair, uint32_t max_completions), 0);
-
 DEFINE_STUB(nvme_request_check_timeout, int, (struct nvme_request *req, uint16_t cid,
 		struct spdk_nvme_ctrlr_process *active_proc, uint64_t now_tick), 0);
 DEFINE_STUB(spdk_strerror, const char *, (int errnum), NULL);
@@ -52,6 +49,31 @@ DEFINE_STUB_V(nvme_transport_ctrlr_disconnect_qpair_done, (struct spdk_nvme_qpai
 DEFINE_STUB(spdk_nvme_ctrlr_get_numa_id, int32_t, (struct spdk_nvme_ctrlr *ctrlr),
 	    SPDK_ENV_NUMA_ID_ANY);
 
+#define UT_NUM_QPAIRS 3
+
+static uint32_t g_ut_available_completions[UT_NUM_QPAIRS + 1];
+static uint32_t g_ut_max_completions[UT_NUM_QPAIRS + 1];
+static uint32_t g_ut_num_polls[UT_NUM_QPAIRS + 1];
+
+int32_t
+spdk_nvme_qpair_process_completions(struct spdk_nvme_qpair *qpair, uint32_t max_completions)
+{
+	uint32_t num_completions;
+
+	SPDK_CU_ASSERT_FATAL(qpair->id <= UT_NUM_QPAIRS);
+
+	num_completions = g_ut_available_completions[qpair->id];
+	if (max_completions != 0) {
+		num_completions = spdk_min(num_completions, max_completions);
+	}
+
+	g_ut_available_completions[qpair->id] -= num_completions;
+	g_ut_max_completions[qpair->id] = max_completions;
+	g_ut_num_polls[qpair->id]++;
+
+	return num_completions;
+}
+
 int
 nvme_qpair_init(struct spdk_nvme_qpair *qpair, uint16_t id,
 		struct spdk_nvme_ctrlr *ctrlr,
@@ -578,6 +600,158 @@ test_nvme_pcie_poll_group_get_stats(void)
 	CU_ASSERT(rc == 0);
 }
 
+static void
+ut_disconnected_qpair_cb(struct spdk_nvme_qpair *qpair, void *poll_group_ctx)
+{
+	CU_ASSERT(false);
+}
+
+static void
+test_nvme_pcie_poll_group_process_completions(void)
+{
+	struct spdk_nvme_poll_group group = {};
+	struct spdk_nvme_ctrlr ctrlr = {}, failed_ctrlr = {};
+	struct nvme_pcie_qpair pqpairs[UT_NUM_QPAIRS] = {};
+	struct nvme_tracker trackers[UT_NUM_QPAIRS] = {};
+	struct spdk_nvme_transport_poll_group *tgroup;
+	struct nvme_pcie_poll_group *pgroup;
+	struct nvme_pcie_qpair *pqpair;
+	int64_t num_completions;
+	int i, rc;
+
+	tgroup = nvme_pcie_poll_group_create();
+	SPDK_CU_ASSERT_FATAL(tgroup != NULL);
+	pgroup = SPDK_CONTAINEROF(tgroup, struct nvme_pcie_poll_group, group);
+	tgroup->group = &group;
+	STAILQ_INIT(&tgroup->connected_qpairs);
+	STAILQ_INIT(&tgroup->disconnected_qpairs);
+
+	for (i = 0; i < UT_NUM_QPAIRS; i++) {
+		pqpair = &pqpairs[i];
+		pqpair->qpair.id = i + 1;
+		pqpair->qpair.ctrlr = &ctrlr;
+		pqpair->qpair.poll_group = tgroup;
+		pqpair->qpair.poll_group_tailq_head = &tgroup->connected_qpairs;
+		pqpair->pcie_state = NVME_PCIE_QPAIR_READY;
+		nvme_qpair_set_state(&pqpair->qpair, NVME_QPAIR_ENABLED);
+		TAILQ_INIT(&pqpair->outstanding_tr);
+		STAILQ_INIT(&pqpair->qpair.queued_req);
+		STAILQ_INIT(&pqpair->qpair.err_req_head);
+		STAILQ_INIT(&pqpair->qpair.aborting_queued_req);
+		STAILQ_INSERT_TAIL(&tgroup->connected_qpairs, &pqpair->qpair, poll_group_stailq);
+	}
+
+	/* Idle qpairs are not polled */
+	num_completions = nvme_pcie_poll_group_process_completions(tgroup, 0,
+			  ut_disconnected_qpair_cb);
+	CU_ASSERT(num_completions == 0);
+	CU_ASSERT(pgroup->num_active_qpairs == 0);
+	CU_ASSERT(g_ut_num_polls[1] == 0);
+	CU_ASSERT(g_ut_num_polls[2] == 0);
+	CU_ASSERT(g_ut_num_polls[3] == 0);
+
+	/* A submission activates the qpair */
+	TAILQ_INSERT_TAIL(&pqpairs[0].outstanding_tr, &trackers[0], tq_list);
+	nvme_pcie_poll_group_activate_qpair(&pqpairs[0]);
+	CU_ASSERT(pqpairs[0].flags.active == 1);
+	CU_ASSERT(pgroup->num_active_qpairs == 1);
+
+	g_ut_available_completions[1] = 5;
+	num_completions = nvme_pcie_poll_group_process_completions(tgroup, 0,
+			  ut_disconnected_qpair_cb);
+	CU_ASSERT(num_completions == 5);
+	CU_ASSERT(g_ut_num_polls[1] == 1);
+	CU_ASSERT(g_ut_max_completions[1] == 0);
+	CU_ASSERT(g_ut_num_polls[2] == 0);
+	CU_ASSERT(g_ut_num_polls[3] == 0);
+
+	/* The periodic scan activates the qpairs which have work to do */
+	TAILQ_INSERT_TAIL(&pqpairs[1].outstanding_tr, &trackers[1], tq_list);
+	TAILQ_INSERT_TAIL(&pqpairs[2].outstanding_tr, &trackers[2], tq_list);
+	pgroup->polls_since_scan = NVME_PCIE_POLL_GROUP_SCAN_POLLS - 1;
+	num_completions = nvme_pcie_poll_group_process_completions(tgroup, 0,
+			  ut_disconnected_qpair_cb);
+	CU_ASSERT(num_completions == 0);
+	CU_ASSERT(pgroup->num_active_qpairs == 3);
+	CU_ASSERT(pgroup->polls_since_scan == 0);
+	CU_ASSERT(g_ut_num_polls[1] == 2);
+	CU_ASSERT(g_ut_num_polls[2] == 1);
+	CU_ASSERT(g_ut_num_polls[3] == 1);
+
+	/* The budget is shared by the active qpairs. The budget left unused by qpair 2 is
+	 * handed to qpair 1 in the next round, then the budget runs out.
+	 */
+	group.completion_budget = 6;
+	g_ut_available_completions[1] = 10;
+	g_ut_available_completions[2] = 1;
+	g_ut_available_completions[3] = 10;
+	num_completions = nvme_pcie_poll_group_process_completions(tgroup, 0,
+			  ut_disconnected_qpair_cb);
+	CU_ASSERT(num_completions == 6);
+	CU_ASSERT(g_ut_available_completions[1] == 7);
+	CU_ASSERT(g_ut_available_completions[2] == 0);
+	CU_ASSERT(g_ut_available_completions[3] == 8);
+	CU_ASSERT(pgroup->next_qpair == &pqpairs[1]);
+
+	/* The next poll continues where the previous one stopped */
+	num_completions = nvme_pcie_poll_group_process_completions(tgroup, 0,
+			  ut_disconnected_qpair_cb);
+	CU_ASSERT(num_completions == 6);
+	CU_ASSERT(g_ut_available_completions[1] == 4);
+	CU_ASSERT(g_ut_available_completions[3] == 5);
+	CU_ASSERT(pgroup->next_qpair == &pqpairs[1]);
+
+	/* completions_per_qpair still caps what a qpair may reap in one round */
+	num_completions = nvme_pcie_poll_group_process_completions(tgroup, 1,
+			  ut_disconnected_qpair_cb);
+	CU_ASSERT(num_completions == 6);
+	CU_ASSERT(g_ut_max_completions[1] == 1);
+	CU_ASSERT(g_ut_max_completions[3] == 1);
+	CU_ASSERT(g_ut_available_completions[1] == 1);
+	CU_ASSERT(g_ut_available_completions[3] == 2);
+
+	/* Idle qpairs are deactivated */
+	group.completion_budget = 0;
+	TAILQ_REMOVE(&pqpairs[1].outstanding_tr, &trackers[1], tq_list);
+	g_ut_num_polls[2] = 0;
+	num_completions = nvme_pcie_poll_group_process_completions(tgroup, 0,
+			  ut_disconnected_qpair_cb);
+	CU_ASSERT(num_completions == 3);
+	CU_ASSERT(pqpairs[1].flags.active == 0);
+	CU_ASSERT(pgroup->num_active_qpairs == 2);
+	CU_ASSERT(g_ut_num_polls[2] == 0);
+
+	/* The scan finds idle qpairs whose controller failed */
+	pqpairs[1].qpair.ctrlr = &failed_ctrlr;
+	failed_ctrlr.is_failed = true;
+	pgroup->polls_since_scan = NVME_PCIE_POLL_GROUP_SCAN_POLLS - 1;
+	num_completions = nvme_pcie_poll_group_process_completions(tgroup, 0,
+			  ut_disconnected_qpair_cb);
+	CU_ASSERT(num_completions == 0);
+	CU_ASSERT(pqpairs[1].flags.active == 1);
+	CU_ASSERT(pgroup->num_active_qpairs == 3);
+	CU_ASSERT(g_ut_num_polls[2] == 1);
+
+	/* Disconnected and removed qpairs are deactivated */
+	rc = nvme_pcie_poll_group_disconnect_qpair(&pqpairs[0].qpair);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(pqpairs[0].flags.active == 0);
+	CU_ASSERT(pgroup->num_active_qpairs == 2);
+
+	for (i = 0; i < UT_NUM_QPAIRS; i++) {
+		STAILQ_REMOVE(&tgroup->connected_qpairs, &pqpairs[i].qpair, spdk_nvme_qpair,
+			      poll_group_stailq);
+		rc = nvme_pcie_poll_group_remove(tgroup, &pqpairs[i].qpair);
+		CU_ASSERT(rc == 0);
+	}
+	CU_ASSERT(pgroup->num_active_qpairs == 0);
+	CU_ASSERT(TAILQ_EMPTY(&pgroup->active_qpairs));
+	CU_ASSERT(pgroup->next_qpair == NULL);
+
+	rc = nvme_pcie_poll_group_destroy(tgroup);
+	CU_ASSERT(rc == 0);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -593,6 +767,7 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_nvme_pcie_ctrlr_connect_qpair);
 	CU_ADD_TEST(suite, test_nvme_pcie_ctrlr_construct_admin_qpair);
 	CU_ADD_TEST(suite, test_nvme_pcie_poll_group_get_stats);
+	CU_ADD_TEST(suite, test_nvme_pcie_poll_group_process_completions);
 
 	num_failures = spdk_ut_run_tests(argc, argv, NULL);
 	CU_cleanup_registry();
@@ -41,6 +41,7 @@ struct spdk_nvme_ctrlr c2 = {
 };
 
 int64_t g_process_completions_return_value = 0;
+uint64_t g_next_completion_ticks = UINT64_MAX;
 int g_destroy_return_value = 0;
 
 TAILQ_HEAD(nvme_transport_list, spdk_nvme_transport) g_spdk_nvme_transports =
@@ -61,6 +62,9 @@ DEFINE_STUB(spdk_nvme_qpair_get_fd, int, (struct spdk_nvme_qpair *qpair,
 DEFINE_STUB(spdk_nvme_ctrlr_get_transport_id,
 	    const struct spdk_nvme_transport_id *,
 	    (struct spdk_nvme_ctrlr *ctrlr), NULL);
+DEFINE_STUB_V(nvme_transport_poll_group_check_disconnected_qpairs,
+	      (struct spdk_nvme_transport_poll_group *tgroup,
+	       spdk_nvme_disconnected_qpair_cb disconnected_qpair_cb));
 int
 nvme_transport_poll_group_get_stats(struct spdk_nvme_transport_poll_group *tgroup,
 				    struct spdk_nvme_transport_poll_group_stat **stats)
@@ -466,6 +470,12 @@ test_spdk_nvme_poll_group_add_remove(void)
 	TAILQ_REMOVE(&g_spdk_nvme_transports, &t4, link);
 }
 
+uint64_t
+nvme_transport_poll_group_get_next_completion(struct spdk_nvme_transport_poll_group *tgroup)
+{
+	return g_next_completion_ticks;
+}
+
 static void
 test_spdk_nvme_poll_group_process_completions(void)
 {
@@ -579,6 +589,60 @@ test_spdk_nvme_poll_group_get_free_stats(void)
 	CU_ASSERT(rc == -ENOTSUP);
 }
 
+static void
+test_spdk_nvme_poll_group_hybrid_polling(void)
+{
+	struct spdk_nvme_poll_group *group;
+	struct spdk_nvme_transport_poll_group *tgroup, *tmp_tgroup;
+	struct spdk_nvme_qpair qpair1_1 = {0};
+
+	TAILQ_INSERT_TAIL(&g_spdk_nvme_transports, &t1, link);
+
+	group = spdk_nvme_poll_group_create(NULL, NULL);
+	SPDK_CU_ASSERT_FATAL(group != NULL);
+	qpair1_1.state = NVME_QPAIR_DISCONNECTED;
+	qpair1_1.transport = &t1;
+	qpair1_1.ctrlr = &c1;
+	CU_ASSERT(spdk_nvme_poll_group_add(group, &qpair1_1) == 0);
+	qpair1_1.state = NVME_QPAIR_ENABLED;
+	CU_ASSERT(nvme_poll_group_connect_qpair(&qpair1_1) == 0);
+
+	/* spdk_get_ticks_hz() is 1000000, so ticks are microseconds. */
+	spdk_nvme_poll_group_set_hybrid_polling(group, 20);
+	CU_ASSERT(group->hybrid_spin_ticks == 20);
+
+	/* The next completion is not expected soon. Don't spin. */
+	g_process_completions_return_value = 4;
+	g_next_completion_ticks = 21;
+	CU_ASSERT(nvme_poll_group_hybrid_spin(group, unit_test_disconnected_qpair_cb) == 0);
+
+	/* No completion is outstanding. Don't spin. */
+	g_next_completion_ticks = UINT64_MAX;
+	CU_ASSERT(nvme_poll_group_hybrid_spin(group, unit_test_disconnected_qpair_cb) == 0);
+
+	/* The next completion is expected soon. Poll instead of waiting for interrupts. */
+	g_next_completion_ticks = 20;
+	CU_ASSERT(spdk_nvme_poll_group_wait(group, unit_test_disconnected_qpair_cb) == 4);
+
+	g_next_completion_ticks = 0;
+	CU_ASSERT(spdk_nvme_poll_group_wait(group, unit_test_disconnected_qpair_cb) == 4);
+
+	spdk_nvme_poll_group_set_hybrid_polling(group, 0);
+	CU_ASSERT(group->hybrid_spin_ticks == 0);
+
+	g_process_completions_return_value = 0;
+	g_next_completion_ticks = UINT64_MAX;
+
+	CU_ASSERT(spdk_nvme_poll_group_remove(group, &qpair1_1) == 0);
+	STAILQ_FOREACH_SAFE(tgroup, &group->tgroups, link, tmp_tgroup) {
+		STAILQ_REMOVE(&group->tgroups, tgroup, spdk_nvme_transport_poll_group, link);
+		free(tgroup);
+	}
+	SPDK_CU_ASSERT_FATAL(spdk_nvme_poll_group_destroy(group) == 0);
+
+	TAILQ_REMOVE(&g_spdk_nvme_transports, &t1, link);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -603,7 +667,9 @@ main(int argc, char **argv)
 			    test_spdk_nvme_poll_group_process_completions) == NULL ||
 		CU_add_test(suite, "nvme_poll_group_destroy_test", test_spdk_nvme_poll_group_destroy) == NULL ||
 		CU_add_test(suite, "nvme_poll_group_get_free_stats",
-			    test_spdk_nvme_poll_group_get_free_stats) == NULL
+			    test_spdk_nvme_poll_group_get_free_stats) == NULL ||
+		CU_add_test(suite, "nvme_poll_group_hybrid_polling",
+			    test_spdk_nvme_poll_group_hybrid_polling) == NULL
 	) {
 		CU_cleanup_registry();
 		return CU_get_error();
@@ -60,6 +60,8 @@ DEFINE_STUB(spdk_memory_domain_translate_data, int,
 DEFINE_STUB_V(spdk_memory_domain_invalidate_data, (struct spdk_memory_domain *domain,
 		void *domain_ctx, struct iovec *iov, uint32_t iovcnt));
 
+struct spdk_nvme_transport_opts g_spdk_nvme_transport_opts = {};
+
 static void
 nvme_transport_ctrlr_disconnect_qpair_done_mocked(struct spdk_nvme_qpair *qpair)
 {
@@ -1029,12 +1031,23 @@ test_nvme_tcp_pdu_ch_handle(void)
 			  struct spdk_nvme_tcp_common_pdu_hdr));
 }
 
+static const char *g_ut_sock_impl_name;
+static struct spdk_sock_impl_opts g_ut_sock_impl_opts;
+
 DEFINE_RETURN_MOCK(spdk_sock_connect_ext, struct spdk_sock *);
 struct spdk_sock *
 spdk_sock_connect_ext(const char *ip, int port,
 		      const char *_impl_name, struct spdk_sock_opts *opts)
 {
 	HANDLE_RETURN_MOCK(spdk_sock_connect_ext);
+	g_ut_sock_impl_name = _impl_name;
+	/* spdk_sock_get_default_opts() is a stub, so impl_opts is only valid along with a name */
+	if (_impl_name != NULL) {
+		CU_ASSERT(opts->impl_opts_size == sizeof(g_ut_sock_impl_opts));
+		memcpy(&g_ut_sock_impl_opts, opts->impl_opts, sizeof(g_ut_sock_impl_opts));
+	} else {
+		memset(&g_ut_sock_impl_opts, 0, sizeof(g_ut_sock_impl_opts));
+	}
 	CU_ASSERT(port == 23);
 	CU_ASSERT(opts->opts_size == sizeof(*opts));
 	CU_ASSERT(opts->priority == 1);
@@ -1063,6 +1076,21 @@ test_nvme_tcp_qpair_connect_sock(void)
 
 	rc = nvme_tcp_qpair_connect_sock(ctrlr, &tqpair.qpair);
 	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_ut_sock_impl_name == NULL);
+	CU_ASSERT(g_ut_sock_impl_opts.enable_zerocopy_send_client == false);
+
+	/* Zero-copy threshold enables zero-copy on the default sock implementation */
+	g_spdk_nvme_transport_opts.tcp_zcopy_threshold = 16384;
+	MOCK_SET(spdk_sock_get_default_impl, "posix");
+
+	rc = nvme_tcp_qpair_connect_sock(ctrlr, &tqpair.qpair);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_ut_sock_impl_name != NULL && !strcmp(g_ut_sock_impl_name, "posix"));
+	CU_ASSERT(g_ut_sock_impl_opts.enable_zerocopy_send_client == true);
+	CU_ASSERT(g_ut_sock_impl_opts.zerocopy_threshold == 16384);
+
+	MOCK_CLEAR(spdk_sock_get_default_impl);
+	g_spdk_nvme_transport_opts.tcp_zcopy_threshold = 0;
 
 	/* Unsupported family of the transport address */
 	ctrlr->trid.adrfam = SPDK_NVMF_ADRFAM_IB;
@@ -1919,6 +1947,132 @@ test_nvme_tcp_qpair_submit_request(void)
 	free(tctrlr);
 }
 
+static void
+test_nvme_tcp_poll_group_batch_digests(void)
+{
+	struct spdk_nvme_ctrlr ctrlr = {};
+	struct spdk_nvme_tcp_stat stats = {};
+	struct nvme_tcp_pdu send_pdu = {}, recv_pdu = {}, treq_pdu = {};
+	struct nvme_tcp_qpair tqpair = {
+		.qpair = {
+			.trtype = SPDK_NVME_TRANSPORT_TCP,
+			.ctrlr = &ctrlr,
+			.id = 1,
+		},
+		.recv_pdu = &recv_pdu,
+		.stats = &stats,
+	};
+	struct spdk_nvme_poll_group group = {};
+	struct nvme_tcp_poll_group tgroup = { .group.group = &group };
+	struct nvme_request send_req = {}, recv_req = { .qpair = &tqpair.qpair };
+	struct nvme_tcp_req send_treq = { .req = &send_req, .tqpair = &tqpair };
+	struct nvme_tcp_req recv_treq = { .req = &recv_req, .tqpair = &tqpair, .pdu = &treq_pdu };
+	uint8_t buf[4096];
+	uint32_t crc32c, reaped = 0;
+	int64_t rc;
+
+	memset(buf, 0xA5, sizeof(buf));
+	crc32c = spdk_crc32c_update(buf, sizeof(buf), ~0) ^ SPDK_CRC32C_XOR;
+
+	tqpair.qpair.poll_group = &tgroup.group;
+	tqpair.qpair.state = NVME_QPAIR_CONNECTED;
+	tqpair.flags.host_ddgst_enable = 1;
+	TAILQ_INIT(&tqpair.send_queue);
+	TAILQ_INIT(&tqpair.outstanding_reqs);
+	TAILQ_INIT(&tgroup.needs_poll);
+	TAILQ_INIT(&tgroup.send_digest_pdus);
+	TAILQ_INIT(&tgroup.recv_digest_pdus);
+	STAILQ_INIT(&tgroup.group.disconnected_qpairs);
+
+	/* The digest of a sent PDU is calculated when the group is polled */
+	send_pdu.req = &send_treq;
+	send_pdu.hdr.common.pdu_type = SPDK_NVME_TCP_PDU_TYPE_CAPSULE_CMD;
+	send_pdu.hdr.common.hlen = sizeof(struct spdk_nvme_tcp_cmd);
+	send_pdu.data_len = sizeof(buf);
+	send_pdu.data_iov[0].iov_base = buf;
+	send_pdu.data_iov[0].iov_len = sizeof(buf);
+	send_pdu.data_iovcnt = 1;
+
+	nvme_tcp_qpair_write_pdu(&tqpair, &send_pdu, ut_nvme_tcp_qpair_xfer_complete_cb, NULL);
+	CU_ASSERT(TAILQ_FIRST(&tgroup.send_digest_pdus) == &send_pdu);
+	CU_ASSERT(TAILQ_EMPTY(&tqpair.send_queue));
+
+	/* The completion of a received PDU is held until its digest is checked */
+	recv_pdu.req = &recv_treq;
+	recv_pdu.ddgst_enable = true;
+	recv_pdu.hdr.common.pdu_type = SPDK_NVME_TCP_PDU_TYPE_C2H_DATA;
+	recv_pdu.hdr.c2h_data.common.flags = SPDK_NVME_TCP_C2H_DATA_FLAGS_SUCCESS |
+					     SPDK_NVME_TCP_C2H_DATA_FLAGS_LAST_PDU;
+	recv_pdu.data_len = sizeof(buf);
+	recv_pdu.data_iov[0].iov_base = buf;
+	recv_pdu.data_iov[0].iov_len = sizeof(buf);
+	recv_pdu.data_iovcnt = 1;
+	MAKE_DIGEST_WORD(recv_pdu.data_digest, crc32c);
+	recv_req.payload_size = sizeof(buf);
+	recv_req.cb_fn = ut_nvme_complete_request;
+	recv_treq.state = NVME_TCP_REQ_ACTIVE;
+	recv_treq.ordering.bits.send_ack = 1;
+	TAILQ_INSERT_TAIL(&tqpair.outstanding_reqs, &recv_treq, link);
+	tqpair.qpair.num_outstanding_reqs = 1;
+	tqpair.recv_state = NVME_TCP_PDU_RECV_STATE_AWAIT_PDU_PAYLOAD;
+
+	nvme_tcp_pdu_payload_handle(&tqpair, &reaped);
+	CU_ASSERT(tqpair.recv_state == NVME_TCP_PDU_RECV_STATE_AWAIT_PDU_READY);
+	CU_ASSERT(TAILQ_FIRST(&tgroup.recv_digest_pdus) == &treq_pdu);
+	CU_ASSERT(recv_treq.ordering.bits.data_recv == 1);
+	CU_ASSERT(recv_treq.ordering.bits.in_progress_accel == 1);
+	CU_ASSERT(tqpair.qpair.num_outstanding_reqs == 1);
+	CU_ASSERT(reaped == 0);
+
+	rc = nvme_tcp_poll_group_process_completions(&tgroup.group, 0,
+			ut_disconnect_qpair_poll_group_cb);
+	CU_ASSERT(rc == 1);
+	CU_ASSERT(TAILQ_EMPTY(&tgroup.send_digest_pdus));
+	CU_ASSERT(TAILQ_EMPTY(&tgroup.recv_digest_pdus));
+	CU_ASSERT(MATCH_DIGEST_WORD(send_pdu.data_digest, crc32c));
+	CU_ASSERT(TAILQ_FIRST(&tqpair.send_queue) == &send_pdu);
+	CU_ASSERT(recv_treq.rsp.status.sc == SPDK_NVME_SC_SUCCESS);
+	CU_ASSERT(tqpair.qpair.num_outstanding_reqs == 0);
+	TAILQ_REMOVE(&tqpair.send_queue, &send_pdu, tailq);
+
+	/* A digest mismatch fails the request */
+	recv_treq.state = NVME_TCP_REQ_ACTIVE;
+	recv_treq.ordering.raw = 0;
+	recv_treq.ordering.bits.send_ack = 1;
+	TAILQ_INSERT_TAIL(&tqpair.outstanding_reqs, &recv_treq, link);
+	tqpair.qpair.num_outstanding_reqs = 1;
+	tqpair.recv_state = NVME_TCP_PDU_RECV_STATE_AWAIT_PDU_PAYLOAD;
+	recv_pdu.req = &recv_treq;
+	MAKE_DIGEST_WORD(recv_pdu.data_digest, ~crc32c);
+
+	nvme_tcp_pdu_payload_handle(&tqpair, &reaped);
+	rc = nvme_tcp_poll_group_process_completions(&tgroup.group, 0,
+			ut_disconnect_qpair_poll_group_cb);
+	CU_ASSERT(rc == 1);
+	CU_ASSERT(recv_treq.rsp.status.sc == SPDK_NVME_SC_COMMAND_TRANSIENT_TRANSPORT_ERROR);
+	CU_ASSERT(tqpair.qpair.num_outstanding_reqs == 0);
+
+	/* Disconnecting the qpair drops its queued PDUs */
+	nvme_tcp_qpair_write_pdu(&tqpair, &send_pdu, ut_nvme_tcp_qpair_xfer_complete_cb, NULL);
+	recv_treq.state = NVME_TCP_REQ_ACTIVE;
+	recv_treq.ordering.raw = 0;
+	recv_treq.ordering.bits.send_ack = 1;
+	TAILQ_INSERT_TAIL(&tqpair.outstanding_reqs, &recv_treq, link);
+	tqpair.qpair.num_outstanding_reqs = 1;
+	tqpair.recv_state = NVME_TCP_PDU_RECV_STATE_AWAIT_PDU_PAYLOAD;
+	recv_pdu.req = &recv_treq;
+	recv_pdu.hdr.c2h_data.common.flags = SPDK_NVME_TCP_C2H_DATA_FLAGS_LAST_PDU;
+
+	nvme_tcp_pdu_payload_handle(&tqpair, &reaped);
+	CU_ASSERT(!TAILQ_EMPTY(&tgroup.send_digest_pdus));
+	CU_ASSERT(!TAILQ_EMPTY(&tgroup.recv_digest_pdus));
+
+	nvme_tcp_poll_group_drop_digests(&tgroup, &tqpair);
+	CU_ASSERT(TAILQ_EMPTY(&tgroup.send_digest_pdus));
+	CU_ASSERT(TAILQ_EMPTY(&tgroup.recv_digest_pdus));
+	CU_ASSERT(recv_treq.ordering.bits.in_progress_accel == 0);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -1955,6 +2109,7 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_nvme_tcp_poll_group_get_stats);
 	CU_ADD_TEST(suite, test_nvme_tcp_ctrlr_construct);
 	CU_ADD_TEST(suite, test_nvme_tcp_qpair_submit_request);
+	CU_ADD_TEST(suite, test_nvme_tcp_poll_group_batch_digests);
 
 	num_failures = spdk_ut_run_tests(argc, argv, NULL);
 	CU_cleanup_registry();
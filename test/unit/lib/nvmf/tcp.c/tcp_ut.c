@@ -279,6 +279,9 @@ DEFINE_STUB(spdk_accel_submit_crc32cv,
 	     uint32_t iovcnt, uint32_t seed, spdk_accel_completion_cb cb_fn, void *cb_arg),
 	    0);
 
+DEFINE_STUB(spdk_accel_get_opc_module_name, int,
+	    (enum spdk_accel_opcode opcode, const char **module_name), -ENOENT);
+
 DEFINE_STUB(spdk_nvmf_bdev_ctrlr_nvme_passthru_admin,
 	    int,
 	    (struct spdk_bdev *bdev, struct spdk_bdev_desc *desc,
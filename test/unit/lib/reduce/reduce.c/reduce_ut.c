@@ -1210,6 +1210,237 @@ destroy(void)
 	backing_dev_destroy(&backing_dev);
 }
 
+static void
+_md_write_chunk(uint64_t chunk, char init_val)
+{
+	uint32_t lbas_per_chunk = g_vol->params.chunk_size / g_vol->params.logical_block_size;
+	char buf[16 * 1024];
+	struct iovec iov;
+
+	ut_build_data_buffer(buf, sizeof(buf), init_val, 4);
+	iov.iov_base = buf;
+	iov.iov_len = sizeof(buf);
+	g_reduce_errno = -1;
+	spdk_reduce_vol_writev(g_vol, &iov, 1, chunk * lbas_per_chunk, lbas_per_chunk, write_cb, NULL);
+	CU_ASSERT(g_reduce_errno == 0);
+}
+
+static void
+_md_verify_chunk(uint64_t chunk, char init_val)
+{
+	uint32_t lbas_per_chunk = g_vol->params.chunk_size / g_vol->params.logical_block_size;
+	char buf[16 * 1024], compare_buf[16 * 1024];
+	struct iovec iov;
+
+	if (init_val == 0) {
+		memset(compare_buf, 0, sizeof(compare_buf));
+	} else {
+		ut_build_data_buffer(compare_buf, sizeof(compare_buf), init_val, 4);
+	}
+	iov.iov_base = buf;
+	iov.iov_len = sizeof(buf);
+	g_reduce_errno = -1;
+	spdk_reduce_vol_readv(g_vol, &iov, 1, chunk * lbas_per_chunk, lbas_per_chunk, read_cb, NULL);
+	CU_ASSERT(g_reduce_errno == 0);
+	CU_ASSERT(memcmp(buf, compare_buf, sizeof(buf)) == 0);
+}
+
+static void
+_md_crash_and_load(struct spdk_reduce_backing_dev *backing_dev)
+{
+	size_t size = backing_dev->blockcnt * backing_dev->blocklen;
+	char *crash_image;
+
+	/* Take a copy of the backing device as it would look like if we crashed right now.  The
+	 *  unload writes the maps back, so restore the copy to force the load to replay the log.
+	 */
+	crash_image = malloc(size);
+	SPDK_CU_ASSERT_FATAL(crash_image != NULL);
+	memcpy(crash_image, g_backing_dev_buf, size);
+
+	g_reduce_errno = -1;
+	spdk_reduce_vol_unload(g_vol, unload_cb, NULL);
+	CU_ASSERT(g_reduce_errno == 0);
+
+	memcpy(g_backing_dev_buf, crash_image, size);
+	free(crash_image);
+
+	g_vol = NULL;
+	g_reduce_errno = -1;
+	spdk_reduce_vol_load(backing_dev, load_cb, NULL);
+	CU_ASSERT(g_reduce_errno == 0);
+	SPDK_CU_ASSERT_FATAL(g_vol != NULL);
+	SPDK_CU_ASSERT_FATAL(g_vol->md_log != NULL);
+	/* The load writes back everything it replayed. */
+	CU_ASSERT(g_vol->md_log->num_dirty_pages == 0);
+	CU_ASSERT(g_vol->md_log->ckpt_seq == g_vol->md_log->open_seq);
+}
+
+static void
+_backing_dev_md(uint32_t backing_io_unit_size)
+{
+	struct spdk_reduce_vol_params params = {};
+	struct spdk_reduce_backing_dev backing_dev = {};
+	struct reduce_md_header *header;
+	uint64_t num_chunks, ckpt_seq, chunk;
+	size_t backing_dev_size;
+	char buf[16 * 1024], *crash_image;
+	struct iovec iov;
+	int i;
+
+	params.chunk_size = 16 * 1024;
+	params.backing_io_unit_size = backing_io_unit_size;
+	params.logical_block_size = 512;
+	spdk_uuid_generate(&params.uuid);
+
+	backing_dev_init(&backing_dev, &params, 512);
+	backing_dev_size = backing_dev.blockcnt * backing_dev.blocklen;
+
+	g_vol = NULL;
+	memset(g_path, 0xFF, sizeof(g_path));
+	g_reduce_errno = -1;
+	spdk_reduce_vol_init(&params, &backing_dev, NULL, init_cb, NULL);
+	CU_ASSERT(g_reduce_errno == 0);
+	SPDK_CU_ASSERT_FATAL(g_vol != NULL);
+	SPDK_CU_ASSERT_FATAL(g_vol->md_log != NULL);
+	/* No persistent memory file is used. */
+	CU_ASSERT(g_persistent_pm_buf == NULL);
+	CU_ASSERT(spdk_reduce_vol_get_pm_path(g_vol)[0] == '\0');
+	CU_ASSERT(((struct spdk_reduce_vol_superblock *)g_backing_dev_buf)->md_type ==
+		  REDUCE_MD_TYPE_BACKING_DEV);
+	/* The metadata takes some of the backing device, so the volume is smaller. */
+	CU_ASSERT(g_vol->params.vol_size < _get_vol_size(params.chunk_size,
+			backing_dev.blockcnt * backing_dev.blocklen));
+	CU_ASSERT(g_vol->params.vol_size >= _get_vol_size(params.chunk_size,
+			backing_dev.blockcnt * backing_dev.blocklen - 2 * _get_md_size(&g_vol->params)));
+	header = (struct reduce_md_header *)(g_backing_dev_buf + REDUCE_MD_HEADER_OFFSET);
+	CU_ASSERT(memcmp(header->signature, SPDK_REDUCE_MD_SIGNATURE, sizeof(header->signature)) == 0);
+	num_chunks = g_vol->params.vol_size / g_vol->params.chunk_size;
+
+	/* Writes and unmaps that were acknowledged must survive a crash. */
+	_md_write_chunk(0, 0x10);
+	_md_write_chunk(1, 0x20);
+	_md_write_chunk(0, 0x30);
+	_md_write_chunk(2, 0x40);
+	g_reduce_errno = -1;
+	spdk_reduce_vol_unmap(g_vol, 2 * g_vol->logical_blocks_per_chunk,
+			      g_vol->logical_blocks_per_chunk, unmap_cb, NULL);
+	CU_ASSERT(g_reduce_errno == 0);
+	CU_ASSERT(g_vol->md_log->num_dirty_pages > 0);
+
+	_md_crash_and_load(&backing_dev);
+	_md_verify_chunk(0, 0x30);
+	_md_verify_chunk(1, 0x20);
+	_md_verify_chunk(2, 0);
+	CU_ASSERT(_vol_get_chunk_map_index(g_vol, 2 * g_vol->logical_blocks_per_chunk) ==
+		  REDUCE_EMPTY_MAP_ENTRY);
+	/* Only the io units of the two live chunks are allocated after the replay. */
+	CU_ASSERT(spdk_bit_array_count_set(g_vol->allocated_chunk_maps) == 2);
+
+	/* A write isn't completed before its log entries are durable, and a crash before that
+	 *  leaves the old data in place.
+	 */
+	crash_image = malloc(backing_dev_size);
+	SPDK_CU_ASSERT_FATAL(crash_image != NULL);
+	g_defer_bdev_io = true;
+	ut_build_data_buffer(buf, sizeof(buf), 0x50, 4);
+	iov.iov_base = buf;
+	iov.iov_len = sizeof(buf);
+	g_reduce_errno = -1;
+	spdk_reduce_vol_writev(g_vol, &iov, 1, 0, g_vol->logical_blocks_per_chunk, write_cb, NULL);
+	while (TAILQ_EMPTY(&g_vol->md_log->waiters)) {
+		SPDK_CU_ASSERT_FATAL(g_pending_bdev_io_count > 0);
+		backing_dev_io_execute(1);
+	}
+	CU_ASSERT(g_reduce_errno == -1);
+	CU_ASSERT(g_pending_bdev_io_count == 1);
+	memcpy(crash_image, g_backing_dev_buf, backing_dev_size);
+	backing_dev_io_execute(0);
+	CU_ASSERT(g_reduce_errno == 0);
+	g_defer_bdev_io = false;
+	_md_verify_chunk(0, 0x50);
+
+	g_reduce_errno = -1;
+	spdk_reduce_vol_unload(g_vol, unload_cb, NULL);
+	CU_ASSERT(g_reduce_errno == 0);
+	memcpy(g_backing_dev_buf, crash_image, backing_dev_size);
+	free(crash_image);
+
+	g_vol = NULL;
+	g_reduce_errno = -1;
+	spdk_reduce_vol_load(&backing_dev, load_cb, NULL);
+	CU_ASSERT(g_reduce_errno == 0);
+	SPDK_CU_ASSERT_FATAL(g_vol != NULL);
+	_md_verify_chunk(0, 0x30);
+	_md_verify_chunk(1, 0x20);
+
+	/* Enough writes to wrap the log several times need checkpoints along the way. */
+	ckpt_seq = g_vol->md_log->ckpt_seq;
+	for (i = 0; i < 4 * (int)g_vol->md_log->log_pages; i++) {
+		chunk = i % num_chunks;
+		_md_write_chunk(chunk, (char)(1 + (chunk + i) % 255));
+	}
+	CU_ASSERT(g_vol->md_log->ckpt_seq > ckpt_seq);
+	CU_ASSERT(g_vol->md_log->md_errno == 0);
+	CU_ASSERT(TAILQ_EMPTY(&g_vol->md_log->waiters));
+
+	_md_crash_and_load(&backing_dev);
+	for (i = 4 * (int)g_vol->md_log->log_pages - (int)num_chunks;
+	     i < 4 * (int)g_vol->md_log->log_pages; i++) {
+		chunk = i % num_chunks;
+		_md_verify_chunk(chunk, (char)(1 + (chunk + i) % 255));
+	}
+	CU_ASSERT(spdk_bit_array_count_set(g_vol->allocated_chunk_maps) == num_chunks);
+
+	/* A clean unload writes back the maps, so the next load has nothing to replay. */
+	g_reduce_errno = -1;
+	spdk_reduce_vol_unload(g_vol, unload_cb, NULL);
+	CU_ASSERT(g_reduce_errno == 0);
+	CU_ASSERT(header->ckpt_seq > 0);
+
+	g_vol = NULL;
+	g_reduce_errno = -1;
+	spdk_reduce_vol_load(&backing_dev, load_cb, NULL);
+	CU_ASSERT(g_reduce_errno == 0);
+	SPDK_CU_ASSERT_FATAL(g_vol != NULL);
+	CU_ASSERT(g_vol->md_log->open_seq == header->ckpt_seq);
+	for (i = 4 * (int)g_vol->md_log->log_pages - (int)num_chunks;
+	     i < 4 * (int)g_vol->md_log->log_pages; i++) {
+		chunk = i % num_chunks;
+		_md_verify_chunk(chunk, (char)(1 + (chunk + i) % 255));
+	}
+
+	g_reduce_errno = -1;
+	spdk_reduce_vol_unload(g_vol, unload_cb, NULL);
+	CU_ASSERT(g_reduce_errno == 0);
+
+	/* A corrupted metadata header fails the load. */
+	header->crc ^= 1;
+	g_vol = NULL;
+	g_reduce_errno = 0;
+	spdk_reduce_vol_load(&backing_dev, load_cb, NULL);
+	CU_ASSERT(g_reduce_errno == -EILSEQ);
+	CU_ASSERT(g_vol == NULL);
+	header->crc ^= 1;
+
+	g_reduce_errno = -1;
+	spdk_reduce_vol_destroy(&backing_dev, destroy_cb, NULL);
+	CU_ASSERT(g_reduce_errno == 0);
+
+	g_reduce_errno = 0;
+	spdk_reduce_vol_load(&backing_dev, load_cb, NULL);
+	CU_ASSERT(g_reduce_errno == -EILSEQ);
+
+	backing_dev_destroy(&backing_dev);
+}
+
+static void
+backing_dev_md(void)
+{
+	_backing_dev_md(512);
+	_backing_dev_md(4096);
+}
+
 /* This test primarily checks that the reduce unit test infrastructure for asynchronous
  * backing device I/O operations is working correctly.
  */
@@ -1344,6 +1575,133 @@ overlapped(void)
 	backing_dev_destroy(&backing_dev);
 }
 
+static uint32_t
+ut_count_free_requests(struct spdk_reduce_vol *vol)
+{
+	struct spdk_reduce_vol_request *req;
+	uint32_t count = 0;
+
+	TAILQ_FOREACH(req, &vol->free_requests, tailq) {
+		count++;
+	}
+
+	return count;
+}
+
+static void
+multi_chunk_io(void)
+{
+	struct spdk_reduce_vol_params params = {};
+	struct spdk_reduce_backing_dev backing_dev = {};
+	const uint32_t logical_block_size = 512;
+	const uint32_t chunk_size = 16 * 1024;
+	const uint32_t blocks_per_chunk = chunk_size / logical_block_size;
+	struct iovec iov[3];
+	uint8_t *buf, *data, *compare_buf;
+	uint32_t len;
+
+	params.chunk_size = chunk_size;
+	params.backing_io_unit_size = 4096;
+	params.logical_block_size = logical_block_size;
+	spdk_uuid_generate(&params.uuid);
+
+	backing_dev_init(&backing_dev, &params, 512);
+
+	g_vol = NULL;
+	g_reduce_errno = -1;
+	spdk_reduce_vol_init(&params, &backing_dev, TEST_MD_PATH, init_cb, NULL);
+	CU_ASSERT(g_reduce_errno == 0);
+	SPDK_CU_ASSERT_FATAL(g_vol != NULL);
+	CU_ASSERT(ut_count_free_requests(g_vol) == REDUCE_NUM_VOL_REQUESTS);
+
+	len = (REDUCE_MAX_BATCH_CHUNKS + 1) * chunk_size;
+	buf = calloc(1, len);
+	compare_buf = calloc(1, len);
+	data = calloc(1, len);
+	SPDK_CU_ASSERT_FATAL(buf != NULL && compare_buf != NULL && data != NULL);
+
+	/* Fill the whole first chunk with 0xAA */
+	memset(buf, 0xAA, chunk_size);
+	iov[0].iov_base = buf;
+	iov[0].iov_len = chunk_size;
+	g_reduce_errno = -1;
+	spdk_reduce_vol_writev(g_vol, iov, 1, 0, blocks_per_chunk, write_cb, NULL);
+	CU_ASSERT(g_reduce_errno == 0);
+
+	/* Write the second half of chunk 0, all of chunk 1 and the first half of chunk 2 using
+	 * iovecs that don't line up with the chunk boundaries.  Chunk 0 needs a read-modify-write,
+	 * chunk 1 is fully overwritten and chunk 2 hasn't been allocated yet.
+	 */
+	len = 2 * chunk_size;
+	ut_build_data_buffer(data, len, 0x10, 256);
+	iov[0].iov_base = data;
+	iov[0].iov_len = 5 * logical_block_size;
+	iov[1].iov_base = data + iov[0].iov_len;
+	iov[1].iov_len = 40 * logical_block_size;
+	iov[2].iov_base = data + iov[0].iov_len + iov[1].iov_len;
+	iov[2].iov_len = len - iov[0].iov_len - iov[1].iov_len;
+	g_reduce_errno = -100;
+	g_defer_bdev_io = true;
+	spdk_reduce_vol_writev(g_vol, iov, 3, blocks_per_chunk / 2, 2 * blocks_per_chunk,
+			       write_cb, NULL);
+	/* Only the read of the old chunk 0 should be pending, the other chunks wait for it */
+	CU_ASSERT(g_reduce_errno == -100);
+	CU_ASSERT(g_pending_bdev_io_count == 1);
+
+	backing_dev_io_execute(1);
+	CU_ASSERT(g_reduce_errno == -100);
+	/* All three chunks compress into a single io unit each.  They were allocated back to
+	 * back, so they should be written by a single merged backing IO.
+	 */
+	CU_ASSERT(g_pending_bdev_io_count == 1);
+	SPDK_CU_ASSERT_FATAL(!TAILQ_EMPTY(&g_pending_bdev_io));
+	CU_ASSERT(TAILQ_FIRST(&g_pending_bdev_io)->iovcnt == 3);
+	CU_ASSERT(TAILQ_FIRST(&g_pending_bdev_io)->lba_count == 3 * 4096 / 512);
+
+	backing_dev_io_execute(0);
+	CU_ASSERT(g_reduce_errno == 0);
+	CU_ASSERT(ut_count_free_requests(g_vol) == REDUCE_NUM_VOL_REQUESTS);
+	g_defer_bdev_io = false;
+
+	/* Read back all three chunks with a single request */
+	memset(compare_buf, 0, 3 * chunk_size);
+	memset(compare_buf, 0xAA, chunk_size / 2);
+	memcpy(compare_buf + chunk_size / 2, data, 2 * chunk_size);
+	memset(buf, 0xFF, 3 * chunk_size);
+	iov[0].iov_base = buf;
+	iov[0].iov_len = 7 * logical_block_size;
+	iov[1].iov_base = buf + iov[0].iov_len;
+	iov[1].iov_len = 3 * chunk_size - iov[0].iov_len;
+	g_reduce_errno = -100;
+	spdk_reduce_vol_readv(g_vol, iov, 2, 0, 3 * blocks_per_chunk, read_cb, NULL);
+	CU_ASSERT(g_reduce_errno == 0);
+	CU_ASSERT(memcmp(buf, compare_buf, 3 * chunk_size) == 0);
+	CU_ASSERT(ut_count_free_requests(g_vol) == REDUCE_NUM_VOL_REQUESTS);
+
+	/* Requests spanning too many chunks are rejected */
+	iov[0].iov_base = buf;
+	iov[0].iov_len = (REDUCE_MAX_BATCH_CHUNKS + 1) * chunk_size;
+	g_reduce_errno = -100;
+	spdk_reduce_vol_writev(g_vol, iov, 1, 0, (REDUCE_MAX_BATCH_CHUNKS + 1) * blocks_per_chunk,
+			       write_cb, NULL);
+	CU_ASSERT(g_reduce_errno == -EINVAL);
+	g_reduce_errno = -100;
+	spdk_reduce_vol_readv(g_vol, iov, 1, 0, (REDUCE_MAX_BATCH_CHUNKS + 1) * blocks_per_chunk,
+			      read_cb, NULL);
+	CU_ASSERT(g_reduce_errno == -EINVAL);
+	CU_ASSERT(ut_count_free_requests(g_vol) == REDUCE_NUM_VOL_REQUESTS);
+
+	g_reduce_errno = -1;
+	spdk_reduce_vol_unload(g_vol, unload_cb, NULL);
+	CU_ASSERT(g_reduce_errno == 0);
+
+	free(buf);
+	free(compare_buf);
+	free(data);
+	persistent_pm_buf_destroy();
+	backing_dev_destroy(&backing_dev);
+}
+
 #define BUFSIZE 4096
 
 static void
@@ -1989,8 +2347,10 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, readv_writev);
 	CU_ADD_TEST(suite, write_unmap_verify);
 	CU_ADD_TEST(suite, destroy);
+	CU_ADD_TEST(suite, backing_dev_md);
 	CU_ADD_TEST(suite, defer_bdev_io);
 	CU_ADD_TEST(suite, overlapped);
+	CU_ADD_TEST(suite, multi_chunk_io);
 	CU_ADD_TEST(suite, compress_algorithm);
 	CU_ADD_TEST(suite, test_prepare_compress_chunk);
 	CU_ADD_TEST(suite, test_reduce_decompress_chunk);
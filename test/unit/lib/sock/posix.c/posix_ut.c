@@ -136,6 +136,129 @@ flush(void)
 	free(req2);
 }
 
+static void
+ut_pipe_fill(struct spdk_pipe *pipe, uint8_t *data, uint32_t len)
+{
+	struct iovec iov[2];
+	int rc;
+
+	rc = spdk_pipe_writer_get_buffer(pipe, len, iov);
+	SPDK_CU_ASSERT_FATAL(rc == (int)len);
+	SPDK_CU_ASSERT_FATAL(iov[0].iov_len == len);
+	memcpy(iov[0].iov_base, data, len);
+	spdk_pipe_writer_advance(pipe, len);
+}
+
+static void
+readv_split(void)
+{
+	struct spdk_posix_sock psock = {};
+	struct spdk_sock *sock = &psock.base;
+	uint8_t data[4096], out[4096], *pipe_buf;
+	struct iovec iov[2];
+	int sv[2], i, rc;
+
+	for (i = 0; i < (int)sizeof(data); i++) {
+		data[i] = i % 251;
+	}
+
+	rc = socketpair(AF_UNIX, SOCK_STREAM, 0, sv);
+	SPDK_CU_ASSERT_FATAL(rc == 0);
+	rc = fcntl(sv[0], F_SETFL, O_NONBLOCK);
+	SPDK_CU_ASSERT_FATAL(rc == 0);
+	pipe_buf = calloc(1, 4096);
+	SPDK_CU_ASSERT_FATAL(pipe_buf != NULL);
+	psock.fd = sv[0];
+	psock.recv_buf_sz = 4096;
+	psock.recv_pipe = spdk_pipe_create(pipe_buf, 4096);
+	SPDK_CU_ASSERT_FATAL(psock.recv_pipe != NULL);
+
+	/* The pipe holds the first 100 bytes, the rest is received directly in the same call */
+	ut_pipe_fill(psock.recv_pipe, data, 100);
+	psock.pipe_has_data = true;
+	rc = write(sv[1], data + 100, 2000);
+	SPDK_CU_ASSERT_FATAL(rc == 2000);
+
+	memset(out, 0, sizeof(out));
+	iov[0].iov_base = out;
+	iov[0].iov_len = 1000;
+	iov[1].iov_base = out + 1000;
+	iov[1].iov_len = 1100;
+	rc = posix_sock_readv(sock, iov, 2);
+	CU_ASSERT(rc == 2100);
+	CU_ASSERT(memcmp(out, data, 2100) == 0);
+	CU_ASSERT(psock.pipe_has_data == false);
+	CU_ASSERT(spdk_pipe_reader_bytes_available(psock.recv_pipe) == 0);
+
+	/* Not enough data on the socket, only the pipe's content is returned */
+	ut_pipe_fill(psock.recv_pipe, data, 100);
+	psock.pipe_has_data = true;
+	memset(out, 0, sizeof(out));
+	rc = posix_sock_readv(sock, iov, 2);
+	CU_ASSERT(rc == 100);
+	CU_ASSERT(memcmp(out, data, 100) == 0);
+	CU_ASSERT(psock.pipe_has_data == false);
+
+	/* Small reads are still served from the pipe only */
+	ut_pipe_fill(psock.recv_pipe, data, 100);
+	psock.pipe_has_data = true;
+	rc = write(sv[1], data + 100, 100);
+	SPDK_CU_ASSERT_FATAL(rc == 100);
+	memset(out, 0, sizeof(out));
+	iov[0].iov_len = 200;
+	rc = posix_sock_readv(sock, iov, 1);
+	CU_ASSERT(rc == 100);
+	CU_ASSERT(memcmp(out, data, 100) == 0);
+
+	spdk_pipe_destroy(psock.recv_pipe);
+	free(pipe_buf);
+	close(sv[0]);
+	close(sv[1]);
+}
+
+static void
+flush_hold(void)
+{
+	struct spdk_posix_sock psock = {};
+	struct spdk_sock *sock = &psock.base;
+
+	sock->impl_opts.flush_batch_timeout = 10;
+
+	/* Nothing queued */
+	CU_ASSERT(posix_sock_flush_hold(sock, 100) == false);
+
+	/* The peer doesn't send anything, don't wait for more writes */
+	sock->queued_iovcnt = 2;
+	CU_ASSERT(posix_sock_flush_hold(sock, 100) == false);
+	CU_ASSERT(psock.flush_deadline == 0);
+
+	/* The peer keeps sending, hold the writes back until the deadline */
+	psock.socket_has_data = true;
+	CU_ASSERT(posix_sock_flush_hold(sock, 100) == true);
+	CU_ASSERT(psock.flush_deadline == 110);
+	sock->queued_iovcnt = 4;
+	CU_ASSERT(posix_sock_flush_hold(sock, 105) == true);
+	CU_ASSERT(posix_sock_flush_hold(sock, 110) == false);
+	CU_ASSERT(psock.flush_deadline == 0);
+	CU_ASSERT(psock.flush_batch_backoff == 0);
+
+	/* A big enough batch is sent right away */
+	sock->queued_iovcnt = 2;
+	CU_ASSERT(posix_sock_flush_hold(sock, 200) == true);
+	sock->queued_iovcnt = IOV_BATCH_SIZE / 2;
+	CU_ASSERT(posix_sock_flush_hold(sock, 201) == false);
+	CU_ASSERT(psock.flush_deadline == 0);
+	CU_ASSERT(posix_sock_flush_hold(sock, 202) == false);
+
+	/* Holding back didn't gather any more writes, so it's suspended for a while */
+	sock->queued_iovcnt = 2;
+	CU_ASSERT(posix_sock_flush_hold(sock, 300) == true);
+	CU_ASSERT(posix_sock_flush_hold(sock, 310) == false);
+	CU_ASSERT(psock.flush_batch_backoff == POSIX_SOCK_FLUSH_BATCH_BACKOFF);
+	CU_ASSERT(posix_sock_flush_hold(sock, 311) == false);
+	CU_ASSERT(psock.flush_batch_backoff == POSIX_SOCK_FLUSH_BATCH_BACKOFF - 1);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -147,6 +270,8 @@ main(int argc, char **argv)
 	suite = CU_add_suite("posix", NULL, NULL);
 
 	CU_ADD_TEST(suite, flush);
+	CU_ADD_TEST(suite, readv_split);
+	CU_ADD_TEST(suite, flush_hold);
 
 
 	num_failures = spdk_ut_run_tests(argc, argv, NULL);
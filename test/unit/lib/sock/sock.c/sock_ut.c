@@ -493,6 +493,7 @@ _sock_group(const char *ip, int port, char *impl_name)
 	struct spdk_sock *listen_sock;
 	struct spdk_sock *server_sock;
 	struct spdk_sock *client_sock;
+	struct spdk_sock_group_stats stats;
 	char *test_string = "abcdef";
 	ssize_t bytes_written;
 	struct iovec iov;
@@ -556,6 +557,13 @@ _sock_group(const char *ip, int port, char *impl_name)
 
 	CU_ASSERT(strncmp(test_string, g_buf, 7) == 0);
 
+	/* Only the socket in the group is accounted */
+	spdk_sock_group_get_stats(group, &stats);
+	CU_ASSERT(stats.num_socks == 1);
+	CU_ASSERT(stats.bytes_read == 7);
+	CU_ASSERT(stats.bytes_written == 0);
+	CU_ASSERT(stats.events == 1);
+
 	rc = spdk_sock_close(&client_sock);
 	CU_ASSERT(client_sock == NULL);
 	CU_ASSERT(rc == 0);
@@ -577,6 +585,9 @@ _sock_group(const char *ip, int port, char *impl_name)
 	rc = spdk_sock_group_remove_sock(group, server_sock);
 	CU_ASSERT(rc == 0);
 
+	spdk_sock_group_get_stats(group, &stats);
+	CU_ASSERT(stats.num_socks == 0);
+
 	rc = spdk_sock_group_close(&group);
 	CU_ASSERT(group == NULL);
 	CU_ASSERT(rc == 0);
@@ -704,6 +704,86 @@ iobuf_priority(void)
 	free_cores();
 }
 
+static void
+iobuf_adaptive_cache(void)
+{
+	struct spdk_iobuf_opts opts = {
+		.small_pool_count = 512,
+		.large_pool_count = 8,
+		.small_bufsize = SMALL_BUFSIZE,
+		.large_bufsize = LARGE_BUFSIZE,
+		.enable_adaptive_cache = 1,
+	};
+	struct spdk_iobuf_channel iobuf_ch = {};
+	struct spdk_iobuf_pool_cache *pool;
+	void *bufs[64];
+	int rc, finish = 0;
+	uint32_t i, j;
+
+	allocate_cores(1);
+	allocate_threads(1);
+
+	set_thread(0);
+
+	/* We cannot use spdk_iobuf_set_opts(), as it won't allow us to use such small pools */
+	g_iobuf.opts = opts;
+	rc = spdk_iobuf_initialize();
+	CU_ASSERT_EQUAL(rc, 0);
+
+	rc = spdk_iobuf_register_module("ut_module");
+	CU_ASSERT_EQUAL(rc, 0);
+	rc = spdk_iobuf_channel_init(&iobuf_ch, "ut_module", 4, 0);
+	CU_ASSERT_EQUAL(rc, 0);
+
+	pool = &iobuf_ch.cache[0].small;
+	CU_ASSERT_EQUAL(pool->cache_size, 4);
+	CU_ASSERT_EQUAL(pool->cache_size_min, 1);
+	CU_ASSERT_EQUAL(pool->cache_size_max, 16);
+	CU_ASSERT_EQUAL(pool->cache_count, 4);
+	/* Caches that were requested to be disabled stay disabled */
+	CU_ASSERT_EQUAL(iobuf_ch.cache[0].large.cache_size_max, 0);
+
+	/* Bursts much larger than the cache make it run dry often, so it should grow up to its
+	 * maximum size and stay there.
+	 */
+	for (i = 0; i < 32; ++i) {
+		for (j = 0; j < SPDK_COUNTOF(bufs); ++j) {
+			bufs[j] = spdk_iobuf_get(&iobuf_ch, SMALL_BUFSIZE, NULL, NULL);
+			SPDK_CU_ASSERT_FATAL(bufs[j] != NULL);
+		}
+		for (j = 0; j < SPDK_COUNTOF(bufs); ++j) {
+			spdk_iobuf_put(&iobuf_ch, bufs[j], SMALL_BUFSIZE);
+		}
+	}
+	CU_ASSERT_EQUAL(pool->cache_size, 16);
+	CU_ASSERT(pool->stats.refill > 0);
+	CU_ASSERT_EQUAL(pool->stats.steal, 0);
+	CU_ASSERT_EQUAL(pool->stats.retry, 0);
+
+	/* Now use a single buffer at a time, leaving most of the cache unused.  The cache should
+	 * shrink back to its minimum size and return the surplus buffers to the pool.
+	 */
+	for (i = 0; i < 32 * 1024; ++i) {
+		bufs[0] = spdk_iobuf_get(&iobuf_ch, SMALL_BUFSIZE, NULL, NULL);
+		SPDK_CU_ASSERT_FATAL(bufs[0] != NULL);
+		spdk_iobuf_put(&iobuf_ch, bufs[0], SMALL_BUFSIZE);
+	}
+	CU_ASSERT_EQUAL(pool->cache_size, 1);
+	CU_ASSERT(pool->cache_count <= 2);
+	CU_ASSERT(spdk_ring_count(pool->pool) >= opts.small_pool_count - 2);
+
+	spdk_iobuf_channel_fini(&iobuf_ch);
+	poll_threads();
+
+	spdk_iobuf_finish(ut_iobuf_finish_cb, &finish);
+	poll_threads();
+
+	CU_ASSERT_EQUAL(finish, 1);
+
+	free_threads();
+	free_cores();
+}
+
 int
 main(int argc, char **argv)
 {
@@ -716,6 +796,7 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, iobuf);
 	CU_ADD_TEST(suite, iobuf_cache);
 	CU_ADD_TEST(suite, iobuf_priority);
+	CU_ADD_TEST(suite, iobuf_adaptive_cache);
 
 	num_failures = spdk_ut_run_tests(argc, argv, NULL);
 	CU_cleanup_registry();
@@ -146,6 +146,104 @@ thread_send_msg(void)
 	free_threads();
 }
 
+static void
+count_msg_cb(void *ctx)
+{
+	int *count = ctx;
+
+	(*count)++;
+}
+
+static void
+thread_send_msg_batched_notify(void)
+{
+#ifdef __linux__
+	struct spdk_thread *thread0;
+	uint64_t notify;
+	int count = 0, i;
+
+	/* Threads created with interrupt mode enabled start out in interrupt mode. */
+	g_interrupt_mode = true;
+	allocate_threads(2);
+	set_thread(0);
+	thread0 = spdk_get_thread();
+	CU_ASSERT(thread0->in_interrupt);
+
+	/* A burst of messages to an idle thread only writes its eventfd once. */
+	set_thread(1);
+	for (i = 0; i < 3; i++) {
+		CU_ASSERT(spdk_thread_send_msg(thread0, count_msg_cb, &count) == 0);
+	}
+	CU_ASSERT(thread0->msg_notify_pending);
+	CU_ASSERT(read(thread0->msg_fd, &notify, sizeof(notify)) == sizeof(notify));
+	CU_ASSERT(notify == 1);
+	CU_ASSERT(write(thread0->msg_fd, &notify, sizeof(notify)) == sizeof(notify));
+
+	poll_thread(0);
+	CU_ASSERT(count == 3);
+	CU_ASSERT(!thread0->msg_notify_pending);
+
+	/* More messages than fit in a batch: the thread wakes itself up until the ring
+	 * is drained. */
+	set_thread(1);
+	for (i = 0; i < SPDK_MSG_BATCH_SIZE * 2 + 1; i++) {
+		CU_ASSERT(spdk_thread_send_msg(thread0, count_msg_cb, &count) == 0);
+	}
+	poll_threads();
+	CU_ASSERT(count == 3 + SPDK_MSG_BATCH_SIZE * 2 + 1);
+	CU_ASSERT(spdk_ring_count(thread0->messages) == 0);
+	CU_ASSERT(!thread0->msg_notify_pending);
+
+	/* Once re-armed, the next message notifies again. */
+	set_thread(1);
+	CU_ASSERT(spdk_thread_send_msg(thread0, count_msg_cb, &count) == 0);
+	CU_ASSERT(read(thread0->msg_fd, &notify, sizeof(notify)) == sizeof(notify));
+	CU_ASSERT(notify == 1);
+	CU_ASSERT(write(thread0->msg_fd, &notify, sizeof(notify)) == sizeof(notify));
+	poll_threads();
+	CU_ASSERT(count == 3 + SPDK_MSG_BATCH_SIZE * 2 + 2);
+
+	/* The UT thread ops cannot reschedule exiting threads in interrupt mode. */
+	for (i = 0; i < 2; i++) {
+		set_thread(i);
+		spdk_thread_set_interrupt_mode(false);
+	}
+
+	free_threads();
+	g_interrupt_mode = false;
+#endif
+}
+
+static void
+thread_msg_cache(void)
+{
+	struct spdk_thread *thread0, *thread1;
+	int count = 0, i;
+
+	allocate_threads(2);
+	set_thread(0);
+	thread0 = spdk_get_thread();
+	set_thread(1);
+	thread1 = spdk_get_thread();
+	CU_ASSERT(thread0->msg_cache_count == SPDK_MSG_MEMPOOL_CACHE_SIZE);
+	CU_ASSERT(thread1->msg_cache_count == SPDK_MSG_MEMPOOL_CACHE_SIZE);
+
+	/* Thread 1 sends more than a full cache worth of messages to thread 0. The
+	 * sender refills and the receiver trims its cache in bulk. */
+	for (i = 0; i < SPDK_MSG_MEMPOOL_CACHE_SIZE + 1; i++) {
+		CU_ASSERT(spdk_thread_send_msg(thread0, count_msg_cb, &count) == 0);
+	}
+	CU_ASSERT(thread1->msg_cache_count == SPDK_MSG_CACHE_BULK_SIZE - 1);
+
+	poll_threads();
+	CU_ASSERT(count == SPDK_MSG_MEMPOOL_CACHE_SIZE + 1);
+	CU_ASSERT(thread0->msg_cache_count <= SPDK_MSG_MEMPOOL_CACHE_SIZE);
+	CU_ASSERT(thread0->msg_cache_count == SPDK_MSG_MEMPOOL_CACHE_SIZE + 1 -
+		  SPDK_MSG_CACHE_BULK_SIZE);
+
+	free_threads();
+}
+
 static int
 poller_run_done(void *ctx)
 {
@@ -2182,6 +2280,8 @@ main(int argc, char **argv)
 
 	CU_ADD_TEST(suite, thread_alloc);
 	CU_ADD_TEST(suite, thread_send_msg);
+	CU_ADD_TEST(suite, thread_send_msg_batched_notify);
+	CU_ADD_TEST(suite, thread_msg_cache);
 	CU_ADD_TEST(suite, thread_poller);
 	CU_ADD_TEST(suite, poller_pause);
 	CU_ADD_TEST(suite, thread_for_each);
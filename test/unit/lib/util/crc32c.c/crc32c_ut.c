@@ -164,6 +164,56 @@ test_crc32c_nvme(void)
 	CU_ASSERT(crc == 0x214941A8);
 }
 
+static void
+test_crc32c_iov_update_multi(void)
+{
+	uint8_t buf[4096];
+	struct iovec iov_mem[7][3], *iovs[7];
+	uint32_t crcs[7], expected[7];
+	int iovcnts[7], i, j, count;
+	size_t offset = 0, len;
+
+	for (i = 0; i < (int)sizeof(buf); i++) {
+		buf[i] = (uint8_t)(i * 7 + 3);
+	}
+
+	/* Streams of different lengths, alignments and segment layouts */
+	for (i = 0; i < 7; i++) {
+		iovs[i] = iov_mem[i];
+		iovcnts[i] = i % 3 + 1;
+		for (j = 0; j < iovcnts[i]; j++) {
+			len = 1 + (i * 131 + j * 61) % 300;
+			iov_mem[i][j].iov_base = &buf[offset % 3000 + i];
+			iov_mem[i][j].iov_len = len;
+			offset += len;
+		}
+	}
+
+	for (count = 0; count <= 7; count++) {
+		for (i = 0; i < count; i++) {
+			crcs[i] = 0xFFFFFFFFu - i;
+			expected[i] = spdk_crc32c_iov_update(iovs[i], iovcnts[i], crcs[i]);
+		}
+
+		spdk_crc32c_iov_update_multi(iovs, iovcnts, crcs, count);
+		for (i = 0; i < count; i++) {
+			CU_ASSERT(crcs[i] == expected[i]);
+		}
+	}
+
+	/* Known value split across streams of the batch */
+	iov_mem[0][0].iov_base = "Hello";
+	iov_mem[0][0].iov_len = 5;
+	iov_mem[0][1].iov_base = " world!";
+	iov_mem[0][1].iov_len = 7;
+	iovcnts[0] = 2;
+	crcs[0] = 0xFFFFFFFFu;
+	crcs[1] = 0xFFFFFFFFu;
+	crcs[2] = 0xFFFFFFFFu;
+	spdk_crc32c_iov_update_multi(iovs, iovcnts, crcs, 3);
+	CU_ASSERT((crcs[0] ^ 0xFFFFFFFFu) == 0x7b98e751);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -176,6 +226,7 @@ main(int argc, char **argv)
 
 	CU_ADD_TEST(suite, test_crc32c);
 	CU_ADD_TEST(suite, test_crc32c_nvme);
+	CU_ADD_TEST(suite, test_crc32c_iov_update_multi);
 
 
 	num_failures = spdk_ut_run_tests(argc, argv, NULL);
@@ -62,6 +62,8 @@ function unittest_ftl() {
 	$valgrind $testdir/lib/ftl/ftl_sb/ftl_sb_ut
 	$valgrind $testdir/lib/ftl/ftl_layout_upgrade/ftl_layout_upgrade_ut
 	$valgrind $testdir/lib/ftl/ftl_p2l.c/ftl_p2l_ut
+	$valgrind $testdir/lib/ftl/ftl_writer.c/ftl_writer_ut
+	$valgrind $testdir/lib/ftl/ftl_l2p_cache.c/ftl_l2p_cache_ut
 }
 
 function unittest_iscsi() {